@@ -27,14 +27,7 @@
 /** @brief Intervalo de publicação em milissegundos (5 minutos) */
 #define CUSTOM_PUBLISH_INTERVAL_MS 300000
 
-/** @brief Tamanho da stack da task em bytes */
-#define CUSTOM_PUBLISH_TASK_STACK_SIZE 2560
-
-/** @brief Prioridade da task de publicação */
-#define CUSTOM_PUBLISH_TASK_PRIORITY 2
-
-/** @brief Nome da task para debug */
-#define CUSTOM_PUBLISH_TASK_NAME "CustomPublish"
+/* Stack, prioridade e núcleo: tabela em services/task_profile.c */
 
 /** @brief Tópico MQTT para publicação customizada */
 #define CUSTOM_PUBLISH_TOPIC "demo/central/custom"
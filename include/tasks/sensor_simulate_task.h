@@ -21,17 +21,39 @@
  * =============================================================================
  */
 
-/** @brief Intervalo de publicação em milissegundos (1 segundo) */
+/** @brief Intervalo de amostragem em milissegundos (1 segundo) */
 #define SENSOR_SIMULATE_INTERVAL_MS 1000
 
-/** @brief Tamanho da stack da task em bytes */
-#define SENSOR_SIMULATE_TASK_STACK_SIZE 3072
+/** @brief Período de amostragem em microssegundos (mínimo 1000 = 1 kHz) */
+#ifndef SENSOR_SIMULATE_PERIOD_US
+#define SENSOR_SIMULATE_PERIOD_US (SENSOR_SIMULATE_INTERVAL_MS * 1000UL)
+#endif
 
-/** @brief Prioridade da task de simulação de sensor */
-#define SENSOR_SIMULATE_TASK_PRIORITY 2
+/** @brief Variação mínima de luminosidade para publicar */
+#define SENSOR_LUMINOSITY_DEADBAND 2.0f
 
-/** @brief Nome da task para debug */
-#define SENSOR_SIMULATE_TASK_NAME "SensorSimulate"
+/** @brief Variação mínima de temperatura para publicar (°C) */
+#define SENSOR_TEMPERATURE_DEADBAND 2.0f
+
+/** @brief Publica variações abaixo da banda morta após este intervalo (ms) */
+#define SENSOR_REPORT_MAX_INTERVAL_MS 30000
+
+/** @brief Republica o valor mesmo sem variação após este intervalo (ms) */
+#define SENSOR_HEARTBEAT_MS 120000
+
+/**
+ * @brief Destinos das leituras (ver mqtt_publish_routed()).
+ *
+ * MQTT_ROUTE_ALL entrega ao motor de regras pelo barramento local e
+ * publica uma cópia no broker; MQTT_ROUTE_LOCAL mantém as leituras no
+ * dispositivo. O filtro de report-by-exception vale só para o broker: a
+ * rota local recebe todas as leituras.
+ */
+#ifndef SENSOR_PUBLISH_ROUTE
+#define SENSOR_PUBLISH_ROUTE MQTT_ROUTE_ALL
+#endif
+
+/* Stack, prioridade e núcleo: tabela em services/task_profile.c */
 
 /*
  * =============================================================================
@@ -42,8 +64,11 @@
 /**
  * @brief Função da task de simulação de sensores.
  *
- * Gera valores aleatórios para luminosidade e temperatura e os publica
- * em tópicos MQTT a cada segundo.
+ * Gera valores aleatórios para luminosidade e temperatura a cada
+ * SENSOR_SIMULATE_PERIOD_US (timer de sampler.h). Todas as leituras
+ * chegam aos handlers locais, mesmo sem conexão com o broker; no broker
+ * são publicadas apenas as que passam pelo filtro de report-by-exception
+ * de cada canal (ver report_filter.h).
  *
  * @param pvParameters Parâmetros da task (não utilizado).
  */
@@ -27,14 +27,7 @@
 /** @brief Intervalo de monitoramento em milissegundos (1 minuto) */
 #define MONITOR_INTERVAL_MS 60000
 
-/** @brief Tamanho da stack da task em bytes */
-#define MONITOR_TASK_STACK_SIZE 3072
-
-/** @brief Prioridade da task de monitoramento */
-#define MONITOR_TASK_PRIORITY 3
-
-/** @brief Nome da task para debug */
-#define MONITOR_TASK_NAME "SystemMonitor"
+/* Stack, prioridade e núcleo: tabela em services/task_profile.c */
 
 /*
  * =============================================================================
@@ -0,0 +1,12 @@
+/**
+ * @file esp_attr.h
+ * @brief Atributos de seção do ESP-IDF (sem efeito no host).
+ */
+
+#ifndef ESP_ATTR_H
+#define ESP_ATTR_H
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+
+#endif /* ESP_ATTR_H */
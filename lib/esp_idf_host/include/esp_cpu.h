@@ -0,0 +1,32 @@
+/**
+ * @file esp_cpu.h
+ * @brief Contador de ciclos da CPU (host).
+ *
+ * No x86 usa o TSC (frequência constante, não a do núcleo); nas demais
+ * arquiteturas, nanossegundos de CLOCK_MONOTONIC. Apenas diferenças
+ * entre duas leituras são significativas, como no CCOUNT do Xtensa.
+ */
+
+#ifndef ESP_CPU_H
+#define ESP_CPU_H
+
+#include <stdint.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+typedef uint32_t esp_cpu_cycle_count_t;
+
+static inline esp_cpu_cycle_count_t esp_cpu_get_cycle_count(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return (esp_cpu_cycle_count_t)__rdtsc();
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (esp_cpu_cycle_count_t)((uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec);
+#endif
+}
+
+#endif /* ESP_CPU_H */
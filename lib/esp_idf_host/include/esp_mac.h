@@ -0,0 +1,12 @@
+/**
+ * @file esp_mac.h
+ * @brief Macros de formatação de endereços MAC ESP-IDF (host).
+ */
+
+#ifndef ESP_MAC_H
+#define ESP_MAC_H
+
+#define MACSTR "%02x:%02x:%02x:%02x:%02x:%02x"
+#define MAC2STR(a) (a)[0], (a)[1], (a)[2], (a)[3], (a)[4], (a)[5]
+
+#endif /* ESP_MAC_H */
@@ -0,0 +1,13 @@
+/**
+ * @file esp_random.h
+ * @brief Gerador de números aleatórios ESP-IDF (host).
+ */
+
+#ifndef ESP_RANDOM_H
+#define ESP_RANDOM_H
+
+#include <stdint.h>
+
+uint32_t esp_random(void);
+
+#endif /* ESP_RANDOM_H */
@@ -0,0 +1,16 @@
+/**
+ * @file esp_rom_crc.h
+ * @brief CRC da ROM do ESP32 (host).
+ */
+
+#ifndef ESP_ROM_CRC_H
+#define ESP_ROM_CRC_H
+
+#include <stdint.h>
+
+/**
+ * @brief CRC32 little-endian (polinômio 0xEDB88320), compatível com a ROM.
+ */
+uint32_t esp_rom_crc32_le(uint32_t crc, uint8_t const *buf, uint32_t len);
+
+#endif /* ESP_ROM_CRC_H */
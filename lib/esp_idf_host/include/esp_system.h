@@ -0,0 +1,39 @@
+/**
+ * @file esp_system.h
+ * @brief Funções de sistema ESP-IDF (host).
+ *
+ * O heap é emulado com HOST_HEAP_SIZE bytes; o uso é obtido de
+ * mallinfo2(), de modo que alocações do firmware aparecem nas métricas.
+ */
+
+#ifndef ESP_SYSTEM_H
+#define ESP_SYSTEM_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+/** Tamanho do heap emulado (semelhante à DRAM livre de um ESP32) */
+#define HOST_HEAP_SIZE (320 * 1024)
+
+typedef enum
+{
+    ESP_RST_UNKNOWN,
+    ESP_RST_POWERON,
+    ESP_RST_EXT,
+    ESP_RST_SW,
+    ESP_RST_PANIC,
+    ESP_RST_INT_WDT,
+    ESP_RST_TASK_WDT,
+    ESP_RST_WDT,
+    ESP_RST_DEEPSLEEP,
+    ESP_RST_BROWNOUT,
+    ESP_RST_SDIO,
+} esp_reset_reason_t;
+
+esp_reset_reason_t esp_reset_reason(void);
+uint32_t esp_get_free_heap_size(void);
+uint32_t esp_get_minimum_free_heap_size(void);
+const char *esp_get_idf_version(void);
+void esp_restart(void) __attribute__((noreturn));
+
+#endif /* ESP_SYSTEM_H */
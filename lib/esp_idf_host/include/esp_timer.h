@@ -0,0 +1,64 @@
+/**
+ * @file esp_timer.h
+ * @brief Temporizador de alta resolução ESP-IDF (host).
+ */
+
+#ifndef ESP_TIMER_H
+#define ESP_TIMER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+/** Timer criado por esp_timer_create() */
+typedef struct esp_timer *esp_timer_handle_t;
+
+/** Callback do timer */
+typedef void (*esp_timer_cb_t)(void *arg);
+
+/** Contexto do callback (no host sempre uma thread do timer) */
+typedef enum
+{
+    ESP_TIMER_TASK,
+    ESP_TIMER_ISR,
+} esp_timer_dispatch_t;
+
+/**
+ * @brief Parâmetros de esp_timer_create().
+ */
+typedef struct
+{
+    esp_timer_cb_t callback;
+    void *arg;
+    esp_timer_dispatch_t dispatch_method;
+    const char *name;
+    bool skip_unhandled_events;
+} esp_timer_create_args_t;
+
+/**
+ * @brief Microssegundos desde o início do processo (CLOCK_MONOTONIC).
+ */
+int64_t esp_timer_get_time(void);
+
+/**
+ * @brief Cria um timer parado (uma thread por timer no host).
+ */
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args,
+                           esp_timer_handle_t *out_handle);
+
+/**
+ * @brief Dispara a cada period µs; o próximo disparo é o anterior + period.
+ */
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period);
+
+/**
+ * @brief Para o timer (ESP_ERR_INVALID_STATE se já parado).
+ */
+esp_err_t esp_timer_stop(esp_timer_handle_t timer);
+
+/**
+ * @brief Apaga um timer parado (ESP_ERR_INVALID_STATE se ativo).
+ */
+esp_err_t esp_timer_delete(esp_timer_handle_t timer);
+
+#endif /* ESP_TIMER_H */
@@ -0,0 +1,125 @@
+/**
+ * @file FreeRTOS.h
+ * @brief Tipos e macros do FreeRTOS (ESP-IDF) sobre POSIX.
+ *
+ * Tasks são pthreads e seções críticas (portMUX) são mutexes. A
+ * prioridade das tasks é registrada, mas o escalonamento fica a cargo
+ * do kernel do host.
+ */
+
+#ifndef FREERTOS_H
+#define FREERTOS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint8_t StackType_t;
+typedef uint32_t configSTACK_DEPTH_TYPE;
+
+#define pdFALSE ((BaseType_t)0)
+#define pdTRUE ((BaseType_t)1)
+#define pdFAIL pdFALSE
+#define pdPASS pdTRUE
+
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+
+/** Mesma frequência de tick do sdkconfig (CONFIG_FREERTOS_HZ) */
+#define configTICK_RATE_HZ 100
+#define portTICK_PERIOD_MS ((TickType_t)1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000U))
+#define pdTICKS_TO_MS(ticks) ((TickType_t)(((uint64_t)(ticks) * 1000U) / configTICK_RATE_HZ))
+
+#define configNUMBER_OF_CORES 2
+#define portNUM_PROCESSORS configNUMBER_OF_CORES
+#define configMAX_PRIORITIES 25
+#define configMINIMAL_STACK_SIZE 768
+#define configMAX_TASK_NAME_LEN 16
+#define tskNO_AFFINITY ((BaseType_t)0x7FFFFFFF)
+#define tskIDLE_PRIORITY 0
+
+/* Estatísticas de execução (CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS), em µs */
+#define configUSE_TRACE_FACILITY 1
+#define configGENERATE_RUN_TIME_STATS 1
+#define configRUN_TIME_COUNTER_TYPE uint32_t
+
+#define configASSERT(x)                                                 \
+    do                                                                  \
+    {                                                                   \
+        if (!(x))                                                       \
+        {                                                               \
+            vAssertCalled(__FILE__, __LINE__);                          \
+        }                                                               \
+    } while (0)
+
+void vAssertCalled(const char *file, int line) __attribute__((noreturn));
+
+#ifndef BIT0
+#define BIT0 0x00000001
+#define BIT1 0x00000002
+#define BIT2 0x00000004
+#define BIT3 0x00000008
+#define BIT4 0x00000010
+#define BIT5 0x00000020
+#define BIT6 0x00000040
+#define BIT7 0x00000080
+#endif
+
+#include "esp_attr.h"
+
+/* Seções críticas */
+
+typedef struct
+{
+    pthread_mutex_t mutex;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED {PTHREAD_MUTEX_INITIALIZER}
+
+void vPortEnterCritical(portMUX_TYPE *mux);
+void vPortExitCritical(portMUX_TYPE *mux);
+void portMUX_INITIALIZE(portMUX_TYPE *mux);
+
+#define portENTER_CRITICAL(mux) vPortEnterCritical(mux)
+#define portEXIT_CRITICAL(mux) vPortExitCritical(mux)
+#define portENTER_CRITICAL_ISR(mux) vPortEnterCritical(mux)
+#define portEXIT_CRITICAL_ISR(mux) vPortExitCritical(mux)
+#define portENTER_CRITICAL_SAFE(mux) vPortEnterCritical(mux)
+#define portEXIT_CRITICAL_SAFE(mux) vPortExitCritical(mux)
+#define taskENTER_CRITICAL(mux) vPortEnterCritical(mux)
+#define taskEXIT_CRITICAL(mux) vPortExitCritical(mux)
+
+#define portYIELD_FROM_ISR(x) ((void)(x))
+
+/** Não há interrupções no host: todo código roda em uma thread */
+#define xPortInIsrContext() pdFALSE
+
+/**
+ * @brief Núcleo "virtual" (0 ou 1) da CPU do host em que a thread roda.
+ */
+BaseType_t xPortGetCoreID(void);
+
+/* Estruturas para alocação estática */
+
+typedef struct
+{
+    void *handle;
+} StaticTask_t;
+
+typedef struct
+{
+    void *handle;
+} StaticQueue_t;
+
+typedef StaticQueue_t StaticSemaphore_t;
+
+typedef struct
+{
+    void *handle;
+} StaticEventGroup_t;
+
+#endif /* FREERTOS_H */
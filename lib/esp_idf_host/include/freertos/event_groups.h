@@ -0,0 +1,24 @@
+/**
+ * @file event_groups.h
+ * @brief Event groups do FreeRTOS sobre pthreads.
+ */
+
+#ifndef FREERTOS_EVENT_GROUPS_H
+#define FREERTOS_EVENT_GROUPS_H
+
+#include "FreeRTOS.h"
+
+typedef struct host_event_group *EventGroupHandle_t;
+typedef uint32_t EventBits_t;
+
+EventGroupHandle_t xEventGroupCreate(void);
+EventGroupHandle_t xEventGroupCreateStatic(StaticEventGroup_t *buffer);
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits);
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits);
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group);
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits_to_wait,
+                                BaseType_t clear_on_exit, BaseType_t wait_for_all,
+                                TickType_t ticks_to_wait);
+void vEventGroupDelete(EventGroupHandle_t group);
+
+#endif /* FREERTOS_EVENT_GROUPS_H */
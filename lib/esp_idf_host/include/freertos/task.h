@@ -0,0 +1,78 @@
+/**
+ * @file task.h
+ * @brief API de tasks do FreeRTOS sobre pthreads.
+ */
+
+#ifndef FREERTOS_TASK_H
+#define FREERTOS_TASK_H
+
+#include "FreeRTOS.h"
+
+typedef struct host_task *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+typedef enum
+{
+    eRunning = 0,
+    eReady,
+    eBlocked,
+    eSuspended,
+    eDeleted,
+    eInvalid
+} eTaskState;
+
+typedef struct
+{
+    TaskHandle_t xHandle;
+    const char *pcTaskName;
+    UBaseType_t xTaskNumber;
+    eTaskState eCurrentState;
+    UBaseType_t uxCurrentPriority;
+    UBaseType_t uxBasePriority;
+    configRUN_TIME_COUNTER_TYPE ulRunTimeCounter;
+    StackType_t *pxStackBase;
+    configSTACK_DEPTH_TYPE usStackHighWaterMark;
+    BaseType_t xCoreID;
+} TaskStatus_t;
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task_code, const char *name,
+                                   uint32_t stack_depth, void *parameters,
+                                   UBaseType_t priority, TaskHandle_t *created_task,
+                                   BaseType_t core_id);
+
+static inline BaseType_t xTaskCreate(TaskFunction_t task_code, const char *name,
+                                     uint32_t stack_depth, void *parameters,
+                                     UBaseType_t priority, TaskHandle_t *created_task)
+{
+    return xTaskCreatePinnedToCore(task_code, name, stack_depth, parameters,
+                                   priority, created_task, tskNO_AFFINITY);
+}
+
+TaskHandle_t xTaskCreateStaticPinnedToCore(TaskFunction_t task_code, const char *name,
+                                           uint32_t stack_depth, void *parameters,
+                                           UBaseType_t priority, StackType_t *stack_buffer,
+                                           StaticTask_t *task_buffer, BaseType_t core_id);
+
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+BaseType_t xTaskDelayUntil(TickType_t *previous_wake_time, TickType_t time_increment);
+#define vTaskDelayUntil(prev, inc) ((void)xTaskDelayUntil(prev, inc))
+
+TickType_t xTaskGetTickCount(void);
+TickType_t xTaskGetTickCountFromISR(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+char *pcTaskGetName(TaskHandle_t task);
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task);
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+UBaseType_t uxTaskGetNumberOfTasks(void);
+UBaseType_t uxTaskGetSystemState(TaskStatus_t *task_status_array, UBaseType_t array_size,
+                                 configRUN_TIME_COUNTER_TYPE *total_run_time);
+TaskHandle_t xTaskGetIdleTaskHandleForCore(BaseType_t core_id);
+
+/* Notificações */
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks_to_wait);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *higher_priority_task_woken);
+
+#endif /* FREERTOS_TASK_H */
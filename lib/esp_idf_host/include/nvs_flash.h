@@ -0,0 +1,14 @@
+/**
+ * @file nvs_flash.h
+ * @brief Inicialização da NVS (sem efeito no host).
+ */
+
+#ifndef NVS_FLASH_H
+#define NVS_FLASH_H
+
+#include "esp_err.h"
+
+esp_err_t nvs_flash_init(void);
+esp_err_t nvs_flash_erase(void);
+
+#endif /* NVS_FLASH_H */
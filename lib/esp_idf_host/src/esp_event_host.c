@@ -0,0 +1,179 @@
+/**
+ * @file esp_event_host.c
+ * @brief Loop de eventos padrão: fila + thread de despacho ("sys_evt").
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_event.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+
+/* Definições privadas */
+
+#define EVENT_MAX_HANDLERS 16
+#define EVENT_QUEUE_LENGTH 32
+#define EVENT_MAX_DATA 256
+
+typedef struct
+{
+    esp_event_base_t base;
+    int32_t id;
+    esp_event_handler_t handler;
+    void *arg;
+} event_handler_entry_t;
+
+typedef struct
+{
+    esp_event_base_t base;
+    int32_t id;
+    size_t data_size;
+    uint8_t data[EVENT_MAX_DATA];
+} event_item_t;
+
+/* Variáveis privadas (static) */
+
+static const char *TAG = "esp_event";
+
+esp_event_base_t const WIFI_EVENT = "WIFI_EVENT";
+esp_event_base_t const IP_EVENT = "IP_EVENT";
+
+static event_handler_entry_t s_handlers[EVENT_MAX_HANDLERS];
+static int s_handler_count = 0;
+static portMUX_TYPE s_handlers_mux = portMUX_INITIALIZER_UNLOCKED;
+static QueueHandle_t s_event_queue = NULL;
+
+/* Funções auxiliares */
+
+static void event_loop_task(void *pvParameters)
+{
+    event_item_t item;
+    event_handler_entry_t snapshot[EVENT_MAX_HANDLERS];
+
+    while (1)
+    {
+        if (xQueueReceive(s_event_queue, &item, portMAX_DELAY) != pdTRUE)
+        {
+            continue;
+        }
+
+        /* Copia a lista para que handlers possam (des)registrar outros */
+        portENTER_CRITICAL(&s_handlers_mux);
+        int count = s_handler_count;
+        memcpy(snapshot, s_handlers, sizeof(snapshot[0]) * (size_t)count);
+        portEXIT_CRITICAL(&s_handlers_mux);
+
+        for (int i = 0; i < count; i++)
+        {
+            bool base_match = snapshot[i].base == ESP_EVENT_ANY_BASE || snapshot[i].base == item.base;
+            bool id_match = snapshot[i].id == ESP_EVENT_ANY_ID || snapshot[i].id == item.id;
+            if (base_match && id_match)
+            {
+                snapshot[i].handler(snapshot[i].arg, item.base, item.id,
+                                    item.data_size ? item.data : NULL);
+            }
+        }
+    }
+}
+
+/* Implementação das funções públicas */
+
+esp_err_t esp_event_loop_create_default(void)
+{
+    if (s_event_queue != NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    s_event_queue = xQueueCreate(EVENT_QUEUE_LENGTH, sizeof(event_item_t));
+    if (s_event_queue == NULL)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (xTaskCreate(event_loop_task, "sys_evt", 2304, NULL, 20, NULL) != pdPASS)
+    {
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_event_handler_register(esp_event_base_t event_base, int32_t event_id,
+                                     esp_event_handler_t event_handler, void *event_handler_arg)
+{
+    if (event_handler == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = ESP_ERR_NO_MEM;
+    portENTER_CRITICAL(&s_handlers_mux);
+    if (s_handler_count < EVENT_MAX_HANDLERS)
+    {
+        s_handlers[s_handler_count++] = (event_handler_entry_t){
+            .base = event_base,
+            .id = event_id,
+            .handler = event_handler,
+            .arg = event_handler_arg,
+        };
+        ret = ESP_OK;
+    }
+    portEXIT_CRITICAL(&s_handlers_mux);
+    return ret;
+}
+
+esp_err_t esp_event_handler_unregister(esp_event_base_t event_base, int32_t event_id,
+                                       esp_event_handler_t event_handler)
+{
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+    portENTER_CRITICAL(&s_handlers_mux);
+    for (int i = 0; i < s_handler_count; i++)
+    {
+        if (s_handlers[i].base == event_base && s_handlers[i].id == event_id &&
+            s_handlers[i].handler == event_handler)
+        {
+            s_handlers[i] = s_handlers[--s_handler_count];
+            ret = ESP_OK;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&s_handlers_mux);
+    return ret;
+}
+
+esp_err_t esp_event_post(esp_event_base_t event_base, int32_t event_id,
+                         const void *event_data, size_t event_data_size,
+                         TickType_t ticks_to_wait)
+{
+    if (s_event_queue == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (event_data_size > EVENT_MAX_DATA)
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    event_item_t item = {
+        .base = event_base,
+        .id = event_id,
+        .data_size = event_data_size,
+    };
+    if (event_data && event_data_size)
+    {
+        memcpy(item.data, event_data, event_data_size);
+    }
+
+    if (xQueueSend(s_event_queue, &item, ticks_to_wait) != pdTRUE)
+    {
+        ESP_LOGW(TAG, "Fila de eventos cheia (%s:%ld)", event_base, (long)event_id);
+        return ESP_ERR_TIMEOUT;
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,243 @@
+/**
+ * @file esp_partition_host.c
+ * @brief Partições de dados emuladas em arquivos com semântica NOR.
+ *
+ * A tabela espelha o partitions.csv do projeto. Cada partição é um
+ * arquivo "<label>.bin" em HOST_FLASH_DIR (padrão .pio/host), criado
+ * apagado (0xFF) na primeira abertura e mantido entre execuções, o que
+ * permite testar a recuperação da fila offline após "reboot".
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "esp_partition.h"
+#include "esp_log.h"
+
+/* Definições privadas */
+
+#define HOST_FLASH_DIR_DEFAULT ".pio/host"
+
+typedef struct
+{
+    esp_partition_t info;
+    FILE *file;
+} host_partition_t;
+
+/* Variáveis privadas (static) */
+
+static const char *TAG = "partition_host";
+
+/** Mesma tabela do partitions.csv (apenas partições de dados) */
+static host_partition_t s_partitions[] = {
+    {.info = {.type = ESP_PARTITION_TYPE_DATA, .subtype = ESP_PARTITION_SUBTYPE_DATA_NVS,
+              .address = 0x9000, .size = 0x6000, .erase_size = SPI_FLASH_SEC_SIZE, .label = "nvs"}},
+    {.info = {.type = ESP_PARTITION_TYPE_DATA, .subtype = ESP_PARTITION_SUBTYPE_DATA_PHY,
+              .address = 0xf000, .size = 0x1000, .erase_size = SPI_FLASH_SEC_SIZE, .label = "phy_init"}},
+    {.info = {.type = ESP_PARTITION_TYPE_DATA, .subtype = (esp_partition_subtype_t)0x40,
+              .address = 0x170000, .size = 0x40000, .erase_size = SPI_FLASH_SEC_SIZE, .label = "offline_q"}},
+};
+
+#define HOST_PARTITION_COUNT (sizeof(s_partitions) / sizeof(s_partitions[0]))
+
+static pthread_mutex_t s_flash_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Funções auxiliares */
+
+static host_partition_t *from_info(const esp_partition_t *partition)
+{
+    return (host_partition_t *)((char *)partition - offsetof(host_partition_t, info));
+}
+
+static bool range_is_valid(const esp_partition_t *partition, size_t offset, size_t size)
+{
+    return partition != NULL && offset <= partition->size && size <= partition->size - offset;
+}
+
+/**
+ * @brief Abre (ou cria apagado) o arquivo que armazena a partição.
+ */
+static bool open_backing_file(host_partition_t *part)
+{
+    if (part->file != NULL)
+    {
+        return true;
+    }
+
+    const char *dir = getenv("HOST_FLASH_DIR");
+    if (dir == NULL || dir[0] == '\0')
+    {
+        dir = HOST_FLASH_DIR_DEFAULT;
+    }
+
+    /* mkdir -p simplificado (dois níveis bastam para o padrão) */
+    char path[512];
+    snprintf(path, sizeof(path), "%s", dir);
+    for (char *p = path + 1; *p; p++)
+    {
+        if (*p == '/')
+        {
+            *p = '\0';
+            mkdir(path, 0755);
+            *p = '/';
+        }
+    }
+    mkdir(path, 0755);
+
+    snprintf(path, sizeof(path), "%s/%s.bin", dir, part->info.label);
+    part->file = fopen(path, "r+b");
+    if (part->file == NULL)
+    {
+        part->file = fopen(path, "w+b");
+        if (part->file == NULL)
+        {
+            ESP_LOGE(TAG, "Falha ao criar %s: %s", path, strerror(errno));
+            return false;
+        }
+
+        uint8_t erased[SPI_FLASH_SEC_SIZE];
+        memset(erased, 0xFF, sizeof(erased));
+        for (uint32_t off = 0; off < part->info.size; off += sizeof(erased))
+        {
+            fwrite(erased, 1, sizeof(erased), part->file);
+        }
+        fflush(part->file);
+        ESP_LOGI(TAG, "Particao '%s' criada em %s", part->info.label, path);
+    }
+    return true;
+}
+
+/* Implementação das funções públicas */
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type,
+                                                esp_partition_subtype_t subtype,
+                                                const char *label)
+{
+    for (size_t i = 0; i < HOST_PARTITION_COUNT; i++)
+    {
+        const esp_partition_t *info = &s_partitions[i].info;
+        if (info->type != type)
+        {
+            continue;
+        }
+        if (subtype != ESP_PARTITION_SUBTYPE_ANY && info->subtype != subtype)
+        {
+            continue;
+        }
+        if (label != NULL && strcmp(info->label, label) != 0)
+        {
+            continue;
+        }
+        return info;
+    }
+    return NULL;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *partition, size_t src_offset,
+                             void *dst, size_t size)
+{
+    if (dst == NULL || !range_is_valid(partition, src_offset, size))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    host_partition_t *part = from_info(partition);
+    esp_err_t ret = ESP_FAIL;
+    pthread_mutex_lock(&s_flash_lock);
+    if (open_backing_file(part) &&
+        fseek(part->file, (long)src_offset, SEEK_SET) == 0 &&
+        fread(dst, 1, size, part->file) == size)
+    {
+        ret = ESP_OK;
+    }
+    pthread_mutex_unlock(&s_flash_lock);
+    return ret;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t *partition, size_t dst_offset,
+                              const void *src, size_t size)
+{
+    if (src == NULL || !range_is_valid(partition, dst_offset, size))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    host_partition_t *part = from_info(partition);
+    uint8_t chunk[256];
+    const uint8_t *in = (const uint8_t *)src;
+    esp_err_t ret = ESP_OK;
+
+    pthread_mutex_lock(&s_flash_lock);
+    if (!open_backing_file(part))
+    {
+        ret = ESP_FAIL;
+    }
+
+    /* Flash NOR: a escrita só leva bits de 1 para 0 (AND com o conteúdo) */
+    for (size_t done = 0; ret == ESP_OK && done < size; done += sizeof(chunk))
+    {
+        size_t n = (size - done < sizeof(chunk)) ? size - done : sizeof(chunk);
+        if (fseek(part->file, (long)(dst_offset + done), SEEK_SET) != 0 ||
+            fread(chunk, 1, n, part->file) != n)
+        {
+            ret = ESP_FAIL;
+            break;
+        }
+        for (size_t i = 0; i < n; i++)
+        {
+            chunk[i] &= in[done + i];
+        }
+        if (fseek(part->file, (long)(dst_offset + done), SEEK_SET) != 0 ||
+            fwrite(chunk, 1, n, part->file) != n)
+        {
+            ret = ESP_FAIL;
+        }
+    }
+    if (ret == ESP_OK)
+    {
+        fflush(part->file);
+    }
+    pthread_mutex_unlock(&s_flash_lock);
+    return ret;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t *partition, size_t offset,
+                                    size_t size)
+{
+    if (!range_is_valid(partition, offset, size) ||
+        (offset % partition->erase_size) != 0 || (size % partition->erase_size) != 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    host_partition_t *part = from_info(partition);
+    uint8_t erased[SPI_FLASH_SEC_SIZE];
+    memset(erased, 0xFF, sizeof(erased));
+    esp_err_t ret = ESP_OK;
+
+    pthread_mutex_lock(&s_flash_lock);
+    if (!open_backing_file(part) || fseek(part->file, (long)offset, SEEK_SET) != 0)
+    {
+        ret = ESP_FAIL;
+    }
+    for (size_t done = 0; ret == ESP_OK && done < size; done += sizeof(erased))
+    {
+        if (fwrite(erased, 1, sizeof(erased), part->file) != sizeof(erased))
+        {
+            ret = ESP_FAIL;
+        }
+    }
+    if (ret == ESP_OK)
+    {
+        fflush(part->file);
+    }
+    pthread_mutex_unlock(&s_flash_lock);
+    return ret;
+}
@@ -0,0 +1,405 @@
+/**
+ * @file esp_system_host.c
+ * @brief Log, timer, heap, aleatórios e CRC do ESP-IDF para o host.
+ *
+ * Cada esp_timer tem uma thread que espera o próximo disparo em tempo
+ * absoluto (CLOCK_MONOTONIC) e chama o callback fora do lock.
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/random.h>
+#include <time.h>
+
+#include "esp_err.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_random.h"
+#include "esp_rom_crc.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+
+/* Variáveis privadas (static) */
+
+#define LOG_MAX_TAG_LEVELS 16
+
+typedef struct
+{
+    const char *tag;
+    esp_log_level_t level;
+} log_tag_level_t;
+
+static pthread_mutex_t s_log_lock = PTHREAD_MUTEX_INITIALIZER;
+struct esp_timer
+{
+    esp_timer_create_args_t args;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint64_t periodo_us;
+    int64_t proximo_us; ///< Próximo disparo (esp_timer_get_time)
+    bool ativo;
+    bool apagado;
+};
+
+static log_tag_level_t s_tag_levels[LOG_MAX_TAG_LEVELS];
+static int s_tag_level_count = 0;
+static esp_log_level_t s_default_level = ESP_LOG_INFO;
+static uint32_t s_min_free_heap = HOST_HEAP_SIZE;
+static struct timespec s_boot_time;
+static pthread_once_t s_boot_once = PTHREAD_ONCE_INIT;
+
+/* Funções auxiliares */
+
+static void record_boot_time(void)
+{
+    clock_gettime(CLOCK_MONOTONIC, &s_boot_time);
+}
+
+/** Marca o "boot" antes de main() para que os timestamps comecem em 0 */
+__attribute__((constructor)) static void host_boot(void)
+{
+    pthread_once(&s_boot_once, record_boot_time);
+}
+
+static void timer_deadline(int64_t us, struct timespec *ts)
+{
+    int64_t ns = s_boot_time.tv_nsec + (us % 1000000) * 1000;
+    ts->tv_sec = s_boot_time.tv_sec + us / 1000000 + ns / 1000000000;
+    ts->tv_nsec = ns % 1000000000;
+}
+
+static void *timer_thread(void *arg)
+{
+    struct esp_timer *t = arg;
+
+    pthread_mutex_lock(&t->lock);
+    while (!t->apagado)
+    {
+        if (!t->ativo)
+        {
+            pthread_cond_wait(&t->cond, &t->lock);
+            continue;
+        }
+
+        struct timespec deadline;
+        timer_deadline(t->proximo_us, &deadline);
+        if (pthread_cond_timedwait(&t->cond, &t->lock, &deadline) != ETIMEDOUT)
+        {
+            continue; // Parado, apagado ou reiniciado: reavalia
+        }
+
+        /* Atrasado, dispara em seguida até alcançar, como o esp_timer */
+        t->proximo_us += (int64_t)t->periodo_us;
+        pthread_mutex_unlock(&t->lock);
+        t->args.callback(t->args.arg);
+        pthread_mutex_lock(&t->lock);
+    }
+    pthread_mutex_unlock(&t->lock);
+    return NULL;
+}
+
+/* Implementação das funções públicas */
+
+int64_t esp_timer_get_time(void)
+{
+    struct timespec now;
+    pthread_once(&s_boot_once, record_boot_time);
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)(now.tv_sec - s_boot_time.tv_sec) * 1000000LL +
+           (now.tv_nsec - s_boot_time.tv_nsec) / 1000;
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args,
+                           esp_timer_handle_t *out_handle)
+{
+    if (create_args == NULL || create_args->callback == NULL || out_handle == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    struct esp_timer *t = calloc(1, sizeof(*t));
+    if (t == NULL)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    t->args = *create_args;
+    pthread_mutex_init(&t->lock, NULL);
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&t->cond, &attr);
+    pthread_condattr_destroy(&attr);
+
+    if (pthread_create(&t->thread, NULL, timer_thread, t) != 0)
+    {
+        pthread_cond_destroy(&t->cond);
+        pthread_mutex_destroy(&t->lock);
+        free(t);
+        return ESP_ERR_NO_MEM;
+    }
+    *out_handle = t;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period)
+{
+    esp_err_t ret = ESP_OK;
+    pthread_mutex_lock(&timer->lock);
+    if (timer->ativo)
+    {
+        ret = ESP_ERR_INVALID_STATE;
+    }
+    else
+    {
+        timer->periodo_us = period;
+        timer->proximo_us = esp_timer_get_time() + (int64_t)period;
+        timer->ativo = true;
+        pthread_cond_signal(&timer->cond);
+    }
+    pthread_mutex_unlock(&timer->lock);
+    return ret;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+{
+    esp_err_t ret = ESP_OK;
+    pthread_mutex_lock(&timer->lock);
+    if (!timer->ativo)
+    {
+        ret = ESP_ERR_INVALID_STATE;
+    }
+    else
+    {
+        timer->ativo = false;
+        pthread_cond_signal(&timer->cond);
+    }
+    pthread_mutex_unlock(&timer->lock);
+    return ret;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer)
+{
+    pthread_mutex_lock(&timer->lock);
+    if (timer->ativo)
+    {
+        pthread_mutex_unlock(&timer->lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->apagado = true;
+    pthread_cond_signal(&timer->cond);
+    pthread_mutex_unlock(&timer->lock);
+
+    pthread_join(timer->thread, NULL);
+    pthread_cond_destroy(&timer->cond);
+    pthread_mutex_destroy(&timer->lock);
+    free(timer);
+    return ESP_OK;
+}
+
+uint32_t esp_log_timestamp(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+void esp_log_level_set(const char *tag, esp_log_level_t level)
+{
+    pthread_mutex_lock(&s_log_lock);
+    if (strcmp(tag, "*") == 0)
+    {
+        s_default_level = level;
+        s_tag_level_count = 0;
+    }
+    else
+    {
+        int i = 0;
+        while (i < s_tag_level_count && strcmp(s_tag_levels[i].tag, tag) != 0)
+        {
+            i++;
+        }
+        if (i < LOG_MAX_TAG_LEVELS)
+        {
+            /* As tags do firmware são literais estáticos */
+            s_tag_levels[i] = (log_tag_level_t){tag, level};
+            s_tag_level_count = (i == s_tag_level_count) ? i + 1 : s_tag_level_count;
+        }
+    }
+    pthread_mutex_unlock(&s_log_lock);
+}
+
+esp_log_level_t esp_log_level_get(const char *tag)
+{
+    esp_log_level_t level = s_default_level;
+    if (__atomic_load_n(&s_tag_level_count, __ATOMIC_ACQUIRE) == 0)
+    {
+        return level;
+    }
+
+    pthread_mutex_lock(&s_log_lock);
+    for (int i = 0; i < s_tag_level_count; i++)
+    {
+        if (strcmp(s_tag_levels[i].tag, tag) == 0)
+        {
+            level = s_tag_levels[i].level;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&s_log_lock);
+    return level;
+}
+
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...)
+{
+    static const char letters[] = {'N', 'E', 'W', 'I', 'D', 'V'};
+    static const char *colors[] = {"", "\033[0;31m", "\033[0;33m", "\033[0;32m", "", ""};
+
+    va_list args;
+    va_start(args, format);
+    pthread_mutex_lock(&s_log_lock);
+    fprintf(stdout, "%s%c (%lu) %s: ", colors[level], letters[level],
+            (unsigned long)esp_log_timestamp(), tag);
+    vfprintf(stdout, format, args);
+    fputs(colors[level][0] ? "\033[0m\n" : "\n", stdout);
+    fflush(stdout);
+    pthread_mutex_unlock(&s_log_lock);
+    va_end(args);
+}
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    switch (code)
+    {
+    case ESP_OK:
+        return "ESP_OK";
+    case ESP_FAIL:
+        return "ESP_FAIL";
+    case ESP_ERR_NO_MEM:
+        return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG:
+        return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE:
+        return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_INVALID_SIZE:
+        return "ESP_ERR_INVALID_SIZE";
+    case ESP_ERR_NOT_FOUND:
+        return "ESP_ERR_NOT_FOUND";
+    case ESP_ERR_NOT_SUPPORTED:
+        return "ESP_ERR_NOT_SUPPORTED";
+    case ESP_ERR_TIMEOUT:
+        return "ESP_ERR_TIMEOUT";
+    case ESP_ERR_NVS_NOT_INITIALIZED:
+        return "ESP_ERR_NVS_NOT_INITIALIZED";
+    case ESP_ERR_NVS_NOT_FOUND:
+        return "ESP_ERR_NVS_NOT_FOUND";
+    case ESP_ERR_NVS_READ_ONLY:
+        return "ESP_ERR_NVS_READ_ONLY";
+    case ESP_ERR_NVS_INVALID_HANDLE:
+        return "ESP_ERR_NVS_INVALID_HANDLE";
+    case ESP_ERR_NVS_INVALID_LENGTH:
+        return "ESP_ERR_NVS_INVALID_LENGTH";
+    case ESP_ERR_NVS_NO_FREE_PAGES:
+        return "ESP_ERR_NVS_NO_FREE_PAGES";
+    case ESP_ERR_NVS_NEW_VERSION_FOUND:
+        return "ESP_ERR_NVS_NEW_VERSION_FOUND";
+    default:
+        return "UNKNOWN ERROR";
+    }
+}
+
+uint32_t esp_random(void)
+{
+    uint32_t value;
+    if (getrandom(&value, sizeof(value), 0) != (ssize_t)sizeof(value))
+    {
+        value = (uint32_t)rand();
+    }
+    return value;
+}
+
+uint32_t esp_rom_crc32_le(uint32_t crc, uint8_t const *buf, uint32_t len)
+{
+    crc = ~crc;
+    for (uint32_t i = 0; i < len; i++)
+    {
+        crc ^= buf[i];
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320U & (0U - (crc & 1U)));
+        }
+    }
+    return ~crc;
+}
+
+esp_reset_reason_t esp_reset_reason(void)
+{
+    return ESP_RST_POWERON;
+}
+
+uint32_t esp_get_free_heap_size(void)
+{
+    struct mallinfo2 info = mallinfo2();
+    uint32_t used = (uint32_t)info.uordblks;
+    uint32_t free_size = (used >= HOST_HEAP_SIZE) ? 0 : HOST_HEAP_SIZE - used;
+
+    /* Mínimo histórico atualizado a cada consulta, como aproximação
+     * do comportamento do heap_caps no chip */
+    uint32_t min = __atomic_load_n(&s_min_free_heap, __ATOMIC_RELAXED);
+    while (free_size < min &&
+           !__atomic_compare_exchange_n(&s_min_free_heap, &min, free_size, false,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+    }
+    return free_size;
+}
+
+uint32_t esp_get_minimum_free_heap_size(void)
+{
+    esp_get_free_heap_size();
+    return __atomic_load_n(&s_min_free_heap, __ATOMIC_RELAXED);
+}
+
+size_t heap_caps_get_total_size(uint32_t caps)
+{
+    return (caps & MALLOC_CAP_SPIRAM) ? 0 : HOST_HEAP_SIZE;
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t caps)
+{
+    return (caps & MALLOC_CAP_SPIRAM) ? 0 : esp_get_free_heap_size();
+}
+
+void heap_caps_get_info(multi_heap_info_t *info, uint32_t caps)
+{
+    memset(info, 0, sizeof(*info));
+    if (caps & MALLOC_CAP_SPIRAM)
+    {
+        return;
+    }
+
+    info->total_free_bytes = esp_get_free_heap_size();
+    info->largest_free_block = info->total_free_bytes;
+    info->minimum_free_bytes = esp_get_minimum_free_heap_size();
+    info->total_allocated_bytes = HOST_HEAP_SIZE - info->total_free_bytes;
+}
+
+const char *esp_get_idf_version(void)
+{
+    return "v5.5-host";
+}
+
+void esp_restart(void)
+{
+    ESP_LOGW("host", "esp_restart() chamado; encerrando o processo");
+    exit(0);
+}
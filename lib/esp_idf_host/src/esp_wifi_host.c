@@ -0,0 +1,263 @@
+/**
+ * @file esp_wifi_host.c
+ * @brief WiFi e netif simulados: conexão imediata com IP 127.0.0.1.
+ *
+ * A sequência de eventos é a mesma do driver real (STA_START ->
+ * STA_CONNECTED -> IP_EVENT_STA_GOT_IP), permitindo exercitar os
+ * handlers do firmware sem rádio. Um BSSID ou canal fixado na
+ * configuração que não corresponda ao AP simulado gera
+ * STA_DISCONNECTED (AP não encontrado), como no driver real.
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#include <string.h>
+
+#include "esp_wifi.h"
+#include "esp_netif.h"
+#include "esp_event.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+
+/* Definições privadas */
+
+#define HOST_WIFI_RSSI -40
+#define HOST_WIFI_CHANNEL 6
+#define HOST_WIFI_REASON_NO_AP_FOUND 201
+
+struct esp_netif_obj
+{
+    esp_netif_ip_info_t ip_info;
+    esp_netif_dns_info_t dns[ESP_NETIF_DNS_FALLBACK + 1];
+    bool dhcp_client;
+};
+
+/* Variáveis privadas (static) */
+
+static const char *TAG = "wifi_host";
+
+static struct esp_netif_obj s_sta_netif;
+static bool s_netif_created = false;
+static wifi_config_t s_wifi_config;
+static bool s_wifi_started = false;
+static bool s_wifi_connected = false;
+
+static const uint8_t s_host_bssid[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+
+/* Implementação das funções públicas */
+
+esp_err_t esp_netif_init(void)
+{
+    return ESP_OK;
+}
+
+esp_netif_t *esp_netif_create_default_wifi_sta(void)
+{
+    s_sta_netif.dhcp_client = true;
+    s_netif_created = true;
+    return &s_sta_netif;
+}
+
+esp_netif_t *esp_netif_get_handle_from_ifkey(const char *if_key)
+{
+    if (!s_netif_created || if_key == NULL || strcmp(if_key, "WIFI_STA_DEF") != 0)
+    {
+        return NULL;
+    }
+    return &s_sta_netif;
+}
+
+esp_err_t esp_netif_get_ip_info(esp_netif_t *esp_netif, esp_netif_ip_info_t *ip_info)
+{
+    if (esp_netif == NULL || ip_info == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *ip_info = esp_netif->ip_info;
+    return ESP_OK;
+}
+
+esp_err_t esp_netif_set_ip_info(esp_netif_t *esp_netif, const esp_netif_ip_info_t *ip_info)
+{
+    if (esp_netif == NULL || ip_info == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_netif->ip_info = *ip_info;
+    return ESP_OK;
+}
+
+esp_err_t esp_netif_dhcpc_start(esp_netif_t *esp_netif)
+{
+    esp_netif->dhcp_client = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_netif_dhcpc_stop(esp_netif_t *esp_netif)
+{
+    esp_netif->dhcp_client = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_netif_get_dns_info(esp_netif_t *esp_netif, esp_netif_dns_type_t type,
+                                 esp_netif_dns_info_t *dns)
+{
+    if (esp_netif == NULL || dns == NULL || type > ESP_NETIF_DNS_FALLBACK)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *dns = esp_netif->dns[type];
+    return ESP_OK;
+}
+
+esp_err_t esp_netif_set_dns_info(esp_netif_t *esp_netif, esp_netif_dns_type_t type,
+                                 esp_netif_dns_info_t *dns)
+{
+    if (esp_netif == NULL || dns == NULL || type > ESP_NETIF_DNS_FALLBACK)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_netif->dns[type] = *dns;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_init(const wifi_init_config_t *config)
+{
+    return (config == NULL) ? ESP_ERR_INVALID_ARG : ESP_OK;
+}
+
+esp_err_t esp_wifi_deinit(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_mode(wifi_mode_t mode)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_config(wifi_interface_t interface, wifi_config_t *conf)
+{
+    if (conf == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_wifi_config = *conf;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_get_config(wifi_interface_t interface, wifi_config_t *conf)
+{
+    if (conf == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *conf = s_wifi_config;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_ps(wifi_ps_type_t type)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_start(void)
+{
+    s_wifi_started = true;
+    return esp_event_post(WIFI_EVENT, WIFI_EVENT_STA_START, NULL, 0, portMAX_DELAY);
+}
+
+esp_err_t esp_wifi_stop(void)
+{
+    s_wifi_started = false;
+    s_wifi_connected = false;
+    return esp_event_post(WIFI_EVENT, WIFI_EVENT_STA_STOP, NULL, 0, portMAX_DELAY);
+}
+
+esp_err_t esp_wifi_connect(void)
+{
+    if (!s_wifi_started)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if ((s_wifi_config.sta.bssid_set &&
+         memcmp(s_wifi_config.sta.bssid, s_host_bssid, sizeof(s_host_bssid)) != 0) ||
+        (s_wifi_config.sta.channel != 0 && s_wifi_config.sta.channel != HOST_WIFI_CHANNEL))
+    {
+        wifi_event_sta_disconnected_t not_found = {0};
+        not_found.reason = HOST_WIFI_REASON_NO_AP_FOUND;
+        return esp_event_post(WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED,
+                              &not_found, sizeof(not_found), portMAX_DELAY);
+    }
+
+    wifi_event_sta_connected_t connected = {0};
+    size_t ssid_len = strnlen((const char *)s_wifi_config.sta.ssid, sizeof(connected.ssid));
+    memcpy(connected.ssid, s_wifi_config.sta.ssid, ssid_len);
+    connected.ssid_len = (uint8_t)ssid_len;
+    memcpy(connected.bssid, s_host_bssid, sizeof(connected.bssid));
+    connected.channel = HOST_WIFI_CHANNEL;
+    connected.authmode = s_wifi_config.sta.threshold.authmode;
+    s_wifi_connected = true;
+    esp_event_post(WIFI_EVENT, WIFI_EVENT_STA_CONNECTED, &connected, sizeof(connected), portMAX_DELAY);
+
+    if (s_sta_netif.dhcp_client)
+    {
+        s_sta_netif.ip_info.ip.addr = ESP_IP4TOADDR(127, 0, 0, 1);
+        s_sta_netif.ip_info.netmask.addr = ESP_IP4TOADDR(255, 0, 0, 0);
+        s_sta_netif.ip_info.gw.addr = ESP_IP4TOADDR(127, 0, 0, 1);
+        s_sta_netif.dns[ESP_NETIF_DNS_MAIN].ip.u_addr.ip4.addr = ESP_IP4TOADDR(127, 0, 0, 53);
+    }
+
+    ip_event_got_ip_t got_ip = {
+        .esp_netif = &s_sta_netif,
+        .ip_info = s_sta_netif.ip_info,
+        .ip_changed = true,
+    };
+    ESP_LOGD(TAG, "Conectado (simulado) a %s", (const char *)s_wifi_config.sta.ssid);
+    return esp_event_post(IP_EVENT, IP_EVENT_STA_GOT_IP, &got_ip, sizeof(got_ip), portMAX_DELAY);
+}
+
+esp_err_t esp_wifi_disconnect(void)
+{
+    s_wifi_connected = false;
+    wifi_event_sta_disconnected_t disconnected = {0};
+    disconnected.reason = 8; // WIFI_REASON_ASSOC_LEAVE
+    return esp_event_post(WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED,
+                          &disconnected, sizeof(disconnected), portMAX_DELAY);
+}
+
+esp_err_t esp_wifi_sta_get_ap_info(wifi_ap_record_t *ap_info)
+{
+    if (ap_info == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_wifi_connected)
+    {
+        return ESP_FAIL;
+    }
+
+    memset(ap_info, 0, sizeof(*ap_info));
+    memcpy(ap_info->bssid, s_host_bssid, sizeof(ap_info->bssid));
+    memcpy(ap_info->ssid, s_wifi_config.sta.ssid, sizeof(s_wifi_config.sta.ssid));
+    ap_info->primary = HOST_WIFI_CHANNEL;
+    ap_info->rssi = HOST_WIFI_RSSI;
+    ap_info->authmode = s_wifi_config.sta.threshold.authmode;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_sta_get_rssi(int *rssi)
+{
+    if (rssi == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_wifi_connected)
+    {
+        return ESP_FAIL;
+    }
+    *rssi = HOST_WIFI_RSSI;
+    return ESP_OK;
+}
@@ -0,0 +1,845 @@
+/**
+ * @file freertos_posix.c
+ * @brief Implementação das APIs do FreeRTOS usadas pelo firmware sobre pthreads.
+ *
+ * Cada task é uma thread POSIX com um descritor próprio (nome, prioridade,
+ * contador de notificação). Timeouts em ticks são convertidos para prazos
+ * absolutos em CLOCK_MONOTONIC.
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+#include "freertos/queue.h"
+#include "esp_timer.h"
+
+/* Tipos privados */
+
+struct host_task
+{
+    pthread_t thread;
+    char name[configMAX_TASK_NAME_LEN];
+    UBaseType_t priority;
+    BaseType_t core_id;
+    TaskFunction_t code;
+    void *parameters;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint32_t notify_value;
+    uint8_t *stack;       ///< Stack pintada (NULL em threads externas)
+    size_t stack_size;    ///< Tamanho alocado no host
+    uint32_t stack_depth; ///< Tamanho pedido pelo firmware (bytes)
+    UBaseType_t number;   ///< xTaskNumber
+    struct host_task *next; ///< Lista de tasks criadas (uxTaskGetSystemState)
+};
+
+struct host_semaphore
+{
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    UBaseType_t count;
+    UBaseType_t max_count;
+    TaskHandle_t owner;  ///< Dono do mutex recursivo
+    UBaseType_t depth;   ///< Aninhamento do mutex recursivo
+};
+
+struct host_event_group
+{
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    EventBits_t bits;
+};
+
+struct host_queue
+{
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head;
+    UBaseType_t count;
+    uint8_t *storage;
+};
+
+/** Padrão de preenchimento da stack, como tskSTACK_FILL_BYTE */
+#define STACK_FILL_BYTE 0xA5
+
+/* Variáveis privadas (static) */
+
+static __thread struct host_task *s_current_task = NULL;
+static UBaseType_t s_task_count = 0;
+static pthread_mutex_t s_task_count_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/** Tasks criadas por xTaskCreatePinnedToCore (protegida por s_task_count_lock) */
+static struct host_task *s_task_list = NULL;
+static UBaseType_t s_task_number = 0;
+
+/** Tasks ociosas simuladas: não há thread, o tempo é estimado */
+static struct host_task s_idle_tasks[portNUM_PROCESSORS] = {
+    {.name = "IDLE0", .core_id = 0},
+    {.name = "IDLE1", .core_id = 1},
+};
+
+/* Funções auxiliares */
+
+static void init_cond_monotonic(pthread_cond_t *cond)
+{
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+static void ticks_to_deadline(TickType_t ticks, struct timespec *deadline)
+{
+    clock_gettime(CLOCK_MONOTONIC, deadline);
+    uint64_t ms = pdTICKS_TO_MS(ticks);
+    deadline->tv_sec += (time_t)(ms / 1000);
+    deadline->tv_nsec += (long)((ms % 1000) * 1000000L);
+    if (deadline->tv_nsec >= 1000000000L)
+    {
+        deadline->tv_sec++;
+        deadline->tv_nsec -= 1000000000L;
+    }
+}
+
+/**
+ * @brief Aguarda a condição com o timeout do FreeRTOS.
+ * @return false quando o prazo expirou
+ */
+static bool cond_wait_ticks(pthread_cond_t *cond, pthread_mutex_t *lock,
+                            const struct timespec *deadline, TickType_t ticks)
+{
+    if (ticks == portMAX_DELAY)
+    {
+        pthread_cond_wait(cond, lock);
+        return true;
+    }
+    return pthread_cond_timedwait(cond, lock, deadline) != ETIMEDOUT;
+}
+
+/** Remove a task da lista; chamada com s_task_count_lock */
+static void task_list_remove_locked(struct host_task *task)
+{
+    for (struct host_task **p = &s_task_list; *p != NULL; p = &(*p)->next)
+    {
+        if (*p == task)
+        {
+            *p = task->next;
+            return;
+        }
+    }
+}
+
+/** Tempo de CPU consumido pela thread (µs) */
+static uint64_t thread_cpu_us(pthread_t thread)
+{
+    clockid_t clock;
+    struct timespec ts;
+    if (pthread_getcpuclockid(thread, &clock) != 0 || clock_gettime(clock, &ts) != 0)
+    {
+        return 0;
+    }
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000U;
+}
+
+static void *task_entry(void *arg)
+{
+    struct host_task *task = (struct host_task *)arg;
+    s_current_task = task;
+    pthread_setname_np(pthread_self(), task->name);
+    task->code(task->parameters);
+
+    /* No FreeRTOS uma task nunca retorna; trate como vTaskDelete(NULL) */
+    vTaskDelete(NULL);
+    return NULL;
+}
+
+/**
+ * @brief Descritor da thread atual; threads externas (main, mosquitto)
+ *        recebem um descritor criado sob demanda.
+ */
+static struct host_task *current_task(void)
+{
+    if (s_current_task == NULL)
+    {
+        struct host_task *task = calloc(1, sizeof(*task));
+        if (task == NULL)
+        {
+            abort();
+        }
+        task->thread = pthread_self();
+        pthread_getname_np(task->thread, task->name, sizeof(task->name));
+        task->priority = 1;
+        task->core_id = tskNO_AFFINITY;
+        pthread_mutex_init(&task->lock, NULL);
+        init_cond_monotonic(&task->cond);
+        s_current_task = task;
+    }
+    return s_current_task;
+}
+
+/* Implementação das funções públicas */
+
+void vAssertCalled(const char *file, int line)
+{
+    fprintf(stderr, "configASSERT falhou em %s:%d\n", file, line);
+    abort();
+}
+
+void portMUX_INITIALIZE(portMUX_TYPE *mux)
+{
+    pthread_mutex_init(&mux->mutex, NULL);
+}
+
+void vPortEnterCritical(portMUX_TYPE *mux)
+{
+    pthread_mutex_lock(&mux->mutex);
+}
+
+void vPortExitCritical(portMUX_TYPE *mux)
+{
+    pthread_mutex_unlock(&mux->mutex);
+}
+
+BaseType_t xPortGetCoreID(void)
+{
+    /* Task fixada responde o núcleo pedido, como no ESP32, sem syscall */
+    if (s_current_task != NULL && s_current_task->core_id != tskNO_AFFINITY)
+    {
+        return s_current_task->core_id % portNUM_PROCESSORS;
+    }
+
+    int cpu = sched_getcpu();
+    return (cpu < 0) ? 0 : (BaseType_t)(cpu % portNUM_PROCESSORS);
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task_code, const char *name,
+                                   uint32_t stack_depth, void *parameters,
+                                   UBaseType_t priority, TaskHandle_t *created_task,
+                                   BaseType_t core_id)
+{
+    struct host_task *task = calloc(1, sizeof(*task));
+    if (task == NULL)
+    {
+        return pdFAIL;
+    }
+
+    snprintf(task->name, sizeof(task->name), "%s", name ? name : "task");
+    task->priority = priority;
+    task->core_id = core_id;
+    task->code = task_code;
+    task->parameters = parameters;
+    pthread_mutex_init(&task->lock, NULL);
+    init_cond_monotonic(&task->cond);
+
+    /* O stack do FreeRTOS é pequeno demais para a libc do host; usa-se
+     * o mínimo de 64 KB para manter margem com printf/snprintf. */
+    size_t stack = (size_t)stack_depth * 4;
+    task->stack_size = stack < 65536 ? 65536 : stack;
+    task->stack_depth = stack_depth;
+    /* Fora do malloc, como as stacks do pthread: o heap emulado
+     * (esp_get_free_heap_size) não enxerga as stacks de 4x */
+    task->stack = mmap(NULL, task->stack_size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+    if (task->stack == MAP_FAILED)
+    {
+        free(task);
+        return pdFAIL;
+    }
+    /* Pintada como no FreeRTOS para uxTaskGetStackHighWaterMark() */
+    memset(task->stack, STACK_FILL_BYTE, task->stack_size);
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstack(&attr, task->stack, task->stack_size);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+    if (created_task)
+    {
+        *created_task = task;
+    }
+
+    /* Lista só depois do pthread_create: task->thread precisa ser válido */
+    pthread_mutex_lock(&s_task_count_lock);
+    s_task_count++;
+    int rc = pthread_create(&task->thread, &attr, task_entry, task);
+    if (rc == 0)
+    {
+        task->number = ++s_task_number;
+        task->next = s_task_list;
+        s_task_list = task;
+    }
+    pthread_mutex_unlock(&s_task_count_lock);
+    pthread_attr_destroy(&attr);
+    if (rc != 0)
+    {
+        pthread_mutex_lock(&s_task_count_lock);
+        s_task_count--;
+        pthread_mutex_unlock(&s_task_count_lock);
+        if (created_task)
+        {
+            *created_task = NULL;
+        }
+        munmap(task->stack, task->stack_size);
+        free(task);
+        return pdFAIL;
+    }
+    return pdPASS;
+}
+
+TaskHandle_t xTaskCreateStaticPinnedToCore(TaskFunction_t task_code, const char *name,
+                                           uint32_t stack_depth, void *parameters,
+                                           UBaseType_t priority, StackType_t *stack_buffer,
+                                           StaticTask_t *task_buffer, BaseType_t core_id)
+{
+    /* A stack do firmware é pequena demais para a libc: usa a do host */
+    TaskHandle_t task = NULL;
+    xTaskCreatePinnedToCore(task_code, name, stack_depth, parameters, priority, &task, core_id);
+    task_buffer->handle = task;
+    return task;
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    struct host_task *self = current_task();
+    if (task == NULL || task == self)
+    {
+        pthread_mutex_lock(&s_task_count_lock);
+        s_task_count--;
+        task_list_remove_locked(self);
+        pthread_mutex_unlock(&s_task_count_lock);
+        /* O descritor não é liberado: outras tasks podem ainda ter o
+         * handle (ex.: notificações tardias). */
+        pthread_exit(NULL);
+    }
+
+    /* Sai da lista antes do cancelamento: a thread ainda é válida */
+    pthread_mutex_lock(&s_task_count_lock);
+    s_task_count--;
+    task_list_remove_locked(task);
+    pthread_cancel(task->thread);
+    pthread_mutex_unlock(&s_task_count_lock);
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    uint64_t us = (uint64_t)pdTICKS_TO_MS(ticks) * 1000ULL;
+    if (us == 0)
+    {
+        sched_yield();
+        return;
+    }
+    usleep((useconds_t)us);
+}
+
+BaseType_t xTaskDelayUntil(TickType_t *previous_wake_time, TickType_t time_increment)
+{
+    TickType_t wake = *previous_wake_time + time_increment;
+    TickType_t now = xTaskGetTickCount();
+    *previous_wake_time = wake;
+    if ((int32_t)(wake - now) <= 0)
+    {
+        return pdFALSE;
+    }
+    vTaskDelay(wake - now);
+    return pdTRUE;
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)((esp_timer_get_time() / 1000) / portTICK_PERIOD_MS);
+}
+
+TickType_t xTaskGetTickCountFromISR(void)
+{
+    return xTaskGetTickCount();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return current_task();
+}
+
+char *pcTaskGetName(TaskHandle_t task)
+{
+    return (task ? task : current_task())->name;
+}
+
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task)
+{
+    return (task ? task : current_task())->priority;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task)
+{
+    struct host_task *t = (task != NULL) ? task : current_task();
+    if (t->stack == NULL)
+    {
+        return 0;
+    }
+
+    /* A stack cresce para baixo: conta os bytes intactos a partir da base */
+    size_t intact = 0;
+    while (intact < t->stack_size && t->stack[intact] == STACK_FILL_BYTE)
+    {
+        intact++;
+    }
+
+    /* O host reserva 4x a stack pedida (ver xTaskCreatePinnedToCore):
+     * a sobra nesse orçamento volta para a escala do firmware */
+    size_t extra = t->stack_size - (size_t)t->stack_depth * 4;
+    return (intact > extra) ? (UBaseType_t)((intact - extra) / 4) : 0;
+}
+
+UBaseType_t uxTaskGetSystemState(TaskStatus_t *task_status_array, UBaseType_t array_size,
+                                 configRUN_TIME_COUNTER_TYPE *total_run_time)
+{
+    uint64_t elapsed = (uint64_t)esp_timer_get_time();
+    uint64_t busy[portNUM_PROCESSORS] = {0};
+    UBaseType_t count = 0;
+
+    pthread_mutex_lock(&s_task_count_lock);
+    for (struct host_task *t = s_task_list; t != NULL; t = t->next)
+    {
+        uint64_t cpu = thread_cpu_us(t->thread);
+
+        /* Tasks sem afinidade dividem o tempo entre os núcleos */
+        if (t->core_id == tskNO_AFFINITY)
+        {
+            for (int c = 0; c < portNUM_PROCESSORS; c++)
+            {
+                busy[c] += cpu / portNUM_PROCESSORS;
+            }
+        }
+        else
+        {
+            busy[t->core_id % portNUM_PROCESSORS] += cpu;
+        }
+
+        if (count < array_size)
+        {
+            TaskStatus_t *s = &task_status_array[count++];
+            memset(s, 0, sizeof(*s));
+            s->xHandle = t;
+            s->pcTaskName = t->name;
+            s->xTaskNumber = t->number;
+            s->eCurrentState = eBlocked;
+            s->uxCurrentPriority = t->priority;
+            s->uxBasePriority = t->priority;
+            s->ulRunTimeCounter = (configRUN_TIME_COUNTER_TYPE)cpu;
+            s->xCoreID = t->core_id;
+        }
+    }
+    pthread_mutex_unlock(&s_task_count_lock);
+
+    /* Ociosidade estimada: tempo decorrido menos o uso das tasks do núcleo */
+    for (int c = 0; c < portNUM_PROCESSORS && count < array_size; c++)
+    {
+        TaskStatus_t *s = &task_status_array[count++];
+        memset(s, 0, sizeof(*s));
+        s->xHandle = &s_idle_tasks[c];
+        s->pcTaskName = s_idle_tasks[c].name;
+        s->eCurrentState = eReady;
+        s->ulRunTimeCounter = (configRUN_TIME_COUNTER_TYPE)(elapsed > busy[c] ? elapsed - busy[c] : 0);
+        s->xCoreID = c;
+    }
+
+    if (total_run_time != NULL)
+    {
+        *total_run_time = (configRUN_TIME_COUNTER_TYPE)elapsed;
+    }
+    return count;
+}
+
+TaskHandle_t xTaskGetIdleTaskHandleForCore(BaseType_t core_id)
+{
+    return (core_id >= 0 && core_id < portNUM_PROCESSORS) ? &s_idle_tasks[core_id] : NULL;
+}
+
+UBaseType_t uxTaskGetNumberOfTasks(void)
+{
+    pthread_mutex_lock(&s_task_count_lock);
+    UBaseType_t count = s_task_count;
+    pthread_mutex_unlock(&s_task_count_lock);
+    return count;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks_to_wait)
+{
+    struct host_task *self = current_task();
+    struct timespec deadline;
+    ticks_to_deadline(ticks_to_wait, &deadline);
+
+    pthread_mutex_lock(&self->lock);
+    while (self->notify_value == 0 && ticks_to_wait != 0)
+    {
+        if (!cond_wait_ticks(&self->cond, &self->lock, &deadline, ticks_to_wait))
+        {
+            break;
+        }
+    }
+    uint32_t value = self->notify_value;
+    if (value > 0)
+    {
+        self->notify_value = clear_on_exit ? 0 : value - 1;
+    }
+    pthread_mutex_unlock(&self->lock);
+    return value;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    if (task == NULL)
+    {
+        return pdFAIL;
+    }
+    pthread_mutex_lock(&task->lock);
+    task->notify_value++;
+    pthread_cond_signal(&task->cond);
+    pthread_mutex_unlock(&task->lock);
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *higher_priority_task_woken)
+{
+    xTaskNotifyGive(task);
+    if (higher_priority_task_woken)
+    {
+        *higher_priority_task_woken = pdFALSE;
+    }
+}
+
+/* Semáforos */
+
+static SemaphoreHandle_t semaphore_create(UBaseType_t max_count, UBaseType_t initial_count)
+{
+    struct host_semaphore *sem = calloc(1, sizeof(*sem));
+    if (sem == NULL)
+    {
+        return NULL;
+    }
+    pthread_mutex_init(&sem->lock, NULL);
+    init_cond_monotonic(&sem->cond);
+    sem->max_count = max_count;
+    sem->count = initial_count;
+    return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return semaphore_create(1, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t *buffer)
+{
+    buffer->handle = semaphore_create(1, 1);
+    return buffer->handle;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return semaphore_create(1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count)
+{
+    return semaphore_create(max_count, initial_count);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks_to_wait)
+{
+    struct timespec deadline;
+    ticks_to_deadline(ticks_to_wait, &deadline);
+
+    pthread_mutex_lock(&semaphore->lock);
+    while (semaphore->count == 0)
+    {
+        if (ticks_to_wait == 0 ||
+            !cond_wait_ticks(&semaphore->cond, &semaphore->lock, &deadline, ticks_to_wait))
+        {
+            pthread_mutex_unlock(&semaphore->lock);
+            return pdFALSE;
+        }
+    }
+    semaphore->count--;
+    pthread_mutex_unlock(&semaphore->lock);
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore)
+{
+    BaseType_t ret = pdFALSE;
+    pthread_mutex_lock(&semaphore->lock);
+    if (semaphore->count < semaphore->max_count)
+    {
+        semaphore->count++;
+        pthread_cond_signal(&semaphore->cond);
+        ret = pdTRUE;
+    }
+    pthread_mutex_unlock(&semaphore->lock);
+    return ret;
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void)
+{
+    return semaphore_create(1, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutexStatic(StaticSemaphore_t *buffer)
+{
+    buffer->handle = semaphore_create(1, 1);
+    return buffer->handle;
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t semaphore, TickType_t ticks_to_wait)
+{
+    TaskHandle_t self = current_task();
+    struct timespec deadline;
+    ticks_to_deadline(ticks_to_wait, &deadline);
+
+    pthread_mutex_lock(&semaphore->lock);
+    if (semaphore->depth > 0 && semaphore->owner == self)
+    {
+        semaphore->depth++;
+        pthread_mutex_unlock(&semaphore->lock);
+        return pdTRUE;
+    }
+    while (semaphore->count == 0)
+    {
+        if (ticks_to_wait == 0 ||
+            !cond_wait_ticks(&semaphore->cond, &semaphore->lock, &deadline, ticks_to_wait))
+        {
+            pthread_mutex_unlock(&semaphore->lock);
+            return pdFALSE;
+        }
+    }
+    semaphore->count--;
+    semaphore->owner = self;
+    semaphore->depth = 1;
+    pthread_mutex_unlock(&semaphore->lock);
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t semaphore)
+{
+    BaseType_t ret = pdFALSE;
+    pthread_mutex_lock(&semaphore->lock);
+    if (semaphore->depth > 0 && semaphore->owner == current_task())
+    {
+        if (--semaphore->depth == 0)
+        {
+            semaphore->owner = NULL;
+            semaphore->count++;
+            pthread_cond_signal(&semaphore->cond);
+        }
+        ret = pdTRUE;
+    }
+    pthread_mutex_unlock(&semaphore->lock);
+    return ret;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore)
+{
+    if (semaphore)
+    {
+        pthread_cond_destroy(&semaphore->cond);
+        pthread_mutex_destroy(&semaphore->lock);
+        free(semaphore);
+    }
+}
+
+/* Event groups */
+
+EventGroupHandle_t xEventGroupCreate(void)
+{
+    struct host_event_group *group = calloc(1, sizeof(*group));
+    if (group == NULL)
+    {
+        return NULL;
+    }
+    pthread_mutex_init(&group->lock, NULL);
+    init_cond_monotonic(&group->cond);
+    return group;
+}
+
+EventGroupHandle_t xEventGroupCreateStatic(StaticEventGroup_t *buffer)
+{
+    buffer->handle = xEventGroupCreate();
+    return buffer->handle;
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits)
+{
+    pthread_mutex_lock(&group->lock);
+    group->bits |= bits;
+    EventBits_t current = group->bits;
+    pthread_cond_broadcast(&group->cond);
+    pthread_mutex_unlock(&group->lock);
+    return current;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits)
+{
+    pthread_mutex_lock(&group->lock);
+    EventBits_t previous = group->bits;
+    group->bits &= ~bits;
+    pthread_mutex_unlock(&group->lock);
+    return previous;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group)
+{
+    pthread_mutex_lock(&group->lock);
+    EventBits_t current = group->bits;
+    pthread_mutex_unlock(&group->lock);
+    return current;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits_to_wait,
+                                BaseType_t clear_on_exit, BaseType_t wait_for_all,
+                                TickType_t ticks_to_wait)
+{
+    struct timespec deadline;
+    ticks_to_deadline(ticks_to_wait, &deadline);
+
+    pthread_mutex_lock(&group->lock);
+    for (;;)
+    {
+        EventBits_t matched = group->bits & bits_to_wait;
+        bool satisfied = wait_for_all ? (matched == bits_to_wait) : (matched != 0);
+        if (satisfied)
+        {
+            EventBits_t current = group->bits;
+            if (clear_on_exit)
+            {
+                group->bits &= ~bits_to_wait;
+            }
+            pthread_mutex_unlock(&group->lock);
+            return current;
+        }
+        if (ticks_to_wait == 0 ||
+            !cond_wait_ticks(&group->cond, &group->lock, &deadline, ticks_to_wait))
+        {
+            EventBits_t current = group->bits;
+            pthread_mutex_unlock(&group->lock);
+            return current;
+        }
+    }
+}
+
+void vEventGroupDelete(EventGroupHandle_t group)
+{
+    if (group)
+    {
+        pthread_cond_destroy(&group->cond);
+        pthread_mutex_destroy(&group->lock);
+        free(group);
+    }
+}
+
+/* Filas */
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    struct host_queue *queue = calloc(1, sizeof(*queue));
+    if (queue == NULL)
+    {
+        return NULL;
+    }
+    queue->storage = calloc(length, item_size ? item_size : 1);
+    if (queue->storage == NULL)
+    {
+        free(queue);
+        return NULL;
+    }
+    pthread_mutex_init(&queue->lock, NULL);
+    init_cond_monotonic(&queue->not_empty);
+    init_cond_monotonic(&queue->not_full);
+    queue->length = length;
+    queue->item_size = item_size;
+    return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks_to_wait)
+{
+    struct timespec deadline;
+    ticks_to_deadline(ticks_to_wait, &deadline);
+
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count == queue->length)
+    {
+        if (ticks_to_wait == 0 ||
+            !cond_wait_ticks(&queue->not_full, &queue->lock, &deadline, ticks_to_wait))
+        {
+            pthread_mutex_unlock(&queue->lock);
+            return pdFALSE;
+        }
+    }
+    UBaseType_t tail = (queue->head + queue->count) % queue->length;
+    memcpy(queue->storage + (size_t)tail * queue->item_size, item, queue->item_size);
+    queue->count++;
+    pthread_cond_signal(&queue->not_empty);
+    pthread_mutex_unlock(&queue->lock);
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *buffer, TickType_t ticks_to_wait)
+{
+    struct timespec deadline;
+    ticks_to_deadline(ticks_to_wait, &deadline);
+
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count == 0)
+    {
+        if (ticks_to_wait == 0 ||
+            !cond_wait_ticks(&queue->not_empty, &queue->lock, &deadline, ticks_to_wait))
+        {
+            pthread_mutex_unlock(&queue->lock);
+            return pdFALSE;
+        }
+    }
+    memcpy(buffer, queue->storage + (size_t)queue->head * queue->item_size, queue->item_size);
+    queue->head = (queue->head + 1) % queue->length;
+    queue->count--;
+    pthread_cond_signal(&queue->not_full);
+    pthread_mutex_unlock(&queue->lock);
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+    pthread_mutex_lock(&queue->lock);
+    UBaseType_t count = queue->count;
+    pthread_mutex_unlock(&queue->lock);
+    return count;
+}
+
+void vQueueDelete(QueueHandle_t queue)
+{
+    if (queue)
+    {
+        pthread_cond_destroy(&queue->not_empty);
+        pthread_cond_destroy(&queue->not_full);
+        pthread_mutex_destroy(&queue->lock);
+        free(queue->storage);
+        free(queue);
+    }
+}
@@ -0,0 +1,61 @@
+/**
+ * @file gpio_host.c
+ * @brief GPIO simulado: níveis mantidos em memória.
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#include "driver/gpio.h"
+#include "esp_log.h"
+
+/* Variáveis privadas (static) */
+
+static const char *TAG = "gpio_host";
+
+static uint64_t s_output_mask = 0;
+static uint64_t s_levels = 0;
+
+/* Implementação das funções públicas */
+
+esp_err_t gpio_config(const gpio_config_t *config)
+{
+    if (config == NULL || (config->pin_bit_mask >> GPIO_NUM_MAX) != 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (config->mode & GPIO_MODE_OUTPUT)
+    {
+        __atomic_fetch_or(&s_output_mask, config->pin_bit_mask, __ATOMIC_RELAXED);
+    }
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level)
+{
+    if (gpio_num < 0 || gpio_num >= GPIO_NUM_MAX)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint64_t bit = 1ULL << gpio_num;
+    if (level)
+    {
+        __atomic_fetch_or(&s_levels, bit, __ATOMIC_RELAXED);
+    }
+    else
+    {
+        __atomic_fetch_and(&s_levels, ~bit, __ATOMIC_RELAXED);
+    }
+    ESP_LOGD(TAG, "GPIO %d = %lu", gpio_num, (unsigned long)level);
+    return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t gpio_num)
+{
+    if (gpio_num < 0 || gpio_num >= GPIO_NUM_MAX)
+    {
+        return 0;
+    }
+    return (int)((__atomic_load_n(&s_levels, __ATOMIC_RELAXED) >> gpio_num) & 1ULL);
+}
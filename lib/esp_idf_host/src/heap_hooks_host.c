@@ -0,0 +1,119 @@
+/**
+ * @file heap_hooks_host.c
+ * @brief Hooks de alocação do ESP-IDF (CONFIG_HEAP_USE_HOOKS) no host.
+ *
+ * malloc, calloc, realloc e free substituem os da glibc, que continua
+ * alocando (__libc_*), e chamam esp_heap_trace_alloc_hook() e
+ * esp_heap_trace_free_hook() como o heap_caps do chip. Um realloc conta
+ * como uma liberação e uma alocação.
+ *
+ * Os hooks do firmware consultam a task atual, e a primeira consulta de
+ * uma thread externa aloca o descritor dela: uma flag por thread impede
+ * que essa alocação chame os hooks de novo.
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#include "heap_hooks_host.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_heap_caps.h"
+
+#if CONFIG_HEAP_USE_HOOKS
+
+/* Alocador da glibc */
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t n, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void __libc_free(void *ptr);
+
+/* Variáveis privadas (static) */
+
+/** Hooks desligados na thread (dentro de um hook ou suspensos) */
+static __thread bool s_sem_hooks = false;
+
+/* Hooks padrão, substituídos pelos do firmware (como no ESP-IDF) */
+
+__attribute__((weak)) void esp_heap_trace_alloc_hook(void *ptr, size_t size, uint32_t caps)
+{
+}
+
+__attribute__((weak)) void esp_heap_trace_free_hook(void *ptr)
+{
+}
+
+/* Funções auxiliares */
+
+static void alloc_hook(void *ptr, size_t size)
+{
+    if (ptr == NULL || s_sem_hooks)
+    {
+        return;
+    }
+    s_sem_hooks = true;
+    esp_heap_trace_alloc_hook(ptr, size, MALLOC_CAP_DEFAULT | MALLOC_CAP_8BIT);
+    s_sem_hooks = false;
+}
+
+static void free_hook(void *ptr)
+{
+    if (ptr == NULL || s_sem_hooks)
+    {
+        return;
+    }
+    s_sem_hooks = true;
+    esp_heap_trace_free_hook(ptr);
+    s_sem_hooks = false;
+}
+
+/* Implementação das funções públicas */
+
+bool heap_hooks_host_suspend(bool suspender)
+{
+    bool anterior = s_sem_hooks;
+    s_sem_hooks = suspender;
+    return anterior;
+}
+
+void *malloc(size_t size)
+{
+    void *ptr = __libc_malloc(size);
+    alloc_hook(ptr, size);
+    return ptr;
+}
+
+void *calloc(size_t n, size_t size)
+{
+    void *ptr = __libc_calloc(n, size);
+    alloc_hook(ptr, n * size);
+    return ptr;
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    void *novo = __libc_realloc(ptr, size);
+    if (novo != NULL || size == 0)
+    {
+        free_hook(ptr);
+    }
+    alloc_hook(novo, size);
+    return novo;
+}
+
+void free(void *ptr)
+{
+    free_hook(ptr);
+    __libc_free(ptr);
+}
+
+#else
+
+bool heap_hooks_host_suspend(bool suspender)
+{
+    return false;
+}
+
+#endif /* CONFIG_HEAP_USE_HOOKS */
@@ -0,0 +1,26 @@
+/**
+ * @file heap_hooks_host.h
+ * @brief Controle interno dos hooks de alocação do host.
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#ifndef HEAP_HOOKS_HOST_H
+#define HEAP_HOOKS_HOST_H
+
+#include <stdbool.h>
+
+/**
+ * @brief Liga ou desliga os hooks na thread atual.
+ *
+ * As bibliotecas do host que substituem componentes do ESP-IDF (a
+ * libmosquitto no lugar do esp-mqtt) alocam por conta própria; essas
+ * alocações não são do firmware e ficam fora da contagem.
+ *
+ * @param suspender true para ignorar as alocações seguintes da thread.
+ * @return Estado anterior, para restaurar depois.
+ */
+bool heap_hooks_host_suspend(bool suspender);
+
+#endif /* HEAP_HOOKS_HOST_H */
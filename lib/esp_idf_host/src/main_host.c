@@ -0,0 +1,72 @@
+/**
+ * @file main_host.c
+ * @brief Ponto de entrada do processo no host: chama app_main().
+ *
+ * Como no ESP-IDF, app_main() roda em uma task ("main") e pode retornar;
+ * o processo continua enquanto as demais tasks estiverem ativas, até
+ * Ctrl+C ou o limite de HOST_RUN_SECONDS (útil para perf/valgrind).
+ *
+ * Em `pio test` (PIO_UNIT_TESTING) o main() é o do teste Unity.
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#include <signal.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#ifndef PIO_UNIT_TESTING
+
+extern void app_main(void);
+
+/* Variáveis privadas (static) */
+
+static const char *TAG = "host";
+
+/* Funções auxiliares */
+
+static void main_task(void *pvParameters)
+{
+    app_main();
+    ESP_LOGI(TAG, "app_main() retornou");
+    vTaskDelete(NULL);
+}
+
+static void on_signal(int signo)
+{
+    /* Apenas funções async-signal-safe aqui: _exit encerra imediatamente */
+    _exit(128 + signo);
+}
+
+/* Implementação das funções públicas */
+
+int main(void)
+{
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    signal(SIGPIPE, SIG_IGN);
+
+    /* Como no ESP-IDF, a task principal roda fixada no núcleo 0 */
+    xTaskCreatePinnedToCore(main_task, "main", 3584, NULL, 1, NULL, 0);
+
+    const char *run_seconds = getenv("HOST_RUN_SECONDS");
+    long seconds = run_seconds ? strtol(run_seconds, NULL, 10) : 0;
+    if (seconds > 0)
+    {
+        sleep((unsigned int)seconds);
+        ESP_LOGI(TAG, "HOST_RUN_SECONDS=%ld atingido; encerrando", seconds);
+        return 0;
+    }
+
+    for (;;)
+    {
+        pause();
+    }
+}
+
+#endif /* PIO_UNIT_TESTING */
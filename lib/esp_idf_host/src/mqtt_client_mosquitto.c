@@ -0,0 +1,507 @@
+/**
+ * @file mqtt_client_mosquitto.c
+ * @brief esp_mqtt_client_* implementado sobre libmosquitto.
+ *
+ * Os callbacks do mosquitto (executados na thread de rede iniciada por
+ * mosquitto_loop_start) são traduzidos para os eventos MQTT_EVENT_* do
+ * esp-mqtt e entregues ao handler registrado na mesma thread, como faz
+ * a task interna do esp-mqtt no chip.
+ *
+ * Diferenças conhecidas:
+ * - esp_mqtt_client_get_outbox_size() considera apenas mensagens QoS>0
+ *   aguardando PUBACK (não há acesso ao outbox interno do mosquitto);
+ * - esp_mqtt_client_subscribe_multiple() com QoS diferentes por tópico
+ *   envia um SUBSCRIBE por tópico e retorna o msg_id do último.
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#include <mosquitto.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mqtt_client.h"
+#include "esp_log.h"
+#include "heap_hooks_host.h"
+
+/* Definições privadas */
+
+#define MQTT_HOST_DEFAULT_PORT 1883
+#define MQTT_HOST_DEFAULT_KEEPALIVE 120
+#define MQTT_HOST_MAX_INFLIGHT 128
+#define MQTT_HOST_MAX_TOPICS 16
+
+typedef struct
+{
+    int msg_id;
+    int len;
+} inflight_entry_t;
+
+struct esp_mqtt_client
+{
+    struct mosquitto *mosq;
+    char host[128];
+    int port;
+    int keepalive;
+    bool started;
+    bool connected;
+    esp_event_handler_t handler;
+    void *handler_arg;
+    int32_t handler_event;
+    pthread_mutex_t lock;
+    inflight_entry_t inflight[MQTT_HOST_MAX_INFLIGHT];
+    int inflight_count;
+    int outbox_bytes;
+};
+
+/* Variáveis privadas (static) */
+
+static const char *TAG = "mqtt_host";
+static esp_event_base_t const MQTT_EVENTS = "MQTT_EVENTS";
+static pthread_once_t s_lib_once = PTHREAD_ONCE_INIT;
+
+/* Funções auxiliares */
+
+static void lib_init(void)
+{
+    mosquitto_lib_init();
+}
+
+/**
+ * @brief Extrai host e porta de "mqtt://host[:porta][/...]".
+ */
+static bool parse_uri(const char *uri, char *host, size_t host_size, int *port)
+{
+    const char *p = strstr(uri, "://");
+    p = p ? p + 3 : uri;
+
+    const char *at = strchr(p, '@'); // credenciais na URI são ignoradas
+    if (at)
+    {
+        p = at + 1;
+    }
+
+    size_t len = strcspn(p, ":/");
+    if (len == 0 || len >= host_size)
+    {
+        return false;
+    }
+    memcpy(host, p, len);
+    host[len] = '\0';
+
+    *port = MQTT_HOST_DEFAULT_PORT;
+    if (p[len] == ':')
+    {
+        *port = atoi(p + len + 1);
+    }
+    return *port > 0 && *port < 65536;
+}
+
+static void dispatch_event(esp_mqtt_client_handle_t client, esp_mqtt_event_t *event)
+{
+    event->client = client;
+    if (client->handler &&
+        (client->handler_event == MQTT_EVENT_ANY || client->handler_event == (int32_t)event->event_id))
+    {
+        client->handler(client->handler_arg, MQTT_EVENTS, event->event_id, event);
+    }
+}
+
+/** Chamada com client->lock adquirido */
+static void inflight_add_locked(esp_mqtt_client_handle_t client, int msg_id, int len)
+{
+    if (client->inflight_count < MQTT_HOST_MAX_INFLIGHT)
+    {
+        client->inflight[client->inflight_count++] = (inflight_entry_t){msg_id, len};
+        client->outbox_bytes += len;
+    }
+}
+
+/**
+ * @return false se o mid não estava em voo (QoS 0, que o esp-mqtt não
+ *         confirma com MQTT_EVENT_PUBLISHED)
+ */
+static bool inflight_remove(esp_mqtt_client_handle_t client, int msg_id)
+{
+    bool found = false;
+
+    pthread_mutex_lock(&client->lock);
+    for (int i = 0; i < client->inflight_count; i++)
+    {
+        if (client->inflight[i].msg_id == msg_id)
+        {
+            client->outbox_bytes -= client->inflight[i].len;
+            client->inflight[i] = client->inflight[--client->inflight_count];
+            found = true;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&client->lock);
+    return found;
+}
+
+/* Callbacks do mosquitto */
+
+static void on_connect(struct mosquitto *mosq, void *obj, int rc, int flags)
+{
+    esp_mqtt_client_handle_t client = (esp_mqtt_client_handle_t)obj;
+    esp_mqtt_event_t event = {0};
+
+    if (rc != 0)
+    {
+        esp_mqtt_error_codes_t error = {
+            .error_type = MQTT_ERROR_TYPE_CONNECTION_REFUSED,
+            .connect_return_code = rc,
+        };
+        event.event_id = MQTT_EVENT_ERROR;
+        event.error_handle = &error;
+        ESP_LOGW(TAG, "Conexao recusada: %s", mosquitto_connack_string(rc));
+        dispatch_event(client, &event);
+        return;
+    }
+
+    client->connected = true;
+    event.event_id = MQTT_EVENT_CONNECTED;
+    event.session_present = flags & 0x01;
+    dispatch_event(client, &event);
+}
+
+static void on_disconnect(struct mosquitto *mosq, void *obj, int rc)
+{
+    esp_mqtt_client_handle_t client = (esp_mqtt_client_handle_t)obj;
+    esp_mqtt_event_t event = {.event_id = MQTT_EVENT_DISCONNECTED};
+
+    client->connected = false;
+    dispatch_event(client, &event);
+}
+
+static void on_publish(struct mosquitto *mosq, void *obj, int mid)
+{
+    esp_mqtt_client_handle_t client = (esp_mqtt_client_handle_t)obj;
+    esp_mqtt_event_t event = {.event_id = MQTT_EVENT_PUBLISHED, .msg_id = mid};
+
+    if (inflight_remove(client, mid))
+    {
+        dispatch_event(client, &event);
+    }
+}
+
+static void on_subscribe(struct mosquitto *mosq, void *obj, int mid,
+                         int qos_count, const int *granted_qos)
+{
+    esp_mqtt_client_handle_t client = (esp_mqtt_client_handle_t)obj;
+    esp_mqtt_event_t event = {.event_id = MQTT_EVENT_SUBSCRIBED, .msg_id = mid};
+
+    /* Como no esp-mqtt, os códigos de retorno do SUBACK vão em data */
+    char codes[MQTT_HOST_MAX_TOPICS];
+    int count = qos_count < MQTT_HOST_MAX_TOPICS ? qos_count : MQTT_HOST_MAX_TOPICS;
+    for (int i = 0; i < count; i++)
+    {
+        codes[i] = (char)granted_qos[i];
+    }
+    event.data = codes;
+    event.data_len = count;
+    event.total_data_len = count;
+    dispatch_event(client, &event);
+}
+
+static void on_unsubscribe(struct mosquitto *mosq, void *obj, int mid)
+{
+    esp_mqtt_client_handle_t client = (esp_mqtt_client_handle_t)obj;
+    esp_mqtt_event_t event = {.event_id = MQTT_EVENT_UNSUBSCRIBED, .msg_id = mid};
+    dispatch_event(client, &event);
+}
+
+static void on_message(struct mosquitto *mosq, void *obj, const struct mosquitto_message *msg)
+{
+    esp_mqtt_client_handle_t client = (esp_mqtt_client_handle_t)obj;
+    esp_mqtt_event_t event = {
+        .event_id = MQTT_EVENT_DATA,
+        .msg_id = msg->mid,
+        .topic = msg->topic,
+        .topic_len = (int)strlen(msg->topic),
+        .data = (char *)msg->payload,
+        .data_len = msg->payloadlen,
+        .total_data_len = msg->payloadlen,
+        .current_data_offset = 0,
+        .qos = msg->qos,
+        .retain = msg->retain,
+    };
+    dispatch_event(client, &event);
+}
+
+/* Implementação das funções públicas */
+
+esp_mqtt_client_handle_t esp_mqtt_client_init(const esp_mqtt_client_config_t *config)
+{
+    if (config == NULL)
+    {
+        return NULL;
+    }
+    pthread_once(&s_lib_once, lib_init);
+
+    esp_mqtt_client_handle_t client = calloc(1, sizeof(*client));
+    if (client == NULL)
+    {
+        return NULL;
+    }
+    pthread_mutex_init(&client->lock, NULL);
+
+    /* MQTT_BROKER_URI permite apontar para outro broker sem recompilar */
+    const char *uri = getenv("MQTT_BROKER_URI");
+    if (uri == NULL || uri[0] == '\0')
+    {
+        uri = config->broker.address.uri;
+    }
+    if (uri != NULL)
+    {
+        if (!parse_uri(uri, client->host, sizeof(client->host), &client->port))
+        {
+            ESP_LOGE(TAG, "URI invalida: %s", uri);
+            free(client);
+            return NULL;
+        }
+    }
+    else
+    {
+        snprintf(client->host, sizeof(client->host), "%s",
+                 config->broker.address.hostname ? config->broker.address.hostname : "localhost");
+        client->port = config->broker.address.port ? (int)config->broker.address.port
+                                                   : MQTT_HOST_DEFAULT_PORT;
+    }
+    client->keepalive = config->session.keepalive ? config->session.keepalive
+                                                  : MQTT_HOST_DEFAULT_KEEPALIVE;
+
+    bool clean_session = !config->session.disable_clean_session;
+    client->mosq = mosquitto_new(config->credentials.client_id, clean_session, client);
+    if (client->mosq == NULL)
+    {
+        ESP_LOGE(TAG, "Falha ao criar cliente mosquitto");
+        free(client);
+        return NULL;
+    }
+
+    if (config->credentials.username)
+    {
+        mosquitto_username_pw_set(client->mosq, config->credentials.username,
+                                  config->credentials.authentication.password);
+    }
+
+    if (config->session.last_will.topic)
+    {
+        const char *msg = config->session.last_will.msg ? config->session.last_will.msg : "";
+        int msg_len = config->session.last_will.msg_len ? config->session.last_will.msg_len
+                                                        : (int)strlen(msg);
+        mosquitto_will_set(client->mosq, config->session.last_will.topic, msg_len, msg,
+                           config->session.last_will.qos, config->session.last_will.retain);
+    }
+
+    int reconnect_s = config->network.reconnect_timeout_ms > 0
+                          ? config->network.reconnect_timeout_ms / 1000
+                          : 10;
+    mosquitto_reconnect_delay_set(client->mosq, reconnect_s > 0 ? reconnect_s : 1,
+                                  reconnect_s > 0 ? reconnect_s : 1, false);
+
+    mosquitto_connect_with_flags_callback_set(client->mosq, on_connect);
+    mosquitto_disconnect_callback_set(client->mosq, on_disconnect);
+    mosquitto_publish_callback_set(client->mosq, on_publish);
+    mosquitto_subscribe_callback_set(client->mosq, on_subscribe);
+    mosquitto_unsubscribe_callback_set(client->mosq, on_unsubscribe);
+    mosquitto_message_callback_set(client->mosq, on_message);
+
+    ESP_LOGI(TAG, "Broker: %s:%d", client->host, client->port);
+    return client;
+}
+
+esp_err_t esp_mqtt_client_register_event(esp_mqtt_client_handle_t client,
+                                         esp_mqtt_event_id_t event,
+                                         esp_event_handler_t event_handler,
+                                         void *event_handler_arg)
+{
+    if (client == NULL || event_handler == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    client->handler = event_handler;
+    client->handler_arg = event_handler_arg;
+    client->handler_event = event;
+    return ESP_OK;
+}
+
+esp_err_t esp_mqtt_client_start(esp_mqtt_client_handle_t client)
+{
+    if (client == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (client->started)
+    {
+        return ESP_FAIL;
+    }
+
+    /* connect_async + loop_start: a conexão (e as reconexões) acontecem
+     * na thread do mosquitto, sem bloquear quem chamou */
+    int rc = mosquitto_connect_async(client->mosq, client->host, client->port, client->keepalive);
+    if (rc != MOSQ_ERR_SUCCESS)
+    {
+        ESP_LOGW(TAG, "Conexao inicial falhou (%s); tentando em segundo plano",
+                 mosquitto_strerror(rc));
+    }
+
+    rc = mosquitto_loop_start(client->mosq);
+    if (rc != MOSQ_ERR_SUCCESS)
+    {
+        ESP_LOGE(TAG, "Falha ao iniciar loop: %s", mosquitto_strerror(rc));
+        return ESP_FAIL;
+    }
+    client->started = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_mqtt_client_stop(esp_mqtt_client_handle_t client)
+{
+    if (client == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!client->started)
+    {
+        return ESP_FAIL;
+    }
+    mosquitto_disconnect(client->mosq);
+    mosquitto_loop_stop(client->mosq, false);
+    client->started = false;
+    client->connected = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_mqtt_client_reconnect(esp_mqtt_client_handle_t client)
+{
+    if (client == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return mosquitto_reconnect_async(client->mosq) == MOSQ_ERR_SUCCESS ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t esp_mqtt_client_destroy(esp_mqtt_client_handle_t client)
+{
+    if (client == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (client->started)
+    {
+        esp_mqtt_client_stop(client);
+    }
+    mosquitto_destroy(client->mosq);
+    pthread_mutex_destroy(&client->lock);
+    free(client);
+    return ESP_OK;
+}
+
+int esp_mqtt_client_publish(esp_mqtt_client_handle_t client, const char *topic,
+                            const char *data, int len, int qos, int retain)
+{
+    if (client == NULL || topic == NULL)
+    {
+        return -1;
+    }
+    if (!client->connected)
+    {
+        return -1;
+    }
+    if (len <= 0 && data != NULL)
+    {
+        len = (int)strlen(data);
+    }
+
+    /* O lock cobre o envio para que o ACK não chegue antes do registro.
+     * O pacote que o mosquitto aloca fica fora dos hooks: no chip, o
+     * outbox estático (static_outbox.h) não aloca */
+    int mid = 0;
+    pthread_mutex_lock(&client->lock);
+    bool hooks = heap_hooks_host_suspend(true);
+    int rc = mosquitto_publish(client->mosq, &mid, topic, len, data, qos, retain != 0);
+    heap_hooks_host_suspend(hooks);
+    if (rc == MOSQ_ERR_SUCCESS && qos > 0)
+    {
+        inflight_add_locked(client, mid, len);
+    }
+    pthread_mutex_unlock(&client->lock);
+
+    if (rc != MOSQ_ERR_SUCCESS)
+    {
+        ESP_LOGD(TAG, "mosquitto_publish: %s", mosquitto_strerror(rc));
+        return -1;
+    }
+    return qos == 0 ? 0 : mid; // esp-mqtt retorna 0 para QoS 0
+}
+
+int esp_mqtt_client_enqueue(esp_mqtt_client_handle_t client, const char *topic,
+                            const char *data, int len, int qos, int retain, bool store)
+{
+    /* O mosquitto mantém sua própria fila; enfileirar equivale a publicar */
+    return esp_mqtt_client_publish(client, topic, data, len, qos, retain);
+}
+
+int esp_mqtt_client_subscribe_single(esp_mqtt_client_handle_t client,
+                                     const char *topic, int qos)
+{
+    if (client == NULL || topic == NULL || !client->connected)
+    {
+        return -1;
+    }
+    int mid = 0;
+    return mosquitto_subscribe(client->mosq, &mid, topic, qos) == MOSQ_ERR_SUCCESS ? mid : -1;
+}
+
+int esp_mqtt_client_subscribe_multiple(esp_mqtt_client_handle_t client,
+                                       const esp_mqtt_topic_t *topic_list, int size)
+{
+    if (client == NULL || topic_list == NULL || size <= 0 || size > MQTT_HOST_MAX_TOPICS ||
+        !client->connected)
+    {
+        return -1;
+    }
+
+    /* libmosquitto não tem SUBSCRIBE com QoS por filtro; um único pacote
+     * mantém o msg_id e os códigos do SUBACK alinhados com a lista, ao
+     * custo de pedir o maior QoS da lista para todos os filtros */
+    int qos = 0;
+    char *filters[MQTT_HOST_MAX_TOPICS];
+    for (int i = 0; i < size; i++)
+    {
+        filters[i] = (char *)topic_list[i].filter;
+        qos = topic_list[i].qos > qos ? topic_list[i].qos : qos;
+    }
+
+    int mid = 0;
+    int rc = mosquitto_subscribe_multiple(client->mosq, &mid, size, filters, qos, 0, NULL);
+    return rc == MOSQ_ERR_SUCCESS ? mid : -1;
+}
+
+int esp_mqtt_client_unsubscribe(esp_mqtt_client_handle_t client, const char *topic)
+{
+    if (client == NULL || topic == NULL || !client->connected)
+    {
+        return -1;
+    }
+    int mid = 0;
+    return mosquitto_unsubscribe(client->mosq, &mid, topic) == MOSQ_ERR_SUCCESS ? mid : -1;
+}
+
+int esp_mqtt_client_get_outbox_size(esp_mqtt_client_handle_t client)
+{
+    if (client == NULL)
+    {
+        return 0;
+    }
+    pthread_mutex_lock(&client->lock);
+    int bytes = client->outbox_bytes;
+    pthread_mutex_unlock(&client->lock);
+    return bytes;
+}
@@ -0,0 +1,195 @@
+/**
+ * @file nvs_host.c
+ * @brief NVS no host: cada chave é um arquivo "nvs.<namespace>.<chave>"
+ *        em HOST_FLASH_DIR (padrão .pio/host), mantido entre execuções.
+ *
+ * As gravações vão direto para o arquivo; nvs_commit() não tem efeito.
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#include "nvs_flash.h"
+#include "nvs.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+/* Definições privadas */
+
+#define HOST_FLASH_DIR_DEFAULT ".pio/host"
+#define NVS_HOST_MAX_HANDLES 8
+#define NVS_KEY_NAME_MAX_SIZE 16
+
+typedef struct
+{
+    bool used;
+    bool writable;
+    char namespace_name[NVS_KEY_NAME_MAX_SIZE];
+} nvs_host_handle_t;
+
+/* Variáveis privadas (static) */
+
+static nvs_host_handle_t s_handles[NVS_HOST_MAX_HANDLES];
+
+/* Funções auxiliares */
+
+static nvs_host_handle_t *get_handle(nvs_handle_t handle)
+{
+    if (handle == 0 || handle > NVS_HOST_MAX_HANDLES || !s_handles[handle - 1].used)
+    {
+        return NULL;
+    }
+    return &s_handles[handle - 1];
+}
+
+static void key_path(const nvs_host_handle_t *h, const char *key, char *path, size_t size)
+{
+    const char *dir = getenv("HOST_FLASH_DIR");
+    if (dir == NULL || dir[0] == '\0')
+    {
+        dir = HOST_FLASH_DIR_DEFAULT;
+    }
+    mkdir(dir, 0755);
+    snprintf(path, size, "%s/nvs.%s.%s", dir, h->namespace_name, key);
+}
+
+/* Implementação das funções públicas */
+
+esp_err_t nvs_flash_init(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_erase(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t nvs_open(const char *namespace_name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle)
+{
+    if (namespace_name == NULL || out_handle == NULL ||
+        strlen(namespace_name) >= NVS_KEY_NAME_MAX_SIZE)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    for (uint32_t i = 0; i < NVS_HOST_MAX_HANDLES; i++)
+    {
+        if (!s_handles[i].used)
+        {
+            s_handles[i].used = true;
+            s_handles[i].writable = (open_mode == NVS_READWRITE);
+            strcpy(s_handles[i].namespace_name, namespace_name);
+            *out_handle = i + 1;
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NO_MEM;
+}
+
+void nvs_close(nvs_handle_t handle)
+{
+    nvs_host_handle_t *h = get_handle(handle);
+    if (h != NULL)
+    {
+        h->used = false;
+    }
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle)
+{
+    return get_handle(handle) ? ESP_OK : ESP_ERR_NVS_INVALID_HANDLE;
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length)
+{
+    nvs_host_handle_t *h = get_handle(handle);
+    if (h == NULL)
+    {
+        return ESP_ERR_NVS_INVALID_HANDLE;
+    }
+    if (key == NULL || length == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    char path[512];
+    key_path(h, key, path, sizeof(path));
+
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+
+    fseek(file, 0, SEEK_END);
+    size_t stored = (size_t)ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    esp_err_t ret = ESP_OK;
+    if (out_value != NULL)
+    {
+        if (*length < stored)
+        {
+            ret = ESP_ERR_NVS_INVALID_LENGTH;
+        }
+        else if (fread(out_value, 1, stored, file) != stored)
+        {
+            ret = ESP_FAIL;
+        }
+    }
+    *length = stored;
+
+    fclose(file);
+    return ret;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length)
+{
+    nvs_host_handle_t *h = get_handle(handle);
+    if (h == NULL)
+    {
+        return ESP_ERR_NVS_INVALID_HANDLE;
+    }
+    if (!h->writable)
+    {
+        return ESP_ERR_NVS_READ_ONLY;
+    }
+    if (key == NULL || value == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    char path[512];
+    key_path(h, key, path, sizeof(path));
+
+    FILE *file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        return ESP_FAIL;
+    }
+    size_t written = fwrite(value, 1, length, file);
+    fclose(file);
+    return (written == length) ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key)
+{
+    nvs_host_handle_t *h = get_handle(handle);
+    if (h == NULL)
+    {
+        return ESP_ERR_NVS_INVALID_HANDLE;
+    }
+    if (!h->writable)
+    {
+        return ESP_ERR_NVS_READ_ONLY;
+    }
+
+    char path[512];
+    key_path(h, key, path, sizeof(path));
+    return (remove(path) == 0) ? ESP_OK : ESP_ERR_NVS_NOT_FOUND;
+}
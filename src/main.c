@@ -14,10 +14,17 @@
 #include "freertos/task.h"
 #include "esp_log.h"
 #include "services/mqtt_system.h"
+#include "services/boot_trace.h"
+#include "services/task_profile.h"
 #include "tasks/system_monitor_task.h"
 #include "tasks/custom_publish_task.h"
 #include "tasks/sensor_simulate_task.h"
 
+#ifdef CONFIG_PUBLISH_BENCH
+#include <stdlib.h>
+#include "services/publish_bench.h"
+#endif
+
 /*
  * =============================================================================
  * CONFIGURAÇÕES DA APLICAÇÃO
@@ -35,8 +42,9 @@ static const char *TAG = "MAIN_APP";
 /**
  * @brief Ponto de entrada da aplicação.
  *
- * Inicializa o sistema (WiFi, MQTT) e em seguida cria as tasks da
- * aplicação, transferindo o controle para o scheduler do FreeRTOS.
+ * Inicializa o sistema e cria as tasks da aplicação sem esperar a rede:
+ * WiFi e MQTT conectam em segundo plano enquanto as tasks já amostram.
+ * O controle é então transferido para o scheduler do FreeRTOS.
  */
 void app_main(void)
 {
@@ -48,7 +56,16 @@ void app_main(void)
     ESP_LOGI(TAG, "╚═════════════════════════════════╝");
     ESP_LOGI(TAG, "");
 
-    // PASSO 1: Inicializa os serviços de WiFi, MQTT e outras funcionalidades base
+#ifdef CONFIG_PUBLISH_BENCH
+    // Modo benchmark: mede o caminho de publicação sem rede e sem as tasks
+    publish_bench_run();
+#ifdef CONFIG_HOST_MODE
+    exit(0);
+#endif
+    return;
+#endif
+
+    // PASSO 1: Inicializa os serviços base; WiFi e MQTT conectam em segundo plano
     esp_err_t ret = mqtt_system_init();
 
     if (ret != ESP_OK)
@@ -62,58 +79,31 @@ void app_main(void)
 
     // PASSO 2: Criar as tasks da aplicação que rodam em paralelo.
     ESP_LOGI(TAG, "Criando tasks da aplicacao...");
+    boot_span_id_t span_tasks = boot_trace_begin("app.tasks");
 
     // Task 1: Monitoramento do Sistema
-    BaseType_t task_created = xTaskCreate(
-        system_monitor_task,        // Função da task
-        MONITOR_TASK_NAME,          // Nome (debug)
-        MONITOR_TASK_STACK_SIZE,    // Tamanho da Stack
-        NULL,                       // Parâmetros
-        MONITOR_TASK_PRIORITY,      // Prioridade
-        NULL                        // Handle
-    );
-
-    if (task_created != pdPASS)
+    // Stack, prioridade e núcleo vêm do perfil de escalonamento (task_profile.h)
+    if (task_profile_create(TASK_ID_MONITOR, system_monitor_task, NULL, NULL) != ESP_OK)
     {
         ESP_LOGE(TAG, "Falha ao criar task de monitoramento");
         return;
     }
 
-    ESP_LOGI(TAG, "   [OK] Task: %s (Prioridade: %d)",
-             MONITOR_TASK_NAME, MONITOR_TASK_PRIORITY);
-
     // Task 2: Publicação de Dados Customizados
-    task_created = xTaskCreate(
-        custom_publish_task,            // Função da task
-        CUSTOM_PUBLISH_TASK_NAME,       // Nome (debug)
-        CUSTOM_PUBLISH_TASK_STACK_SIZE, // Tamanho da Stack
-        NULL,                           // Parâmetros
-        CUSTOM_PUBLISH_TASK_PRIORITY,   // Prioridade
-        NULL                            // Handle
-    );
-
-    if (task_created != pdPASS)
+    if (task_profile_create(TASK_ID_CUSTOM_PUBLISH, custom_publish_task, NULL, NULL) != ESP_OK)
     {
         ESP_LOGE(TAG, "Falha ao criar task de publicacao customizada");
         return;
     }
 
     // Task 3: Simulação de Sensores
-    task_created = xTaskCreate(
-        sensor_simulate_task,            // Função da task
-        SENSOR_SIMULATE_TASK_NAME,       // Nome (debug)
-        SENSOR_SIMULATE_TASK_STACK_SIZE, // Tamanho da Stack
-        NULL,                           // Parâmetros
-        SENSOR_SIMULATE_TASK_PRIORITY,   // Prioridade
-        NULL                            // Handle
-    );
-
-    if (task_created != pdPASS)
+    if (task_profile_create(TASK_ID_SENSOR_SIMULATE, sensor_simulate_task, NULL, NULL) != ESP_OK)
     {
         ESP_LOGE(TAG, "Falha ao criar task de simulação de sensores");
         return;
     }
 
+    boot_trace_end(span_tasks);
     ESP_LOGI(TAG, "Tasks da aplicacao criadas com sucesso!");
     ESP_LOGI(TAG, "");
     ESP_LOGI(TAG, "════════════════════════════════════════");
@@ -121,20 +111,28 @@ void app_main(void)
     ESP_LOGI(TAG, "════════════════════════════════════════");
     ESP_LOGI(TAG, "");
     ESP_LOGI(TAG, "Funcionalidades ativas:");
-    ESP_LOGI(TAG, "   - Telemetria automatica a cada %d segundos",
-             TELEMETRY_INTERVAL_MS / 1000);
+    ESP_LOGI(TAG, "   - Telemetria amostrada a cada %lu us", TELEMETRY_PERIOD_US);
     ESP_LOGI(TAG, "   - Health check a cada %d segundos",
              HEALTH_CHECK_INTERVAL_MS / 1000);
-    ESP_LOGI(TAG, "   - Watchdog WiFi monitorando conectividade");
+    ESP_LOGI(TAG, "   - Conexao WiFi/MQTT em segundo plano (reconexao automatica)");
     ESP_LOGI(TAG, "   - Monitoramento do sistema a cada %d segundos",
              MONITOR_INTERVAL_MS / 1000);
     ESP_LOGI(TAG, "   - Publicacao customizada a cada %d segundos",
              CUSTOM_PUBLISH_INTERVAL_MS / 1000);
     ESP_LOGI(TAG, "");
-    ESP_LOGI(TAG, "Tasks criadas: 3");
-    ESP_LOGI(TAG, "   1. %s (P%d)", MONITOR_TASK_NAME, MONITOR_TASK_PRIORITY);
-    ESP_LOGI(TAG, "   2. %s (P%d)", CUSTOM_PUBLISH_TASK_NAME, CUSTOM_PUBLISH_TASK_PRIORITY);
-    ESP_LOGI(TAG, "   3. %s (P%d)", SENSOR_SIMULATE_TASK_NAME, SENSOR_SIMULATE_TASK_PRIORITY);
+    ESP_LOGI(TAG, "Tasks (perfil de escalonamento %s):", task_profile_name());
+    for (int id = 0; id < TASK_ID_COUNT; id++)
+    {
+        const task_profile_t *p = task_profile_get(id);
+        if (p->nucleo == tskNO_AFFINITY)
+        {
+            ESP_LOGI(TAG, "   %s (P%u, qualquer nucleo)", p->nome, (unsigned)p->prioridade);
+        }
+        else
+        {
+            ESP_LOGI(TAG, "   %s (P%u, nucleo %d)", p->nome, (unsigned)p->prioridade, (int)p->nucleo);
+        }
+    }
     ESP_LOGI(TAG, "");
 
     // PASSO 3: Finaliza app_main. O scheduler do FreeRTOS assume o controle.
@@ -0,0 +1,205 @@
+/**
+ * @file actuator.c
+ * @brief Task de atuação - Implementação
+ *
+ * A fila é um buffer circular limitado com número de sequência por
+ * posição: produtores reservam a posição com compare-exchange no índice
+ * de escrita e publicam o comando gravando a sequência; o único
+ * consumidor (a task) lê em ordem e devolve a posição somando o tamanho
+ * da fila à sequência.
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#include "actuator.h"
+
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "driver/gpio.h"
+#include "task_profile.h"
+
+/* Definições privadas */
+
+static const char *TAG = "ACTUATOR";
+
+_Static_assert((ACTUATOR_QUEUE_SIZE & (ACTUATOR_QUEUE_SIZE - 1)) == 0,
+               "ACTUATOR_QUEUE_SIZE deve ser potencia de 2");
+
+typedef struct
+{
+    uint32_t seq;
+    actuator_cmd_t cmd;
+} queue_slot_t;
+
+/* Variáveis privadas (static) */
+
+static queue_slot_t s_queue[ACTUATOR_QUEUE_SIZE];
+static uint32_t s_write_pos = 0; ///< Compartilhado pelos produtores
+static uint32_t s_read_pos = 0;  ///< Exclusivo da task
+
+static TaskHandle_t s_task = NULL;
+static bool s_queue_ready = false;
+
+static latency_hist_t s_latency;
+static uint32_t s_executed = 0;
+static uint32_t s_dropped = 0;
+
+/* Funções auxiliares */
+
+static void queue_init(void)
+{
+    for (uint32_t i = 0; i < ACTUATOR_QUEUE_SIZE; i++)
+    {
+        s_queue[i].seq = i;
+    }
+    s_write_pos = 0;
+    s_read_pos = 0;
+    __atomic_store_n(&s_queue_ready, true, __ATOMIC_RELEASE);
+}
+
+static bool queue_pop(actuator_cmd_t *cmd)
+{
+    queue_slot_t *slot = &s_queue[s_read_pos & (ACTUATOR_QUEUE_SIZE - 1)];
+    uint32_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+
+    if ((int32_t)(seq - (s_read_pos + 1)) < 0)
+    {
+        return false; // Vazia ou produtor ainda gravando
+    }
+
+    *cmd = slot->cmd;
+    __atomic_store_n(&slot->seq, s_read_pos + ACTUATOR_QUEUE_SIZE, __ATOMIC_RELEASE);
+    s_read_pos++;
+    return true;
+}
+
+static void actuator_task(void *pvParameters)
+{
+    ESP_LOGI(TAG, "Task de atuacao iniciada (nucleo %d)", xPortGetCoreID());
+
+    actuator_cmd_t cmd;
+    uint32_t dropped_seen = 0;
+
+    while (1)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        while (queue_pop(&cmd))
+        {
+            gpio_set_level(cmd.gpio, cmd.level);
+            uint32_t latency_us = (uint32_t)esp_timer_get_time() - cmd.timestamp_us;
+            latency_hist_record(&s_latency, latency_us);
+            __atomic_fetch_add(&s_executed, 1, __ATOMIC_RELAXED);
+
+            if (cmd.rule != ACTUATOR_NO_RULE)
+            {
+                ESP_LOGI(TAG, "GPIO %u = %u (regra %u, valor %ld, %lu us)",
+                         cmd.gpio, cmd.level, cmd.rule, (long)cmd.value,
+                         (unsigned long)latency_us);
+            }
+            else
+            {
+                ESP_LOGI(TAG, "GPIO %u = %u (%lu us)", cmd.gpio, cmd.level,
+                         (unsigned long)latency_us);
+            }
+        }
+
+        uint32_t dropped = __atomic_load_n(&s_dropped, __ATOMIC_RELAXED);
+        if (dropped != dropped_seen)
+        {
+            ESP_LOGW(TAG, "Fila de atuacao cheia: %lu comandos descartados",
+                     (unsigned long)(dropped - dropped_seen));
+            dropped_seen = dropped;
+        }
+    }
+}
+
+/* Implementação das funções públicas */
+
+esp_err_t actuator_init(void)
+{
+    if (s_task != NULL)
+    {
+        return ESP_OK;
+    }
+
+    if (!__atomic_load_n(&s_queue_ready, __ATOMIC_ACQUIRE))
+    {
+        queue_init();
+    }
+
+    if (task_profile_create(TASK_ID_ACTUATOR, actuator_task, NULL, &s_task) != ESP_OK)
+    {
+        s_task = NULL;
+        return ESP_FAIL;
+    }
+
+    /* Aplica o que foi postado antes da task existir */
+    xTaskNotifyGive(s_task);
+    return ESP_OK;
+}
+
+esp_err_t actuator_post(const actuator_cmd_t *cmd)
+{
+    if (!__atomic_load_n(&s_queue_ready, __ATOMIC_ACQUIRE))
+    {
+        __atomic_fetch_add(&s_dropped, 1, __ATOMIC_RELAXED);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uint32_t pos = __atomic_load_n(&s_write_pos, __ATOMIC_RELAXED);
+    queue_slot_t *slot;
+
+    while (1)
+    {
+        slot = &s_queue[pos & (ACTUATOR_QUEUE_SIZE - 1)];
+        uint32_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        int32_t diff = (int32_t)(seq - pos);
+
+        if (diff == 0)
+        {
+            if (__atomic_compare_exchange_n(&s_write_pos, &pos, pos + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                break;
+            }
+            // pos recarregado pelo compare-exchange
+        }
+        else if (diff < 0)
+        {
+            __atomic_fetch_add(&s_dropped, 1, __ATOMIC_RELAXED);
+            return ESP_ERR_NO_MEM;
+        }
+        else
+        {
+            pos = __atomic_load_n(&s_write_pos, __ATOMIC_RELAXED);
+        }
+    }
+
+    slot->cmd = *cmd;
+    __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+
+    TaskHandle_t task = s_task;
+    if (task != NULL)
+    {
+        xTaskNotifyGive(task);
+    }
+    return ESP_OK;
+}
+
+void actuator_get_stats(actuator_stats_t *stats)
+{
+    latency_hist_summary(&s_latency, &stats->latencia);
+    stats->executados = __atomic_load_n(&s_executed, __ATOMIC_RELAXED);
+    stats->descartados = __atomic_load_n(&s_dropped, __ATOMIC_RELAXED);
+}
+
+void actuator_reset_stats(void)
+{
+    latency_hist_reset(&s_latency);
+    __atomic_store_n(&s_executed, 0, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,79 @@
+/**
+ * @file actuator.h
+ * @brief Task de atuação com fila de comandos sem lock.
+ *
+ * Os handlers de mensagens (na task do cliente MQTT) não acionam GPIOs
+ * nem escrevem no log: apenas postam um comando compacto, com o instante
+ * de recebimento da mensagem, em uma fila circular MPSC sem lock. A task
+ * de atuação, de alta prioridade e fixada no núcleo de aplicação, aplica
+ * o nível no pino, registra a latência mensagem→pino em um histograma
+ * (latency_hist.h) e só então faz o log.
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#ifndef ACTUATOR_H
+#define ACTUATOR_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "latency_hist.h"
+
+/* Configuração */
+
+#ifndef ACTUATOR_QUEUE_SIZE
+#define ACTUATOR_QUEUE_SIZE 256 ///< Comandos pendentes (potência de 2, >= RULE_ENGINE_MAX_RULES)
+#endif
+
+/* Stack, prioridade e núcleo da task: TASK_ID_ACTUATOR em task_profile.c */
+
+/** Origem do comando sem regra associada */
+#define ACTUATOR_NO_RULE UINT16_MAX
+
+/**
+ * @brief Comando de atuação (12 bytes).
+ */
+typedef struct
+{
+	uint32_t timestamp_us; ///< Recebimento da mensagem que originou o comando.
+	int32_t value;		   ///< Valor que disparou o comando (para o log).
+	uint16_t rule;		   ///< Índice da regra ou ACTUATOR_NO_RULE.
+	uint8_t gpio;		   ///< Pino.
+	uint8_t level;		   ///< Nível a aplicar.
+} actuator_cmd_t;
+
+/**
+ * @brief Estatísticas da task de atuação.
+ */
+typedef struct
+{
+	latency_summary_t latencia; ///< Latência mensagem→pino.
+	uint32_t executados;		  ///< Comandos aplicados.
+	uint32_t descartados;		  ///< Comandos perdidos com a fila cheia.
+} actuator_stats_t;
+
+/**
+ * @brief Cria a fila e a task de atuação. Comandos postados antes disso
+ *        ficam na fila e são aplicados quando a task iniciar.
+ * @return ESP_OK ou ESP_FAIL se a task não pôde ser criada.
+ */
+esp_err_t actuator_init(void);
+
+/**
+ * @brief Posta um comando (seguro em qualquer task, sem bloquear).
+ * @return ESP_OK ou ESP_ERR_NO_MEM se a fila estiver cheia.
+ */
+esp_err_t actuator_post(const actuator_cmd_t *cmd);
+
+/**
+ * @brief Obtém as estatísticas de atuação.
+ */
+void actuator_get_stats(actuator_stats_t *stats);
+
+/**
+ * @brief Zera o histograma de latência e o contador de comandos aplicados.
+ */
+void actuator_reset_stats(void);
+
+#endif /* ACTUATOR_H */
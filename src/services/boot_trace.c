@@ -0,0 +1,103 @@
+/**
+ * @file boot_trace.c
+ * @brief Perfil de tempo do boot - Implementação
+ *
+ * Tempos em uint32_t µs (cobre ~71 min de boot) para que a publicação
+ * de fim_us seja atômica também no Xtensa. fim_us == 0 marca span aberto.
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#include "boot_trace.h"
+
+#include <stdio.h>
+#include "esp_timer.h"
+
+/* Definições privadas */
+
+typedef struct
+{
+    const char *nome;
+    uint32_t inicio_us;
+    uint32_t fim_us; ///< 0 enquanto aberto
+} boot_span_t;
+
+/* Variáveis privadas (static) */
+
+static boot_span_t s_spans[BOOT_TRACE_MAX_SPANS];
+static uint32_t s_count = 0;
+
+/* Funções auxiliares */
+
+static inline uint32_t now_us(void)
+{
+    return (uint32_t)esp_timer_get_time();
+}
+
+/* Implementação das funções públicas */
+
+boot_span_id_t boot_trace_begin(const char *nome)
+{
+    uint32_t idx = __atomic_fetch_add(&s_count, 1, __ATOMIC_RELAXED);
+    if (idx >= BOOT_TRACE_MAX_SPANS)
+    {
+        return -1;
+    }
+
+    s_spans[idx].nome = nome;
+    s_spans[idx].inicio_us = now_us();
+    return (boot_span_id_t)idx;
+}
+
+void boot_trace_end(boot_span_id_t id)
+{
+    if (id < 0 || id >= BOOT_TRACE_MAX_SPANS)
+    {
+        return;
+    }
+
+    uint32_t fim = now_us();
+    __atomic_store_n(&s_spans[id].fim_us, fim ? fim : 1, __ATOMIC_RELEASE);
+}
+
+int boot_trace_to_json(char *buf, size_t len)
+{
+    if (buf == NULL || len < 3)
+    {
+        return 0;
+    }
+
+    uint32_t count = __atomic_load_n(&s_count, __ATOMIC_RELAXED);
+    if (count > BOOT_TRACE_MAX_SPANS)
+    {
+        count = BOOT_TRACE_MAX_SPANS;
+    }
+
+    size_t pos = 0;
+    buf[pos++] = '[';
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t fim = __atomic_load_n(&s_spans[i].fim_us, __ATOMIC_ACQUIRE);
+        if (fim == 0)
+        {
+            continue;
+        }
+
+        /* Reserva espaço para o ']' final */
+        int n = snprintf(buf + pos, len - pos - 1, "%s[\"%s\",%lu,%lu]",
+                         pos > 1 ? "," : "", s_spans[i].nome,
+                         (unsigned long)s_spans[i].inicio_us,
+                         (unsigned long)(fim - s_spans[i].inicio_us));
+        if (n < 0 || (size_t)n >= len - pos - 1)
+        {
+            break;
+        }
+        pos += n;
+    }
+
+    buf[pos++] = ']';
+    buf[pos] = '\0';
+    return (int)pos;
+}
@@ -0,0 +1,51 @@
+/**
+ * @file boot_trace.h
+ * @brief Perfil de tempo do boot em spans de esp_timer.
+ *
+ * Cada fase e subetapa da inicialização registra um span (nome, início e
+ * duração em microssegundos desde o boot) em um buffer estático. Os spans
+ * são abertos e fechados por quem executa a etapa, em qualquer task, sem
+ * alocação nem lock: o índice do próximo slot é reservado atomicamente.
+ * O trace completo segue no payload de MQTT_TOPIC_BOOT.
+ *
+ * Nomes com ponto indicam subetapas ("init.nvs" dentro de "init").
+ * Os nomes devem ser literais (apenas o ponteiro é guardado).
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#ifndef BOOT_TRACE_H
+#define BOOT_TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef BOOT_TRACE_MAX_SPANS
+#define BOOT_TRACE_MAX_SPANS 24 ///< Spans registrados por boot (os excedentes são ignorados)
+#endif
+
+/** Identificador de um span aberto (-1 se o buffer estiver cheio) */
+typedef int boot_span_id_t;
+
+/**
+ * @brief Abre um span no instante atual.
+ * @param nome Nome literal da etapa.
+ */
+boot_span_id_t boot_trace_begin(const char *nome);
+
+/**
+ * @brief Fecha um span aberto por boot_trace_begin(). Ignora -1.
+ */
+void boot_trace_end(boot_span_id_t id);
+
+/**
+ * @brief Serializa os spans fechados como array JSON.
+ *
+ * Formato: `[["init",412,18350],["init.nvs",420,9120],...]`, com nome,
+ * início e duração em µs. Spans que não cabem em `buf` são omitidos.
+ * @return Bytes escritos (sem o '\0').
+ */
+int boot_trace_to_json(char *buf, size_t len);
+
+#endif /* BOOT_TRACE_H */
@@ -0,0 +1,166 @@
+/**
+ * @file cpu_stats.c
+ * @brief Uso de CPU por task e por núcleo - Implementação
+ *
+ * Guarda o contador de execução de cada task da amostra anterior (por
+ * handle) e calcula os deltas na seguinte. Contadores de 32 bits em µs
+ * dão voltas a cada ~71 min; a subtração sem sinal cobre janelas menores
+ * que isso. Uma task criada dentro da janela conta desde a criação.
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#include "cpu_stats.h"
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+
+/* Definições privadas */
+
+#define CPU_STATS_SUPPORTED (configUSE_TRACE_FACILITY == 1 && configGENERATE_RUN_TIME_STATS == 1)
+
+#if CPU_STATS_SUPPORTED
+
+static const char *TAG = "CPU_STATS";
+
+typedef struct
+{
+    TaskHandle_t handle;
+    uint32_t execucao;
+} cpu_prev_t;
+
+/* Variáveis privadas (static) */
+
+/* Estáticos: o snapshot não cabe na stack da task de health */
+static TaskStatus_t s_status[CPU_STATS_MAX_TASKS];
+static cpu_prev_t s_prev[CPU_STATS_MAX_TASKS];
+static UBaseType_t s_prev_count = 0;
+static uint32_t s_prev_total = 0;
+static bool s_iniciado = false;
+
+#endif
+
+static cpu_usage_t s_ultimo;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/* Funções auxiliares */
+
+#if CPU_STATS_SUPPORTED
+
+static uint32_t prev_execucao(TaskHandle_t handle)
+{
+    for (UBaseType_t i = 0; i < s_prev_count; i++)
+    {
+        if (s_prev[i].handle == handle)
+        {
+            return s_prev[i].execucao;
+        }
+    }
+    return 0;
+}
+
+/** Insere a task na lista decrescente de maiores usos */
+static void top_insert(cpu_usage_t *u, const char *nome, uint16_t uso)
+{
+    int pos = u->n_tasks;
+    while (pos > 0 && u->tasks[pos - 1].uso_x100 < uso)
+    {
+        pos--;
+    }
+    if (pos >= CPU_STATS_TOP_TASKS)
+    {
+        return;
+    }
+
+    int last = (u->n_tasks < CPU_STATS_TOP_TASKS) ? u->n_tasks : CPU_STATS_TOP_TASKS - 1;
+    memmove(&u->tasks[pos + 1], &u->tasks[pos], (last - pos) * sizeof(u->tasks[0]));
+    strncpy(u->tasks[pos].nome, nome, CPU_STATS_NAME_LEN - 1);
+    u->tasks[pos].nome[CPU_STATS_NAME_LEN - 1] = '\0';
+    u->tasks[pos].uso_x100 = uso;
+    if (u->n_tasks < CPU_STATS_TOP_TASKS)
+    {
+        u->n_tasks++;
+    }
+}
+
+#endif
+
+/* Implementação das funções públicas */
+
+void cpu_stats_sample(void)
+{
+#if CPU_STATS_SUPPORTED
+    configRUN_TIME_COUNTER_TYPE total = 0;
+    UBaseType_t count = uxTaskGetSystemState(s_status, CPU_STATS_MAX_TASKS, &total);
+    if (count == 0)
+    {
+        ESP_LOGW(TAG, "Mais de %d tasks, aumente CPU_STATS_MAX_TASKS", CPU_STATS_MAX_TASKS);
+        return;
+    }
+
+    uint32_t janela = (uint32_t)total - s_prev_total;
+    if (s_iniciado && janela > 0)
+    {
+        cpu_usage_t u;
+        memset(&u, 0, sizeof(u));
+        u.janela_ms = janela / 1000U;
+
+        TaskHandle_t idle[CPU_STATS_MAX_CORES] = {NULL};
+        u.nucleos = (portNUM_PROCESSORS < CPU_STATS_MAX_CORES) ? portNUM_PROCESSORS
+                                                                : CPU_STATS_MAX_CORES;
+        for (int c = 0; c < u.nucleos; c++)
+        {
+            idle[c] = xTaskGetIdleTaskHandleForCore(c);
+        }
+
+        for (UBaseType_t i = 0; i < count; i++)
+        {
+            uint32_t delta = (uint32_t)s_status[i].ulRunTimeCounter -
+                             prev_execucao(s_status[i].xHandle);
+            uint64_t uso = (uint64_t)delta * 10000U / janela;
+            if (uso > 10000U)
+            {
+                uso = 10000U; // Arredondamento entre o contador da task e o total
+            }
+
+            bool ociosa = false;
+            for (int c = 0; c < u.nucleos; c++)
+            {
+                if (s_status[i].xHandle == idle[c])
+                {
+                    u.ocioso_x100[c] = (uint16_t)uso;
+                    ociosa = true;
+                }
+            }
+            if (!ociosa)
+            {
+                top_insert(&u, s_status[i].pcTaskName, (uint16_t)uso);
+            }
+        }
+
+        u.valido = true;
+        portENTER_CRITICAL(&s_lock);
+        s_ultimo = u;
+        portEXIT_CRITICAL(&s_lock);
+    }
+
+    for (UBaseType_t i = 0; i < count; i++)
+    {
+        s_prev[i].handle = s_status[i].xHandle;
+        s_prev[i].execucao = (uint32_t)s_status[i].ulRunTimeCounter;
+    }
+    s_prev_count = count;
+    s_prev_total = (uint32_t)total;
+    s_iniciado = true;
+#endif
+}
+
+void cpu_stats_get(cpu_usage_t *out)
+{
+    portENTER_CRITICAL(&s_lock);
+    *out = s_ultimo;
+    portEXIT_CRITICAL(&s_lock);
+}
@@ -0,0 +1,74 @@
+/**
+ * @file cpu_stats.h
+ * @brief Uso de CPU por task e por núcleo a partir das run-time stats.
+ *
+ * Cada chamada de cpu_stats_sample() lê uxTaskGetSystemState() e calcula,
+ * desde a amostra anterior, a ociosidade de cada núcleo (tempo das tasks
+ * IDLE) e as tasks que mais usaram CPU. O uso de uma task é a fração de
+ * um núcleo: a soma de todas as tasks, ociosas incluídas, é 100% por
+ * núcleo. A task de health amostra a cada HEALTH_CHECK_INTERVAL_MS e o
+ * resultado segue em health_status_t.
+ *
+ * Requer CONFIG_FREERTOS_USE_TRACE_FACILITY e
+ * CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS (contador por esp_timer, em µs);
+ * sem eles o resultado nunca fica válido.
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#ifndef CPU_STATS_H
+#define CPU_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef CPU_STATS_TOP_TASKS
+#define CPU_STATS_TOP_TASKS 6 ///< Tasks (fora as ociosas) reportadas por amostra
+#endif
+
+#ifndef CPU_STATS_MAX_TASKS
+#define CPU_STATS_MAX_TASKS 32 ///< Capacidade do snapshot de uxTaskGetSystemState
+#endif
+
+/** Núcleos reportados (o ESP32 tem no máximo dois) */
+#define CPU_STATS_MAX_CORES 2
+
+/** Comprimento do nome da task (configMAX_TASK_NAME_LEN do sdkconfig) */
+#define CPU_STATS_NAME_LEN 16
+
+/**
+ * @brief Uso de CPU de uma task na janela.
+ */
+typedef struct
+{
+	char nome[CPU_STATS_NAME_LEN]; ///< Nome da task.
+	uint16_t uso_x100;			   ///< Uso de um núcleo (centésimos de %).
+} cpu_task_usage_t;
+
+/**
+ * @brief Resultado da última amostra.
+ */
+typedef struct
+{
+	bool valido;								///< false até a segunda amostra.
+	uint32_t janela_ms;							///< Intervalo entre as amostras.
+	uint8_t nucleos;							///< Núcleos com ociosidade medida.
+	uint8_t n_tasks;							///< Entradas válidas em tasks.
+	uint16_t ocioso_x100[CPU_STATS_MAX_CORES];	///< Ociosidade por núcleo (centésimos de %).
+	cpu_task_usage_t tasks[CPU_STATS_TOP_TASKS]; ///< Maiores usos, em ordem decrescente.
+} cpu_usage_t;
+
+/**
+ * @brief Fecha a janela atual e abre a próxima.
+ *
+ * Chamada por uma única task. A primeira chamada só inicia a medição.
+ */
+void cpu_stats_sample(void);
+
+/**
+ * @brief Copia o resultado da última janela fechada.
+ */
+void cpu_stats_get(cpu_usage_t *out);
+
+#endif /* CPU_STATS_H */
@@ -0,0 +1,526 @@
+/**
+ * @file deferred_log.c
+ * @brief Log diferido - Implementação
+ *
+ * O buffer é a mesma fila da task de atuação: sequência por posição,
+ * compare-exchange no índice de escrita pelos produtores e um único
+ * consumidor (a LogDrain). O produtor reserva a posição e grava o
+ * registro direto nela, percorrendo o formato só para saber o tipo de
+ * cada argumento; a formatação com snprintf fica para a LogDrain (ou
+ * para o host, no modo bruto).
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#include "deferred_log.h"
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "task_profile.h"
+
+/* Definições privadas */
+
+static const char *TAG = "DEFERRED_LOG";
+
+_Static_assert((DEFERRED_LOG_SLOTS & (DEFERRED_LOG_SLOTS - 1)) == 0,
+               "DEFERRED_LOG_SLOTS deve ser potencia de 2");
+_Static_assert(DLOG_ID_COUNT <= UINT16_MAX, "IDs de formato nao cabem no registro");
+
+#define DEFERRED_LOG_LINE_MAX 192 ///< Linha formatada, sem o prefixo do esp_log
+
+typedef struct
+{
+    esp_log_level_t nivel;
+    const char *tag;
+    const char *fmt;
+} formato_t;
+
+static const formato_t s_formatos[DLOG_ID_COUNT] = {
+#define DEFERRED_LOG_TABELA(id, nivel_, tag_, fmt_) [id] = {nivel_, tag_, fmt_},
+    DEFERRED_LOG_FORMATS(DEFERRED_LOG_TABELA)
+#undef DEFERRED_LOG_TABELA
+};
+
+/** Uma conversão do formato, já sem modificadores de tamanho e sem ".*" */
+typedef struct
+{
+    char spec[16]; ///< Conversão para snprintf ("%-14s", "%llu", ...)
+    char conv;     ///< Caractere da conversão
+    uint8_t longo; ///< Quantidade de 'l'
+    bool size_t_;  ///< Modificador 'z'
+    bool prec_arg; ///< Precisão passada como argumento (".*")
+} conversao_t;
+
+typedef struct
+{
+    uint32_t seq;
+    deferred_log_record_t rec;
+} ring_slot_t;
+
+/* Variáveis privadas (static) */
+
+static ring_slot_t s_ring[DEFERRED_LOG_SLOTS];
+static uint32_t s_write_pos = 0; ///< Compartilhado pelos produtores
+static uint32_t s_read_pos = 0;  ///< Exclusivo da LogDrain
+
+static TaskHandle_t s_task = NULL;
+static bool s_ring_ready = false;
+
+static uint32_t s_gravados = 0;
+static uint32_t s_descartados = 0;
+
+/* Funções auxiliares */
+
+/** Lê a conversão que começa em p ('%') e retorna o caractere seguinte */
+static const char *parse_conversao(const char *p, conversao_t *c)
+{
+    size_t n = 0;
+    memset(c, 0, sizeof(*c));
+    c->spec[n++] = *p++;
+
+    while (*p != '\0' && strchr("-+ #0123456789", *p) != NULL && n < sizeof(c->spec) - 4)
+    {
+        c->spec[n++] = *p++;
+    }
+    if (*p == '.')
+    {
+        if (p[1] == '*')
+        {
+            c->prec_arg = true;
+            p += 2;
+        }
+        else
+        {
+            c->spec[n++] = *p++;
+            while (*p >= '0' && *p <= '9' && n < sizeof(c->spec) - 4)
+            {
+                c->spec[n++] = *p++;
+            }
+        }
+    }
+    while (*p == 'h' || *p == 'l' || *p == 'z')
+    {
+        if (*p == 'l')
+        {
+            c->longo++;
+        }
+        else if (*p == 'z')
+        {
+            c->size_t_ = true;
+        }
+        p++;
+    }
+
+    c->conv = *p;
+    if (*p != '\0')
+    {
+        p++;
+    }
+    if (c->longo >= 2)
+    {
+        c->spec[n++] = 'l';
+        c->spec[n++] = 'l';
+    }
+    c->spec[n++] = c->conv;
+    c->spec[n] = '\0';
+    return p;
+}
+
+static bool conv_inteira(char conv)
+{
+    return conv != '\0' && strchr("diuxXoc", conv) != NULL;
+}
+
+static bool conv_real(char conv)
+{
+    return conv != '\0' && strchr("feEgG", conv) != NULL;
+}
+
+static void push_arg(deferred_log_record_t *rec, uint32_t valor)
+{
+    if (rec->n_args < DEFERRED_LOG_MAX_ARGS)
+    {
+        rec->args[rec->n_args] = valor;
+    }
+    rec->n_args++; // Contado mesmo além do limite, para manter 64 bits juntos
+}
+
+static void push_str(deferred_log_record_t *rec, const char *s, size_t max)
+{
+    if (rec->n_str >= DEFERRED_LOG_STR_SIZE)
+    {
+        return;
+    }
+    size_t livre = DEFERRED_LOG_STR_SIZE - rec->n_str - 1;
+    size_t len = 0;
+    if (s != NULL)
+    {
+        while (len < max && len < livre && s[len] != '\0')
+        {
+            len++;
+        }
+        memcpy(&rec->str[rec->n_str], s, len);
+    }
+    rec->str[rec->n_str + len] = '\0';
+    rec->n_str += len + 1;
+}
+
+/** Percorre o formato do registro e copia os argumentos */
+static void pack(deferred_log_record_t *rec, deferred_log_id_t id, va_list ap)
+{
+    conversao_t c;
+    const char *p = s_formatos[id].fmt;
+
+    rec->timestamp_ms = esp_log_timestamp();
+    rec->id = (uint16_t)id;
+    rec->n_args = 0;
+    rec->n_str = 0;
+
+    while (*p != '\0')
+    {
+        if (p[0] != '%')
+        {
+            p++;
+            continue;
+        }
+        if (p[1] == '%')
+        {
+            p += 2;
+            continue;
+        }
+        p = parse_conversao(p, &c);
+
+        int prec = -1;
+        if (c.prec_arg)
+        {
+            prec = va_arg(ap, int);
+        }
+
+        if (conv_inteira(c.conv))
+        {
+            if (c.longo >= 2)
+            {
+                uint64_t v = va_arg(ap, unsigned long long);
+                push_arg(rec, (uint32_t)v);
+                push_arg(rec, (uint32_t)(v >> 32));
+            }
+            else if (c.longo == 1)
+            {
+                push_arg(rec, (uint32_t)va_arg(ap, unsigned long));
+            }
+            else if (c.size_t_)
+            {
+                push_arg(rec, (uint32_t)va_arg(ap, size_t));
+            }
+            else
+            {
+                push_arg(rec, va_arg(ap, unsigned int));
+            }
+        }
+        else if (conv_real(c.conv))
+        {
+            float f = (float)va_arg(ap, double);
+            uint32_t bits;
+            memcpy(&bits, &f, sizeof(bits));
+            push_arg(rec, bits);
+        }
+        else if (c.conv == 's')
+        {
+            push_str(rec, va_arg(ap, const char *), prec >= 0 ? (size_t)prec : SIZE_MAX);
+        }
+    }
+
+    if (rec->n_args > DEFERRED_LOG_MAX_ARGS)
+    {
+        rec->n_args = DEFERRED_LOG_MAX_ARGS;
+    }
+}
+
+/** Avança *pos pelo que snprintf escreveu, sem passar do fim da linha */
+static void advance(size_t size, size_t *pos, int escrito)
+{
+    if (escrito > 0)
+    {
+        *pos += (size_t)escrito;
+        if (*pos >= size)
+        {
+            *pos = size - 1;
+        }
+    }
+}
+
+#if DEFERRED_LOG_RAW
+static void emit(const deferred_log_record_t *rec)
+{
+    static const char hex[] = "0123456789abcdef";
+    char linha[2 * sizeof(deferred_log_record_t) + 1];
+    const uint8_t *b = (const uint8_t *)rec;
+    size_t n = offsetof(deferred_log_record_t, args) + rec->n_args * sizeof(uint32_t);
+    size_t pos = 0;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        linha[pos++] = hex[b[i] >> 4];
+        linha[pos++] = hex[b[i] & 0x0F];
+    }
+    b = (const uint8_t *)rec->str;
+    for (size_t i = 0; i < rec->n_str; i++)
+    {
+        linha[pos++] = hex[b[i] >> 4];
+        linha[pos++] = hex[b[i] & 0x0F];
+    }
+    linha[pos] = '\0';
+    printf("DL %s\n", linha);
+}
+#else
+static void emit(const deferred_log_record_t *rec)
+{
+    char linha[DEFERRED_LOG_LINE_MAX];
+    const formato_t *f = &s_formatos[rec->id];
+
+    deferred_log_format(rec, linha, sizeof(linha));
+    ESP_LOG_LEVEL_LOCAL(f->nivel, f->tag, "[%lu] %s", (unsigned long)rec->timestamp_ms, linha);
+}
+#endif
+
+static void ring_init(void)
+{
+    for (uint32_t i = 0; i < DEFERRED_LOG_SLOTS; i++)
+    {
+        s_ring[i].seq = i;
+    }
+    s_write_pos = 0;
+    s_read_pos = 0;
+    __atomic_store_n(&s_ring_ready, true, __ATOMIC_RELEASE);
+}
+
+static bool ring_pop(deferred_log_record_t *rec)
+{
+    ring_slot_t *slot = &s_ring[s_read_pos & (DEFERRED_LOG_SLOTS - 1)];
+    uint32_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+
+    if ((int32_t)(seq - (s_read_pos + 1)) < 0)
+    {
+        return false; // Vazio ou produtor ainda gravando
+    }
+
+    *rec = slot->rec;
+    __atomic_store_n(&slot->seq, s_read_pos + DEFERRED_LOG_SLOTS, __ATOMIC_RELEASE);
+    s_read_pos++;
+    return true;
+}
+
+/** Reserva uma posição; NULL com o buffer cheio */
+static ring_slot_t *ring_reserve(uint32_t *pos_out)
+{
+    uint32_t pos = __atomic_load_n(&s_write_pos, __ATOMIC_RELAXED);
+
+    while (1)
+    {
+        ring_slot_t *slot = &s_ring[pos & (DEFERRED_LOG_SLOTS - 1)];
+        uint32_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        int32_t diff = (int32_t)(seq - pos);
+
+        if (diff == 0)
+        {
+            if (__atomic_compare_exchange_n(&s_write_pos, &pos, pos + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                *pos_out = pos;
+                return slot;
+            }
+            // pos recarregado pelo compare-exchange
+        }
+        else if (diff < 0)
+        {
+            return NULL;
+        }
+        else
+        {
+            pos = __atomic_load_n(&s_write_pos, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+static void log_drain_task(void *pvParameters)
+{
+    deferred_log_record_t rec;
+    uint32_t descartados_vistos = 0;
+    TickType_t ultimo = xTaskGetTickCount();
+
+    ESP_LOGI(TAG, "LogDrain iniciada (%d registros, %s)", DEFERRED_LOG_SLOTS,
+             DEFERRED_LOG_RAW ? "bruto" : "formatado");
+
+    while (1)
+    {
+        task_profile_delay_until(TASK_ID_LOG_DRAIN, &ultimo, pdMS_TO_TICKS(DEFERRED_LOG_DRAIN_MS));
+
+        while (ring_pop(&rec))
+        {
+            emit(&rec);
+        }
+
+        uint32_t descartados = __atomic_load_n(&s_descartados, __ATOMIC_RELAXED);
+        if (descartados != descartados_vistos)
+        {
+            ESP_LOGW(TAG, "Buffer de log cheio: %lu registros descartados",
+                     (unsigned long)(descartados - descartados_vistos));
+            descartados_vistos = descartados;
+        }
+    }
+}
+
+/* Implementação das funções públicas */
+
+esp_err_t deferred_log_init(void)
+{
+#if !DEFERRED_LOG
+    return ESP_OK; // DLOG escreve na hora
+#endif
+    if (s_task != NULL)
+    {
+        return ESP_OK;
+    }
+
+    if (!__atomic_load_n(&s_ring_ready, __ATOMIC_ACQUIRE))
+    {
+        ring_init();
+    }
+
+    if (task_profile_create(TASK_ID_LOG_DRAIN, log_drain_task, NULL, &s_task) != ESP_OK)
+    {
+        s_task = NULL;
+        __atomic_store_n(&s_ring_ready, false, __ATOMIC_RELEASE);
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+void deferred_log_write(deferred_log_id_t id, ...)
+{
+    va_list ap;
+
+    if ((unsigned)id >= DLOG_ID_COUNT)
+    {
+        return;
+    }
+
+    if (!__atomic_load_n(&s_ring_ready, __ATOMIC_ACQUIRE))
+    {
+        /* Sem LogDrain: formata e escreve na hora */
+        deferred_log_record_t rec;
+        va_start(ap, id);
+        pack(&rec, id, ap);
+        va_end(ap);
+        emit(&rec);
+        return;
+    }
+
+    uint32_t pos;
+    ring_slot_t *slot = ring_reserve(&pos);
+    if (slot == NULL)
+    {
+        __atomic_fetch_add(&s_descartados, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    va_start(ap, id);
+    pack(&slot->rec, id, ap);
+    va_end(ap);
+    __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+    __atomic_fetch_add(&s_gravados, 1, __ATOMIC_RELAXED);
+}
+
+int deferred_log_format(const deferred_log_record_t *rec, char *line, size_t size)
+{
+    conversao_t c;
+    size_t pos = 0;
+    uint8_t arg = 0;
+    uint8_t str = 0;
+
+    if (size == 0)
+    {
+        return 0;
+    }
+    line[0] = '\0';
+    if (rec->id >= DLOG_ID_COUNT)
+    {
+        return 0;
+    }
+
+    const char *p = s_formatos[rec->id].fmt;
+    while (*p != '\0' && pos < size - 1)
+    {
+        if (p[0] != '%' || p[1] == '%')
+        {
+            line[pos++] = *p;
+            p += (p[0] == '%') ? 2 : 1;
+            line[pos] = '\0';
+            continue;
+        }
+        p = parse_conversao(p, &c);
+
+        int escrito = 0;
+        if (conv_inteira(c.conv))
+        {
+            uint32_t lo = (arg < rec->n_args) ? rec->args[arg] : 0;
+            arg++;
+            if (c.longo >= 2)
+            {
+                uint32_t hi = (arg < rec->n_args) ? rec->args[arg] : 0;
+                arg++;
+                uint64_t v = ((uint64_t)hi << 32) | lo;
+                if (c.conv == 'd' || c.conv == 'i')
+                {
+                    escrito = snprintf(&line[pos], size - pos, c.spec, (long long)(int64_t)v);
+                }
+                else
+                {
+                    escrito = snprintf(&line[pos], size - pos, c.spec, (unsigned long long)v);
+                }
+            }
+            else if (c.conv == 'd' || c.conv == 'i')
+            {
+                escrito = snprintf(&line[pos], size - pos, c.spec, (int)(int32_t)lo);
+            }
+            else if (c.conv == 'c')
+            {
+                escrito = snprintf(&line[pos], size - pos, c.spec, (int)lo);
+            }
+            else
+            {
+                escrito = snprintf(&line[pos], size - pos, c.spec, (unsigned int)lo);
+            }
+        }
+        else if (conv_real(c.conv))
+        {
+            float f = 0.0f;
+            if (arg < rec->n_args)
+            {
+                memcpy(&f, &rec->args[arg], sizeof(f));
+            }
+            arg++;
+            escrito = snprintf(&line[pos], size - pos, c.spec, (double)f);
+        }
+        else if (c.conv == 's')
+        {
+            const char *s = (str < rec->n_str) ? &rec->str[str] : "";
+            str += (uint8_t)(strnlen(s, rec->n_str - str) + 1);
+            escrito = snprintf(&line[pos], size - pos, c.spec, s);
+        }
+        advance(size, &pos, escrito);
+    }
+
+    return (int)pos;
+}
+
+void deferred_log_get_stats(deferred_log_stats_t *out)
+{
+    out->gravados = __atomic_load_n(&s_gravados, __ATOMIC_RELAXED);
+    out->descartados = __atomic_load_n(&s_descartados, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,138 @@
+/**
+ * @file deferred_log.h
+ * @brief Log diferido: ID de formato e argumentos brutos em um buffer sem lock.
+ *
+ * ESP_LOGx formata e escreve na UART (115200 baud) dentro de quem chama:
+ * uma linha custa milissegundos. DLOG(id, ...) só grava o ID do formato
+ * (deferred_log_fmt.h), o instante e os argumentos em um registro de
+ * tamanho fixo, com as strings copiadas, e retorna em microssegundos.
+ * A task LogDrain, de prioridade baixa, esvazia o buffer a cada
+ * DEFERRED_LOG_DRAIN_MS:
+ *
+ * - DEFERRED_LOG_RAW = 0: formata cada registro e o escreve pelo esp_log,
+ *   com o instante original entre colchetes.
+ * - DEFERRED_LOG_RAW = 1: escreve o registro em hexadecimal ("DL ...");
+ *   tools/deferred_log.py formata as linhas no host a partir da tabela.
+ *
+ * Buffer cheio descarta o registro (contado e avisado pela LogDrain). O
+ * nível do formato é filtrado em tempo de compilação (LOG_LOCAL_LEVEL);
+ * o filtro por tag em tempo de execução só vale no modo formatado. Antes
+ * de deferred_log_init(), ou com DEFERRED_LOG = 0, DLOG formata e escreve
+ * na hora, como ESP_LOGx. Não chamar de ISR.
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#ifndef DEFERRED_LOG_H
+#define DEFERRED_LOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_log.h"
+#include "deferred_log_fmt.h"
+
+#ifndef DEFERRED_LOG
+#define DEFERRED_LOG 1 ///< 0 = DLOG escreve na hora, como ESP_LOGx
+#endif
+
+#ifndef DEFERRED_LOG_RAW
+#define DEFERRED_LOG_RAW 0 ///< 1 = LogDrain escreve registros em hex para tools/deferred_log.py
+#endif
+
+#ifndef DEFERRED_LOG_SLOTS
+#define DEFERRED_LOG_SLOTS 64 ///< Registros no buffer (potência de 2)
+#endif
+
+#ifndef DEFERRED_LOG_DRAIN_MS
+#define DEFERRED_LOG_DRAIN_MS 50 ///< Período da LogDrain
+#endif
+
+/** Palavras de 32 bits de argumentos por registro (ll e double ocupam 2 e 1) */
+#define DEFERRED_LOG_MAX_ARGS 6
+
+/** Bytes para as strings de um registro, terminadores incluídos */
+#define DEFERRED_LOG_STR_SIZE 32
+
+/**
+ * @brief IDs dos formatos (posição em DEFERRED_LOG_FORMATS).
+ */
+typedef enum
+{
+#define DEFERRED_LOG_ID(id, nivel, tag, fmt) id,
+	DEFERRED_LOG_FORMATS(DEFERRED_LOG_ID)
+#undef DEFERRED_LOG_ID
+	DLOG_ID_COUNT
+} deferred_log_id_t;
+
+/** Nível de cada formato, para o filtro em tempo de compilação de DLOG */
+enum
+{
+#define DEFERRED_LOG_NIVEL(id, nivel, tag, fmt) id##_NIVEL = nivel,
+	DEFERRED_LOG_FORMATS(DEFERRED_LOG_NIVEL)
+#undef DEFERRED_LOG_NIVEL
+};
+
+/**
+ * @brief Registro gravado no buffer (e, em hex, no modo bruto).
+ */
+typedef struct
+{
+	uint32_t timestamp_ms;				 ///< esp_log_timestamp() na gravação.
+	uint16_t id;						 ///< deferred_log_id_t.
+	uint8_t n_args;						 ///< Palavras válidas em args.
+	uint8_t n_str;						 ///< Bytes válidos em str.
+	uint32_t args[DEFERRED_LOG_MAX_ARGS]; ///< Argumentos na ordem do formato.
+	char str[DEFERRED_LOG_STR_SIZE];	 ///< Strings copiadas, separadas por '\0'.
+} deferred_log_record_t;
+
+/** Memória do buffer (registros e números de sequência) */
+#define DEFERRED_LOG_BYTES (DEFERRED_LOG_SLOTS * (sizeof(deferred_log_record_t) + sizeof(uint32_t)))
+
+/**
+ * @brief Contadores do buffer.
+ */
+typedef struct
+{
+	uint32_t gravados;	 ///< Registros aceitos.
+	uint32_t descartados; ///< Registros perdidos com o buffer cheio.
+} deferred_log_stats_t;
+
+/**
+ * @brief Grava um registro do formato id (nível filtrado em compilação).
+ */
+#define DLOG(id, ...)                                       \
+    do                                                      \
+    {                                                       \
+        if ((int)LOG_LOCAL_LEVEL >= (int)id##_NIVEL)        \
+        {                                                   \
+            deferred_log_write(id, ##__VA_ARGS__);          \
+        }                                                   \
+    } while (0)
+
+/**
+ * @brief Inicia o buffer e cria a task LogDrain.
+ */
+esp_err_t deferred_log_init(void);
+
+/**
+ * @brief Grava um registro; prefira a macro DLOG.
+ *
+ * Os argumentos seguem as conversões do formato id.
+ */
+void deferred_log_write(deferred_log_id_t id, ...);
+
+/**
+ * @brief Formata um registro (o mesmo texto de ESP_LOGx, sem prefixo).
+ *
+ * @return Comprimento escrito em line (truncado em size - 1).
+ */
+int deferred_log_format(const deferred_log_record_t *rec, char *line, size_t size);
+
+/**
+ * @brief Copia os contadores do buffer.
+ */
+void deferred_log_get_stats(deferred_log_stats_t *out);
+
+#endif /* DEFERRED_LOG_H */
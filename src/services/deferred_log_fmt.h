@@ -0,0 +1,82 @@
+/**
+ * @file deferred_log_fmt.h
+ * @brief Tabela de formatos do log diferido.
+ *
+ * Cada entrada é X(id, nível, tag, formato). A posição na tabela é o ID
+ * gravado no buffer e lido por tools/deferred_log.py, que interpreta este
+ * arquivo: acrescente entradas só no fim e não reordene as existentes.
+ *
+ * Conversões aceitas: d i u x X o c (com h, l, ll ou z), f e g (gravadas
+ * como float), s e .*s (copiadas, truncadas em DEFERRED_LOG_STR_SIZE no
+ * total) e %%. Largura e flags são repassadas ao formatador; largura com
+ * '*' não é suportada.
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#ifndef DEFERRED_LOG_FMT_H
+#define DEFERRED_LOG_FMT_H
+
+#define DEFERRED_LOG_FORMATS(X)                                                                                   \
+    /* SystemMonitor */                                                                                           \
+    X(DLOG_MON_VAZIA, ESP_LOG_INFO, "MONITOR_TASK", "")                                                           \
+    X(DLOG_MON_BORDA, ESP_LOG_INFO, "MONITOR_TASK", "════════════════════════════════════════")                   \
+    X(DLOG_MON_TITULO, ESP_LOG_INFO, "MONITOR_TASK", "  Status do Sistema (Loop #%lu)")                          \
+    X(DLOG_MON_MQTT_OK, ESP_LOG_INFO, "MONITOR_TASK", "MQTT: Conectado e operacional")                           \
+    X(DLOG_MON_PUBLICADAS, ESP_LOG_INFO, "MONITOR_TASK", "Mensagens publicadas: %lu")                            \
+    X(DLOG_MON_RECEBIDAS, ESP_LOG_INFO, "MONITOR_TASK", "Mensagens recebidas: %lu")                              \
+    X(DLOG_MON_FALHAS, ESP_LOG_INFO, "MONITOR_TASK", "Falhas de publicacao: %lu")                                \
+    X(DLOG_MON_DESCONEXOES, ESP_LOG_INFO, "MONITOR_TASK", "Desconexoes: %lu")                                    \
+    X(DLOG_MON_LOCAIS, ESP_LOG_INFO, "MONITOR_TASK", "Entregas locais: %lu (ecos suprimidos: %lu)")              \
+    X(DLOG_MON_SUBS, ESP_LOG_INFO, "MONITOR_TASK",                                                               \
+      "Subscricoes: %lu/%lu confirmadas, %lu rejeitadas (%lu SUBSCRIBE, %lu topicos)")                            \
+    X(DLOG_MON_HEAP_LIVRE, ESP_LOG_INFO, "MONITOR_TASK", "Heap livre: %lu bytes")                                \
+    X(DLOG_MON_RSSI, ESP_LOG_INFO, "MONITOR_TASK", "WiFi RSSI: %d dBm")                                          \
+    X(DLOG_MON_UPTIME, ESP_LOG_INFO, "MONITOR_TASK", "Uptime: %llu segundos")                                    \
+    X(DLOG_MON_ALERTA_HEAP, ESP_LOG_WARN, "MONITOR_TASK", "Alerta: Memoria heap abaixo de 30KB!")                \
+    X(DLOG_MON_ALERTA_RSSI, ESP_LOG_WARN, "MONITOR_TASK", "Alerta: Sinal WiFi fraco!")                           \
+    X(DLOG_MON_DESCONECTADO, ESP_LOG_WARN, "MONITOR_TASK", "MQTT: Desconectado (%s)")                            \
+    X(DLOG_MON_RECONECTANDO, ESP_LOG_INFO, "MONITOR_TASK", "Sistema tentando reconectar automaticamente...")     \
+    X(DLOG_MON_ESCALONAMENTO, ESP_LOG_INFO, "MONITOR_TASK", "Escalonamento (perfil %s):")                        \
+    X(DLOG_MON_JITTER, ESP_LOG_INFO, "MONITOR_TASK",                                                             \
+      "   %-14s nucleo %s P%u: jitter p50=%lu p99=%lu max=%lu us (%lu)")                                          \
+    X(DLOG_MON_CPU, ESP_LOG_INFO, "MONITOR_TASK", "CPU%d: %lu.%02lu%% ocupada (janela %lu ms)")                  \
+    X(DLOG_MON_CPU_TASK, ESP_LOG_INFO, "MONITOR_TASK", "   %-14s %u.%02u%%")                                     \
+    X(DLOG_MON_HEAP, ESP_LOG_INFO, "MONITOR_TASK", "Heap: maior bloco %lu bytes, fragmentacao %u.%02u%%")        \
+    X(DLOG_MON_HEAP_REGIAO, ESP_LOG_INFO, "MONITOR_TASK", "   %-8s livre %lu, maior bloco %lu, minimo %lu")      \
+    X(DLOG_MON_ALERTA_BLOCO, ESP_LOG_WARN, "MONITOR_TASK",                                                       \
+      "Alerta: maior bloco livre menor que uma mensagem MQTT (%d bytes)!")                                        \
+    X(DLOG_MON_HEAP_TAXAS, ESP_LOG_INFO, "MONITOR_TASK",                                                         \
+      "   %lu malloc/s, %lu free/s, %lu bytes/s (janela %lu ms)")                                                 \
+    X(DLOG_MON_CAPTURA, ESP_LOG_INFO, "MONITOR_TASK", "Captura do heap (%lu ms):")                               \
+    X(DLOG_MON_CAPTURA_TASK, ESP_LOG_INFO, "MONITOR_TASK", "   %-14s %lu alocacoes, %lu bytes")                  \
+    X(DLOG_MON_REGIME_AVISO, ESP_LOG_WARN, "MONITOR_TASK",                                                       \
+      "Heap em regime: %lu alocacoes no intervalo (esperado 0)")                                                  \
+    X(DLOG_MON_REGIME_TASK, ESP_LOG_WARN, "MONITOR_TASK", "   %-14s %lu desde o init")                           \
+    X(DLOG_MON_REGIME, ESP_LOG_INFO, "MONITOR_TASK",                                                             \
+      "Heap em regime: %lu alocacoes no intervalo (%lu desde o init)")                                            \
+    X(DLOG_MON_OUTBOX, ESP_LOG_INFO, "MONITOR_TASK", "Outbox estatico: %lu/%d slots (pico %lu, %lu recusadas)")  \
+    /* mqtt_event_handler e handlers de mensagens */                                                              \
+    X(DLOG_MQTT_CONECTADO, ESP_LOG_INFO, "MQTT_SYSTEM", "MQTT conectado ao broker! (sessao %s)")                 \
+    X(DLOG_MQTT_DESCONECTADO, ESP_LOG_WARN, "MQTT_SYSTEM", "MQTT desconectado")                                  \
+    X(DLOG_MQTT_MENSAGEM, ESP_LOG_INFO, "MQTT_SYSTEM", "Mensagem MQTT em '%.*s': %.*s")                          \
+    X(DLOG_MQTT_FRAGMENTADA, ESP_LOG_WARN, "MQTT_SYSTEM", "Mensagem fragmentada ignorada (%d bytes)")            \
+    X(DLOG_MQTT_SEM_HANDLER, ESP_LOG_DEBUG, "MQTT_SYSTEM", "Nenhum handler para o topico")                       \
+    X(DLOG_MQTT_SUBACK_RECUSA, ESP_LOG_WARN, "MQTT_SYSTEM", "Broker recusou subscricao (msg_id=%d)")             \
+    X(DLOG_MQTT_ERRO, ESP_LOG_ERROR, "MQTT_SYSTEM", "Erro MQTT")                                                 \
+    X(DLOG_MQTT_EVENTO, ESP_LOG_DEBUG, "MQTT_SYSTEM", "Evento MQTT: %d")                                         \
+    X(DLOG_MQTT_LUM_INVALIDA, ESP_LOG_WARN, "MQTT_SYSTEM", "Luminosidade invalida: %.*s")                        \
+    X(DLOG_MQTT_LUMINOSIDADE, ESP_LOG_DEBUG, "MQTT_SYSTEM", "Luminosidade: %ld")                                 \
+    X(DLOG_MQTT_TEMP_INVALIDA, ESP_LOG_WARN, "MQTT_SYSTEM", "Temperatura invalida: %.*s")                        \
+    X(DLOG_MQTT_TEMPERATURA, ESP_LOG_DEBUG, "MQTT_SYSTEM", "Temperatura: %ld")                                   \
+    /* Amostragem (sampler.h) */                                                                                 \
+    X(DLOG_SENSORES_SIMULADOS, ESP_LOG_INFO, "SENSOR_SIMULATE",                                                  \
+      "Sensores simulados: Luminosidade=%d%s, Temperatura=%d°C%s")                                               \
+    X(DLOG_MON_AMOSTRAGEM, ESP_LOG_INFO, "MONITOR_TASK", "Amostragem (esp_timer):")                              \
+    X(DLOG_MON_AMOSTRA_JITTER, ESP_LOG_INFO, "MONITOR_TASK",                                                     \
+      "   %-14s periodo %lu us: jitter p50=%lu p99=%lu max=%lu us (%lu)")                                        \
+    X(DLOG_MON_AMOSTRA_ATRASOS, ESP_LOG_INFO, "MONITOR_TASK",                                                    \
+      "   %-14s execucao max %lu us: %lu atrasos, %lu disparos perdidos")
+
+#endif /* DEFERRED_LOG_FMT_H */
@@ -0,0 +1,288 @@
+/**
+ * @file heap_stats.c
+ * @brief Fragmentação do heap, taxas de alocação e janela de captura - Implementação
+ *
+ * Os hooks rodam dentro do alocador (IRAM, sem locks): só incrementam
+ * contadores atômicos acumulados desde o boot. As janelas (taxas e
+ * captura) são diferenças entre cópias desses contadores.
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#include "heap_stats.h"
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+#if CONFIG_HEAP_TRACING_STANDALONE
+#include "esp_heap_trace.h"
+#endif
+
+/* Definições privadas */
+
+#if CONFIG_HEAP_USE_HOOKS
+static const char *TAG = "HEAP_STATS";
+#endif
+
+static const uint32_t s_caps[HEAP_REGIAO_COUNT] = {
+    [HEAP_REGIAO_INTERNA] = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT,
+    [HEAP_REGIAO_DMA] = MALLOC_CAP_DMA,
+    [HEAP_REGIAO_PSRAM] = MALLOC_CAP_SPIRAM,
+};
+
+static const char *const s_region_names[HEAP_REGIAO_COUNT] = {
+    [HEAP_REGIAO_INTERNA] = "internal",
+    [HEAP_REGIAO_DMA] = "dma",
+    [HEAP_REGIAO_PSRAM] = "psram",
+};
+
+/* Variáveis privadas (static) */
+
+#if CONFIG_HEAP_USE_HOOKS
+
+/* Acumulados desde o boot, escritos pelos hooks */
+static uint32_t s_allocs;
+static uint32_t s_frees;
+static uint32_t s_bytes;
+static uint32_t s_task_allocs[HEAP_TRACE_SLOTS];
+static uint32_t s_task_bytes[HEAP_TRACE_SLOTS];
+
+/* Janela de taxas (só a task de health) */
+static uint32_t s_prev_allocs;
+static uint32_t s_prev_frees;
+static uint32_t s_prev_bytes;
+static int64_t s_prev_us;
+static bool s_iniciado = false;
+
+/* Janela de captura (s_lock) */
+static bool s_trace_aberta = false;
+static int64_t s_trace_inicio_us;
+static uint32_t s_trace_duracao_ms;
+static uint32_t s_trace_base_allocs[HEAP_TRACE_SLOTS];
+static uint32_t s_trace_base_bytes[HEAP_TRACE_SLOTS];
+
+#if CONFIG_HEAP_TRACING_STANDALONE
+static heap_trace_record_t s_trace_records[HEAP_STATS_TRACE_RECORDS];
+static bool s_trace_records_prontos = false;
+#endif
+
+#endif
+
+static heap_usage_t s_ultimo;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/* Hooks do heap (CONFIG_HEAP_USE_HOOKS) */
+
+#if CONFIG_HEAP_USE_HOOKS
+IRAM_ATTR void esp_heap_trace_alloc_hook(void *ptr, size_t size, uint32_t caps)
+{
+    __atomic_add_fetch(&s_allocs, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&s_bytes, size, __ATOMIC_RELAXED);
+
+    int slot = HEAP_TRACE_OTHER;
+    if (!xPortInIsrContext())
+    {
+        slot = task_profile_current(); // TASK_ID_COUNT == HEAP_TRACE_OTHER
+    }
+    __atomic_add_fetch(&s_task_allocs[slot], 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&s_task_bytes[slot], size, __ATOMIC_RELAXED);
+}
+
+IRAM_ATTR void esp_heap_trace_free_hook(void *ptr)
+{
+    __atomic_add_fetch(&s_frees, 1, __ATOMIC_RELAXED);
+}
+#endif
+
+/* Funções auxiliares */
+
+#if CONFIG_HEAP_USE_HOOKS
+
+static void load_task_counters(uint32_t *allocs, uint32_t *bytes)
+{
+    for (int i = 0; i < HEAP_TRACE_SLOTS; i++)
+    {
+        allocs[i] = __atomic_load_n(&s_task_allocs[i], __ATOMIC_RELAXED);
+        bytes[i] = __atomic_load_n(&s_task_bytes[i], __ATOMIC_RELAXED);
+    }
+}
+
+/** Fecha a captura se a duração venceu; chamada pela task de health */
+static void trace_check_end(int64_t agora_us)
+{
+    heap_trace_result_t r;
+    uint32_t allocs[HEAP_TRACE_SLOTS];
+    uint32_t bytes[HEAP_TRACE_SLOTS];
+    load_task_counters(allocs, bytes);
+
+    portENTER_CRITICAL(&s_lock);
+    bool vencida = s_trace_aberta &&
+                   agora_us - s_trace_inicio_us >= (int64_t)s_trace_duracao_ms * 1000;
+    if (vencida)
+    {
+        r.valido = true;
+        r.janela_ms = (uint32_t)((agora_us - s_trace_inicio_us) / 1000);
+        for (int i = 0; i < HEAP_TRACE_SLOTS; i++)
+        {
+            r.allocs[i] = allocs[i] - s_trace_base_allocs[i];
+            r.bytes[i] = bytes[i] - s_trace_base_bytes[i];
+        }
+        s_ultimo.trace = r;
+        s_trace_aberta = false;
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    if (!vencida)
+    {
+        return;
+    }
+
+    ESP_LOGI(TAG, "Captura do heap encerrada (%lu ms)", r.janela_ms);
+#if CONFIG_HEAP_TRACING_STANDALONE
+    if (s_trace_records_prontos)
+    {
+        heap_trace_stop();
+        heap_trace_dump();
+    }
+#endif
+}
+
+#endif
+
+/* Implementação das funções públicas */
+
+void heap_stats_sample(void)
+{
+#if CONFIG_HEAP_USE_HOOKS
+    int64_t agora_us = esp_timer_get_time();
+    uint32_t allocs = __atomic_load_n(&s_allocs, __ATOMIC_RELAXED);
+    uint32_t frees = __atomic_load_n(&s_frees, __ATOMIC_RELAXED);
+    uint32_t bytes = __atomic_load_n(&s_bytes, __ATOMIC_RELAXED);
+
+    if (s_iniciado)
+    {
+        portENTER_CRITICAL(&s_lock);
+        s_ultimo.taxas_validas = true;
+        s_ultimo.janela_ms = (uint32_t)((agora_us - s_prev_us) / 1000);
+        s_ultimo.allocs = allocs - s_prev_allocs;
+        s_ultimo.frees = frees - s_prev_frees;
+        s_ultimo.bytes_alocados = bytes - s_prev_bytes;
+        portEXIT_CRITICAL(&s_lock);
+    }
+
+    s_prev_allocs = allocs;
+    s_prev_frees = frees;
+    s_prev_bytes = bytes;
+    s_prev_us = agora_us;
+    s_iniciado = true;
+
+    trace_check_end(agora_us);
+#endif
+}
+
+void heap_stats_get(heap_usage_t *out)
+{
+    portENTER_CRITICAL(&s_lock);
+    *out = s_ultimo;
+    portEXIT_CRITICAL(&s_lock);
+
+    /* heap_caps_get_info percorre o heap com o lock dele: fora da seção crítica */
+    multi_heap_info_t info;
+    for (int r = 0; r < HEAP_REGIAO_COUNT; r++)
+    {
+        heap_region_info_t *regiao = &out->regioes[r];
+        regiao->presente = heap_caps_get_total_size(s_caps[r]) > 0;
+        if (!regiao->presente)
+        {
+            continue;
+        }
+        heap_caps_get_info(&info, s_caps[r]);
+        regiao->livre = info.total_free_bytes;
+        regiao->maior_bloco = info.largest_free_block;
+        regiao->minimo = info.minimum_free_bytes;
+    }
+
+    heap_caps_get_info(&info, MALLOC_CAP_8BIT);
+    out->maior_bloco = info.largest_free_block;
+    out->frag_x100 = 0;
+    if (info.total_free_bytes > 0)
+    {
+        out->frag_x100 = (uint16_t)(10000U - (uint64_t)info.largest_free_block * 10000U /
+                                                 info.total_free_bytes);
+    }
+}
+
+esp_err_t heap_stats_trace_start(uint32_t duracao_ms)
+{
+#if CONFIG_HEAP_USE_HOOKS
+    if (duracao_ms == 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint32_t allocs[HEAP_TRACE_SLOTS];
+    uint32_t bytes[HEAP_TRACE_SLOTS];
+    load_task_counters(allocs, bytes);
+
+    portENTER_CRITICAL(&s_lock);
+    bool aberta = s_trace_aberta;
+    if (!aberta)
+    {
+        memcpy(s_trace_base_allocs, allocs, sizeof(allocs));
+        memcpy(s_trace_base_bytes, bytes, sizeof(bytes));
+        s_trace_inicio_us = esp_timer_get_time();
+        s_trace_duracao_ms = duracao_ms;
+        s_trace_aberta = true;
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    if (aberta)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+#if CONFIG_HEAP_TRACING_STANDALONE
+    if (!s_trace_records_prontos)
+    {
+        s_trace_records_prontos = heap_trace_init_standalone(s_trace_records,
+                                                             HEAP_STATS_TRACE_RECORDS) == ESP_OK;
+    }
+    if (s_trace_records_prontos)
+    {
+        heap_trace_start(HEAP_TRACE_LEAKS);
+    }
+#endif
+
+    ESP_LOGI(TAG, "Captura do heap iniciada (%lu ms)", duracao_ms);
+    return ESP_OK;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+void heap_stats_get_task_allocs(uint32_t por_task[TASK_ID_COUNT])
+{
+    for (int id = 0; id < TASK_ID_COUNT; id++)
+    {
+#if CONFIG_HEAP_USE_HOOKS
+        por_task[id] = __atomic_load_n(&s_task_allocs[id], __ATOMIC_RELAXED);
+#else
+        por_task[id] = 0;
+#endif
+    }
+}
+
+const char *heap_stats_region_name(heap_regiao_t regiao)
+{
+    return s_region_names[regiao];
+}
+
+const char *heap_stats_trace_name(int slot)
+{
+    return (slot == HEAP_TRACE_OTHER) ? "other" : task_profile_get(slot)->nome;
+}
@@ -0,0 +1,136 @@
+/**
+ * @file heap_stats.h
+ * @brief Fragmentação do heap, taxas de alocação e janela de captura.
+ *
+ * Heap livre sozinho não mostra fragmentação: uma mensagem do outbox do
+ * esp-mqtt precisa de um bloco contíguo. Por isso o health traz:
+ * - o maior bloco livre (MALLOC_CAP_8BIT) e a fragmentação, 1 - maior
+ *   bloco / livre, em centésimos de %;
+ * - livre, maior bloco e mínimo histórico por capacidade (interna, DMA,
+ *   PSRAM), lidos de heap_caps_get_info() a cada consulta.
+ *
+ * Com CONFIG_HEAP_USE_HOOKS, os hooks de alocação contam malloc, free e
+ * bytes alocados; cada heap_stats_sample() (task de health, a cada
+ * HEALTH_CHECK_INTERVAL_MS) fecha uma janela com esses totais. Os mesmos
+ * hooks atribuem cada alocação à task do perfil que a fez (ou a "other":
+ * tasks do ESP-IDF, esp-mqtt e ISRs). heap_stats_trace_start() abre uma
+ * janela de captura: ao fim, as alocações por task dentro dela seguem no
+ * health até a próxima captura. Com CONFIG_HEAP_TRACING_STANDALONE a
+ * janela também liga o heap trace do ESP-IDF (modo leaks) e imprime os
+ * blocos ainda alocados, com o chamador, ao fechar.
+ *
+ * A janela de captura fecha na primeira amostra após a duração pedida;
+ * a duração real segue no resultado.
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#ifndef HEAP_STATS_H
+#define HEAP_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "task_profile.h"
+
+#ifndef HEAP_STATS_TRACE_MS
+#define HEAP_STATS_TRACE_MS 0 ///< Janela de captura aberta no fim do init (ms, 0 = desligada)
+#endif
+
+#ifndef HEAP_STATS_TRACE_RECORDS
+#define HEAP_STATS_TRACE_RECORDS 64 ///< Registros do heap trace do ESP-IDF (CONFIG_HEAP_TRACING_STANDALONE)
+#endif
+
+/** Posição das alocações fora das tasks do perfil na janela de captura */
+#define HEAP_TRACE_OTHER TASK_ID_COUNT
+
+/** Posições da janela de captura: tasks do perfil e HEAP_TRACE_OTHER */
+#define HEAP_TRACE_SLOTS (TASK_ID_COUNT + 1)
+
+/**
+ * @brief Regiões do heap por capacidade.
+ */
+typedef enum
+{
+	HEAP_REGIAO_INTERNA = 0, ///< MALLOC_CAP_INTERNAL.
+	HEAP_REGIAO_DMA,		 ///< MALLOC_CAP_DMA.
+	HEAP_REGIAO_PSRAM,		 ///< MALLOC_CAP_SPIRAM.
+	HEAP_REGIAO_COUNT
+} heap_regiao_t;
+
+/**
+ * @brief Ocupação de uma região.
+ */
+typedef struct
+{
+	bool presente;		  ///< false se o chip não tem a região.
+	uint32_t livre;		  ///< Bytes livres.
+	uint32_t maior_bloco; ///< Maior bloco livre contíguo.
+	uint32_t minimo;	  ///< Menor livre desde o boot.
+} heap_region_info_t;
+
+/**
+ * @brief Alocações por task na última janela de captura.
+ */
+typedef struct
+{
+	bool valido;					   ///< false até a primeira captura fechar.
+	uint32_t janela_ms;				   ///< Duração real da captura.
+	uint32_t allocs[HEAP_TRACE_SLOTS]; ///< Alocações por task (HEAP_TRACE_OTHER = demais).
+	uint32_t bytes[HEAP_TRACE_SLOTS];  ///< Bytes alocados por task.
+} heap_trace_result_t;
+
+/**
+ * @brief Estado do heap para o health.
+ */
+typedef struct
+{
+	uint32_t maior_bloco;						   ///< Maior bloco livre (MALLOC_CAP_8BIT).
+	uint16_t frag_x100;							   ///< Fragmentação (centésimos de %).
+	heap_region_info_t regioes[HEAP_REGIAO_COUNT]; ///< Por capacidade.
+	bool taxas_validas;							   ///< Hooks ativos e uma janela fechada.
+	uint32_t janela_ms;							   ///< Intervalo entre as amostras.
+	uint32_t allocs;							   ///< malloc na janela.
+	uint32_t frees;								   ///< free na janela.
+	uint32_t bytes_alocados;					   ///< Bytes pedidos na janela.
+	heap_trace_result_t trace;					   ///< Última janela de captura.
+} heap_usage_t;
+
+/**
+ * @brief Fecha a janela de taxas (e a de captura, se venceu) e abre a próxima.
+ *
+ * Chamada por uma única task. A primeira chamada só inicia a medição.
+ */
+void heap_stats_sample(void);
+
+/**
+ * @brief Lê as regiões agora e copia as taxas da última janela fechada.
+ */
+void heap_stats_get(heap_usage_t *out);
+
+/**
+ * @brief Abre uma janela de captura das alocações por task.
+ *
+ * @param duracao_ms Duração mínima da janela.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG (duração 0), ESP_ERR_INVALID_STATE
+ *         (captura em andamento) ou ESP_ERR_NOT_SUPPORTED (sem hooks).
+ */
+esp_err_t heap_stats_trace_start(uint32_t duracao_ms);
+
+/**
+ * @brief Alocações de cada task do perfil desde o boot (zeros sem hooks).
+ */
+void heap_stats_get_task_allocs(uint32_t por_task[TASK_ID_COUNT]);
+
+/**
+ * @brief Nome de uma região ("internal", "dma", "psram").
+ */
+const char *heap_stats_region_name(heap_regiao_t regiao);
+
+/**
+ * @brief Nome de uma posição da janela de captura (task ou "other").
+ */
+const char *heap_stats_trace_name(int slot);
+
+#endif /* HEAP_STATS_H */
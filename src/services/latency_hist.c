@@ -0,0 +1,131 @@
+/**
+ * @file latency_hist.c
+ * @brief Histograma logarítmico de latências - Implementação
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#include "latency_hist.h"
+
+/* Funções auxiliares */
+
+/**
+ * @brief Bucket de uma latência: valores 0..3 são exatos, acima disso
+ *        cada oitava é dividida em 4 pelos dois bits após o mais alto.
+ */
+static uint32_t bucket_of(uint32_t us)
+{
+    if (us < 4)
+    {
+        return us;
+    }
+
+    uint32_t msb = 31 - (uint32_t)__builtin_clz(us);
+    uint32_t index = (msb - 1) * 4 + ((us >> (msb - 2)) & 3);
+    return index < LATENCY_HIST_BUCKETS ? index : LATENCY_HIST_BUCKETS - 1;
+}
+
+/** Limite inferior (µs) do bucket; a largura é 1 << (oitava - 2) */
+static uint32_t bucket_floor(uint32_t index, uint32_t *width)
+{
+    if (index < 4)
+    {
+        *width = 1;
+        return index;
+    }
+
+    uint32_t msb = index / 4 + 1;
+    *width = 1U << (msb - 2);
+    return (4 + index % 4) << (msb - 2);
+}
+
+/**
+ * @brief Percentis 50/95/99 em uma única passada, com interpolação
+ *        linear dentro do bucket.
+ */
+static void percentiles(const uint32_t *buckets, uint32_t total, uint32_t out[3])
+{
+    static const uint32_t per_mille[3] = {500, 950, 990};
+    uint32_t seen = 0;
+    int next = 0;
+
+    for (uint32_t i = 0; i < LATENCY_HIST_BUCKETS && next < 3; i++)
+    {
+        if (buckets[i] == 0)
+        {
+            continue;
+        }
+
+        uint32_t width;
+        uint32_t floor = bucket_floor(i, &width);
+        while (next < 3)
+        {
+            uint32_t target = (uint32_t)(((uint64_t)total * per_mille[next] + 999) / 1000);
+            if (seen + buckets[i] < target)
+            {
+                break;
+            }
+            out[next++] = floor + (uint32_t)((uint64_t)width * (target - seen) / buckets[i]);
+        }
+        seen += buckets[i];
+    }
+}
+
+/* Implementação das funções públicas */
+
+void latency_hist_record(latency_hist_t *hist, uint32_t latency_us)
+{
+    __atomic_fetch_add(&hist->buckets[bucket_of(latency_us)], 1, __ATOMIC_RELAXED);
+    if (latency_us > __atomic_load_n(&hist->max_us, __ATOMIC_RELAXED))
+    {
+        __atomic_store_n(&hist->max_us, latency_us, __ATOMIC_RELAXED);
+    }
+}
+
+void latency_hist_summary(const latency_hist_t *hist, latency_summary_t *out)
+{
+    uint32_t buckets[LATENCY_HIST_BUCKETS];
+    uint32_t total = 0;
+
+    for (uint32_t i = 0; i < LATENCY_HIST_BUCKETS; i++)
+    {
+        buckets[i] = __atomic_load_n(&hist->buckets[i], __ATOMIC_RELAXED);
+        total += buckets[i];
+    }
+
+    uint32_t p[3] = {0, 0, 0};
+    if (total > 0)
+    {
+        percentiles(buckets, total, p);
+    }
+
+    out->amostras = total;
+    out->max_us = __atomic_load_n(&hist->max_us, __ATOMIC_RELAXED);
+    out->p50_us = p[0];
+    out->p95_us = p[1];
+    out->p99_us = p[2];
+
+    /* A interpolação não deve passar do máximo medido */
+    if (out->p99_us > out->max_us)
+    {
+        out->p99_us = out->max_us;
+    }
+    if (out->p95_us > out->p99_us)
+    {
+        out->p95_us = out->p99_us;
+    }
+    if (out->p50_us > out->p95_us)
+    {
+        out->p50_us = out->p95_us;
+    }
+}
+
+void latency_hist_reset(latency_hist_t *hist)
+{
+    for (uint32_t i = 0; i < LATENCY_HIST_BUCKETS; i++)
+    {
+        __atomic_store_n(&hist->buckets[i], 0, __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&hist->max_us, 0, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,62 @@
+/**
+ * @file latency_hist.h
+ * @brief Histograma logarítmico de latências em microssegundos.
+ *
+ * Valores 0..3 µs têm bucket próprio; acima disso cada oitava é dividida
+ * em 4 buckets, com erro relativo de até 25% por bucket (os percentis são
+ * interpolados linearmente dentro do bucket). O último bucket (~58 s)
+ * acumula o excesso.
+ *
+ * @note Um único escritor por histograma. As leituras concorrentes usam
+ *       acessos atômicos e não veem buckets corrompidos, apenas um
+ *       conjunto possivelmente defasado em uma amostra.
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#ifndef LATENCY_HIST_H
+#define LATENCY_HIST_H
+
+#include <stdint.h>
+
+/** Número de buckets: 4 por oitava, até 2^26 µs */
+#define LATENCY_HIST_BUCKETS 100
+
+/**
+ * @brief Histograma de latências.
+ */
+typedef struct
+{
+	uint32_t buckets[LATENCY_HIST_BUCKETS]; ///< Contagem por bucket.
+	uint32_t max_us;							 ///< Maior latência registrada (µs).
+} latency_hist_t;
+
+/**
+ * @brief Resumo de um histograma.
+ */
+typedef struct
+{
+	uint32_t amostras; ///< Latências registradas.
+	uint32_t p50_us;	  ///< Mediana (µs).
+	uint32_t p95_us;	  ///< Percentil 95 (µs).
+	uint32_t p99_us;	  ///< Percentil 99 (µs).
+	uint32_t max_us;	  ///< Maior latência observada (µs).
+} latency_summary_t;
+
+/**
+ * @brief Registra uma latência.
+ */
+void latency_hist_record(latency_hist_t *hist, uint32_t latency_us);
+
+/**
+ * @brief Calcula amostras, percentis e máximo.
+ */
+void latency_hist_summary(const latency_hist_t *hist, latency_summary_t *out);
+
+/**
+ * @brief Zera o histograma.
+ */
+void latency_hist_reset(latency_hist_t *hist);
+
+#endif /* LATENCY_HIST_H */
@@ -0,0 +1,162 @@
+/**
+ * @file local_bus.c
+ * @brief Barramento local de publish/subscribe - Implementação
+ *
+ * As impressões de eco ficam em um vetor pequeno protegido por spinlock,
+ * ocupado em rodízio. Sem encaminhamentos pendentes, local_bus_is_echo()
+ * retorna sem calcular o hash.
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#include "local_bus.h"
+#include "mqtt_dispatch.h"
+#include "mem_budget.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+/* Definições privadas */
+
+/**
+ * @brief Impressão de uma mensagem encaminhada ao broker.
+ */
+typedef struct
+{
+    uint32_t hash;       ///< Hash de tópico + payload (0 = livre)
+    uint32_t expires_ms; ///< Instante em que a impressão deixa de valer
+} echo_slot_t;
+
+/* Variáveis privadas (static) */
+
+static SemaphoreHandle_t s_deliver_mutex = NULL;
+
+static echo_slot_t s_echo[LOCAL_BUS_ECHO_SLOTS];
+static uint32_t s_echo_next = 0;
+static uint32_t s_echo_pending = 0;
+static portMUX_TYPE s_echo_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/* Funções auxiliares */
+
+static inline uint32_t now_ms(void)
+{
+    return xTaskGetTickCount() * portTICK_PERIOD_MS;
+}
+
+static uint32_t fnv1a(uint32_t hash, const char *bytes, int len)
+{
+    for (int i = 0; i < len; i++)
+    {
+        hash ^= (uint8_t)bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static uint32_t message_hash(const char *topic, int topic_len,
+                             const char *data, int data_len)
+{
+    uint32_t hash = fnv1a(2166136261u, topic, topic_len);
+    hash = fnv1a(hash ^ 0xFF, data, data_len); // Separa "a/b"+"c" de "a/"+"bc"
+    return hash | 1;                          // 0 marca slot livre
+}
+
+/* Implementação das funções públicas */
+
+esp_err_t local_bus_init(void)
+{
+    if (s_deliver_mutex == NULL)
+    {
+#if MEM_STATIC_ALLOCATION
+        static StaticSemaphore_t s_deliver_mutex_buf;
+        s_deliver_mutex = xSemaphoreCreateRecursiveMutexStatic(&s_deliver_mutex_buf);
+#else
+        s_deliver_mutex = xSemaphoreCreateRecursiveMutex();
+#endif
+        if (s_deliver_mutex == NULL)
+        {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    return ESP_OK;
+}
+
+int local_bus_deliver(const mqtt_message_t *msg)
+{
+    xSemaphoreTakeRecursive(s_deliver_mutex, portMAX_DELAY);
+    int handled = mqtt_dispatch_message(msg);
+    xSemaphoreGiveRecursive(s_deliver_mutex);
+    return handled;
+}
+
+void local_bus_mark_forwarded(const char *topic, int topic_len,
+                              const char *data, int data_len)
+{
+    uint32_t hash = message_hash(topic, topic_len, data, data_len);
+    uint32_t expires = now_ms() + LOCAL_BUS_ECHO_TTL_MS;
+
+    portENTER_CRITICAL(&s_echo_lock);
+    echo_slot_t *slot = &s_echo[s_echo_next];
+    s_echo_next = (s_echo_next + 1) % LOCAL_BUS_ECHO_SLOTS;
+    if (slot->hash == 0)
+    {
+        s_echo_pending++;
+    }
+    slot->hash = hash;
+    slot->expires_ms = expires;
+    portEXIT_CRITICAL(&s_echo_lock);
+}
+
+void local_bus_unmark_forwarded(const char *topic, int topic_len,
+                                const char *data, int data_len)
+{
+    uint32_t hash = message_hash(topic, topic_len, data, data_len);
+
+    portENTER_CRITICAL(&s_echo_lock);
+    for (uint32_t i = 0; i < LOCAL_BUS_ECHO_SLOTS; i++)
+    {
+        if (s_echo[i].hash == hash)
+        {
+            s_echo[i].hash = 0;
+            s_echo_pending--;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&s_echo_lock);
+}
+
+bool local_bus_is_echo(const char *topic, int topic_len,
+                       const char *data, int data_len)
+{
+    if (__atomic_load_n(&s_echo_pending, __ATOMIC_RELAXED) == 0)
+    {
+        return false;
+    }
+
+    uint32_t hash = message_hash(topic, topic_len, data, data_len);
+    uint32_t now = now_ms();
+    bool echo = false;
+
+    portENTER_CRITICAL(&s_echo_lock);
+    for (uint32_t i = 0; i < LOCAL_BUS_ECHO_SLOTS; i++)
+    {
+        echo_slot_t *slot = &s_echo[i];
+        if (slot->hash == 0)
+        {
+            continue;
+        }
+
+        bool expired = (int32_t)(now - slot->expires_ms) >= 0;
+        if (expired || (!echo && slot->hash == hash))
+        {
+            echo = echo || !expired;
+            slot->hash = 0;
+            s_echo_pending--;
+        }
+    }
+    portEXIT_CRITICAL(&s_echo_lock);
+
+    return echo;
+}
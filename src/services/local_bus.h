@@ -0,0 +1,77 @@
+/**
+ * @file local_bus.h
+ * @brief Barramento local de publish/subscribe.
+ *
+ * Entrega mensagens publicadas no próprio dispositivo diretamente aos
+ * handlers de mqtt_dispatch.h, sem ida e volta ao broker. Todas as
+ * entregas (locais e vindas do broker) passam por local_bus_deliver(),
+ * que as serializa com um mutex recursivo: os handlers nunca executam
+ * em paralelo e podem publicar localmente de dentro do callback.
+ *
+ * Quando uma mensagem também é encaminhada ao broker e o dispositivo
+ * está subscrito ao mesmo tópico, o broker a devolve. Cada
+ * encaminhamento registra uma impressão digital (hash de tópico e
+ * payload) que descarta esse eco uma única vez, dentro de
+ * LOCAL_BUS_ECHO_TTL_MS.
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#ifndef LOCAL_BUS_H
+#define LOCAL_BUS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "mqtt_system.h"
+
+#ifndef LOCAL_BUS_ECHO_SLOTS
+#define LOCAL_BUS_ECHO_SLOTS 16 ///< Encaminhamentos aguardando eco
+#endif
+
+#ifndef LOCAL_BUS_ECHO_TTL_MS
+#define LOCAL_BUS_ECHO_TTL_MS 5000 ///< Validade da impressão de um encaminhamento
+#endif
+
+/**
+ * @brief Cria o mutex de entrega. Idempotente.
+ * @return ESP_OK ou ESP_ERR_NO_MEM.
+ */
+esp_err_t local_bus_init(void);
+
+/**
+ * @brief Entrega uma mensagem aos handlers registrados.
+ *
+ * Executa no contexto de quem chama, com o mutex de entrega tomado.
+ * @param msg Mensagem (local ou recebida do broker).
+ * @return Número de handlers chamados.
+ */
+int local_bus_deliver(const mqtt_message_t *msg);
+
+/**
+ * @brief Registra que uma mensagem já entregue localmente foi enviada ao broker.
+ */
+void local_bus_mark_forwarded(const char *topic, int topic_len,
+                              const char *data, int data_len);
+
+/**
+ * @brief Desfaz um local_bus_mark_forwarded() cujo envio ao broker falhou.
+ *
+ * Sem isso a impressão descartaria, dentro do TTL, uma mensagem externa
+ * idêntica.
+ */
+void local_bus_unmark_forwarded(const char *topic, int topic_len,
+                                const char *data, int data_len);
+
+/**
+ * @brief Verifica se uma mensagem recebida é o eco de um encaminhamento.
+ *
+ * Uma impressão casada é consumida: um segundo recebimento idêntico é
+ * entregue normalmente.
+ * @return true se a mensagem deve ser descartada.
+ */
+bool local_bus_is_echo(const char *topic, int topic_len,
+                       const char *data, int data_len);
+
+#endif /* LOCAL_BUS_H */
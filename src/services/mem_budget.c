@@ -0,0 +1,120 @@
+/**
+ * @file mem_budget.c
+ * @brief Orçamento de RAM e auditoria do heap - Implementação
+ *
+ * A auditoria usa os contadores por task dos hooks de heap_stats.c.
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#include "mem_budget.h"
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+#include "esp_log.h"
+#include "mqtt_system.h"
+#include "static_outbox.h"
+#include "heap_stats.h"
+#include "deferred_log.h"
+
+/* Definições privadas */
+
+static const char *TAG = "MEM_BUDGET";
+
+/** Objetos de sincronização do sistema (telemetria, barramento local, fila offline) */
+#define MEM_SYNC_MUTEXES 3
+#define MEM_SYNC_EVENT_GROUPS 1
+
+#define BUDGET_TCBS (TASK_ID_COUNT * sizeof(StaticTask_t))
+#define BUDGET_SYNC (MEM_SYNC_MUTEXES * sizeof(StaticSemaphore_t) + \
+                     MEM_SYNC_EVENT_GROUPS * sizeof(StaticEventGroup_t))
+
+#ifdef CONFIG_MQTT_CUSTOM_OUTBOX
+#define BUDGET_OUTBOX STATIC_OUTBOX_BYTES
+#else
+#define BUDGET_OUTBOX 0
+#endif
+
+#if MEM_STATIC_ALLOCATION
+#define BUDGET_STATIC_TOTAL (TASK_STACK_TOTAL + BUDGET_TCBS + BUDGET_SYNC + BUDGET_OUTBOX + \
+                             DEFERRED_LOG_BYTES)
+#if !defined(CONFIG_MQTT_CUSTOM_OUTBOX) && !defined(CONFIG_HOST_MODE)
+#warning "MEM_STATIC_ALLOCATION sem CONFIG_MQTT_CUSTOM_OUTBOX: o outbox do esp-mqtt continua no heap"
+#endif
+#else
+#define BUDGET_STATIC_TOTAL (BUDGET_OUTBOX + DEFERRED_LOG_BYTES)
+#endif
+
+_Static_assert(BUDGET_STATIC_TOTAL <= MEM_BUDGET_STATIC_MAX,
+               "Regioes estaticas acima de MEM_BUDGET_STATIC_MAX");
+
+/* Variáveis privadas (static) */
+
+static const mem_budget_entry_t s_budget[] = {
+    {"stacks", TASK_STACK_TOTAL, MEM_STATIC_ALLOCATION},
+    {"tcbs", BUDGET_TCBS, MEM_STATIC_ALLOCATION},
+    {"sync", BUDGET_SYNC, MEM_STATIC_ALLOCATION},
+#ifdef CONFIG_MQTT_CUSTOM_OUTBOX
+    {"mqtt_outbox", STATIC_OUTBOX_BYTES, true},
+#endif
+    {"log_ring", DEFERRED_LOG_BYTES, true},
+    {"mqtt_buffers", 2 * MQTT_BUFFER_SIZE, false},
+};
+
+#if CONFIG_HEAP_USE_HOOKS
+static bool s_audit_ativo = false;
+static uint32_t s_base[TASK_ID_COUNT]; ///< Alocações de cada task no início da auditoria
+#endif
+
+/* Implementação das funções públicas */
+
+const mem_budget_entry_t *mem_budget_table(size_t *count)
+{
+    *count = sizeof(s_budget) / sizeof(s_budget[0]);
+    return s_budget;
+}
+
+void mem_budget_log(void)
+{
+    ESP_LOGI(TAG, "Orcamento de memoria (modo %s):",
+             MEM_STATIC_ALLOCATION ? "estatico" : "heap");
+    for (size_t i = 0; i < sizeof(s_budget) / sizeof(s_budget[0]); i++)
+    {
+        ESP_LOGI(TAG, "   %-14s %6lu bytes %s", s_budget[i].nome, s_budget[i].bytes,
+                 s_budget[i].estatico ? "estatico" : "heap");
+    }
+    ESP_LOGI(TAG, "   Estatico: %lu de %lu bytes", (uint32_t)BUDGET_STATIC_TOTAL,
+             (uint32_t)MEM_BUDGET_STATIC_MAX);
+}
+
+void mem_budget_audit_start(void)
+{
+#if CONFIG_HEAP_USE_HOOKS
+    heap_stats_get_task_allocs(s_base);
+    __atomic_store_n(&s_audit_ativo, true, __ATOMIC_RELEASE);
+#endif
+}
+
+void mem_budget_audit_get(mem_audit_t *out)
+{
+    memset(out, 0, sizeof(*out));
+#if CONFIG_HEAP_USE_HOOKS
+    out->suportado = true;
+    out->ativo = __atomic_load_n(&s_audit_ativo, __ATOMIC_ACQUIRE);
+    if (!out->ativo)
+    {
+        return;
+    }
+
+    heap_stats_get_task_allocs(out->por_task);
+    for (int id = 0; id < TASK_ID_COUNT; id++)
+    {
+        /* Task de conexão fora da auditoria (ver mem_budget.h) */
+        out->por_task[id] = (id == TASK_ID_CONNECTION) ? 0 : out->por_task[id] - s_base[id];
+        out->total += out->por_task[id];
+    }
+#endif
+}
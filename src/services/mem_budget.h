@@ -0,0 +1,90 @@
+/**
+ * @file mem_budget.h
+ * @brief Modo de memória estática, orçamento de RAM e auditoria do heap.
+ *
+ * Com MEM_STATIC_ALLOCATION = 1:
+ * - as tasks do perfil usam stacks e TCBs de um pool estático
+ *   (task_profile.c);
+ * - mutexes e event groups do sistema usam buffers estáticos;
+ * - com CONFIG_MQTT_CUSTOM_OUTBOX, o outbox do esp-mqtt usa o pool de
+ *   static_outbox.h em vez de um malloc por publicação QoS > 0.
+ *
+ * A tabela de orçamento lista cada região com o tamanho calculado em tempo
+ * de compilação. A soma das regiões estáticas é verificada contra
+ * MEM_BUDGET_STATIC_MAX: estourar o orçamento é erro de compilação.
+ *
+ * Os buffers do cliente esp-mqtt (2 x MQTT_BUFFER_SIZE) continuam no
+ * heap: o esp-mqtt os aloca uma única vez, ao criar o cliente na task de
+ * conexão.
+ *
+ * Com CONFIG_HEAP_USE_HOOKS, a auditoria conta os malloc feitos pelas
+ * tasks do perfil (hooks de heap_stats.h) a partir de
+ * mem_budget_audit_start() (fim de mqtt_system_init). A task de conexão
+ * fica de fora: ela sobe e reconecta WiFi e MQTT, caminhos que alocam
+ * dentro do ESP-IDF. Em regime, no modo estático, a contagem por intervalo
+ * deve ser zero; o SystemMonitor avisa quando não é, e no host o teste
+ * test_static_alloc verifica. Sem os hooks a auditoria fica indisponível.
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#ifndef MEM_BUDGET_H
+#define MEM_BUDGET_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "task_profile.h"
+
+#ifndef MEM_STATIC_ALLOCATION
+#define MEM_STATIC_ALLOCATION 0 ///< 1 = tasks, mutexes e outbox em memória estática
+#endif
+
+#ifndef MEM_BUDGET_STATIC_MAX
+#define MEM_BUDGET_STATIC_MAX (48 * 1024) ///< Limite das regiões estáticas do orçamento (bytes)
+#endif
+
+/**
+ * @brief Região de memória do orçamento.
+ */
+typedef struct
+{
+	const char *nome; ///< Região.
+	uint32_t bytes;	  ///< Tamanho em tempo de compilação.
+	bool estatico;	  ///< true = .bss; false = heap (alocação única).
+} mem_budget_entry_t;
+
+/**
+ * @brief Alocações das tasks do perfil desde mem_budget_audit_start().
+ */
+typedef struct
+{
+	bool suportado;						///< CONFIG_HEAP_USE_HOOKS ativo.
+	bool ativo;							///< Auditoria iniciada.
+	uint32_t total;						///< Alocações das tasks auditadas.
+	uint32_t por_task[TASK_ID_COUNT];	///< Alocações por task.
+} mem_audit_t;
+
+/**
+ * @brief Tabela de orçamento.
+ * @param count Número de entradas (saída).
+ */
+const mem_budget_entry_t *mem_budget_table(size_t *count);
+
+/**
+ * @brief Imprime a tabela, o total estático e o limite.
+ */
+void mem_budget_log(void);
+
+/**
+ * @brief Zera os contadores e passa a contar as alocações em regime.
+ */
+void mem_budget_audit_start(void);
+
+/**
+ * @brief Copia os contadores da auditoria.
+ */
+void mem_budget_audit_get(mem_audit_t *out);
+
+#endif /* MEM_BUDGET_H */
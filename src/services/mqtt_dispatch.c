@@ -0,0 +1,272 @@
+/**
+ * @file mqtt_dispatch.c
+ * @brief Tabela de despacho de mensagens MQTT recebidas - Implementação
+ *
+ * Registros são raros (normalmente na inicialização) e protegidos por
+ * spinlock; o despacho, executado na task do cliente MQTT, apenas lê
+ * a tabela. Um slot só fica visível após todos os campos serem
+ * gravados (flag `state` publicada com semântica release).
+ *
+ * Slots removidos viram lápides e são reaproveitados pelo próximo
+ * registro. Como o despacho pode estar lendo o slot nesse momento, cada
+ * slot tem um contador de sequência: ímpar durante a regravação, e o
+ * leitor repete a leitura se o contador mudou. Lápides seguidas de um
+ * slot vazio voltam a ser vazias, o que mantém curtas as sondagens de
+ * tópicos sem handler.
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#include "mqtt_dispatch.h"
+#include "topic_trie.h"
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+
+/* Definições privadas */
+
+#define SLOT_EMPTY 0
+#define SLOT_ACTIVE 1
+#define SLOT_DELETED 2
+
+#define TABLE_MASK (MQTT_DISPATCH_TABLE_SIZE - 1)
+
+_Static_assert((MQTT_DISPATCH_TABLE_SIZE & TABLE_MASK) == 0,
+               "MQTT_DISPATCH_TABLE_SIZE deve ser potencia de 2");
+
+/**
+ * @brief Slot da tabela hash.
+ */
+typedef struct
+{
+    uint32_t seq;                          ///< Sequência da gravação (ímpar durante a escrita)
+    uint8_t state;                         ///< SLOT_EMPTY, SLOT_ACTIVE ou SLOT_DELETED
+    uint8_t topic_len;                     ///< Comprimento do tópico
+    uint32_t hash;                         ///< Hash FNV-1a do tópico
+    mqtt_message_handler_t callback;       ///< Handler registrado
+    void *ctx;                             ///< Contexto do handler
+    char topic[MQTT_DISPATCH_MAX_TOPIC];   ///< Cópia do tópico
+} dispatch_slot_t;
+
+/* Variáveis privadas (static) */
+
+static dispatch_slot_t s_table[MQTT_DISPATCH_TABLE_SIZE];
+static uint32_t s_active = 0;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/* Funções auxiliares */
+
+static inline uint32_t topic_hash(const char *topic, int len)
+{
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < len; i++)
+    {
+        hash ^= (uint8_t)topic[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static inline uint8_t slot_state(const dispatch_slot_t *slot)
+{
+    return __atomic_load_n(&slot->state, __ATOMIC_ACQUIRE);
+}
+
+/** Grava um handler no slot (vazio ou lápide). Chamar com lock. */
+static void slot_write(dispatch_slot_t *slot, const char *topic, size_t len, uint32_t hash,
+                       mqtt_message_handler_t callback, void *ctx)
+{
+    uint32_t seq = slot->seq;
+
+    __atomic_store_n(&slot->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    slot->topic_len = (uint8_t)len;
+    slot->hash = hash;
+    slot->callback = callback;
+    slot->ctx = ctx;
+    memcpy(slot->topic, topic, len + 1);
+    __atomic_store_n(&slot->state, SLOT_ACTIVE, __ATOMIC_RELEASE);
+
+    __atomic_store_n(&slot->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+/** Início da leitura de um slot: aguarda o fim de uma gravação em andamento */
+static inline uint32_t slot_read_begin(const dispatch_slot_t *slot)
+{
+    uint32_t seq;
+    while ((seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE)) & 1)
+    {
+    }
+    return seq;
+}
+
+/** Fim da leitura: false se o slot foi regravado durante a leitura */
+static inline bool slot_read_valid(const dispatch_slot_t *slot, uint32_t seq)
+{
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&slot->seq, __ATOMIC_RELAXED) == seq;
+}
+
+/**
+ * @brief Devolve a vazio as lápides que terminam em um slot vazio.
+ *
+ * Nenhuma sequência de sondagem passa por essas lápides: quem passasse
+ * por elas pararia no slot vazio seguinte. Chamar com lock.
+ */
+static void purge_tombstones(uint32_t index)
+{
+    while (s_table[index].state == SLOT_DELETED &&
+           s_table[(index + 1) & TABLE_MASK].state == SLOT_EMPTY)
+    {
+        __atomic_store_n(&s_table[index].state, SLOT_EMPTY, __ATOMIC_RELEASE);
+        index = (index - 1) & TABLE_MASK;
+    }
+}
+
+/* Implementação das funções públicas */
+
+esp_err_t mqtt_dispatch_register(const char *topic_filter,
+                                 mqtt_message_handler_t callback, void *ctx)
+{
+    if (topic_filter == NULL || callback == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (topic_trie_has_wildcard(topic_filter))
+    {
+        return topic_trie_insert(topic_filter, callback, ctx);
+    }
+
+    size_t len = strlen(topic_filter);
+    if (len == 0 || len >= MQTT_DISPATCH_MAX_TOPIC)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint32_t hash = topic_hash(topic_filter, len);
+    esp_err_t ret = ESP_ERR_NO_MEM;
+
+    portENTER_CRITICAL(&s_lock);
+
+    if (s_active < MQTT_DISPATCH_MAX_HANDLERS)
+    {
+        // Primeiro slot livre da sondagem: vazio ou lápide
+        for (uint32_t i = 0; i < MQTT_DISPATCH_TABLE_SIZE; i++)
+        {
+            dispatch_slot_t *slot = &s_table[(hash + i) & TABLE_MASK];
+
+            if (slot->state != SLOT_ACTIVE)
+            {
+                slot_write(slot, topic_filter, len, hash, callback, ctx);
+                s_active++;
+                ret = ESP_OK;
+                break;
+            }
+        }
+    }
+
+    portEXIT_CRITICAL(&s_lock);
+
+    return ret;
+}
+
+esp_err_t mqtt_dispatch_unregister(const char *topic_filter,
+                                   mqtt_message_handler_t callback)
+{
+    if (topic_filter == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (topic_trie_has_wildcard(topic_filter))
+    {
+        return topic_trie_remove(topic_filter, callback);
+    }
+
+    size_t len = strlen(topic_filter);
+    uint32_t hash = topic_hash(topic_filter, len);
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+
+    portENTER_CRITICAL(&s_lock);
+
+    for (uint32_t i = 0; i < MQTT_DISPATCH_TABLE_SIZE; i++)
+    {
+        uint32_t index = (hash + i) & TABLE_MASK;
+        dispatch_slot_t *slot = &s_table[index];
+
+        if (slot->state == SLOT_EMPTY)
+        {
+            break;
+        }
+
+        if (slot->state == SLOT_ACTIVE && slot->hash == hash &&
+            slot->topic_len == len && slot->callback == callback &&
+            memcmp(slot->topic, topic_filter, len) == 0)
+        {
+            __atomic_store_n(&slot->state, SLOT_DELETED, __ATOMIC_RELEASE);
+            purge_tombstones(index);
+            s_active--;
+            ret = ESP_OK;
+            break;
+        }
+    }
+
+    portEXIT_CRITICAL(&s_lock);
+
+    return ret;
+}
+
+int mqtt_dispatch_message(const mqtt_message_t *msg)
+{
+    if (msg->topic == NULL || msg->topic_len <= 0)
+    {
+        return 0;
+    }
+
+    int handled = topic_trie_is_empty() ? 0 : topic_trie_dispatch(msg);
+
+    if (msg->topic_len >= MQTT_DISPATCH_MAX_TOPIC)
+    {
+        return handled;
+    }
+
+    uint32_t hash = topic_hash(msg->topic, msg->topic_len);
+
+    for (uint32_t i = 0; i < MQTT_DISPATCH_TABLE_SIZE; i++)
+    {
+        const dispatch_slot_t *slot = &s_table[(hash + i) & TABLE_MASK];
+        mqtt_message_handler_t callback;
+        void *ctx;
+        uint8_t state;
+        bool match;
+        uint32_t seq;
+
+        // Cópia consistente do slot: repete se foi reaproveitado no meio
+        do
+        {
+            seq = slot_read_begin(slot);
+            state = slot_state(slot);
+            match = state == SLOT_ACTIVE && slot->hash == hash &&
+                    slot->topic_len == msg->topic_len &&
+                    memcmp(slot->topic, msg->topic, msg->topic_len) == 0;
+            callback = slot->callback;
+            ctx = slot->ctx;
+        } while (!slot_read_valid(slot, seq));
+
+        if (state == SLOT_EMPTY)
+        {
+            break;
+        }
+
+        if (match)
+        {
+            callback(msg, ctx);
+            handled++;
+        }
+    }
+
+    return handled;
+}
@@ -0,0 +1,55 @@
+/**
+ * @file mqtt_dispatch.h
+ * @brief Tabela de despacho de mensagens MQTT recebidas.
+ *
+ * Associa tópicos a callbacks. Tópicos exatos ficam em uma tabela hash
+ * estática (endereçamento aberto, FNV-1a); filtros com curingas '+'/'#'
+ * ficam na trie de topic_trie.h. O despacho compara diretamente os
+ * bytes de `event->topic`/`topic_len`, sem cópias nem alocação.
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#ifndef MQTT_DISPATCH_H
+#define MQTT_DISPATCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "mqtt_system.h"
+
+/** Número de slots da tabela hash (potência de 2) */
+#define MQTT_DISPATCH_TABLE_SIZE 64
+
+/** Número máximo de handlers registrados */
+#define MQTT_DISPATCH_MAX_HANDLERS (MQTT_DISPATCH_TABLE_SIZE / 2)
+
+/** Comprimento máximo de um tópico registrado (incluindo '\0') */
+#define MQTT_DISPATCH_MAX_TOPIC 64
+
+/**
+ * @brief Registra um handler para um tópico.
+ * @param topic_filter Tópico exato ou filtro com curingas ('+', '#').
+ * @param callback Função chamada para cada mensagem no tópico.
+ * @param ctx Contexto repassado ao callback.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG ou ESP_ERR_NO_MEM se a tabela estiver cheia.
+ */
+esp_err_t mqtt_dispatch_register(const char *topic_filter,
+                                 mqtt_message_handler_t callback, void *ctx);
+
+/**
+ * @brief Remove o registro de um handler.
+ * @return ESP_OK ou ESP_ERR_NOT_FOUND.
+ */
+esp_err_t mqtt_dispatch_unregister(const char *topic_filter,
+                                   mqtt_message_handler_t callback);
+
+/**
+ * @brief Despacha uma mensagem para os handlers do tópico.
+ * @param msg Mensagem recebida (visão sobre o buffer do evento).
+ * @return Número de handlers chamados.
+ */
+int mqtt_dispatch_message(const mqtt_message_t *msg);
+
+#endif /* MQTT_DISPATCH_H */
@@ -0,0 +1,170 @@
+/**
+ * @file mqtt_stats.c
+ * @brief Implementação dos contadores de estatísticas MQTT por núcleo.
+ *
+ * Os escritores nunca zeram nem reescrevem as linhas por núcleo: o reset
+ * apenas registra o total atual como nova origem no lado do leitor.
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#include "mqtt_stats.h"
+#include "freertos/FreeRTOS.h"
+
+/* Variáveis privadas (static) */
+
+/** Contadores de 32 bits incrementados por cada núcleo */
+static uint32_t s_per_core[portNUM_PROCESSORS][MQTT_STAT_COUNT];
+
+/** Instante da última mensagem recebida (ms) */
+static uint32_t s_last_message_ms = 0;
+
+/**
+ * @brief Publicação aguardando ACK. msg_id 0 indica posição livre; o
+ *        esp-mqtt só usa 1..65535 para QoS >= 1.
+ */
+typedef struct
+{
+    uint32_t msg_id;
+    uint32_t sent_us;
+} ack_slot_t;
+
+_Static_assert((MQTT_ACK_TRACK_SLOTS & (MQTT_ACK_TRACK_SLOTS - 1)) == 0,
+               "MQTT_ACK_TRACK_SLOTS deve ser potencia de 2");
+
+static ack_slot_t s_ack_slots[MQTT_ACK_TRACK_SLOTS];
+
+/** Histograma de latência; escrito apenas pela task do cliente MQTT */
+static latency_hist_t s_ack_hist;
+
+/* Estado do leitor (protegido por s_reader_lock) */
+static portMUX_TYPE s_reader_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t s_seen[portNUM_PROCESSORS][MQTT_STAT_COUNT];
+static uint64_t s_totals[MQTT_STAT_COUNT];
+static uint64_t s_origin[MQTT_STAT_COUNT];
+
+/* Funções auxiliares */
+
+/**
+ * @brief Acumula nos totais de 64 bits o que cada núcleo somou desde a
+ *        última leitura. A subtração em 32 bits absorve o estouro.
+ */
+static void fold_locked(void)
+{
+    for (int core = 0; core < portNUM_PROCESSORS; core++)
+    {
+        for (int id = 0; id < MQTT_STAT_COUNT; id++)
+        {
+            uint32_t now = __atomic_load_n(&s_per_core[core][id], __ATOMIC_RELAXED);
+            s_totals[id] += (uint32_t)(now - s_seen[core][id]);
+            s_seen[core][id] = now;
+        }
+    }
+}
+
+/* Implementação das funções públicas */
+
+void mqtt_stats_add(mqtt_stat_id_t id, uint32_t value)
+{
+    /* Atômico mesmo na linha do próprio núcleo: a task pode migrar entre
+     * a leitura do núcleo e o incremento */
+    __atomic_fetch_add(&s_per_core[xPortGetCoreID()][id], value, __ATOMIC_RELAXED);
+}
+
+void mqtt_stats_set_last_message(uint32_t timestamp_ms)
+{
+    __atomic_store_n(&s_last_message_ms, timestamp_ms, __ATOMIC_RELAXED);
+}
+
+void mqtt_stats_ack_track(int msg_id, int64_t sent_us)
+{
+    if (msg_id <= 0)
+    {
+        return;
+    }
+
+    ack_slot_t *slot = &s_ack_slots[(uint32_t)msg_id & (MQTT_ACK_TRACK_SLOTS - 1)];
+
+    /* O instante é gravado antes do msg_id; quem casa o ACK confirma a
+     * posse com compare-exchange e descarta a leitura se perder a corrida */
+    __atomic_store_n(&slot->sent_us, (uint32_t)sent_us, __ATOMIC_RELAXED);
+    uint32_t evicted = __atomic_exchange_n(&slot->msg_id, (uint32_t)msg_id, __ATOMIC_RELEASE);
+    if (evicted != 0)
+    {
+        mqtt_stats_add(MQTT_STAT_ACK_PERDIDOS, 1);
+    }
+}
+
+void mqtt_stats_ack_complete(int msg_id, int64_t now_us)
+{
+    if (msg_id <= 0)
+    {
+        return;
+    }
+
+    ack_slot_t *slot = &s_ack_slots[(uint32_t)msg_id & (MQTT_ACK_TRACK_SLOTS - 1)];
+    uint32_t expected = (uint32_t)msg_id;
+
+    if (__atomic_load_n(&slot->msg_id, __ATOMIC_ACQUIRE) != expected)
+    {
+        mqtt_stats_add(MQTT_STAT_ACK_PERDIDOS, 1);
+        return;
+    }
+
+    uint32_t sent_us = __atomic_load_n(&slot->sent_us, __ATOMIC_RELAXED);
+    if (!__atomic_compare_exchange_n(&slot->msg_id, &expected, 0, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+    {
+        mqtt_stats_add(MQTT_STAT_ACK_PERDIDOS, 1);
+        return;
+    }
+
+    /* Diferença em 32 bits: válida para latências de até ~71 min */
+    latency_hist_record(&s_ack_hist, (uint32_t)now_us - sent_us);
+}
+
+void mqtt_stats_ack_latency(latency_summary_t *out)
+{
+    latency_hist_summary(&s_ack_hist, out);
+}
+
+void mqtt_stats_ack_reset(void)
+{
+    latency_hist_reset(&s_ack_hist);
+}
+
+void mqtt_stats_snapshot(uint64_t totals[MQTT_STAT_COUNT], uint32_t *last_message_ms)
+{
+    portENTER_CRITICAL(&s_reader_lock);
+    fold_locked();
+    for (int id = 0; id < MQTT_STAT_COUNT; id++)
+    {
+        totals[id] = s_totals[id] - s_origin[id];
+    }
+    portEXIT_CRITICAL(&s_reader_lock);
+
+    if (last_message_ms)
+    {
+        *last_message_ms = __atomic_load_n(&s_last_message_ms, __ATOMIC_RELAXED);
+    }
+}
+
+void mqtt_stats_reset(uint32_t mask)
+{
+    portENTER_CRITICAL(&s_reader_lock);
+    fold_locked();
+    for (int id = 0; id < MQTT_STAT_COUNT; id++)
+    {
+        if (mask & MQTT_STAT_BIT(id))
+        {
+            s_origin[id] = s_totals[id];
+        }
+    }
+    portEXIT_CRITICAL(&s_reader_lock);
+
+    if (mask & MQTT_STAT_BIT(MQTT_STAT_RECEBIDAS))
+    {
+        __atomic_store_n(&s_last_message_ms, 0, __ATOMIC_RELAXED);
+    }
+}
@@ -0,0 +1,105 @@
+/**
+ * @file mqtt_stats.h
+ * @brief Contadores de estatísticas MQTT sem lock no caminho de escrita.
+ *
+ * Cada núcleo incrementa sua própria linha de contadores de 32 bits com
+ * operações atômicas relaxadas, evitando disputa entre as tasks que
+ * publicam nos dois núcleos e a task do cliente MQTT. A leitura acumula
+ * os incrementos de cada linha em totais de 64 bits (tratando o
+ * estouro dos 32 bits), sob uma seção crítica que só o leitor usa.
+ *
+ * Também mede a latência de confirmação (PUBACK/PUBCOMP) das publicações
+ * QoS >= 1: o msg_id é marcado no envio e casado com MQTT_EVENT_PUBLISHED,
+ * e o tempo decorrido vai para um histograma logarítmico (latency_hist.h).
+ *
+ * @note Os totais de 64 bits dependem de uma leitura a cada 2^32
+ *       incrementos por núcleo; a task de health já lê a cada minuto.
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#ifndef MQTT_STATS_H
+#define MQTT_STATS_H
+
+#include <stdint.h>
+#include "latency_hist.h"
+
+/* Configuração */
+
+#ifndef MQTT_ACK_TRACK_SLOTS
+#define MQTT_ACK_TRACK_SLOTS 32 ///< Publicações aguardando ACK rastreadas (potência de 2)
+#endif
+
+/**
+ * @brief Identificadores dos contadores monotônicos.
+ */
+typedef enum
+{
+	MQTT_STAT_PUBLICADAS = 0,		  ///< Mensagens publicadas (inclui reenvios da fila offline).
+	MQTT_STAT_RECEBIDAS,			  ///< Mensagens recebidas.
+	MQTT_STAT_FALHAS_PUBLICACAO,	  ///< Falhas de publicação.
+	MQTT_STAT_DESCONEXOES,			  ///< Desconexões do broker.
+	MQTT_STAT_TEMPO_DESCONECTADO_MS, ///< Tempo acumulado desconectado (ms).
+	MQTT_STAT_ACK_PERDIDOS,		  ///< ACKs sem envio marcado ou marcações descartadas.
+	MQTT_STAT_ENTREGAS_LOCAIS,	  ///< Publicações entregues pelo barramento local.
+	MQTT_STAT_ECOS_SUPRIMIDOS,	  ///< Ecos do broker de publicações já entregues localmente.
+	MQTT_STAT_COUNT
+} mqtt_stat_id_t;
+
+/** Máscara de um contador para mqtt_stats_reset() */
+#define MQTT_STAT_BIT(id) (1U << (id))
+
+/**
+ * @brief Soma `value` a um contador (seguro em qualquer task/núcleo).
+ */
+void mqtt_stats_add(mqtt_stat_id_t id, uint32_t value);
+
+/**
+ * @brief Registra o instante (ms) da última mensagem recebida.
+ */
+void mqtt_stats_set_last_message(uint32_t timestamp_ms);
+
+/**
+ * @brief Lê todos os contadores de uma vez.
+ * @param totals Vetor com MQTT_STAT_COUNT posições para os totais de 64 bits.
+ * @param last_message_ms Instante da última mensagem (pode ser NULL).
+ */
+void mqtt_stats_snapshot(uint64_t totals[MQTT_STAT_COUNT], uint32_t *last_message_ms);
+
+/**
+ * @brief Marca o envio de uma publicação QoS >= 1.
+ * @param msg_id Identificador retornado pelo cliente MQTT (> 0).
+ * @param sent_us Instante do envio (esp_timer_get_time()).
+ * @note Um ACK que chegue antes da marcação, ou uma marcação sobrescrita
+ *       por mais de MQTT_ACK_TRACK_SLOTS envios pendentes, conta em
+ *       MQTT_STAT_ACK_PERDIDOS.
+ */
+void mqtt_stats_ack_track(int msg_id, int64_t sent_us);
+
+/**
+ * @brief Casa um MQTT_EVENT_PUBLISHED com o envio e registra a latência.
+ * @param msg_id Identificador do evento.
+ * @param now_us Instante do recebimento do ACK.
+ */
+void mqtt_stats_ack_complete(int msg_id, int64_t now_us);
+
+/**
+ * @brief Calcula os percentis do histograma de latência de ACK.
+ * @param out Resumo de saída; percentis interpolados dentro do bucket.
+ */
+void mqtt_stats_ack_latency(latency_summary_t *out);
+
+/**
+ * @brief Zera o histograma de latência (as marcações pendentes são mantidas).
+ */
+void mqtt_stats_ack_reset(void);
+
+/**
+ * @brief Zera os contadores selecionados.
+ * @param mask Combinação de MQTT_STAT_BIT(); o instante da última mensagem é
+ *             zerado junto com MQTT_STAT_RECEBIDAS.
+ */
+void mqtt_stats_reset(uint32_t mask);
+
+#endif /* MQTT_STATS_H */
@@ -14,18 +14,34 @@
 
 /* Includes */
 #include "mqtt_system.h"
+#include "telemetry_batch.h"
+#include "report_filter.h"
+#include "rule_engine.h"
+#include "actuator.h"
+#include "local_bus.h"
+#include "offline_queue.h"
+#include "payload_codec.h"
+#include "mqtt_dispatch.h"
+#include "wifi_cache.h"
+#include "sub_registry.h"
+#include "boot_trace.h"
+#include "task_profile.h"
+#include "mem_budget.h"
+#include "deferred_log.h"
+#include "sampler.h"
 
 #include <stdio.h>
-#define MIN(a,b) (((a)<(b))?(a):(b))
 #include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/event_groups.h"
+#include "freertos/semphr.h"
 #include "esp_system.h"
 #include "esp_wifi.h"
 #include "esp_event.h"
 #include "esp_log.h"
 #include "esp_netif.h"
+#include "esp_mac.h"
 #include "esp_timer.h"
 #include "esp_random.h"
 #include "nvs_flash.h"
@@ -40,14 +56,16 @@
 /** Tag para logging */
 static const char *TAG = "MQTT_SYSTEM";
 
-/** Event bits para sincronização WiFi */
-#define WIFI_CONNECTED_BIT BIT0
-#define WIFI_FAIL_BIT BIT1
+/** Event bits de prontidão da rede (s_net_events) */
+#define WIFI_CONNECTED_BIT BIT0 ///< IP obtido
+#define WIFI_FAIL_BIT BIT1      ///< Tentativas de conexão WiFi esgotadas
+#define MQTT_CONNECTED_BIT BIT2 ///< CONNACK recebido
+#define NET_CHANGED_BIT BIT3    ///< Rede ou subscrições mudaram (acorda a task de conexão)
 
 /* Variáveis privadas (static) */
 
-/** Instância global de estatísticas */
-static mqtt_statistics_t s_stats = {0};
+/** Início (ms) da desconexão atual, 0 se conectado ou nunca conectado */
+static uint32_t s_disconnected_since_ms = 0;
 
 /** Handle do cliente MQTT */
 static esp_mqtt_client_handle_t s_mqtt_client = NULL;
@@ -55,17 +73,100 @@ static esp_mqtt_client_handle_t s_mqtt_client = NULL;
 /** Flag indicando se MQTT está conectado */
 static bool s_mqtt_connected = false;
 
+/** CONNACKs recebidos; a task de conexão republica o status a cada um */
+static uint32_t s_mqtt_connect_count = 0;
+
+/** Prontidão de WiFi e MQTT; acorda quem espera assim que o evento chega */
+static EventGroupHandle_t s_net_events = NULL;
+
+/** Estado da máquina de conexão (escrito só pela task de conexão) */
+static mqtt_conn_state_t s_conn_state = MQTT_CONN_PARADO;
+
+/** Callbacks de mudança de prontidão */
+static mqtt_ready_callback_t s_ready_callbacks[MQTT_READY_MAX_CALLBACKS];
+static void *s_ready_ctx[MQTT_READY_MAX_CALLBACKS];
+static uint32_t s_ready_callback_count = 0;
+static bool s_ready_state = false; ///< Último estado notificado (protegido por s_ready_lock)
+static portMUX_TYPE s_ready_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/** Tamanho do payload de boot (campos fixos + trace de boot_trace.h) */
+#define BOOT_INFO_MAX_SIZE 1024
+
+/** Tamanho do payload de health (JSON com CPU, regiões do heap e captura) */
+#define HEALTH_INFO_MAX_SIZE 1536
+
+/** Marcos do boot (ms desde o boot), 0 até acontecerem */
+static uint32_t s_boot_wifi_ms = 0;
+static uint32_t s_boot_mqtt_ms = 0;
+static uint32_t s_boot_first_publish_ms = 0;
+
+/** Spans fechados pelos handlers de evento (-1 depois de fechados) */
+static boot_span_id_t s_span_wifi_conexao = -1;
+static boot_span_id_t s_span_mqtt_conexao = -1;
+
 /** Contador de tentativas de reconexão WiFi */
 static int s_wifi_retry_num = 0;
 
+/** Interface de rede da estação */
+static esp_netif_t *s_sta_netif = NULL;
+
+/** Conexão rápida em andamento: uma falha antes do IP descarta o cache */
+static bool s_wifi_fast_attempt = false;
+
+/** IP reaproveitado do cache em uso (DHCP parado) */
+static bool s_wifi_static_ip = false;
+
+/** Prazo do CONNACK com o IP do cache em curso */
+static bool s_wifi_static_pending = false;
+
+/** Tick do IP_EVENT_STA_GOT_IP com o IP do cache (início do prazo) */
+static TickType_t s_wifi_static_since = 0;
+
+/** Canal e BSSID da associação atual, gravados no cache ao obter IP */
+static wifi_cache_t s_wifi_link;
+
 /** Handles das tasks do sistema */
 static TaskHandle_t s_task_telemetry = NULL;
 static TaskHandle_t s_task_health = NULL;
-static TaskHandle_t s_task_wifi_watchdog = NULL;
+static TaskHandle_t s_task_connection = NULL;
+static TaskHandle_t s_task_offline_drain = NULL;
 
 /** Flag indicando se sistema foi inicializado */
 static bool s_system_initialized = false;
 
+/**
+ * Menor stack livre por task, lida pela task de health a cada
+ * HEALTH_CHECK_INTERVAL_MS; o health só serializa esta cópia
+ */
+static uint16_t s_stack_livre[TASK_ID_COUNT];
+
+/** Mutex que protege o lote de telemetria */
+static SemaphoreHandle_t s_telemetry_mutex = NULL;
+
+/** Formato de fio de cada tópico configurável */
+static payload_format_t s_payload_format[MQTT_PAYLOAD_MAX] = {
+    [MQTT_PAYLOAD_TELEMETRY] = MQTT_TELEMETRY_FORMAT,
+    [MQTT_PAYLOAD_HEALTH] = MQTT_HEALTH_FORMAT,
+};
+
+/** Tópicos de destino indexados por formato */
+static const char *const s_telemetry_topics[] = {
+    [PAYLOAD_FORMAT_JSON] = MQTT_TOPIC_TELEMETRY,
+    [PAYLOAD_FORMAT_CBOR] = MQTT_TOPIC_TELEMETRY MQTT_TOPIC_SUFFIX_CBOR,
+    [PAYLOAD_FORMAT_BINARY] = MQTT_TOPIC_TELEMETRY MQTT_TOPIC_SUFFIX_BINARY,
+};
+
+static const char *const s_health_topics[] = {
+    [PAYLOAD_FORMAT_JSON] = MQTT_TOPIC_HEALTH,
+    [PAYLOAD_FORMAT_CBOR] = MQTT_TOPIC_HEALTH MQTT_TOPIC_SUFFIX_CBOR,
+    [PAYLOAD_FORMAT_BINARY] = MQTT_TOPIC_HEALTH MQTT_TOPIC_SUFFIX_BINARY,
+};
+
+#ifdef CONFIG_PUBLISH_BENCH
+/** Destino das publicações durante o benchmark (substitui o cliente) */
+static mqtt_bench_sink_t s_bench_sink = NULL;
+#endif
+
 /* Declarações forward de funções privadas */
 
 /* Handlers de eventos */
@@ -75,6 +176,7 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base,
                                int32_t event_id, void *event_data);
 
 /* Funções de inicialização */
+static esp_err_t init_core(void);
 static esp_err_t init_nvs(void);
 static esp_err_t init_wifi(void);
 static esp_err_t init_mqtt(void);
@@ -83,15 +185,43 @@ static esp_err_t create_tasks(void);
 /* Tasks */
 static void telemetry_task(void *pvParameters);
 static void health_monitoring_task(void *pvParameters);
-static void wifi_watchdog_task(void *pvParameters);
+static void connection_task(void *pvParameters);
+static void offline_drain_task(void *pvParameters);
+
+/* Handlers de mensagens recebidas */
+static void on_luminosity_message(const mqtt_message_t *msg, void *ctx);
+static void on_temperature_message(const mqtt_message_t *msg, void *ctx);
+static void on_rules_message(const mqtt_message_t *msg, void *ctx);
 
 /* Funções auxiliares */
-static esp_err_t wait_for_wifi_connection(uint32_t timeout_sec);
-static esp_err_t wait_for_mqtt_connection(uint32_t timeout_sec);
+static bool client_is_ready(void);
+static int client_publish(const char *topic, const char *data, int len, int qos, bool retain);
+static int publish_to_client(const char *topic, const char *data, int len, int qos, bool retain);
+static void wifi_fast_connect_apply(wifi_config_t *wifi_config);
+static void wifi_fast_connect_fallback(void);
+static void wifi_fast_connect_store(const esp_netif_ip_info_t *ip_info);
+static void wifi_fast_connect_renew(void);
+static TickType_t wifi_fast_connect_remaining(void);
+static void wifi_fast_connect_expire(void);
+static mqtt_conn_state_t conn_state_from_bits(EventBits_t bits);
+static void conn_enter_state(mqtt_conn_state_t state);
+static void publish_online(bool *boot_published);
+static void publish_boot_info(void);
+static void reconcile_subscriptions(void);
+static uint32_t boot_ms(void);
+static void notify_ready(bool ready);
+static void mark_first_publish(void);
+static void flush_expired_telemetry(void);
+static void sample_task_stacks(void);
 static esp_err_t init_gpios(void);
 
-static uint64_t s_last_temp_high_time = 0; // Timestamp da última vez que a temperatura esteve acima de 23
-static bool s_ac_on = false; // Estado atual do ar condicionado
+/** Regras padrão: luzes abaixo de 3; ar acima de 23, desliga abaixo de 20 após 10 min */
+static const rule_t s_default_rules[] = {
+    {.channel = RULE_CHANNEL_LUMINOSIDADE, .cmp = RULE_CMP_LT, .threshold = 3,
+     .gpio = GPIO_LIGHTS, .level = 1},
+    {.channel = RULE_CHANNEL_TEMPERATURA, .cmp = RULE_CMP_GT, .threshold = 23,
+     .hysteresis = 3, .hold_ms = 10 * 60 * 1000, .gpio = GPIO_AC, .level = 1},
+};
 
 /* Implementação das funções públicas */
 
@@ -108,119 +238,94 @@ esp_err_t mqtt_system_init(void)
     ESP_LOGI(TAG, "===========================================");
 
     esp_err_t ret;
+    boot_span_id_t span_init = boot_trace_begin("init");
+    boot_span_id_t span;
+
+    if (s_net_events == NULL)
+    {
+#if MEM_STATIC_ALLOCATION
+        static StaticEventGroup_t s_net_events_buf;
+        s_net_events = xEventGroupCreateStatic(&s_net_events_buf);
+#else
+        s_net_events = xEventGroupCreate();
+#endif
+        if (s_net_events == NULL)
+        {
+            ESP_LOGE(TAG, "Falha ao criar event group de rede");
+            return ESP_ERR_NO_MEM;
+        }
+    }
 
     /* Fase 1: Subsistemas base */
     ESP_LOGI(TAG, "FASE 1: Inicializando subsistemas base...");
 
+    span = boot_trace_begin("init.nvs");
     ret = init_nvs();
+    boot_trace_end(span);
     if (ret != ESP_OK)
     {
         ESP_LOGE(TAG, "Falha ao inicializar NVS");
         return ret;
     }
 
+    span = boot_trace_begin("init.offline_q");
+    if (offline_queue_init() != ESP_OK)
+    {
+        ESP_LOGW(TAG, "  Fila offline indisponivel, mensagens offline serao perdidas");
+    }
+    boot_trace_end(span);
+
+    span = boot_trace_begin("init.netif");
     ESP_ERROR_CHECK(esp_netif_init());
+    boot_trace_end(span);
     ESP_LOGI(TAG, "  Netif inicializado");
 
+    span = boot_trace_begin("init.event_loop");
     ESP_ERROR_CHECK(esp_event_loop_create_default());
+    boot_trace_end(span);
     ESP_LOGI(TAG, "  Event loop criado");
 
-    memset(&s_stats, 0, sizeof(mqtt_statistics_t));
-    ESP_LOGI(TAG, "  Estatisticas inicializadas");
-
-    ret = init_gpios();
+    span = boot_trace_begin("init.core");
+    ret = init_core();
+    boot_trace_end(span);
     if (ret != ESP_OK)
     {
-        ESP_LOGE(TAG, "Falha ao inicializar GPIOs");
         return ret;
     }
-    ESP_LOGI(TAG, "  GPIOs inicializados");
-
-    /* Fase 2: WiFi */
-#ifdef CONFIG_QEMU_MODE
-    ESP_LOGW(TAG, "FASE 2: MODO QEMU - WiFi desabilitado");
-    ESP_LOGW(TAG, "  Executando em emulacao, funcionalidades de rede limitadas");
-#else
-    ESP_LOGI(TAG, "FASE 2: Configurando WiFi...");
 
-    ret = init_wifi();
-    if (ret != ESP_OK)
-    {
-        ESP_LOGE(TAG, "Falha ao inicializar WiFi");
-        return ret;
-    }
+    /* Fase 2: Tasks (antes da rede: amostragem e controle local desde t=0) */
+    ESP_LOGI(TAG, "FASE 2: Criando tasks do sistema...");
 
-    ret = wait_for_wifi_connection(30);
+    span = boot_trace_begin("init.tasks");
+    ret = create_tasks();
+    boot_trace_end(span);
     if (ret != ESP_OK)
     {
-        ESP_LOGE(TAG, "Timeout aguardando conexão WiFi");
+        ESP_LOGE(TAG, "Falha ao criar tasks");
         return ret;
     }
-#endif
 
-    /* Fase 3: MQTT */
+    /* Fase 3: WiFi e MQTT seguem na task de conexão */
 #ifdef CONFIG_QEMU_MODE
-    ESP_LOGW(TAG, "FASE 3: MODO QEMU - MQTT desabilitado");
+    ESP_LOGW(TAG, "FASE 3: MODO QEMU - WiFi e MQTT desabilitados");
+    ESP_LOGW(TAG, "  Executando em emulacao, funcionalidades de rede limitadas");
 #else
-    ESP_LOGI(TAG, "FASE 3: Inicializando MQTT...");
-
-    ret = init_mqtt();
-    if (ret != ESP_OK)
-    {
-        ESP_LOGE(TAG, "Falha ao inicializar MQTT");
-        return ret;
-    }
-
-    ret = wait_for_mqtt_connection(20);
-    if (ret != ESP_OK)
-    {
-        ESP_LOGW(TAG, "Timeout MQTT - continuando em modo degradado");
-    }
-
-    // Subscrever aos topicos necessarios
-    if (s_mqtt_connected)
-    {
-        mqtt_subscribe_topic("/casa/externo/luminosidade", 0);
-        mqtt_subscribe_topic("/casa/sala/temperatura", 0);
-    }
+    ESP_LOGI(TAG, "FASE 3: WiFi e MQTT conectando em segundo plano");
 #endif
 
-    /* Fase 4: Tasks */
-    ESP_LOGI(TAG, "FASE 4: Criando tasks da aplicacao...");
-
-    ret = create_tasks();
-    if (ret != ESP_OK)
-    {
-        ESP_LOGE(TAG, "Falha ao criar tasks");
-        return ret;
-    }
-
-
-
-    /* Publicar status online */
-    if (s_mqtt_connected)
-    {
-        mqtt_publish_status(true);
-
-        char boot_info[256];
-        snprintf(boot_info, sizeof(boot_info),
-                 "{\"device\":\"esp32_central\","
-                 "\"firmware\":\"1.0.0\","
-                 "\"reset_reason\":%d,"
-                 "\"free_heap\":%lu,"
-                 "\"idf_version\":\"%s\"}",
-                 esp_reset_reason(),
-                 esp_get_free_heap_size(),
-                 esp_get_idf_version());
-
-        mqtt_publish_data(MQTT_TOPIC_BOOT, boot_info, 0, 1, false);
-    }
-
     s_system_initialized = true;
+    boot_trace_end(span_init);
+
+    /* Daqui em diante, no modo estático, as tasks não devem alocar */
+    mem_budget_log();
+    mem_budget_audit_start();
+#if HEAP_STATS_TRACE_MS > 0
+    heap_stats_trace_start(HEAP_STATS_TRACE_MS);
+#endif
 
     ESP_LOGI(TAG, "");
     ESP_LOGI(TAG, "===========================================");
-    ESP_LOGI(TAG, "  Sistema IoT MQTT Inicializado!");
+    ESP_LOGI(TAG, "  Sistema IoT MQTT Inicializado em %lu ms!", boot_ms());
     ESP_LOGI(TAG, "===========================================");
     ESP_LOGI(TAG, "");
 
@@ -236,9 +341,18 @@ esp_err_t mqtt_system_shutdown(void)
 
     ESP_LOGI(TAG, "Desligando sistema MQTT...");
 
-    /* Publicar offline */
+    /* A máquina de conexão não deve reagir à parada */
+    if (s_task_connection)
+    {
+        task_profile_delete(TASK_ID_CONNECTION);
+        s_task_connection = NULL;
+    }
+    s_conn_state = MQTT_CONN_PARADO;
+
+    /* Publicar lote pendente e offline */
     if (s_mqtt_connected)
     {
+        mqtt_flush_telemetry();
         mqtt_publish_status(false);
         vTaskDelay(pdMS_TO_TICKS(100));
     }
@@ -246,18 +360,19 @@ esp_err_t mqtt_system_shutdown(void)
     /* Parar tasks */
     if (s_task_telemetry)
     {
-        vTaskDelete(s_task_telemetry);
+        sampler_stop(SAMPLER_JOB_TELEMETRY);
+        task_profile_delete(TASK_ID_TELEMETRY);
         s_task_telemetry = NULL;
     }
     if (s_task_health)
     {
-        vTaskDelete(s_task_health);
+        task_profile_delete(TASK_ID_HEALTH);
         s_task_health = NULL;
     }
-    if (s_task_wifi_watchdog)
+    if (s_task_offline_drain)
     {
-        vTaskDelete(s_task_wifi_watchdog);
-        s_task_wifi_watchdog = NULL;
+        task_profile_delete(TASK_ID_OFFLINE_DRAIN);
+        s_task_offline_drain = NULL;
     }
 
     /* Desconectar MQTT */
@@ -281,47 +396,147 @@ bool mqtt_system_is_connected(void)
     return s_mqtt_connected;
 }
 
+mqtt_conn_state_t mqtt_system_get_conn_state(void)
+{
+    return __atomic_load_n(&s_conn_state, __ATOMIC_RELAXED);
+}
+
+esp_err_t mqtt_system_wait_ready(uint32_t timeout_ms)
+{
+    if (s_net_events == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    TickType_t ticks = (timeout_ms == UINT32_MAX) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+    EventBits_t bits = xEventGroupWaitBits(s_net_events, MQTT_CONNECTED_BIT,
+                                           pdFALSE, pdTRUE, ticks);
+
+    return (bits & MQTT_CONNECTED_BIT) ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+esp_err_t mqtt_system_register_ready_callback(mqtt_ready_callback_t callback, void *ctx)
+{
+    if (callback == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = ESP_ERR_NO_MEM;
+    bool ready = false;
+
+    portENTER_CRITICAL(&s_ready_lock);
+    if (s_ready_callback_count < MQTT_READY_MAX_CALLBACKS)
+    {
+        s_ready_callbacks[s_ready_callback_count] = callback;
+        s_ready_ctx[s_ready_callback_count] = ctx;
+        __atomic_store_n(&s_ready_callback_count, s_ready_callback_count + 1, __ATOMIC_RELEASE);
+        ready = s_ready_state;
+        ret = ESP_OK;
+    }
+    portEXIT_CRITICAL(&s_ready_lock);
+
+    /* Registro tardio: informa o estado já notificado. Um notify_ready()
+     * posterior ao lock inclui este callback; um anterior não o inclui */
+    if (ready)
+    {
+        callback(true, ctx);
+    }
+
+    return ret;
+}
+
+esp_err_t mqtt_get_boot_timing(mqtt_boot_timing_t *timing)
+{
+    if (timing == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    timing->wifi_ms = __atomic_load_n(&s_boot_wifi_ms, __ATOMIC_RELAXED);
+    timing->mqtt_ms = __atomic_load_n(&s_boot_mqtt_ms, __ATOMIC_RELAXED);
+    timing->primeira_publicacao_ms = __atomic_load_n(&s_boot_first_publish_ms, __ATOMIC_RELAXED);
+    return ESP_OK;
+}
+
 int mqtt_publish_data(const char *topic, const char *data,
                       int len, int qos, bool retain)
 {
-    if (s_mqtt_client == NULL)
+    if (len == 0)
+    {
+        len = strlen(data);
+    }
+
+    if (!client_is_ready())
     {
-        ESP_LOGE(TAG, "Cliente MQTT nao inicializado");
-        s_stats.falhas_publicacao++;
+        /* Store-and-forward: status retido não faz sentido ser reenviado */
+        if (qos > 0 && !retain && offline_queue_is_ready() &&
+            offline_queue_push(topic, data, len, qos) == ESP_OK)
+        {
+            ESP_LOGD(TAG, "MQTT desconectado, '%s' armazenado na fila offline", topic);
+            return 0;
+        }
+
+        if (s_mqtt_client == NULL)
+        {
+            ESP_LOGW(TAG, "MQTT ainda nao iniciado, '%s' descartado", topic);
+        }
+        else
+        {
+            ESP_LOGW(TAG, "MQTT desconectado, não e possível publicar");
+        }
+        mqtt_stats_add(MQTT_STAT_FALHAS_PUBLICACAO, 1);
         return -1;
     }
 
-    if (!s_mqtt_connected)
+    return publish_to_client(topic, data, len, qos, retain);
+}
+
+int mqtt_publish_routed(const char *topic, const char *data, int len,
+                        int qos, bool retain, mqtt_route_t route)
+{
+    if (topic == NULL || data == NULL || (route & MQTT_ROUTE_ALL) == 0)
     {
-        ESP_LOGW(TAG, "MQTT desconectado, não e possível publicar");
-        s_stats.falhas_publicacao++;
         return -1;
     }
 
+    if ((route & MQTT_ROUTE_LOCAL) == 0)
+    {
+        return mqtt_publish_data(topic, data, len, qos, retain);
+    }
+
     if (len == 0)
     {
         len = strlen(data);
     }
 
-    int msg_id = esp_mqtt_client_publish(s_mqtt_client,
-                                         topic,
-                                         data,
-                                         len,
-                                         qos,
-                                         retain ? 1 : 0);
+    mqtt_message_t msg = {
+        .topic = topic,
+        .topic_len = (int)strlen(topic),
+        .data = data,
+        .data_len = len,
+        .qos = qos,
+        .retain = retain,
+        .timestamp_us = esp_timer_get_time(),
+    };
+
+    local_bus_deliver(&msg);
+    mqtt_stats_add(MQTT_STAT_ENTREGAS_LOCAIS, 1);
 
-    if (msg_id >= 0)
+    if ((route & MQTT_ROUTE_BROKER) == 0 || !client_is_ready())
     {
-        s_stats.total_publicadas++;
-        ESP_LOGD(TAG, "Publicado em '%s' (msg_id=%d, QoS=%d)",
-                 topic, msg_id, qos);
+        return 0;
     }
-    else
+
+    /* Registrada antes do envio: o eco pode chegar antes do retorno. A
+     * cópia do broker não vai para a fila offline: drenada depois do TTL,
+     * o eco seria entregue localmente uma segunda vez */
+    local_bus_mark_forwarded(topic, msg.topic_len, data, len);
+    int msg_id = publish_to_client(topic, data, len, qos, retain);
+    if (msg_id < 0)
     {
-        s_stats.falhas_publicacao++;
-        ESP_LOGE(TAG, "Falha ao publicar em '%s'", topic);
+        local_bus_unmark_forwarded(topic, msg.topic_len, data, len);
     }
-
     return msg_id;
 }
 
@@ -332,55 +547,99 @@ int mqtt_publish_telemetry(const telemetry_data_t *data)
         return -1;
     }
 
-    char buffer[256];
-    snprintf(buffer, sizeof(buffer),
-             "{"
-             "\"temperatura\":%.2f,"
-             "\"umidade\":%.2f,"
-             "\"contador\":%lu,"
-             "\"timestamp\":%llu"
-             "}",
-             data->temperatura,
-             data->umidade,
-             data->contador,
-             data->timestamp);
+#if MQTT_TELEMETRY_BATCH_SIZE > 1
+    if (s_telemetry_mutex == NULL)
+    {
+        return -1;
+    }
+
+    xSemaphoreTake(s_telemetry_mutex, portMAX_DELAY);
+    bool flush_due = telemetry_batch_add(data, esp_timer_get_time() / 1000ULL);
+    xSemaphoreGive(s_telemetry_mutex);
+
+    return flush_due ? mqtt_flush_telemetry() : 0;
+#else
+    payload_format_t format = s_payload_format[MQTT_PAYLOAD_TELEMETRY];
+    uint8_t buffer[128];
+    uint32_t encoded = 0;
+    size_t len = payload_encode_telemetry(format, data, 1, false,
+                                          buffer, sizeof(buffer), &encoded);
+    if (len == 0)
+    {
+        return -1;
+    }
+
+    return mqtt_publish_data(s_telemetry_topics[format], (const char *)buffer,
+                             len, 1, false);
+#endif
+}
+
+int mqtt_flush_telemetry(void)
+{
+    /* Buffers estáticos: lote não cabe na stack das tasks chamadoras */
+    static telemetry_data_t s_batch_samples[TELEMETRY_BATCH_CAPACITY];
+    static uint8_t s_batch_buffer[TELEMETRY_BATCH_BUFFER_SIZE];
+
+    if (s_telemetry_mutex == NULL)
+    {
+        return -1;
+    }
+
+    xSemaphoreTake(s_telemetry_mutex, portMAX_DELAY);
+
+    payload_format_t format = s_payload_format[MQTT_PAYLOAD_TELEMETRY];
+    uint32_t pending = telemetry_batch_snapshot(s_batch_samples, TELEMETRY_BATCH_CAPACITY);
+    uint32_t count = 0;
+    size_t len = payload_encode_telemetry(format, s_batch_samples, pending, true,
+                                          s_batch_buffer, sizeof(s_batch_buffer),
+                                          &count);
+    int msg_id = 0;
+
+    if (count > 0)
+    {
+        msg_id = mqtt_publish_data(s_telemetry_topics[format],
+                                   (const char *)s_batch_buffer, len, 1, false);
+        if (msg_id >= 0)
+        {
+            telemetry_batch_consume(count);
+            ESP_LOGD(TAG, "Lote de telemetria publicado (%lu amostras, %u bytes)",
+                     count, (unsigned)len);
+        }
+    }
+
+    xSemaphoreGive(s_telemetry_mutex);
 
-    return mqtt_publish_data(MQTT_TOPIC_TELEMETRY, buffer, 0, 1, false);
+    return msg_id;
 }
 
 int mqtt_publish_health_check(void)
 {
-    health_status_t health;
+    health_report_t report;
+
+    if (mqtt_get_health_status(&report.health) != ESP_OK)
+    {
+        return -1;
+    }
+
+    mqtt_get_statistics(&report.stats);
+    offline_queue_get_stats(&report.offline);
+    actuator_get_stats(&report.atuacao);
 
-    if (mqtt_get_health_status(&health) != ESP_OK)
+    for (int id = 0; id < TASK_ID_COUNT; id++)
+    {
+        report.stack_livre[id] = __atomic_load_n(&s_stack_livre[id], __ATOMIC_RELAXED);
+    }
+
+    payload_format_t format = s_payload_format[MQTT_PAYLOAD_HEALTH];
+    uint8_t buffer[HEALTH_INFO_MAX_SIZE];
+    size_t len = payload_encode_health(format, &report, buffer, sizeof(buffer));
+    if (len == 0)
     {
         return -1;
     }
 
-    char buffer[512];
-    snprintf(buffer, sizeof(buffer),
-             "{"
-             "\"free_heap\":%lu,"
-             "\"min_free_heap\":%lu,"
-             "\"wifi_rssi\":%d,"
-             "\"uptime_sec\":%llu,"
-             "\"mqtt_connected\":%d,"
-             "\"msgs_sent\":%lu,"
-             "\"msgs_received\":%lu,"
-             "\"mqtt_failures\":%lu,"
-             "\"disconnects\":%lu"
-             "}",
-             health.free_heap,
-             health.min_free_heap,
-             health.wifi_rssi,
-             health.uptime_sec,
-             health.mqtt_connected ? 1 : 0,
-             s_stats.total_publicadas,
-             s_stats.total_recebidas,
-             s_stats.falhas_publicacao,
-             s_stats.desconexoes);
-
-    return mqtt_publish_data(MQTT_TOPIC_HEALTH, buffer, 0, 0, false);
+    return mqtt_publish_data(s_health_topics[format], (const char *)buffer,
+                             len, 0, false);
 }
 
 int mqtt_publish_status(bool online)
@@ -389,44 +648,108 @@ int mqtt_publish_status(bool online)
     return mqtt_publish_data(MQTT_TOPIC_STATUS, status, 0, 1, true);
 }
 
+esp_err_t mqtt_set_payload_format(mqtt_payload_topic_t topic, payload_format_t format)
+{
+    if (topic >= MQTT_PAYLOAD_MAX || format > PAYLOAD_FORMAT_BINARY)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (topic == MQTT_PAYLOAD_TELEMETRY && s_telemetry_mutex != NULL)
+    {
+        /* Lote pendente é publicado no formato anterior */
+        mqtt_flush_telemetry();
+    }
+
+    s_payload_format[topic] = format;
+    return ESP_OK;
+}
+
 int mqtt_subscribe_topic(const char *topic, int qos)
 {
-    if (s_mqtt_client == NULL || !s_mqtt_connected)
+    esp_err_t ret = sub_registry_add(topic, qos);
+    if (ret != ESP_OK)
     {
+        ESP_LOGE(TAG, "Falha ao registrar subscricao em '%s': %s",
+                 topic ? topic : "(null)", esp_err_to_name(ret));
         return -1;
     }
 
-    int msg_id = esp_mqtt_client_subscribe(s_mqtt_client, topic, qos);
+    if (s_net_events != NULL)
+    {
+        xEventGroupSetBits(s_net_events, NET_CHANGED_BIT);
+    }
+    return 0;
+}
 
-    if (msg_id >= 0)
+int mqtt_unsubscribe_topic(const char *topic)
+{
+    if (sub_registry_remove(topic) != ESP_OK)
     {
-        ESP_LOGI(TAG, "Subscrito em '%s' (QoS=%d, msg_id=%d)",
-                 topic, qos, msg_id);
+        return -1;
     }
-    else
+
+    if (s_net_events != NULL)
     {
-        ESP_LOGE(TAG, "Falha ao subscrever em '%s'", topic);
+        xEventGroupSetBits(s_net_events, NET_CHANGED_BIT);
     }
+    return 0;
+}
 
-    return msg_id;
+esp_err_t mqtt_register_handler(const char *topic_filter,
+                                mqtt_message_handler_t callback, void *ctx)
+{
+    return mqtt_dispatch_register(topic_filter, callback, ctx);
 }
 
-int mqtt_unsubscribe_topic(const char *topic)
+esp_err_t mqtt_unregister_handler(const char *topic_filter,
+                                  mqtt_message_handler_t callback)
+{
+    return mqtt_dispatch_unregister(topic_filter, callback);
+}
+
+bool mqtt_message_to_int(const mqtt_message_t *msg, int32_t *value)
 {
-    if (s_mqtt_client == NULL || !s_mqtt_connected)
+    const char *p = msg->data;
+    const char *end = msg->data + msg->data_len;
+
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n'))
     {
-        return -1;
+        p++;
+    }
+    while (end > p && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r' || end[-1] == '\n'))
+    {
+        end--;
     }
 
-    int msg_id = esp_mqtt_client_unsubscribe(s_mqtt_client, topic);
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+    {
+        negative = (*p == '-');
+        p++;
+    }
 
-    if (msg_id >= 0)
+    if (p == end)
     {
-        ESP_LOGI(TAG, "Cancelada subscricao em '%s' (msg_id=%d)",
-                 topic, msg_id);
+        return false;
     }
 
-    return msg_id;
+    int64_t result = 0;
+    for (; p < end; p++)
+    {
+        if (*p < '0' || *p > '9')
+        {
+            return false;
+        }
+        result = result * 10 + (*p - '0');
+        if (result > INT32_MAX)
+        {
+            return false;
+        }
+    }
+
+    *value = (int32_t)(negative ? -result : result);
+    return true;
 }
 
 esp_err_t mqtt_get_statistics(mqtt_statistics_t *stats)
@@ -436,23 +759,74 @@ esp_err_t mqtt_get_statistics(mqtt_statistics_t *stats)
         return ESP_ERR_INVALID_ARG;
     }
 
-    memcpy(stats, &s_stats, sizeof(mqtt_statistics_t));
+    mqtt_statistics64_t wide;
+    mqtt_get_statistics64(&wide);
+
+    /* Formato de 32 bits do payload de health: mantém os bits baixos */
+    stats->total_publicadas = (uint32_t)wide.total_publicadas;
+    stats->total_recebidas = (uint32_t)wide.total_recebidas;
+    stats->falhas_publicacao = (uint32_t)wide.falhas_publicacao;
+    stats->desconexoes = (uint32_t)wide.desconexoes;
+    stats->tempo_desconectado_ms = (uint32_t)wide.tempo_desconectado_ms;
+    stats->ultima_mensagem_ts = wide.ultima_mensagem_ts;
+    stats->ack_amostras = wide.ack_latencia.amostras;
+    stats->ack_p50_us = wide.ack_latencia.p50_us;
+    stats->ack_p95_us = wide.ack_latencia.p95_us;
+    stats->ack_p99_us = wide.ack_latencia.p99_us;
+    stats->ack_max_us = wide.ack_latencia.max_us;
+    stats->ack_perdidos = (uint32_t)wide.ack_perdidos;
+    stats->entregas_locais = (uint32_t)wide.entregas_locais;
+    stats->ecos_suprimidos = (uint32_t)wide.ecos_suprimidos;
     return ESP_OK;
 }
 
-void mqtt_reset_statistics(void)
+esp_err_t mqtt_get_statistics64(mqtt_statistics64_t *stats)
 {
-    uint32_t desconexoes = s_stats.desconexoes;
-    uint32_t tempo_desconectado = s_stats.tempo_desconectado_ms;
+    if (stats == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
 
-    memset(&s_stats, 0, sizeof(mqtt_statistics_t));
+    uint64_t totals[MQTT_STAT_COUNT];
+    mqtt_stats_snapshot(totals, &stats->ultima_mensagem_ts);
+
+    stats->total_publicadas = totals[MQTT_STAT_PUBLICADAS];
+    stats->total_recebidas = totals[MQTT_STAT_RECEBIDAS];
+    stats->falhas_publicacao = totals[MQTT_STAT_FALHAS_PUBLICACAO];
+    stats->desconexoes = totals[MQTT_STAT_DESCONEXOES];
+    stats->tempo_desconectado_ms = totals[MQTT_STAT_TEMPO_DESCONECTADO_MS];
+    stats->ack_perdidos = totals[MQTT_STAT_ACK_PERDIDOS];
+    mqtt_stats_ack_latency(&stats->ack_latencia);
+    stats->entregas_locais = totals[MQTT_STAT_ENTREGAS_LOCAIS];
+    stats->ecos_suprimidos = totals[MQTT_STAT_ECOS_SUPRIMIDOS];
+    return ESP_OK;
+}
 
-    s_stats.desconexoes = desconexoes;
-    s_stats.tempo_desconectado_ms = tempo_desconectado;
+void mqtt_reset_statistics(void)
+{
+    /* Desconexões e tempo desconectado são preservados */
+    mqtt_stats_reset(MQTT_STAT_BIT(MQTT_STAT_PUBLICADAS) |
+                     MQTT_STAT_BIT(MQTT_STAT_RECEBIDAS) |
+                     MQTT_STAT_BIT(MQTT_STAT_FALHAS_PUBLICACAO) |
+                     MQTT_STAT_BIT(MQTT_STAT_ACK_PERDIDOS) |
+                     MQTT_STAT_BIT(MQTT_STAT_ENTREGAS_LOCAIS) |
+                     MQTT_STAT_BIT(MQTT_STAT_ECOS_SUPRIMIDOS));
+    mqtt_stats_ack_reset();
 
     ESP_LOGI(TAG, "Estatisticas resetadas");
 }
 
+esp_err_t mqtt_get_offline_queue_stats(offline_queue_stats_t *stats)
+{
+    if (stats == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    offline_queue_get_stats(stats);
+    return ESP_OK;
+}
+
 esp_err_t mqtt_get_health_status(health_status_t *health)
 {
     if (health == NULL)
@@ -464,6 +838,8 @@ esp_err_t mqtt_get_health_status(health_status_t *health)
     health->min_free_heap = esp_get_minimum_free_heap_size();
     health->uptime_sec = esp_timer_get_time() / 1000000ULL;
     health->mqtt_connected = s_mqtt_connected;
+    cpu_stats_get(&health->cpu);
+    heap_stats_get(&health->heap);
 
 #ifndef CONFIG_QEMU_MODE
     esp_wifi_sta_get_rssi(&health->wifi_rssi);
@@ -476,29 +852,170 @@ esp_err_t mqtt_get_health_status(health_status_t *health)
 
 void mqtt_print_statistics(void)
 {
+    mqtt_statistics64_t stats;
+    mqtt_get_statistics64(&stats);
+
     ESP_LOGI(TAG, "=== Estatisticas MQTT ===");
-    ESP_LOGI(TAG, "Publicadas   : %lu", s_stats.total_publicadas);
-    ESP_LOGI(TAG, "Recebidas    : %lu", s_stats.total_recebidas);
-    ESP_LOGI(TAG, "Falhas       : %lu", s_stats.falhas_publicacao);
-    ESP_LOGI(TAG, "Desconexoes  : %lu", s_stats.desconexoes);
-    ESP_LOGI(TAG, "Tempo offline: %lu ms", s_stats.tempo_desconectado_ms);
+    ESP_LOGI(TAG, "Publicadas   : %llu", (unsigned long long)stats.total_publicadas);
+    ESP_LOGI(TAG, "Recebidas    : %llu", (unsigned long long)stats.total_recebidas);
+    ESP_LOGI(TAG, "Falhas       : %llu", (unsigned long long)stats.falhas_publicacao);
+    ESP_LOGI(TAG, "Desconexoes  : %llu", (unsigned long long)stats.desconexoes);
+    ESP_LOGI(TAG, "Tempo offline: %llu ms", (unsigned long long)stats.tempo_desconectado_ms);
+    ESP_LOGI(TAG, "ACK (QoS>=1) : n=%lu p50=%lu p95=%lu p99=%lu max=%lu us, %llu sem par",
+             stats.ack_latencia.amostras, stats.ack_latencia.p50_us,
+             stats.ack_latencia.p95_us, stats.ack_latencia.p99_us,
+             stats.ack_latencia.max_us, (unsigned long long)stats.ack_perdidos);
+    ESP_LOGI(TAG, "Locais       : %llu entregues, %llu ecos suprimidos",
+             (unsigned long long)stats.entregas_locais,
+             (unsigned long long)stats.ecos_suprimidos);
+
+    actuator_stats_t actuation;
+    actuator_get_stats(&actuation);
+    ESP_LOGI(TAG, "Atuacao      : n=%lu p50=%lu p95=%lu p99=%lu max=%lu us, %lu descartados",
+             actuation.latencia.amostras, actuation.latencia.p50_us,
+             actuation.latencia.p95_us, actuation.latencia.p99_us,
+             actuation.latencia.max_us, actuation.descartados);
+
+    offline_queue_stats_t offline;
+    offline_queue_get_stats(&offline);
+    ESP_LOGI(TAG, "Fila offline : %lu msgs (%lu bytes), %lu descartadas",
+             offline.profundidade, offline.bytes, offline.descartadas);
     ESP_LOGI(TAG, "========================");
 }
 
-/* Implementação das funções privadas */
-
-static esp_err_t init_nvs(void)
+#ifdef CONFIG_PUBLISH_BENCH
+esp_err_t mqtt_bench_attach(mqtt_bench_sink_t sink)
 {
-    ESP_LOGI(TAG, "  -> Inicializando NVS...");
-
-    esp_err_t ret = nvs_flash_init();
-
-    if (ret == ESP_ERR_NVS_NO_FREE_PAGES ||
-        ret == ESP_ERR_NVS_NEW_VERSION_FOUND)
+    if (sink != NULL && !s_system_initialized && s_telemetry_mutex == NULL)
     {
-        ESP_LOGW(TAG, "  NVS corrompido, apagando...");
-        ESP_ERROR_CHECK(nvs_flash_erase());
-        ret = nvs_flash_init();
+        esp_err_t ret = init_core();
+        if (ret != ESP_OK)
+        {
+            return ret;
+        }
+    }
+
+    s_bench_sink = sink;
+    return ESP_OK;
+}
+
+void mqtt_bench_inject_data(const char *topic, const char *data, int len)
+{
+    esp_mqtt_event_t event = {
+        .event_id = MQTT_EVENT_DATA,
+        .client = s_mqtt_client,
+        .topic = (char *)topic,
+        .topic_len = (int)strlen(topic),
+        .data = (char *)data,
+        .data_len = len,
+        .total_data_len = len,
+        .qos = 1,
+    };
+    mqtt_event_handler(NULL, "MQTT_EVENTS", MQTT_EVENT_DATA, &event);
+}
+#endif
+
+/* Implementação das funções privadas */
+
+/**
+ * @brief Estado base independente de rede: estatísticas, lote de
+ *        telemetria, GPIOs e handlers das mensagens recebidas.
+ */
+static esp_err_t init_core(void)
+{
+    mqtt_stats_reset(UINT32_MAX);
+    s_disconnected_since_ms = 0;
+    ESP_LOGI(TAG, "  Estatisticas inicializadas");
+
+    if (s_telemetry_mutex == NULL)
+    {
+#if MEM_STATIC_ALLOCATION
+        static StaticSemaphore_t s_telemetry_mutex_buf;
+        s_telemetry_mutex = xSemaphoreCreateMutexStatic(&s_telemetry_mutex_buf);
+#else
+        s_telemetry_mutex = xSemaphoreCreateMutex();
+#endif
+        if (s_telemetry_mutex == NULL)
+        {
+            ESP_LOGE(TAG, "Falha ao criar mutex de telemetria");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    telemetry_batch_reset();
+
+    boot_span_id_t span = boot_trace_begin("init.core.gpio");
+    esp_err_t ret = init_gpios();
+    boot_trace_end(span);
+    if (ret != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Falha ao inicializar GPIOs");
+        return ret;
+    }
+    ESP_LOGI(TAG, "  GPIOs inicializados");
+
+    span = boot_trace_begin("init.core.log");
+    ret = deferred_log_init();
+    boot_trace_end(span);
+    if (ret != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Falha ao criar task de log diferido");
+        return ret;
+    }
+    ESP_LOGI(TAG, "  Log diferido inicializado");
+
+    span = boot_trace_begin("init.core.atuador");
+    ret = actuator_init();
+    boot_trace_end(span);
+    if (ret != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Falha ao criar task de atuacao");
+        return ret;
+    }
+    ESP_LOGI(TAG, "  Task de atuacao criada");
+
+    span = boot_trace_begin("init.core.regras");
+    ret = rule_engine_init((1ULL << GPIO_LIGHTS) | (1ULL << GPIO_AC), s_default_rules,
+                           sizeof(s_default_rules) / sizeof(s_default_rules[0]));
+    boot_trace_end(span);
+    if (ret != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Falha ao carregar regras padrao");
+        return ret;
+    }
+    ESP_LOGI(TAG, "  Motor de regras inicializado");
+
+    ret = local_bus_init();
+    if (ret != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Falha ao criar barramento local");
+        return ret;
+    }
+
+    mqtt_register_handler(MQTT_TOPIC_LUMINOSITY, on_luminosity_message, NULL);
+    mqtt_register_handler(MQTT_TOPIC_TEMPERATURE, on_temperature_message, NULL);
+    mqtt_register_handler(MQTT_TOPIC_CONFIG_RULES, on_rules_message, NULL);
+    ESP_LOGI(TAG, "  Handlers de mensagens registrados");
+
+    /* Conjunto desejado; enviado em um único SUBSCRIBE ao conectar */
+    mqtt_subscribe_topic(MQTT_TOPIC_LUMINOSITY, 1);
+    mqtt_subscribe_topic(MQTT_TOPIC_TEMPERATURE, 1);
+    mqtt_subscribe_topic(MQTT_TOPIC_CONFIG_RULES, 1);
+
+    return ESP_OK;
+}
+
+static esp_err_t init_nvs(void)
+{
+    ESP_LOGI(TAG, "  -> Inicializando NVS...");
+
+    esp_err_t ret = nvs_flash_init();
+
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES ||
+        ret == ESP_ERR_NVS_NEW_VERSION_FOUND)
+    {
+        ESP_LOGW(TAG, "  NVS corrompido, apagando...");
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        ret = nvs_flash_init();
     }
 
     if (ret == ESP_OK)
@@ -511,7 +1028,7 @@ static esp_err_t init_nvs(void)
 
 static esp_err_t init_wifi(void)
 {
-    esp_netif_create_default_wifi_sta();
+    s_sta_netif = esp_netif_create_default_wifi_sta();
 
     wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
     ESP_ERROR_CHECK(esp_wifi_init(&cfg));
@@ -537,6 +1054,8 @@ static esp_err_t init_wifi(void)
         },
     };
 
+    wifi_fast_connect_apply(&wifi_config);
+
     ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
     ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &wifi_config));
     ESP_ERROR_CHECK(esp_wifi_start());
@@ -564,7 +1083,7 @@ static esp_err_t init_mqtt(void)
         .session.last_will.retain = 1,
 
         .session.keepalive = MQTT_KEEPALIVE_SEC,
-        .session.disable_clean_session = false,
+        .session.disable_clean_session = MQTT_PERSISTENT_SESSION,
         .network.timeout_ms = MQTT_TIMEOUT_MS,
 
         .buffer.size = MQTT_BUFFER_SIZE,
@@ -610,104 +1129,443 @@ static esp_err_t init_mqtt(void)
 
 static esp_err_t create_tasks(void)
 {
-    BaseType_t ret;
+    esp_err_t ret;
+
+    ESP_LOGI(TAG, "  Perfil de escalonamento: %s", task_profile_name());
+
+    /* Nenhuma stack é conhecida até a primeira amostra da task de health */
+    sample_task_stacks();
 
-    ret = xTaskCreate(telemetry_task, "Telemetry",
-                      4096, NULL, 5, &s_task_telemetry);
-    if (ret != pdPASS)
+    ret = task_profile_create(TASK_ID_TELEMETRY, telemetry_task, NULL, &s_task_telemetry);
+    if (ret != ESP_OK)
     {
         ESP_LOGE(TAG, "  Falha ao criar task de telemetria");
         return ESP_FAIL;
     }
     ESP_LOGI(TAG, "  Task de telemetria criada");
 
-    ret = xTaskCreate(health_monitoring_task, "HealthMon",
-                      3072, NULL, 3, &s_task_health);
-    if (ret != pdPASS)
+    ret = task_profile_create(TASK_ID_HEALTH, health_monitoring_task, NULL, &s_task_health);
+    if (ret != ESP_OK)
     {
         ESP_LOGE(TAG, "  Falha ao criar task de health");
         return ESP_FAIL;
     }
     ESP_LOGI(TAG, "  Task de health criada");
 
+    if (offline_queue_is_ready())
+    {
+        ret = task_profile_create(TASK_ID_OFFLINE_DRAIN, offline_drain_task, NULL,
+                                  &s_task_offline_drain);
+        if (ret != ESP_OK)
+        {
+            ESP_LOGE(TAG, "  Falha ao criar task de fila offline");
+            return ESP_FAIL;
+        }
+        ESP_LOGI(TAG, "  Task de fila offline criada");
+    }
+
 #ifndef CONFIG_QEMU_MODE
-    ret = xTaskCreate(wifi_watchdog_task, "WiFiWatchdog",
-                      2048, NULL, 4, &s_task_wifi_watchdog);
-    if (ret != pdPASS)
+    ret = task_profile_create(TASK_ID_CONNECTION, connection_task, NULL, &s_task_connection);
+    if (ret != ESP_OK)
     {
-        ESP_LOGE(TAG, "  Falha ao criar task de watchdog");
+        ESP_LOGE(TAG, "  Falha ao criar task de conexao");
         return ESP_FAIL;
     }
-    ESP_LOGI(TAG, "  Task de watchdog criada");
+    ESP_LOGI(TAG, "  Task de conexao criada");
 #else
-    ESP_LOGI(TAG, "  Task de watchdog ignorada (modo QEMU)");
+    ESP_LOGI(TAG, "  Task de conexao ignorada (modo QEMU)");
 #endif
 
     return ESP_OK;
 }
 
-static esp_err_t wait_for_wifi_connection(uint32_t timeout_sec)
+/**
+ * @brief Estado correspondente aos bits de prontidão.
+ */
+static mqtt_conn_state_t conn_state_from_bits(EventBits_t bits)
 {
-    ESP_LOGI(TAG, "  Aguardando conexão WiFi...");
+    if (bits & MQTT_CONNECTED_BIT)
+    {
+        return MQTT_CONN_ONLINE;
+    }
+    if (bits & WIFI_CONNECTED_BIT)
+    {
+        return MQTT_CONN_MQTT_CONECTANDO;
+    }
+    return (bits & WIFI_FAIL_BIT) ? MQTT_CONN_WIFI_FALHA : MQTT_CONN_WIFI_CONECTANDO;
+}
 
-    uint32_t count = 0;
-    wifi_ap_record_t ap_info;
+/**
+ * @brief Ações de entrada de cada estado (executadas na task de conexão).
+ */
+static void conn_enter_state(mqtt_conn_state_t state)
+{
+    __atomic_store_n(&s_conn_state, state, __ATOMIC_RELAXED);
 
-    while (count < timeout_sec)
+    switch (state)
     {
-        if (esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK)
+    case MQTT_CONN_WIFI_FALHA:
+        ESP_LOGW(TAG, "WiFi indisponivel, nova tentativa em %d ms", WIFI_WATCHDOG_INTERVAL_MS);
+        break;
+
+    case MQTT_CONN_MQTT_CONECTANDO:
+        /* O cliente só é criado com IP; depois ele mesmo reconecta */
+        if (s_mqtt_client == NULL)
         {
-            ESP_LOGI(TAG, "  WiFi conectado!");
+            ESP_LOGI(TAG, "WiFi conectado em %lu ms, iniciando MQTT...", s_boot_wifi_ms);
+            boot_span_id_t span = boot_trace_begin("mqtt.init");
+            esp_err_t ret = init_mqtt();
+            boot_trace_end(span);
 
-            esp_netif_t *netif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
-            if (netif != NULL)
+            if (ret != ESP_OK)
             {
-                esp_netif_ip_info_t ip_info;
-                if (esp_netif_get_ip_info(netif, &ip_info) == ESP_OK)
-                {
-                    ESP_LOGI(TAG, "  IP: " IPSTR, IP2STR(&ip_info.ip));
-                }
+                ESP_LOGE(TAG, "Falha ao inicializar MQTT, nova tentativa em %d ms",
+                         WIFI_WATCHDOG_INTERVAL_MS);
+            }
+            else if (s_boot_mqtt_ms == 0)
+            {
+                s_span_mqtt_conexao = boot_trace_begin("mqtt.conexao");
             }
-
-            return ESP_OK;
         }
+        break;
 
-        vTaskDelay(pdMS_TO_TICKS(1000));
-        count++;
+    case MQTT_CONN_ONLINE:
+        wifi_fast_connect_renew();
+        reconcile_subscriptions();
+        break;
+
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief Publica "online" (e o boot, uma vez) após um CONNACK.
+ *
+ * O LWT pode ter deixado "offline" retido no broker. Chamada a cada CONNACK
+ * (s_mqtt_connect_count), e não só na entrada em MQTT_CONN_ONLINE: uma
+ * reconexão completa entre duas leituras dos bits mantém o estado ONLINE.
+ */
+static void publish_online(bool *boot_published)
+{
+    mqtt_publish_status(true);
+    if (!*boot_published)
+    {
+        ESP_LOGI(TAG, "MQTT conectado em %lu ms", s_boot_mqtt_ms);
+        publish_boot_info();
+        *boot_published = true;
+    }
+}
+
+static void publish_boot_info(void)
+{
+    /* Estático: publicado uma vez, fora da stack da task de conexão */
+    static char s_boot_info[BOOT_INFO_MAX_SIZE];
+
+    mqtt_boot_timing_t timing;
+    mqtt_get_boot_timing(&timing);
+
+    int len = snprintf(s_boot_info, sizeof(s_boot_info),
+                       "{\"device\":\"esp32_central\","
+                       "\"firmware\":\"1.0.0\","
+                       "\"reset_reason\":%d,"
+                       "\"free_heap\":%lu,"
+                       "\"idf_version\":\"%s\","
+                       "\"wifi_ms\":%lu,"
+                       "\"mqtt_ms\":%lu,"
+                       "\"first_pub_ms\":%lu,"
+                       "\"sched\":\"%s\","
+                       "\"trace\":",
+                       esp_reset_reason(),
+                       esp_get_free_heap_size(),
+                       esp_get_idf_version(),
+                       timing.wifi_ms,
+                       timing.mqtt_ms,
+                       timing.primeira_publicacao_ms,
+                       task_profile_name());
+
+    /* Reserva o '}' final */
+    len += boot_trace_to_json(s_boot_info + len, sizeof(s_boot_info) - len - 1);
+    s_boot_info[len++] = '}';
+    s_boot_info[len] = '\0';
+
+    mqtt_publish_data(MQTT_TOPIC_BOOT, s_boot_info, len, 1, false);
+}
+
+/**
+ * @brief Envia a diferença entre o conjunto desejado e o confirmado.
+ *
+ * Executa só na task de conexão: os pendentes saem em um único SUBSCRIBE
+ * e as remoções em UNSUBSCRIBEs individuais.
+ */
+static void reconcile_subscriptions(void)
+{
+    esp_mqtt_topic_t list[SUB_REGISTRY_MAX_TOPICS];
+    int count = sub_registry_begin_subscribe(list, SUB_REGISTRY_MAX_TOPICS);
+
+    if (count > 0)
+    {
+        int msg_id = esp_mqtt_client_subscribe_multiple(s_mqtt_client, list, count);
+        sub_registry_end_subscribe(msg_id);
+
+        if (msg_id >= 0)
+        {
+            ESP_LOGI(TAG, "SUBSCRIBE com %d topicos (msg_id=%d)", count, msg_id);
+        }
+        else
+        {
+            ESP_LOGW(TAG, "Falha ao enviar SUBSCRIBE com %d topicos", count);
+        }
+    }
 
-        if (count % 5 == 0)
+    char filter[SUB_REGISTRY_MAX_FILTER];
+    while (sub_registry_next_removal(filter, sizeof(filter)))
+    {
+        if (esp_mqtt_client_unsubscribe(s_mqtt_client, filter) < 0)
         {
-            ESP_LOGI(TAG, "  Aguardando... (%lu s)", count);
+            break; // Desconectado: tenta de novo na próxima conexão
         }
+        sub_registry_removal_done(filter);
+        ESP_LOGI(TAG, "Cancelada subscricao em '%s'", filter);
     }
+}
 
-    return ESP_ERR_TIMEOUT;
+/** Milissegundos desde o boot, nunca 0 (0 marca "ainda não aconteceu") */
+static uint32_t boot_ms(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000) | 1;
 }
 
-static esp_err_t wait_for_mqtt_connection(uint32_t timeout_sec)
+static void notify_ready(bool ready)
 {
-    ESP_LOGI(TAG, "  Aguardando conexão MQTT...");
+    portENTER_CRITICAL(&s_ready_lock);
+    s_ready_state = ready;
+    uint32_t count = s_ready_callback_count;
+    portEXIT_CRITICAL(&s_ready_lock);
 
-    uint32_t count = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        s_ready_callbacks[i](ready, s_ready_ctx[i]);
+    }
+}
 
-    while (!s_mqtt_connected && count < timeout_sec)
+static void mark_first_publish(void)
+{
+    uint32_t expected = 0;
+    uint32_t now = boot_ms();
+
+    if (__atomic_compare_exchange_n(&s_boot_first_publish_ms, &expected, now, false,
+                                    __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+        ESP_LOGI(TAG, "Primeira publicacao %lu ms apos o boot (WiFi %lu ms, MQTT %lu ms)",
+                 now, s_boot_wifi_ms, s_boot_mqtt_ms);
+    }
+}
+
+/**
+ * @brief Publica o lote parcial cuja amostra mais antiga venceu
+ *        MQTT_TELEMETRY_BATCH_MAX_AGE_MS.
+ *
+ * telemetry_batch_add() só confere a idade quando recebe uma amostra; com
+ * o report-by-exception suprimindo leituras, o lote esperaria a próxima
+ * amostra reportada (até o heartbeat).
+ */
+static void flush_expired_telemetry(void)
+{
+#if MQTT_TELEMETRY_BATCH_SIZE > 1
+    if (s_telemetry_mutex == NULL)
     {
-        vTaskDelay(pdMS_TO_TICKS(1000));
-        count++;
+        return;
+    }
+
+    xSemaphoreTake(s_telemetry_mutex, portMAX_DELAY);
+    bool vencido = telemetry_batch_expired(esp_timer_get_time() / 1000ULL);
+    xSemaphoreGive(s_telemetry_mutex);
 
-        if (count % 5 == 0)
+    if (vencido)
+    {
+        mqtt_flush_telemetry();
+    }
+#endif
+}
+
+/**
+ * @brief Atualiza s_stack_livre com a marca de stack livre de cada task.
+ *
+ * uxTaskGetStackHighWaterMark() varre a stack de cada task: fica na
+ * cadência da task de health, fora do caminho de publicação.
+ */
+static void sample_task_stacks(void)
+{
+    for (int id = 0; id < TASK_ID_COUNT; id++)
+    {
+        task_stack_info_t info;
+        task_profile_get_stack(id, &info);
+
+        uint16_t livre = PAYLOAD_STACK_AUSENTE;
+        if (info.ativa)
         {
-            ESP_LOGI(TAG, "  Aguardando... (%lu s)", count);
+            livre = (info.livre_min < PAYLOAD_STACK_AUSENTE) ? (uint16_t)info.livre_min
+                                                             : PAYLOAD_STACK_AUSENTE - 1;
         }
+        __atomic_store_n(&s_stack_livre[id], livre, __ATOMIC_RELAXED);
     }
+}
 
-    if (s_mqtt_connected)
+static void wifi_fast_connect_apply(wifi_config_t *wifi_config)
+{
+#if WIFI_FAST_CONNECT
+    wifi_cache_t cache;
+    if (wifi_cache_load(CONFIG_WIFI_SSID, &cache) != ESP_OK)
     {
-        ESP_LOGI(TAG, "  MQTT conectado!");
-        return ESP_OK;
+        ESP_LOGI(TAG, "  Sem cache de conexao rapida, varredura completa");
+        return;
+    }
+
+    wifi_config->sta.channel = cache.channel;
+    memcpy(wifi_config->sta.bssid, cache.bssid, sizeof(cache.bssid));
+    wifi_config->sta.bssid_set = true;
+    s_wifi_fast_attempt = true;
+
+#if WIFI_FAST_CONNECT_REUSE_IP
+    if (cache.ip != 0 && esp_netif_dhcpc_stop(s_sta_netif) == ESP_OK)
+    {
+        esp_netif_ip_info_t ip_info = {
+            .ip.addr = cache.ip,
+            .netmask.addr = cache.netmask,
+            .gw.addr = cache.gw,
+        };
+        esp_netif_set_ip_info(s_sta_netif, &ip_info);
+
+        if (cache.dns != 0)
+        {
+            esp_netif_dns_info_t dns = {0};
+            dns.ip.type = ESP_IPADDR_TYPE_V4;
+            dns.ip.u_addr.ip4.addr = cache.dns;
+            esp_netif_set_dns_info(s_sta_netif, ESP_NETIF_DNS_MAIN, &dns);
+        }
+        s_wifi_static_ip = true;
+    }
+#endif
+
+    ESP_LOGI(TAG, "  Conexao rapida: canal %u, BSSID " MACSTR "%s",
+             cache.channel, MAC2STR(cache.bssid),
+             s_wifi_static_ip ? ", IP do cache" : "");
+#else
+    (void)wifi_config;
+#endif
+}
+
+/**
+ * @brief Descarta o cache e volta à associação padrão (varredura + DHCP).
+ *
+ * Chamado com a estação desassociada: na primeira falha da conexão rápida
+ * e em qualquer queda enquanto o IP do cache está em uso, para que o
+ * endereço volte a ser negociado na próxima associação.
+ */
+static void wifi_fast_connect_fallback(void)
+{
+    if (s_wifi_fast_attempt)
+    {
+        s_wifi_fast_attempt = false;
+        wifi_cache_erase();
+
+        wifi_config_t wifi_config;
+        if (esp_wifi_get_config(WIFI_IF_STA, &wifi_config) == ESP_OK)
+        {
+            wifi_config.sta.channel = 0;
+            wifi_config.sta.bssid_set = false;
+            esp_wifi_set_config(WIFI_IF_STA, &wifi_config);
+        }
+    }
+
+    s_wifi_static_pending = false;
+    if (s_wifi_static_ip)
+    {
+        s_wifi_static_ip = false;
+        esp_netif_dhcpc_start(s_sta_netif);
+    }
+}
+
+static void wifi_fast_connect_store(const esp_netif_ip_info_t *ip_info)
+{
+#if WIFI_FAST_CONNECT
+    wifi_cache_t cache = s_wifi_link;
+
+#if WIFI_FAST_CONNECT_REUSE_IP
+    cache.ip = ip_info->ip.addr;
+    cache.netmask = ip_info->netmask.addr;
+    cache.gw = ip_info->gw.addr;
+
+    esp_netif_dns_info_t dns;
+    if (esp_netif_get_dns_info(s_sta_netif, ESP_NETIF_DNS_MAIN, &dns) == ESP_OK &&
+        dns.ip.type == ESP_IPADDR_TYPE_V4)
+    {
+        cache.dns = dns.ip.u_addr.ip4.addr;
+    }
+#else
+    (void)ip_info;
+#endif
+
+    if (cache.channel != 0)
+    {
+        wifi_cache_save(CONFIG_WIFI_SSID, &cache);
     }
+#else
+    (void)ip_info;
+#endif
+}
+
+/**
+ * @brief Devolve o endereço do cache ao DHCP depois do CONNACK.
+ *
+ * O CONNACK prova que o endereço ainda funciona; o DHCP volta a rodar para
+ * renovar o lease, e o servidor não entrega o IP a outro equipamento. Em
+ * geral o servidor confirma o mesmo endereço e a sessão TCP continua; se
+ * entregar outro, o cliente MQTT reconecta com ele e o novo
+ * IP_EVENT_STA_GOT_IP regrava o cache.
+ */
+static void wifi_fast_connect_renew(void)
+{
+    if (s_wifi_static_ip)
+    {
+        s_wifi_static_ip = false;
+        s_wifi_static_pending = false;
+        ESP_LOGI(TAG, "Renovando no DHCP o IP do cache");
+        esp_netif_dhcpc_start(s_sta_netif);
+    }
+}
 
-    return ESP_ERR_TIMEOUT;
+/**
+ * @brief Ticks restantes para o CONNACK com o IP do cache.
+ * @return portMAX_DELAY sem prazo em curso, 0 se o prazo venceu.
+ */
+static TickType_t wifi_fast_connect_remaining(void)
+{
+    if (!s_wifi_static_ip || !s_wifi_static_pending)
+    {
+        return portMAX_DELAY;
+    }
+
+    TickType_t elapsed = xTaskGetTickCount() - s_wifi_static_since;
+    TickType_t timeout = pdMS_TO_TICKS(WIFI_FAST_CONNECT_MQTT_TIMEOUT_MS);
+    return (elapsed < timeout) ? timeout - elapsed : 0;
+}
+
+/**
+ * @brief Sem CONNACK no prazo: o IP do cache provavelmente não vale mais.
+ *
+ * A associação e o IP_EVENT_STA_GOT_IP não validam um lease vencido ou
+ * entregue a outro equipamento. Apaga o cache e desassocia; o handler de
+ * WIFI_EVENT_STA_DISCONNECTED religa o DHCP e reconecta.
+ */
+static void wifi_fast_connect_expire(void)
+{
+    ESP_LOGW(TAG, "Sem CONNACK em %d ms com o IP do cache, voltando ao DHCP",
+             WIFI_FAST_CONNECT_MQTT_TIMEOUT_MS);
+    s_wifi_static_pending = false;
+    wifi_cache_erase();
+    esp_wifi_disconnect();
 }
 
 /* Handlers de eventos */
@@ -720,9 +1578,29 @@ static void wifi_event_handler(void *arg, esp_event_base_t event_base,
         ESP_LOGI(TAG, "WiFi iniciado, conectando...");
         esp_wifi_connect();
     }
+    else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_CONNECTED)
+    {
+        wifi_event_sta_connected_t *event = (wifi_event_sta_connected_t *)event_data;
+        memcpy(s_wifi_link.bssid, event->bssid, sizeof(s_wifi_link.bssid));
+        s_wifi_link.channel = event->channel;
+    }
     else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED)
     {
-        if (s_wifi_retry_num < WIFI_MAX_RETRY)
+        wifi_event_sta_disconnected_t *event = (wifi_event_sta_disconnected_t *)event_data;
+        xEventGroupClearBits(s_net_events, WIFI_CONNECTED_BIT);
+        xEventGroupSetBits(s_net_events, NET_CHANGED_BIT);
+
+        bool fast_failed = s_wifi_fast_attempt;
+        wifi_fast_connect_fallback();
+
+        if (fast_failed)
+        {
+            /* Não conta como tentativa: a varredura completa começa agora */
+            ESP_LOGW(TAG, "Conexao rapida falhou (motivo %u), usando varredura completa",
+                     event->reason);
+            esp_wifi_connect();
+        }
+        else if (s_wifi_retry_num < WIFI_MAX_RETRY)
         {
             esp_wifi_connect();
             s_wifi_retry_num++;
@@ -733,6 +1611,7 @@ static void wifi_event_handler(void *arg, esp_event_base_t event_base,
         {
             ESP_LOGE(TAG, "Falha ao conectar WiFi após %d tentativas",
                      WIFI_MAX_RETRY);
+            xEventGroupSetBits(s_net_events, WIFI_FAIL_BIT | NET_CHANGED_BIT);
         }
     }
     else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP)
@@ -740,6 +1619,32 @@ static void wifi_event_handler(void *arg, esp_event_base_t event_base,
         ip_event_got_ip_t *event = (ip_event_got_ip_t *)event_data;
         ESP_LOGI(TAG, "IP obtido: " IPSTR, IP2STR(&event->ip_info.ip));
         s_wifi_retry_num = 0;
+        s_wifi_fast_attempt = false;
+
+        /* O IP do cache só é confirmado pelo CONNACK; até lá não é regravado */
+        if (s_wifi_static_ip)
+        {
+            s_wifi_static_since = xTaskGetTickCount();
+            s_wifi_static_pending = true;
+        }
+        else
+        {
+            wifi_fast_connect_store(&event->ip_info);
+        }
+
+        if (s_boot_wifi_ms == 0)
+        {
+            s_boot_wifi_ms = boot_ms();
+        }
+        boot_trace_end(__atomic_exchange_n(&s_span_wifi_conexao, -1, __ATOMIC_RELAXED));
+        xEventGroupClearBits(s_net_events, WIFI_FAIL_BIT);
+        xEventGroupSetBits(s_net_events, WIFI_CONNECTED_BIT | NET_CHANGED_BIT);
+
+        /* Sem isso o cliente só tentaria de novo no fim do seu timer de reconexão */
+        if (s_mqtt_client != NULL && !s_mqtt_connected)
+        {
+            esp_mqtt_client_reconnect(s_mqtt_client);
+        }
     }
 }
 
@@ -751,86 +1656,152 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base,
     switch ((esp_mqtt_event_id_t)event_id)
     {
     case MQTT_EVENT_CONNECTED:
-        ESP_LOGI(TAG, "MQTT conectado ao broker!");
+        DLOG(DLOG_MQTT_CONECTADO, event->session_present ? "retomada" : "nova");
         s_mqtt_connected = true;
+        __atomic_add_fetch(&s_mqtt_connect_count, 1, __ATOMIC_RELEASE);
 
-        mqtt_subscribe_topic("/casa/externo/luminosidade", 1);
-        mqtt_subscribe_topic("/casa/sala/temperatura", 1);
+        /* Antes de acordar a task de conexão, que reconcilia as subscrições */
+        sub_registry_on_connect(event->session_present);
+
+        if (s_boot_mqtt_ms == 0)
+        {
+            s_boot_mqtt_ms = boot_ms();
+        }
+        boot_trace_end(__atomic_exchange_n(&s_span_mqtt_conexao, -1, __ATOMIC_RELAXED));
+        xEventGroupSetBits(s_net_events, MQTT_CONNECTED_BIT | NET_CHANGED_BIT);
+
+        if (s_disconnected_since_ms != 0)
+        {
+            uint32_t now_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+            mqtt_stats_add(MQTT_STAT_TEMPO_DESCONECTADO_MS, now_ms - s_disconnected_since_ms);
+            s_disconnected_since_ms = 0;
+        }
+
+        if (s_task_offline_drain != NULL)
+        {
+            xTaskNotifyGive(s_task_offline_drain);
+        }
+
+        notify_ready(true);
         break;
 
     case MQTT_EVENT_DISCONNECTED:
-        ESP_LOGW(TAG, "MQTT desconectado");
+        DLOG(DLOG_MQTT_DESCONECTADO);
         s_mqtt_connected = false;
-        s_stats.desconexoes++;
+        xEventGroupClearBits(s_net_events, MQTT_CONNECTED_BIT);
+        xEventGroupSetBits(s_net_events, NET_CHANGED_BIT);
+        mqtt_stats_add(MQTT_STAT_DESCONEXOES, 1);
+        /* 0 indica "conectado"; evita o valor no primeiro tick */
+        s_disconnected_since_ms = (xTaskGetTickCount() * portTICK_PERIOD_MS) | 1;
+
+        notify_ready(false);
         break;
 
     case MQTT_EVENT_DATA:
-        ESP_LOGI(TAG, "Mensagem MQTT:");
-        ESP_LOGI(TAG, "  Topico: %.*s", event->topic_len, event->topic);
-        ESP_LOGI(TAG, "  Dados: %.*s", event->data_len, event->data);
-        s_stats.total_recebidas++;
-        s_stats.ultima_mensagem_ts = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    {
+        int64_t received_us = esp_timer_get_time();
 
-        char topic[64];
-        char data[64];
-        snprintf(topic, MIN(event->topic_len + 1, sizeof(topic)), "%.*s", event->topic_len, event->topic);
-        snprintf(data, MIN(event->data_len + 1, sizeof(data)), "%.*s", event->data_len, event->data);
+        /* Diferido: só copia para o buffer, a UART fica com a LogDrain */
+        DLOG(DLOG_MQTT_MENSAGEM, event->topic_len, event->topic, event->data_len, event->data);
+        mqtt_stats_add(MQTT_STAT_RECEBIDAS, 1);
+        mqtt_stats_set_last_message(xTaskGetTickCount() * portTICK_PERIOD_MS);
 
-        if (strcmp(topic, "/casa/externo/luminosidade") == 0)
+        /* Mensagens fragmentadas (maiores que o buffer) não são despachadas */
+        if (event->data_len != event->total_data_len)
         {
-            int luminosity = atoi(data);
-            if (luminosity < 3)
-            {
-                gpio_set_level(GPIO_LIGHTS, 1); // Acender luzes
-                ESP_LOGI(TAG, "Luminosidade: %d, Luzes ACESAS", luminosity);
-            }
-            else
-            {
-                gpio_set_level(GPIO_LIGHTS, 0); // Apagar luzes
-                ESP_LOGI(TAG, "Luminosidade: %d, Luzes APAGADAS", luminosity);
-            }
+            DLOG(DLOG_MQTT_FRAGMENTADA, event->total_data_len);
+            break;
         }
-        else if (strcmp(topic, "/casa/sala/temperatura") == 0)
+
+        if (local_bus_is_echo(event->topic, event->topic_len, event->data, event->data_len))
         {
-            int temperature = atoi(data);
-            if (temperature > 23)
-            {
-                gpio_set_level(GPIO_AC, 1); // Ligar ar condicionado
-                s_ac_on = true;
-                s_last_temp_high_time = esp_timer_get_time() / 1000;
-                ESP_LOGI(TAG, "Temperatura: %d, Ar condicionado LIGADO", temperature);
-            }
-            else if (s_ac_on)
-            {
-                uint64_t current_time = esp_timer_get_time() / 1000;
-                if (temperature < 20 && (current_time - s_last_temp_high_time) >= (10 * 60 * 1000))
-                {
-                    gpio_set_level(GPIO_AC, 0); // Desligar ar condicionado
-                    s_ac_on = false;
-                    ESP_LOGI(TAG, "Temperatura: %d, Ar condicionado DESLIGADO (10 min abaixo de 20)", temperature);
-                }
-                else
-                {
-                    ESP_LOGI(TAG, "Temperatura: %d, Ar condicionado continua LIGADO", temperature);
-                }
-            }
-            else
-            {
-                ESP_LOGI(TAG, "Temperatura: %d, Ar condicionado DESLIGADO", temperature);
-            }
+            mqtt_stats_add(MQTT_STAT_ECOS_SUPRIMIDOS, 1);
+            break;
+        }
+
+        mqtt_message_t msg = {
+            .topic = event->topic,
+            .topic_len = event->topic_len,
+            .data = event->data,
+            .data_len = event->data_len,
+            .qos = event->qos,
+            .retain = event->retain,
+            .timestamp_us = received_us,
+        };
+
+        if (local_bus_deliver(&msg) == 0)
+        {
+            DLOG(DLOG_MQTT_SEM_HANDLER);
         }
         break;
+    }
+
+    case MQTT_EVENT_SUBSCRIBED:
+        if (sub_registry_on_suback(event->msg_id, (const uint8_t *)event->data,
+                                   event->data_len) > 0)
+        {
+            DLOG(DLOG_MQTT_SUBACK_RECUSA, event->msg_id);
+        }
+        break;
+
+    case MQTT_EVENT_PUBLISHED:
+        /* PUBACK (QoS 1) ou PUBCOMP (QoS 2) */
+        mqtt_stats_ack_complete(event->msg_id, esp_timer_get_time());
+        break;
 
     case MQTT_EVENT_ERROR:
-        ESP_LOGE(TAG, "Erro MQTT");
+        DLOG(DLOG_MQTT_ERRO);
         break;
 
     default:
-        ESP_LOGD(TAG, "Evento MQTT: %d", event_id);
+        DLOG(DLOG_MQTT_EVENTO, (int)event_id);
         break;
     }
 }
 
+/* Handlers de mensagens recebidas */
+
+static void on_luminosity_message(const mqtt_message_t *msg, void *ctx)
+{
+    int32_t luminosity;
+    if (!mqtt_message_to_int(msg, &luminosity))
+    {
+        DLOG(DLOG_MQTT_LUM_INVALIDA, msg->data_len, msg->data);
+        return;
+    }
+
+    DLOG(DLOG_MQTT_LUMINOSIDADE, (long)luminosity);
+    rule_engine_eval(RULE_CHANNEL_LUMINOSIDADE, luminosity, msg->timestamp_us);
+}
+
+static void on_temperature_message(const mqtt_message_t *msg, void *ctx)
+{
+    int32_t temperature;
+    if (!mqtt_message_to_int(msg, &temperature))
+    {
+        DLOG(DLOG_MQTT_TEMP_INVALIDA, msg->data_len, msg->data);
+        return;
+    }
+
+    DLOG(DLOG_MQTT_TEMPERATURA, (long)temperature);
+    rule_engine_eval(RULE_CHANNEL_TEMPERATURA, temperature, msg->timestamp_us);
+}
+
+static void on_rules_message(const mqtt_message_t *msg, void *ctx)
+{
+    uint32_t bad_line = 0;
+    esp_err_t ret = rule_engine_load_text(msg->data, msg->data_len, &bad_line);
+
+    if (ret == ESP_ERR_INVALID_ARG)
+    {
+        ESP_LOGW(TAG, "Regras rejeitadas: linha %lu invalida", bad_line);
+    }
+    else if (ret != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Regras rejeitadas: mais que %d regras", RULE_ENGINE_MAX_RULES);
+    }
+}
+
 /* Tasks */
 
 static void telemetry_task(void *pvParameters)
@@ -839,22 +1810,60 @@ static void telemetry_task(void *pvParameters)
 
     telemetry_data_t data = {0};
 
+    const report_filter_config_t temp_cfg = {
+        .deadband = TELEMETRY_DEADBAND_TEMPERATURA,
+        .min_interval_ms = TELEMETRY_REPORT_MIN_INTERVAL_MS,
+        .max_interval_ms = TELEMETRY_REPORT_MAX_INTERVAL_MS,
+        .heartbeat_ms = TELEMETRY_HEARTBEAT_MS,
+    };
+    const report_filter_config_t umid_cfg = {
+        .deadband = TELEMETRY_DEADBAND_UMIDADE,
+        .min_interval_ms = TELEMETRY_REPORT_MIN_INTERVAL_MS,
+        .max_interval_ms = TELEMETRY_REPORT_MAX_INTERVAL_MS,
+        .heartbeat_ms = TELEMETRY_HEARTBEAT_MS,
+    };
+    report_filter_t temp_filter;
+    report_filter_t umid_filter;
+    report_filter_init(&temp_filter, &temp_cfg);
+    report_filter_init(&umid_filter, &umid_cfg);
+
+    sampler_start(SAMPLER_JOB_TELEMETRY, TELEMETRY_PERIOD_US);
+    int64_t amostra_us = esp_timer_get_time();
     while (1)
     {
-        if (s_mqtt_connected)
+        /* Amostra mesmo desconectado: a fila offline guarda os dados */
+        data.temperatura = 20.0f + (esp_random() % 150) / 10.0f;
+        data.umidade = 40.0f + (esp_random() % 400) / 10.0f;
+        data.timestamp = amostra_us / 1000ULL; // Instante nominal, sem o jitter
+        data.contador++;
+
+        /* Um registro leva os dois canais: basta um deles pedir report */
+        report_reason_t reason = report_filter_check(&temp_filter, data.temperatura, data.timestamp);
+        if (reason == REPORT_NONE)
         {
-            data.temperatura = 20.0f + (esp_random() % 150) / 10.0f;
-            data.umidade = 40.0f + (esp_random() % 400) / 10.0f;
-            data.timestamp = esp_timer_get_time() / 1000ULL;
-            data.contador++;
+            reason = report_filter_check(&umid_filter, data.umidade, data.timestamp);
+        }
 
-            mqtt_publish_telemetry(&data);
+        bool reported = (reason != REPORT_NONE) && mqtt_publish_telemetry(&data) >= 0;
+        report_filter_commit(&temp_filter, data.temperatura, data.timestamp, reported);
+        report_filter_commit(&umid_filter, data.umidade, data.timestamp, reported);
 
-            ESP_LOGI(TAG, "Telemetria: T=%.1f°C, H=%.1f%% (#%lu)",
+        if (reported)
+        {
+            ESP_LOGI(TAG, "Telemetria: T=%.1f°C, H=%.1f%% (#%lu, motivo %d, %lu suprimidas)",
+                     data.temperatura, data.umidade, data.contador, reason,
+                     temp_filter.suprimidas);
+        }
+        else
+        {
+            ESP_LOGD(TAG, "Telemetria suprimida: T=%.1f°C, H=%.1f%% (#%lu)",
                      data.temperatura, data.umidade, data.contador);
+
+            /* Sem amostra nova no lote, a idade só é verificada aqui */
+            flush_expired_telemetry();
         }
 
-        vTaskDelay(pdMS_TO_TICKS(TELEMETRY_INTERVAL_MS));
+        amostra_us = sampler_wait(SAMPLER_JOB_TELEMETRY);
     }
 }
 
@@ -862,9 +1871,21 @@ static void health_monitoring_task(void *pvParameters)
 {
     ESP_LOGI(TAG, "Task de health monitoring iniciada");
 
+    /* Abre as primeiras janelas de CPU e heap: o primeiro health já traz o uso */
+    cpu_stats_sample();
+    heap_stats_sample();
+    sample_task_stacks();
+
+    TickType_t ultimo_despertar = xTaskGetTickCount();
     while (1)
     {
-        vTaskDelay(pdMS_TO_TICKS(HEALTH_CHECK_INTERVAL_MS));
+        task_profile_delay_until(TASK_ID_HEALTH, &ultimo_despertar,
+                                 pdMS_TO_TICKS(HEALTH_CHECK_INTERVAL_MS));
+
+        /* Amostra mesmo offline: a janela segue o intervalo do health */
+        cpu_stats_sample();
+        heap_stats_sample();
+        sample_task_stacks();
 
         if (s_mqtt_connected)
         {
@@ -884,15 +1905,188 @@ static void health_monitoring_task(void *pvParameters)
     }
 }
 
-static void wifi_watchdog_task(void *pvParameters)
+/**
+ * @brief Máquina de conexão: sobe WiFi e MQTT sem bloquear mqtt_system_init().
+ *
+ * O estado é derivado dos bits de s_net_events; cada mudança sinalizada
+ * por NET_CHANGED_BIT executa as ações de entrada do novo estado. Só o
+ * estado MQTT_CONN_WIFI_FALHA (e um cliente MQTT que falhou ao iniciar)
+ * usa timeout, para começar uma nova rodada de tentativas, além do prazo
+ * do CONNACK enquanto o IP do cache está em uso.
+ */
+static void connection_task(void *pvParameters)
 {
-    // Implementação básica para evitar o erro de referência indefinida
-    ESP_LOGI(TAG, "WiFi Watchdog Task iniciada");
-    while(1) {
-        vTaskDelay(pdMS_TO_TICKS(10000)); // Espera 10 segundos
+    ESP_LOGI(TAG, "Task de conexao iniciada");
+
+    bool boot_published = false;
+    uint32_t conexao_anunciada = 0;
+
+    conn_enter_state(MQTT_CONN_WIFI_CONECTANDO);
+
+    boot_span_id_t span = boot_trace_begin("wifi.init");
+    s_span_wifi_conexao = boot_trace_begin("wifi.conexao");
+    init_wifi();
+    boot_trace_end(span);
+
+    while (1)
+    {
+        bool retry = s_conn_state == MQTT_CONN_WIFI_FALHA ||
+                     (s_conn_state == MQTT_CONN_MQTT_CONECTANDO && s_mqtt_client == NULL);
+        TickType_t wait = retry ? pdMS_TO_TICKS(WIFI_WATCHDOG_INTERVAL_MS) : portMAX_DELAY;
+        if (s_conn_state == MQTT_CONN_MQTT_CONECTANDO)
+        {
+            TickType_t static_wait = wifi_fast_connect_remaining();
+            wait = (static_wait < wait) ? static_wait : wait;
+        }
+
+        EventBits_t bits = xEventGroupWaitBits(s_net_events, NET_CHANGED_BIT,
+                                               pdTRUE, pdFALSE, wait);
+
+        if (s_conn_state == MQTT_CONN_MQTT_CONECTANDO && wifi_fast_connect_remaining() == 0)
+        {
+            wifi_fast_connect_expire();
+        }
+
+        if ((bits & NET_CHANGED_BIT) == 0 && s_conn_state == MQTT_CONN_WIFI_FALHA)
+        {
+            /* Sem tentativas pendentes no handler: é seguro zerar o contador */
+            ESP_LOGI(TAG, "Nova rodada de conexao WiFi");
+            s_wifi_retry_num = 0;
+            xEventGroupClearBits(s_net_events, WIFI_FAIL_BIT);
+            esp_wifi_connect();
+        }
+
+        mqtt_conn_state_t next = conn_state_from_bits(xEventGroupGetBits(s_net_events));
+        if (next != s_conn_state || (next == MQTT_CONN_MQTT_CONECTANDO && s_mqtt_client == NULL))
+        {
+            conn_enter_state(next);
+        }
+        else if (next == MQTT_CONN_ONLINE)
+        {
+            reconcile_subscriptions(); // Conjunto desejado mudou ou reconexão
+        }
+
+        uint32_t conexao = __atomic_load_n(&s_mqtt_connect_count, __ATOMIC_ACQUIRE);
+        if (next == MQTT_CONN_ONLINE && conexao != conexao_anunciada)
+        {
+            conexao_anunciada = conexao;
+            publish_online(&boot_published);
+        }
     }
 }
 
+static void offline_drain_task(void *pvParameters)
+{
+    /* Buffers estáticos: payload de até OFFLINE_QUEUE_MAX_PAYLOAD bytes */
+    static offline_queue_msg_t s_msg;
+    static char s_payload[OFFLINE_QUEUE_MAX_PAYLOAD];
+
+    ESP_LOGI(TAG, "Task de fila offline iniciada");
+
+    while (1)
+    {
+        /* Aguarda notificação de MQTT_EVENT_CONNECTED */
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        offline_queue_stats_t stats;
+        offline_queue_get_stats(&stats);
+        if (stats.profundidade > 0)
+        {
+            ESP_LOGI(TAG, "Drenando fila offline: %lu mensagens", stats.profundidade);
+        }
+
+        while (s_mqtt_connected)
+        {
+            /* Não compete com o tráfego ao vivo enquanto o outbox estiver cheio */
+            if (esp_mqtt_client_get_outbox_size(s_mqtt_client) > OFFLINE_DRAIN_MAX_OUTBOX)
+            {
+                vTaskDelay(pdMS_TO_TICKS(OFFLINE_DRAIN_INTERVAL_MS));
+                continue;
+            }
+
+            int sent = 0;
+            while (sent < OFFLINE_DRAIN_BURST && s_mqtt_connected &&
+                   offline_queue_peek(&s_msg, s_payload, sizeof(s_payload)) == ESP_OK)
+            {
+                int64_t sent_us = esp_timer_get_time();
+                int msg_id = esp_mqtt_client_publish(s_mqtt_client, s_msg.topic,
+                                                     s_payload, s_msg.len,
+                                                     s_msg.qos, 0);
+                if (msg_id < 0)
+                {
+                    break;
+                }
+                mqtt_stats_ack_track(msg_id, sent_us);
+
+                offline_queue_pop(s_msg.seq);
+                mqtt_stats_add(MQTT_STAT_PUBLICADAS, 1);
+                sent++;
+            }
+
+            if (sent < OFFLINE_DRAIN_BURST)
+            {
+                break; // Fila vazia, desconectado ou falha no envio
+            }
+
+            vTaskDelay(pdMS_TO_TICKS(OFFLINE_DRAIN_INTERVAL_MS));
+        }
+
+        offline_queue_get_stats(&stats);
+        ESP_LOGI(TAG, "Fila offline: %lu mensagens pendentes", stats.profundidade);
+    }
+}
+
+static bool client_is_ready(void)
+{
+#ifdef CONFIG_PUBLISH_BENCH
+    if (s_bench_sink != NULL)
+    {
+        return true;
+    }
+#endif
+    return s_mqtt_client != NULL && s_mqtt_connected;
+}
+
+static int client_publish(const char *topic, const char *data, int len, int qos, bool retain)
+{
+#ifdef CONFIG_PUBLISH_BENCH
+    if (s_bench_sink != NULL)
+    {
+        return s_bench_sink(topic, data, len, qos, retain);
+    }
+#endif
+    return esp_mqtt_client_publish(s_mqtt_client, topic, data, len, qos, retain ? 1 : 0);
+}
+
+/** Envia ao cliente conectado e contabiliza. @return msg_id ou -1 */
+static int publish_to_client(const char *topic, const char *data, int len,
+                             int qos, bool retain)
+{
+    int64_t sent_us = (qos > 0) ? esp_timer_get_time() : 0;
+    int msg_id = client_publish(topic, data, len, qos, retain);
+
+    if (msg_id >= 0)
+    {
+        mqtt_stats_add(MQTT_STAT_PUBLICADAS, 1);
+        if (qos > 0)
+        {
+            mqtt_stats_ack_track(msg_id, sent_us);
+        }
+        if (__builtin_expect(s_boot_first_publish_ms == 0, 0))
+        {
+            mark_first_publish();
+        }
+        ESP_LOGD(TAG, "Publicado em '%s' (msg_id=%d, QoS=%d)",
+                 topic, msg_id, qos);
+    }
+    else
+    {
+        mqtt_stats_add(MQTT_STAT_FALHAS_PUBLICACAO, 1);
+        ESP_LOGE(TAG, "Falha ao publicar em '%s'", topic);
+    }
+
+    return msg_id;
+}
 
 static esp_err_t init_gpios(void)
 {
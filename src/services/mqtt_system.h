@@ -16,6 +16,9 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "esp_err.h"
+#include "mqtt_stats.h"
+#include "cpu_stats.h"
+#include "heap_stats.h"
 
 /* Configurações e definições públicas */
 
@@ -50,12 +53,67 @@
 
 /* Comportamento do sistema */
 #define MQTT_KEEPALIVE_SEC 60				 ///< Intervalo de keep-alive MQTT
+#ifndef MQTT_PERSISTENT_SESSION
+#define MQTT_PERSISTENT_SESSION 1			 ///< Sessão persistente (clean session = 0)
+#endif
 #define MQTT_BUFFER_SIZE 2048				 ///< Tamanho do buffer MQTT
 #define MQTT_TIMEOUT_MS 10000				 ///< Timeout de operações MQTT
 #define WIFI_MAX_RETRY 5					 ///< Tentativas de reconexão WiFi
 #define TELEMETRY_INTERVAL_MS 1000		 ///< Intervalo de telemetria
+#ifndef TELEMETRY_PERIOD_US
+#define TELEMETRY_PERIOD_US (TELEMETRY_INTERVAL_MS * 1000UL) ///< Período de amostragem (µs, ver sampler.h)
+#endif
 #define HEALTH_CHECK_INTERVAL_MS 60000	 ///< Intervalo de health check
-#define WIFI_WATCHDOG_INTERVAL_MS 30000 ///< Intervalo de verificação WiFi
+#define WIFI_WATCHDOG_INTERVAL_MS 30000 ///< Pausa antes de nova rodada de conexão WiFi
+
+/* Publicação de telemetria em lote */
+#ifndef MQTT_TELEMETRY_BATCH_SIZE
+#define MQTT_TELEMETRY_BATCH_SIZE 10		 ///< Amostras por lote (1 = publicação individual)
+#endif
+
+#ifndef MQTT_TELEMETRY_BATCH_MAX_AGE_MS
+#define MQTT_TELEMETRY_BATCH_MAX_AGE_MS 15000 ///< Idade máxima de um lote antes do envio
+#endif
+
+/* Report-by-exception da telemetria (ver report_filter.h) */
+#ifndef TELEMETRY_DEADBAND_TEMPERATURA
+#define TELEMETRY_DEADBAND_TEMPERATURA 0.5f	 ///< Variação mínima de temperatura (°C)
+#endif
+
+#ifndef TELEMETRY_DEADBAND_UMIDADE
+#define TELEMETRY_DEADBAND_UMIDADE 2.0f		 ///< Variação mínima de umidade (%)
+#endif
+
+#ifndef TELEMETRY_REPORT_MIN_INTERVAL_MS
+#define TELEMETRY_REPORT_MIN_INTERVAL_MS 5000	 ///< Intervalo mínimo entre amostras reportadas
+#endif
+
+#ifndef TELEMETRY_REPORT_MAX_INTERVAL_MS
+#define TELEMETRY_REPORT_MAX_INTERVAL_MS 60000 ///< Reporta variações pequenas após este intervalo
+#endif
+
+#ifndef TELEMETRY_HEARTBEAT_MS
+#define TELEMETRY_HEARTBEAT_MS 300000			 ///< Reporta mesmo sem variação após este intervalo
+#endif
+
+/* Formato dos payloads (ver payload_codec.h) */
+#ifndef MQTT_TELEMETRY_FORMAT
+#define MQTT_TELEMETRY_FORMAT PAYLOAD_FORMAT_JSON ///< Formato inicial da telemetria
+#endif
+
+#ifndef MQTT_HEALTH_FORMAT
+#define MQTT_HEALTH_FORMAT PAYLOAD_FORMAT_JSON	 ///< Formato inicial do health
+#endif
+
+/* Prontidão da conexão */
+#ifndef MQTT_READY_MAX_CALLBACKS
+#define MQTT_READY_MAX_CALLBACKS 4			 ///< Callbacks de prontidão registráveis
+#endif
+
+/* Fila offline (store-and-forward) */
+#define OFFLINE_DRAIN_BURST 10				 ///< Mensagens reenviadas por rajada
+#define OFFLINE_DRAIN_INTERVAL_MS 250		 ///< Pausa entre rajadas de reenvio
+#define OFFLINE_DRAIN_MAX_OUTBOX 4096		 ///< Outbox MQTT máximo (bytes) para continuar drenando
 
 /* Tipos e estruturas */
 
@@ -70,8 +128,142 @@ typedef struct
 	uint32_t desconexoes;			  ///< Contador de desconexões.
 	uint32_t tempo_desconectado_ms; ///< Tempo total desconectado (ms).
 	uint32_t ultima_mensagem_ts;	  ///< Timestamp da última mensagem (ms).
+	uint32_t ack_amostras;		  ///< ACKs de QoS >= 1 medidos.
+	uint32_t ack_p50_us;			  ///< Latência de ACK, mediana (µs).
+	uint32_t ack_p95_us;			  ///< Latência de ACK, percentil 95 (µs).
+	uint32_t ack_p99_us;			  ///< Latência de ACK, percentil 99 (µs).
+	uint32_t ack_max_us;			  ///< Latência de ACK máxima (µs).
+	uint32_t ack_perdidos;		  ///< ACKs que não puderam ser casados com o envio.
+	uint32_t entregas_locais;	  ///< Publicações entregues pelo barramento local.
+	uint32_t ecos_suprimidos;	  ///< Ecos do broker descartados.
 } mqtt_statistics_t;
 
+/**
+ * @brief Estatísticas MQTT com contadores de 64 bits (não estouram).
+ */
+typedef struct
+{
+	uint64_t total_publicadas;		  ///< Total de mensagens publicadas.
+	uint64_t total_recebidas;		  ///< Total de mensagens recebidas.
+	uint64_t falhas_publicacao;	  ///< Número de falhas na publicação.
+	uint64_t desconexoes;			  ///< Contador de desconexões.
+	uint64_t tempo_desconectado_ms; ///< Tempo total desconectado (ms).
+	uint32_t ultima_mensagem_ts;	  ///< Timestamp da última mensagem (ms).
+	uint64_t ack_perdidos;		  ///< ACKs que não puderam ser casados com o envio.
+	latency_summary_t ack_latencia; ///< Percentis da latência de ACK (QoS >= 1).
+	uint64_t entregas_locais;	  ///< Publicações entregues pelo barramento local.
+	uint64_t ecos_suprimidos;	  ///< Ecos do broker descartados.
+} mqtt_statistics64_t;
+
+/**
+ * @brief Estatísticas da fila offline (store-and-forward).
+ */
+typedef struct
+{
+	uint32_t profundidade; ///< Mensagens pendentes na fila.
+	uint32_t bytes;		  ///< Bytes de payload pendentes.
+	uint32_t capacidade;	  ///< Capacidade da partição (bytes).
+	uint32_t enfileiradas; ///< Total de mensagens armazenadas.
+	uint32_t drenadas;	  ///< Total de mensagens reenviadas ao broker.
+	uint32_t descartadas;  ///< Mensagens perdidas por falta de espaço.
+} offline_queue_stats_t;
+
+/**
+ * @brief Formatos de fio dos payloads de telemetria e health.
+ */
+typedef enum
+{
+	PAYLOAD_FORMAT_JSON = 0,  ///< JSON legível (tópico base).
+	PAYLOAD_FORMAT_CBOR = 1,  ///< CBOR, chaves inteiras (tópico + "/cbor").
+	PAYLOAD_FORMAT_BINARY = 2 ///< Binário compacto versionado (tópico + "/bin").
+} payload_format_t;
+
+/**
+ * @brief Tópicos com formato de payload configurável.
+ */
+typedef enum
+{
+	MQTT_PAYLOAD_TELEMETRY = 0, ///< MQTT_TOPIC_TELEMETRY
+	MQTT_PAYLOAD_HEALTH = 1,	 ///< MQTT_TOPIC_HEALTH
+	MQTT_PAYLOAD_MAX
+} mqtt_payload_topic_t;
+
+/**
+ * @brief Destinos de uma publicação (combináveis com '|').
+ */
+typedef enum
+{
+	MQTT_ROUTE_LOCAL = 0x01,  ///< Handlers locais, sem passar pelo broker.
+	MQTT_ROUTE_BROKER = 0x02, ///< Broker, como mqtt_publish_data().
+	MQTT_ROUTE_ALL = 0x03	  ///< Ambos; o eco devolvido pelo broker é descartado.
+} mqtt_route_t;
+
+/**
+ * @brief Mensagem MQTT recebida.
+ *
+ * Visão delimitada por comprimento sobre o buffer do evento MQTT (ou da
+ * publicação local): os campos `topic` e `data` NÃO terminam em '\0' e
+ * só são válidos durante a chamada do handler.
+ */
+typedef struct
+{
+	const char *topic; ///< Tópico (não terminado em '\0').
+	int topic_len;		 ///< Comprimento do tópico.
+	const char *data;	 ///< Payload (não terminado em '\0').
+	int data_len;		 ///< Comprimento do payload.
+	int qos;				 ///< QoS da mensagem.
+	bool retain;		 ///< Flag de retain.
+	int64_t timestamp_us; ///< Recebimento do evento ou publicação local (esp_timer_get_time()).
+} mqtt_message_t;
+
+/**
+ * @brief Handler de mensagens recebidas.
+ * @param msg Mensagem recebida.
+ * @param ctx Contexto informado no registro.
+ */
+typedef void (*mqtt_message_handler_t)(const mqtt_message_t *msg, void *ctx);
+
+#ifdef CONFIG_PUBLISH_BENCH
+/**
+ * @brief Destino das publicações no modo benchmark (mesma assinatura
+ *        e retorno de esp_mqtt_client_publish).
+ */
+typedef int (*mqtt_bench_sink_t)(const char *topic, const char *data,
+								 int len, int qos, bool retain);
+#endif
+
+/**
+ * @brief Callback de mudança de prontidão.
+ *
+ * Chamado na task do cliente MQTT a cada CONNACK (`ready` true) e a cada
+ * desconexão (`ready` false). Não deve bloquear.
+ * @param ready true quando o sistema pode publicar no broker.
+ * @param ctx Contexto informado no registro.
+ */
+typedef void (*mqtt_ready_callback_t)(bool ready, void *ctx);
+
+/**
+ * @brief Estado da máquina de conexão em segundo plano.
+ */
+typedef enum
+{
+	MQTT_CONN_PARADO = 0,		///< Antes de mqtt_system_init(), após shutdown ou sem rede (QEMU).
+	MQTT_CONN_WIFI_CONECTANDO, ///< Associando ao AP / aguardando IP.
+	MQTT_CONN_WIFI_FALHA,		///< Tentativas esgotadas; nova rodada após WIFI_WATCHDOG_INTERVAL_MS.
+	MQTT_CONN_MQTT_CONECTANDO, ///< Com IP, aguardando o CONNACK.
+	MQTT_CONN_ONLINE,				///< Conectado ao broker.
+} mqtt_conn_state_t;
+
+/**
+ * @brief Marcos do primeiro boot, em ms desde o boot (0 = ainda não ocorreu).
+ */
+typedef struct
+{
+	uint32_t wifi_ms;				 ///< IP obtido.
+	uint32_t mqtt_ms;				 ///< CONNACK recebido.
+	uint32_t primeira_publicacao_ms; ///< Primeira publicação aceita pelo cliente MQTT.
+} mqtt_boot_timing_t;
+
 /**
  * @brief Níveis de Qualidade de Serviço (QoS) MQTT.
  */
@@ -103,14 +295,23 @@ typedef struct
 	int wifi_rssi;				///< Força do sinal WiFi (dBm).
 	uint64_t uptime_sec;		///< Tempo de atividade (segundos).
 	bool mqtt_connected;		///< Status da conexão MQTT.
+	cpu_usage_t cpu;			///< Uso de CPU na última janela (HEALTH_CHECK_INTERVAL_MS).
+	heap_usage_t heap;		///< Fragmentação, regiões e taxas de alocação.
 } health_status_t;
 
 /* Funções de Inicialização e Controle */
 
 /**
  * @brief Inicializa o sistema IoT MQTT completo.
+ *
+ * Inicializa NVS, fila offline, GPIOs e regras e cria as tasks do
+ * sistema, retornando sem esperar a rede. WiFi e MQTT sobem na task de
+ * conexão; status e boot são publicados quando o broker aceita a conexão.
+ * Publicações anteriores seguem as regras de mqtt_publish_data() (QoS >= 1
+ * vai para a fila offline).
  * @return ESP_OK se sucesso, erro caso contrário.
- * @note Bloqueia até o WiFi conectar ou timeout. Deve ser chamada uma única vez.
+ * @note Deve ser chamada uma única vez. Use mqtt_system_wait_ready() ou
+ *       mqtt_system_register_ready_callback() para reagir à conexão.
  */
 esp_err_t mqtt_system_init(void);
 
@@ -126,6 +327,38 @@ esp_err_t mqtt_system_shutdown(void);
  */
 bool mqtt_system_is_connected(void);
 
+/**
+ * @brief Obtém o estado atual da máquina de conexão.
+ */
+mqtt_conn_state_t mqtt_system_get_conn_state(void);
+
+/**
+ * @brief Aguarda a conexão com o broker.
+ *
+ * Retorna assim que o CONNACK chega, sem polling.
+ * @param timeout_ms Tempo máximo de espera (UINT32_MAX espera indefinidamente).
+ * @return ESP_OK se conectado, ESP_ERR_TIMEOUT ou ESP_ERR_INVALID_STATE antes
+ *         de mqtt_system_init().
+ */
+esp_err_t mqtt_system_wait_ready(uint32_t timeout_ms);
+
+/**
+ * @brief Registra um callback de mudança de prontidão.
+ *
+ * Se a conexão já tiver sido notificada, o callback é chamado
+ * imediatamente com `ready` true, na task de quem registra. Um registro
+ * concorrente com o CONNACK recebe esse `true` uma única vez.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG ou ESP_ERR_NO_MEM se
+ *         MQTT_READY_MAX_CALLBACKS já estiverem registrados.
+ */
+esp_err_t mqtt_system_register_ready_callback(mqtt_ready_callback_t callback, void *ctx);
+
+/**
+ * @brief Obtém os marcos de tempo do boot (IP, CONNACK e primeira publicação).
+ * @return ESP_OK ou ESP_ERR_INVALID_ARG se `timing` for NULL.
+ */
+esp_err_t mqtt_get_boot_timing(mqtt_boot_timing_t *timing);
+
 /* Funções de Publicação MQTT */
 
 /**
@@ -135,19 +368,49 @@ bool mqtt_system_is_connected(void);
  * @param len Comprimento dos dados (0 para string).
  * @param qos Nível de QoS (0, 1, 2).
  * @param retain Se a mensagem deve ser retida pelo broker.
- * @return ID da mensagem ou -1 em caso de erro.
- * @note Retorna erro se o MQTT não estiver conectado.
+ * @return ID da mensagem, 0 se armazenada na fila offline ou -1 em caso de erro.
+ * @note Com o MQTT desconectado, mensagens com QoS >= 1 e sem retain são
+ *       armazenadas na fila offline e reenviadas após a reconexão.
  */
 int mqtt_publish_data(const char *topic, const char *data,
 							 int len, int qos, bool retain);
 
+/**
+ * @brief Publica dados no barramento local e/ou no broker.
+ *
+ * Com MQTT_ROUTE_LOCAL os handlers registrados para o tópico são chamados
+ * antes do retorno, na task de quem publica, mesmo sem conexão com o
+ * broker. A cópia para o broker (MQTT_ROUTE_ALL) só é enviada com o
+ * cliente conectado; ela não vai para a fila offline, pois o valor já foi
+ * consumido localmente.
+ * @param topic Tópico de destino.
+ * @param data Dados a publicar.
+ * @param len Comprimento dos dados (0 para string).
+ * @param qos Nível de QoS da cópia para o broker.
+ * @param retain Flag de retain da cópia para o broker.
+ * @param route Destinos da mensagem.
+ * @return ID da mensagem no broker, 0 se entregue apenas localmente ou -1 em caso de erro.
+ */
+int mqtt_publish_routed(const char *topic, const char *data, int len,
+								int qos, bool retain, mqtt_route_t route);
+
 /**
  * @brief Publica dados de telemetria (temperatura, umidade, contador, timestamp).
  * @param data Estrutura com os dados de telemetria.
  * @return ID da mensagem ou -1 em caso de erro.
+ * @note Com MQTT_TELEMETRY_BATCH_SIZE > 1 a amostra é acumulada e o lote
+ *       é publicado como um array JSON ao atingir MQTT_TELEMETRY_BATCH_SIZE
+ *       amostras ou MQTT_TELEMETRY_BATCH_MAX_AGE_MS. Retorna 0 enquanto a
+ *       amostra apenas foi acumulada.
  */
 int mqtt_publish_telemetry(const telemetry_data_t *data);
 
+/**
+ * @brief Publica imediatamente as amostras de telemetria acumuladas.
+ * @return ID da mensagem, 0 se não havia amostras pendentes ou -1 em caso de erro.
+ */
+int mqtt_flush_telemetry(void);
+
 /**
  * @brief Publica as métricas de saúde do sistema (heap, RSSI, uptime, etc.).
  * @return ID da mensagem ou -1 em caso de erro.
@@ -161,23 +424,69 @@ int mqtt_publish_health_check(void);
  */
 int mqtt_publish_status(bool online);
 
+/**
+ * @brief Seleciona o formato de fio de um tópico.
+ * @param topic Tópico a configurar.
+ * @param format Formato desejado.
+ * @return ESP_OK se sucesso, ESP_ERR_INVALID_ARG se algum parâmetro for inválido.
+ * @note Payloads CBOR e binários são publicados no tópico base acrescido de
+ *       MQTT_TOPIC_SUFFIX_CBOR ou MQTT_TOPIC_SUFFIX_BINARY.
+ */
+esp_err_t mqtt_set_payload_format(mqtt_payload_topic_t topic, payload_format_t format);
+
 /* Funções de Subscrição MQTT */
 
 /**
- * @brief Subscreve em um tópico MQTT.
+ * @brief Adiciona um tópico ao conjunto de subscrições desejado.
+ *
+ * Pode ser chamada antes da conexão. A task de conexão envia as
+ * subscrições pendentes em um único SUBSCRIBE assim que o broker estiver
+ * disponível e as reenvia apenas se o broker perder a sessão.
  * @param topic Tópico para subscrever (suporta wildcards).
  * @param qos Nível de QoS desejado.
- * @return ID da mensagem ou -1 em caso de erro.
+ * @return 0 se registrado, -1 se inválido ou com o registro cheio
+ *         (SUB_REGISTRY_MAX_TOPICS).
  */
 int mqtt_subscribe_topic(const char *topic, int qos);
 
 /**
- * @brief Cancela a subscrição de um tópico MQTT.
+ * @brief Remove um tópico do conjunto de subscrições desejado.
+ *
+ * O UNSUBSCRIBE é enviado pela task de conexão (imediatamente se
+ * conectado, senão na próxima conexão).
  * @param topic Tópico para cancelar a subscrição.
- * @return ID da mensagem ou -1 em caso de erro.
+ * @return 0 ou -1 se o tópico não estava registrado.
  */
 int mqtt_unsubscribe_topic(const char *topic);
 
+/**
+ * @brief Registra um handler para mensagens recebidas em um tópico.
+ * @param topic_filter Tópico ou filtro com curingas MQTT ('+', '#'), copiado internamente.
+ * @param callback Função chamada para cada mensagem, na task do cliente MQTT ou,
+ *                 para publicações locais, na task que publicou. As chamadas
+ *                 nunca são concorrentes (ver local_bus.h).
+ * @param ctx Contexto repassado ao callback.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG ou ESP_ERR_NO_MEM se a tabela estiver cheia.
+ * @note O registro não envia SUBSCRIBE ao broker; use mqtt_subscribe_topic().
+ */
+esp_err_t mqtt_register_handler(const char *topic_filter,
+										  mqtt_message_handler_t callback, void *ctx);
+
+/**
+ * @brief Remove um handler registrado com mqtt_register_handler().
+ * @return ESP_OK ou ESP_ERR_NOT_FOUND.
+ */
+esp_err_t mqtt_unregister_handler(const char *topic_filter,
+											 mqtt_message_handler_t callback);
+
+/**
+ * @brief Converte o payload de uma mensagem em inteiro decimal.
+ * @param msg Mensagem recebida.
+ * @param value Valor convertido.
+ * @return true se o payload é um inteiro válido (espaços nas bordas são ignorados).
+ */
+bool mqtt_message_to_int(const mqtt_message_t *msg, int32_t *value);
+
 /* Funções de Estatísticas e Monitoramento */
 
 /**
@@ -187,12 +496,29 @@ int mqtt_unsubscribe_topic(const char *topic);
  */
 esp_err_t mqtt_get_statistics(mqtt_statistics_t *stats);
 
+/**
+ * @brief Obtém as estatísticas MQTT com contadores de 64 bits.
+ * Cada contador é lido sem corrupção, mas o conjunto não é atômico: um
+ * incremento concorrente pode aparecer em um campo e ainda não em outro.
+ * @param stats Ponteiro para a estrutura onde as estatísticas serão copiadas.
+ * @return ESP_OK se sucesso, ESP_ERR_INVALID_ARG se `stats` for NULL.
+ */
+esp_err_t mqtt_get_statistics64(mqtt_statistics64_t *stats);
+
 /**
  * @brief Reseta os contadores de estatísticas MQTT.
- * Zera todos os contadores, exceto desconexões e tempo desconectado.
+ * Zera todos os contadores e o histograma de latência de ACK, exceto
+ * desconexões e tempo desconectado.
  */
 void mqtt_reset_statistics(void);
 
+/**
+ * @brief Obtém as estatísticas da fila offline.
+ * @param stats Ponteiro para a estrutura onde as estatísticas serão copiadas.
+ * @return ESP_OK se sucesso, ESP_ERR_INVALID_ARG se `stats` for NULL.
+ */
+esp_err_t mqtt_get_offline_queue_stats(offline_queue_stats_t *stats);
+
 /**
  * @brief Obtém o status de saúde atual do sistema.
  * @param health Ponteiro para a estrutura onde o status será copiado.
@@ -206,6 +532,26 @@ esp_err_t mqtt_get_health_status(health_status_t *health);
  */
 void mqtt_print_statistics(void);
 
+#ifdef CONFIG_PUBLISH_BENCH
+/* Ganchos de Benchmark (apenas com CONFIG_PUBLISH_BENCH) */
+
+/**
+ * @brief Prepara o sistema para o benchmark sem WiFi/MQTT.
+ * Inicializa estatísticas, lote de telemetria, GPIOs e handlers, e desvia
+ * as publicações para `sink` como se o cliente estivesse conectado.
+ * @param sink Destino das publicações (NULL restaura o cliente real).
+ * @return ESP_OK ou o erro da inicialização.
+ */
+esp_err_t mqtt_bench_attach(mqtt_bench_sink_t sink);
+
+/**
+ * @brief Entrega uma mensagem ao handler de eventos MQTT como MQTT_EVENT_DATA.
+ * Exercita o mesmo caminho de uma mensagem vinda do broker (log,
+ * estatísticas e dispatch para os handlers registrados).
+ */
+void mqtt_bench_inject_data(const char *topic, const char *data, int len);
+#endif
+
 /* Tópicos MQTT Padrão */
 
 /** Tópico base do sistema */
@@ -226,10 +572,21 @@ void mqtt_print_statistics(void);
 /** Tópico de configuração */
 #define MQTT_TOPIC_CONFIG MQTT_TOPIC_BASE "/config"
 
+/** Tabela de regras de automação (texto, ver rule_engine.h; publicar com retain) */
+#define MQTT_TOPIC_CONFIG_RULES MQTT_TOPIC_CONFIG "/regras"
+
 /** Tópico de boot/informações iniciais */
 #define MQTT_TOPIC_BOOT MQTT_TOPIC_BASE "/boot"
 
+/** Tópicos dos sensores da casa (controle local de luzes e ar condicionado) */
+#define MQTT_TOPIC_LUMINOSITY "/casa/externo/luminosidade"
+#define MQTT_TOPIC_TEMPERATURE "/casa/sala/temperatura"
+
 /** Tópico de alertas/erros */
 #define MQTT_TOPIC_ALERTS MQTT_TOPIC_BASE "/alertas"
 
+/** Sufixos dos tópicos com payload CBOR e binário */
+#define MQTT_TOPIC_SUFFIX_CBOR "/cbor"
+#define MQTT_TOPIC_SUFFIX_BINARY "/bin"
+
 #endif /* MQTT_SYSTEM_H */
\ No newline at end of file
@@ -0,0 +1,456 @@
+/**
+ * @file offline_queue.c
+ * @brief Fila persistente store-and-forward - Implementação
+ *
+ * Formato na flash: a partição é dividida em setores de 4 KB. Cada
+ * setor contém registros sequenciais (cabeçalho + tópico + payload,
+ * alinhados a 4 bytes) que nunca atravessam o limite do setor. Um
+ * registro é marcado como consumido gravando 0x00 no byte `state`
+ * (transição 1 -> 0, sem apagar o setor). No boot, a varredura dos
+ * cabeçalhos reconstrói as posições de escrita e de leitura.
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#include "offline_queue.h"
+#include "mem_budget.h"
+
+#include <stddef.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+
+/* Definições privadas */
+
+static const char *TAG = "OFFLINE_QUEUE";
+
+#define SECTOR_SIZE 4096
+#define RECORD_MAGIC 0x5146
+#define RECORD_PENDING 0xFF
+#define RECORD_CONSUMED 0x00
+#define ALIGN4(x) (((x) + 3U) & ~3U)
+
+/**
+ * @brief Cabeçalho de um registro na flash.
+ */
+typedef struct __attribute__((packed))
+{
+    uint16_t magic;       ///< RECORD_MAGIC
+    uint16_t payload_len; ///< Comprimento do payload
+    uint8_t topic_len;    ///< Comprimento do tópico (sem '\0')
+    uint8_t qos;          ///< QoS original
+    uint8_t state;        ///< RECORD_PENDING ou RECORD_CONSUMED
+    uint8_t reserved;
+    uint32_t seq;         ///< Número de sequência
+    uint32_t crc;         ///< CRC32 de tópico + payload
+} record_header_t;
+
+#define RECORD_MAX_SIZE ALIGN4(sizeof(record_header_t) + OFFLINE_QUEUE_MAX_TOPIC + OFFLINE_QUEUE_MAX_PAYLOAD)
+
+_Static_assert(RECORD_MAX_SIZE <= SECTOR_SIZE, "Registro maximo nao cabe em um setor");
+
+/* Variáveis privadas (static) */
+
+static const esp_partition_t *s_partition = NULL;
+static SemaphoreHandle_t s_mutex = NULL;
+static uint32_t s_num_sectors = 0;
+
+/** Posição de escrita (setor e deslocamento dentro do setor) */
+static uint32_t s_write_sector = 0;
+static uint32_t s_write_pos = 0;
+
+/** Posição do registro pendente mais antigo */
+static uint32_t s_read_sector = 0;
+static uint32_t s_read_pos = 0;
+
+static uint32_t s_next_seq = 0;
+static offline_queue_stats_t s_stats = {0};
+
+/** Buffer de montagem de registros (evita uso de stack) */
+static uint8_t s_record_buf[RECORD_MAX_SIZE];
+
+/* Funções auxiliares */
+
+static inline uint32_t record_size(const record_header_t *hdr)
+{
+    return ALIGN4(sizeof(record_header_t) + hdr->topic_len + hdr->payload_len);
+}
+
+static inline uint32_t sector_offset(uint32_t sector, uint32_t pos)
+{
+    return sector * SECTOR_SIZE + pos;
+}
+
+static bool read_header(uint32_t sector, uint32_t pos, record_header_t *hdr)
+{
+    if (pos + sizeof(record_header_t) > SECTOR_SIZE)
+    {
+        return false;
+    }
+
+    if (esp_partition_read(s_partition, sector_offset(sector, pos),
+                           hdr, sizeof(record_header_t)) != ESP_OK)
+    {
+        return false;
+    }
+
+    return hdr->magic == RECORD_MAGIC &&
+           hdr->topic_len > 0 &&
+           hdr->topic_len < OFFLINE_QUEUE_MAX_TOPIC &&
+           hdr->payload_len <= OFFLINE_QUEUE_MAX_PAYLOAD &&
+           pos + record_size(hdr) <= SECTOR_SIZE;
+}
+
+static void mark_consumed(uint32_t sector, uint32_t pos)
+{
+    uint8_t state = RECORD_CONSUMED;
+    esp_partition_write(s_partition,
+                        sector_offset(sector, pos) + offsetof(record_header_t, state),
+                        &state, sizeof(state));
+}
+
+static void sync_read_to_write(void)
+{
+    s_read_sector = s_write_sector;
+    s_read_pos = s_write_pos;
+}
+
+/**
+ * @brief Move a escrita para o próximo setor, apagando-o.
+ *
+ * Se o setor ainda contém mensagens pendentes (fila cheia), elas são
+ * descartadas e a leitura avança para o setor seguinte.
+ */
+static void advance_write_sector(void)
+{
+    uint32_t next = (s_write_sector + 1) % s_num_sectors;
+
+    if (s_stats.profundidade > 0 && s_read_sector == next)
+    {
+        record_header_t hdr;
+        uint32_t pos = 0;
+
+        while (read_header(next, pos, &hdr))
+        {
+            if (hdr.state == RECORD_PENDING && s_stats.profundidade > 0)
+            {
+                s_stats.profundidade--;
+                s_stats.bytes -= hdr.payload_len;
+                s_stats.descartadas++;
+            }
+            pos += record_size(&hdr);
+        }
+
+        s_read_sector = (next + 1) % s_num_sectors;
+        s_read_pos = 0;
+
+        ESP_LOGW(TAG, "Fila cheia, setor %lu descartado", next);
+    }
+
+    esp_partition_erase_range(s_partition, sector_offset(next, 0), SECTOR_SIZE);
+
+    s_write_sector = next;
+    s_write_pos = 0;
+
+    if (s_stats.profundidade == 0)
+    {
+        sync_read_to_write();
+    }
+}
+
+/**
+ * @brief Varre a partição e reconstrói as posições de escrita e leitura.
+ */
+static void scan_partition(void)
+{
+    bool has_records = false;
+    uint32_t max_seq = 0;
+    uint32_t min_pending_seq = UINT32_MAX;
+
+    for (uint32_t sector = 0; sector < s_num_sectors; sector++)
+    {
+        record_header_t hdr;
+        uint32_t pos = 0;
+
+        while (read_header(sector, pos, &hdr))
+        {
+            uint32_t size = record_size(&hdr);
+
+            if (!has_records || hdr.seq > max_seq)
+            {
+                max_seq = hdr.seq;
+                s_write_sector = sector;
+                s_write_pos = pos + size;
+            }
+            has_records = true;
+
+            if (hdr.state == RECORD_PENDING)
+            {
+                s_stats.profundidade++;
+                s_stats.bytes += hdr.payload_len;
+
+                if (hdr.seq < min_pending_seq)
+                {
+                    min_pending_seq = hdr.seq;
+                    s_read_sector = sector;
+                    s_read_pos = pos;
+                }
+            }
+
+            pos += size;
+        }
+    }
+
+    if (!has_records)
+    {
+        // Partição vazia ou com conteúdo desconhecido: começa do zero
+        s_write_sector = 0;
+        s_write_pos = 0;
+        esp_partition_erase_range(s_partition, 0, SECTOR_SIZE);
+    }
+
+    s_next_seq = has_records ? max_seq + 1 : 0;
+
+    if (s_stats.profundidade == 0)
+    {
+        sync_read_to_write();
+    }
+}
+
+/* Implementação das funções públicas */
+
+esp_err_t offline_queue_init(void)
+{
+    if (s_partition != NULL)
+    {
+        return ESP_OK;
+    }
+
+    const esp_partition_t *partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                                                ESP_PARTITION_SUBTYPE_ANY,
+                                                                OFFLINE_QUEUE_PARTITION_LABEL);
+    if (partition == NULL)
+    {
+        ESP_LOGW(TAG, "Particao '%s' nao encontrada, fila offline desabilitada",
+                 OFFLINE_QUEUE_PARTITION_LABEL);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+#if MEM_STATIC_ALLOCATION
+    static StaticSemaphore_t s_mutex_buf;
+    s_mutex = xSemaphoreCreateMutexStatic(&s_mutex_buf);
+#else
+    s_mutex = xSemaphoreCreateMutex();
+#endif
+    if (s_mutex == NULL)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+
+    s_partition = partition;
+    s_num_sectors = partition->size / SECTOR_SIZE;
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_stats.capacidade = partition->size;
+
+    scan_partition();
+
+    ESP_LOGI(TAG, "Fila offline: %lu mensagens pendentes (%lu bytes) em %lu KB",
+             s_stats.profundidade, s_stats.bytes, s_stats.capacidade / 1024);
+
+    return ESP_OK;
+}
+
+bool offline_queue_is_ready(void)
+{
+    return s_partition != NULL;
+}
+
+esp_err_t offline_queue_push(const char *topic, const char *data, int len, int qos)
+{
+    if (s_partition == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    size_t topic_len = strlen(topic);
+
+    if (topic_len == 0 || topic_len >= OFFLINE_QUEUE_MAX_TOPIC ||
+        len < 0 || len > OFFLINE_QUEUE_MAX_PAYLOAD)
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    record_header_t hdr = {
+        .magic = RECORD_MAGIC,
+        .payload_len = (uint16_t)len,
+        .topic_len = (uint8_t)topic_len,
+        .qos = (uint8_t)qos,
+        .state = RECORD_PENDING,
+        .reserved = 0xFF,
+    };
+
+    uint32_t crc = esp_rom_crc32_le(0, (const uint8_t *)topic, topic_len);
+    hdr.crc = esp_rom_crc32_le(crc, (const uint8_t *)data, len);
+
+    uint32_t size = record_size(&hdr);
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+
+    if (s_write_pos + size > SECTOR_SIZE)
+    {
+        advance_write_sector();
+    }
+
+    hdr.seq = s_next_seq++;
+
+    memset(s_record_buf, 0xFF, size);
+    memcpy(s_record_buf, &hdr, sizeof(hdr));
+    memcpy(s_record_buf + sizeof(hdr), topic, topic_len);
+    memcpy(s_record_buf + sizeof(hdr) + topic_len, data, len);
+
+    esp_err_t ret = esp_partition_write(s_partition,
+                                        sector_offset(s_write_sector, s_write_pos),
+                                        s_record_buf, size);
+    if (ret == ESP_OK)
+    {
+        if (s_stats.profundidade == 0)
+        {
+            s_read_sector = s_write_sector;
+            s_read_pos = s_write_pos;
+        }
+
+        s_write_pos += size;
+        s_stats.profundidade++;
+        s_stats.bytes += len;
+        s_stats.enfileiradas++;
+    }
+
+    xSemaphoreGive(s_mutex);
+
+    return ret;
+}
+
+esp_err_t offline_queue_peek(offline_queue_msg_t *msg, char *data, size_t size)
+{
+    if (s_partition == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+
+    while (s_stats.profundidade > 0)
+    {
+        record_header_t hdr;
+
+        if (!read_header(s_read_sector, s_read_pos, &hdr))
+        {
+            if (s_read_sector == s_write_sector)
+            {
+                // Contadores inconsistentes (ex.: gravação interrompida)
+                s_stats.profundidade = 0;
+                s_stats.bytes = 0;
+                sync_read_to_write();
+                break;
+            }
+
+            s_read_sector = (s_read_sector + 1) % s_num_sectors;
+            s_read_pos = 0;
+            continue;
+        }
+
+        if (hdr.state != RECORD_PENDING)
+        {
+            s_read_pos += record_size(&hdr);
+            continue;
+        }
+
+        uint32_t offset = sector_offset(s_read_sector, s_read_pos) + sizeof(hdr);
+
+        bool ok = hdr.payload_len <= size &&
+                  esp_partition_read(s_partition, offset, msg->topic, hdr.topic_len) == ESP_OK &&
+                  esp_partition_read(s_partition, offset + hdr.topic_len, data, hdr.payload_len) == ESP_OK;
+
+        if (ok)
+        {
+            uint32_t crc = esp_rom_crc32_le(0, (const uint8_t *)msg->topic, hdr.topic_len);
+            ok = esp_rom_crc32_le(crc, (const uint8_t *)data, hdr.payload_len) == hdr.crc;
+        }
+
+        if (!ok)
+        {
+            ESP_LOGW(TAG, "Registro %lu corrompido, descartando", hdr.seq);
+            mark_consumed(s_read_sector, s_read_pos);
+            s_read_pos += record_size(&hdr);
+            s_stats.profundidade--;
+            s_stats.bytes -= hdr.payload_len;
+            s_stats.descartadas++;
+            continue;
+        }
+
+        msg->topic[hdr.topic_len] = '\0';
+        msg->seq = hdr.seq;
+        msg->qos = hdr.qos;
+        msg->len = hdr.payload_len;
+        ret = ESP_OK;
+        break;
+    }
+
+    xSemaphoreGive(s_mutex);
+
+    return ret;
+}
+
+esp_err_t offline_queue_pop(uint32_t seq)
+{
+    if (s_partition == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+    record_header_t hdr;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+
+    if (s_stats.profundidade > 0 &&
+        read_header(s_read_sector, s_read_pos, &hdr) &&
+        hdr.seq == seq && hdr.state == RECORD_PENDING)
+    {
+        mark_consumed(s_read_sector, s_read_pos);
+        s_read_pos += record_size(&hdr);
+        s_stats.profundidade--;
+        s_stats.bytes -= hdr.payload_len;
+        s_stats.drenadas++;
+
+        if (s_stats.profundidade == 0)
+        {
+            sync_read_to_write();
+        }
+
+        ret = ESP_OK;
+    }
+
+    xSemaphoreGive(s_mutex);
+
+    return ret;
+}
+
+void offline_queue_get_stats(offline_queue_stats_t *stats)
+{
+    if (s_mutex == NULL)
+    {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    *stats = s_stats;
+    xSemaphoreGive(s_mutex);
+}
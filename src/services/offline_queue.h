@@ -0,0 +1,90 @@
+/**
+ * @file offline_queue.h
+ * @brief Fila persistente store-and-forward para mensagens MQTT.
+ *
+ * Armazena mensagens publicadas enquanto o MQTT está desconectado em
+ * um buffer circular log-estruturado na partição de dados
+ * OFFLINE_QUEUE_PARTITION_LABEL. Os setores são apagados apenas quando
+ * a escrita os alcança, distribuindo o desgaste por toda a partição.
+ * As mensagens são drenadas após a reconexão.
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#ifndef OFFLINE_QUEUE_H
+#define OFFLINE_QUEUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "mqtt_system.h"
+
+/** Rótulo da partição de dados usada pela fila (ver partitions.csv) */
+#define OFFLINE_QUEUE_PARTITION_LABEL "offline_q"
+
+/** Tamanho máximo do tópico armazenado (incluindo '\0') */
+#define OFFLINE_QUEUE_MAX_TOPIC 64
+
+/** Tamanho máximo do payload armazenado (bytes) */
+#define OFFLINE_QUEUE_MAX_PAYLOAD 2048
+
+/**
+ * @brief Mensagem lida da fila.
+ */
+typedef struct
+{
+	uint32_t seq;									///< Número de sequência do registro.
+	int qos;											///< QoS original da publicação.
+	int len;											///< Comprimento do payload.
+	char topic[OFFLINE_QUEUE_MAX_TOPIC];	///< Tópico de destino.
+} offline_queue_msg_t;
+
+/**
+ * @brief Localiza a partição e reconstrói o estado da fila.
+ * @return ESP_OK se sucesso, ESP_ERR_NOT_FOUND se a partição não existir.
+ */
+esp_err_t offline_queue_init(void);
+
+/**
+ * @brief Indica se a fila foi inicializada com sucesso.
+ */
+bool offline_queue_is_ready(void);
+
+/**
+ * @brief Armazena uma mensagem na fila.
+ *
+ * Se a partição estiver cheia, o setor mais antigo é descartado.
+ *
+ * @param topic Tópico de destino.
+ * @param data Payload.
+ * @param len Comprimento do payload.
+ * @param qos QoS da publicação original.
+ * @return ESP_OK se sucesso, ESP_ERR_INVALID_SIZE se a mensagem for grande demais.
+ */
+esp_err_t offline_queue_push(const char *topic, const char *data, int len, int qos);
+
+/**
+ * @brief Lê a mensagem pendente mais antiga sem removê-la.
+ * @param msg Metadados da mensagem.
+ * @param data Buffer para o payload (mínimo OFFLINE_QUEUE_MAX_PAYLOAD bytes).
+ * @param size Tamanho do buffer `data`.
+ * @return ESP_OK se sucesso, ESP_ERR_NOT_FOUND se a fila estiver vazia.
+ */
+esp_err_t offline_queue_peek(offline_queue_msg_t *msg, char *data, size_t size);
+
+/**
+ * @brief Marca como consumida a mensagem retornada por offline_queue_peek().
+ * @param seq Número de sequência da mensagem.
+ * @return ESP_OK se sucesso, ESP_ERR_NOT_FOUND se o registro já foi descartado.
+ */
+esp_err_t offline_queue_pop(uint32_t seq);
+
+/**
+ * @brief Obtém as estatísticas da fila.
+ * @param stats Estrutura de destino.
+ */
+void offline_queue_get_stats(offline_queue_stats_t *stats);
+
+#endif /* OFFLINE_QUEUE_H */
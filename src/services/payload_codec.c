@@ -0,0 +1,707 @@
+/**
+ * @file payload_codec.c
+ * @brief Codificação dos payloads de telemetria e health - Implementação
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#include "payload_codec.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/* Definições privadas */
+
+/** Tipos maiores CBOR (RFC 8949) */
+#define CBOR_UINT 0
+#define CBOR_NEGINT 1
+#define CBOR_TEXT 3
+#define CBOR_ARRAY 4
+#define CBOR_MAP 5
+#define CBOR_FALSE 0xF4
+#define CBOR_TRUE 0xF5
+#define CBOR_FLOAT32 0xFA
+
+/** Tamanhos dos registros binários */
+#define BINARY_HEADER_SIZE 4
+#define BINARY_TELEMETRY_SIZE 16
+#define BINARY_HEALTH_SIZE \
+    (88 + 1 + 2 * TASK_ID_COUNT + 4 + 1 + 2 * CPU_STATS_MAX_CORES + 22)
+
+/* Os arrays do registro de health são precedidos pela contagem (uint8) */
+_Static_assert(TASK_ID_COUNT <= UINT8_MAX, "Contagem de tasks nao cabe no registro");
+_Static_assert(CPU_STATS_MAX_CORES <= UINT8_MAX, "Contagem de nucleos nao cabe no registro");
+
+/** Número de campos do mapa CBOR de health (mais os opcionais abaixo, se presentes) */
+#define CBOR_HEALTH_FIELDS 27
+#define CBOR_CPU_FIELDS 3
+#define CBOR_HEAP_RATE_FIELDS 4
+#define CBOR_HEAP_TRACE_FIELDS 2
+
+/** Ociosidade de núcleo sem medição no layout binário */
+#define BINARY_CPU_AUSENTE 0xFFFF
+
+/**
+ * @brief Escritor sequencial com detecção de estouro.
+ */
+typedef struct
+{
+    uint8_t *buf;
+    size_t size;
+    size_t len;
+    bool overflow;
+} writer_t;
+
+/* Funções auxiliares - escrita */
+
+static void put_bytes(writer_t *w, const void *data, size_t len)
+{
+    if (w->overflow || w->len + len > w->size)
+    {
+        w->overflow = true;
+        return;
+    }
+    memcpy(w->buf + w->len, data, len);
+    w->len += len;
+}
+
+static void put_u8(writer_t *w, uint8_t value)
+{
+    put_bytes(w, &value, 1);
+}
+
+static void put_le(writer_t *w, uint64_t value, size_t bytes)
+{
+    uint8_t tmp[8];
+    for (size_t i = 0; i < bytes; i++)
+    {
+        tmp[i] = (uint8_t)(value >> (8 * i));
+    }
+    put_bytes(w, tmp, bytes);
+}
+
+static void put_be(writer_t *w, uint64_t value, size_t bytes)
+{
+    uint8_t tmp[8];
+    for (size_t i = 0; i < bytes; i++)
+    {
+        tmp[i] = (uint8_t)(value >> (8 * (bytes - 1 - i)));
+    }
+    put_bytes(w, tmp, bytes);
+}
+
+/** Converte para inteiro em centésimos com arredondamento */
+static int32_t to_centi(float value)
+{
+    return (int32_t)(value * 100.0f + (value < 0 ? -0.5f : 0.5f));
+}
+
+/* Funções auxiliares - JSON */
+
+static void json_uint(writer_t *w, const char *key, uint64_t value, bool comma)
+{
+    char tmp[40];
+    int n = snprintf(tmp, sizeof(tmp), "%s\"%s\":%llu",
+                     comma ? "," : "", key, (unsigned long long)value);
+    put_bytes(w, tmp, n);
+}
+
+static void json_int(writer_t *w, const char *key, int32_t value, bool comma)
+{
+    char tmp[40];
+    int n = snprintf(tmp, sizeof(tmp), "%s\"%s\":%ld",
+                     comma ? "," : "", key, (long)value);
+    put_bytes(w, tmp, n);
+}
+
+/** Ponto fixo com duas casas, sem printf de float */
+static void json_fixed2(writer_t *w, const char *key, float value, bool comma)
+{
+    int32_t centi = to_centi(value);
+    uint32_t abs_centi = centi < 0 ? (uint32_t)(-centi) : (uint32_t)centi;
+    char tmp[40];
+    int n = snprintf(tmp, sizeof(tmp), "%s\"%s\":%s%lu.%02lu",
+                     comma ? "," : "", key, centi < 0 ? "-" : "",
+                     (unsigned long)(abs_centi / 100), (unsigned long)(abs_centi % 100));
+    put_bytes(w, tmp, n);
+}
+
+/** Objeto "stack_free" com o nome de cada task existente */
+static void json_stack_free(writer_t *w, const uint16_t *livre)
+{
+    static const char key[] = ",\"stack_free\":{";
+    put_bytes(w, key, sizeof(key) - 1);
+    bool first = true;
+    for (int id = 0; id < TASK_ID_COUNT; id++)
+    {
+        if (livre[id] != PAYLOAD_STACK_AUSENTE)
+        {
+            json_uint(w, task_profile_get(id)->nome, livre[id], !first);
+            first = false;
+        }
+    }
+    put_u8(w, '}');
+}
+
+/** Centésimos de % como número com duas casas */
+static void put_centi(writer_t *w, uint32_t centi)
+{
+    char tmp[16];
+    int n = snprintf(tmp, sizeof(tmp), "%lu.%02lu",
+                     (unsigned long)(centi / 100), (unsigned long)(centi % 100));
+    put_bytes(w, tmp, n);
+}
+
+/** Janela, ociosidade por núcleo e tasks com maior uso de CPU */
+static void json_cpu(writer_t *w, const cpu_usage_t *cpu)
+{
+    if (!cpu->valido)
+    {
+        return;
+    }
+
+    json_uint(w, "cpu_window_ms", cpu->janela_ms, true);
+
+    static const char idle_key[] = ",\"cpu_idle\":[";
+    put_bytes(w, idle_key, sizeof(idle_key) - 1);
+    for (int c = 0; c < cpu->nucleos; c++)
+    {
+        if (c > 0)
+        {
+            put_u8(w, ',');
+        }
+        put_centi(w, cpu->ocioso_x100[c]);
+    }
+
+    static const char tasks_key[] = "],\"cpu_tasks\":{";
+    put_bytes(w, tasks_key, sizeof(tasks_key) - 1);
+    for (int i = 0; i < cpu->n_tasks; i++)
+    {
+        char tmp[CPU_STATS_NAME_LEN + 8];
+        int n = snprintf(tmp, sizeof(tmp), "%s\"%s\":", i > 0 ? "," : "", cpu->tasks[i].nome);
+        put_bytes(w, tmp, n);
+        put_centi(w, cpu->tasks[i].uso_x100);
+    }
+    put_u8(w, '}');
+}
+
+/** Maior bloco, fragmentação, regiões, taxas e última captura do heap */
+static void json_heap(writer_t *w, const heap_usage_t *heap)
+{
+    json_uint(w, "heap_largest", heap->maior_bloco, true);
+    static const char frag_key[] = ",\"heap_frag\":";
+    put_bytes(w, frag_key, sizeof(frag_key) - 1);
+    put_centi(w, heap->frag_x100);
+
+    static const char caps_key[] = ",\"heap_caps\":{";
+    put_bytes(w, caps_key, sizeof(caps_key) - 1);
+    bool first = true;
+    for (int r = 0; r < HEAP_REGIAO_COUNT; r++)
+    {
+        const heap_region_info_t *regiao = &heap->regioes[r];
+        if (!regiao->presente)
+        {
+            continue;
+        }
+        char tmp[24];
+        int n = snprintf(tmp, sizeof(tmp), "%s\"%s\":{", first ? "" : ",",
+                         heap_stats_region_name(r));
+        put_bytes(w, tmp, n);
+        json_uint(w, "free", regiao->livre, false);
+        json_uint(w, "largest", regiao->maior_bloco, true);
+        json_uint(w, "min", regiao->minimo, true);
+        put_u8(w, '}');
+        first = false;
+    }
+    put_u8(w, '}');
+
+    if (heap->taxas_validas)
+    {
+        json_uint(w, "heap_window_ms", heap->janela_ms, true);
+        json_uint(w, "heap_allocs", heap->allocs, true);
+        json_uint(w, "heap_frees", heap->frees, true);
+        json_uint(w, "heap_alloc_bytes", heap->bytes_alocados, true);
+    }
+
+    /* Captura: [alocações, bytes] das tasks que alocaram */
+    if (heap->trace.valido)
+    {
+        json_uint(w, "heap_trace_ms", heap->trace.janela_ms, true);
+        static const char trace_key[] = ",\"heap_trace\":{";
+        put_bytes(w, trace_key, sizeof(trace_key) - 1);
+        first = true;
+        for (int i = 0; i < HEAP_TRACE_SLOTS; i++)
+        {
+            if (heap->trace.allocs[i] == 0)
+            {
+                continue;
+            }
+            char tmp[64];
+            int n = snprintf(tmp, sizeof(tmp), "%s\"%s\":[%lu,%lu]", first ? "" : ",",
+                             heap_stats_trace_name(i), (unsigned long)heap->trace.allocs[i],
+                             (unsigned long)heap->trace.bytes[i]);
+            put_bytes(w, tmp, n);
+            first = false;
+        }
+        put_u8(w, '}');
+    }
+}
+
+static void json_telemetry(writer_t *w, const telemetry_data_t *data)
+{
+    put_u8(w, '{');
+    json_fixed2(w, "temperatura", data->temperatura, false);
+    json_fixed2(w, "umidade", data->umidade, true);
+    json_uint(w, "contador", data->contador, true);
+    json_uint(w, "timestamp", data->timestamp, true);
+    put_u8(w, '}');
+}
+
+/* Funções auxiliares - CBOR */
+
+static void cbor_head(writer_t *w, uint8_t major, uint64_t value)
+{
+    uint8_t type = (uint8_t)(major << 5);
+
+    if (value < 24)
+    {
+        put_u8(w, type | (uint8_t)value);
+    }
+    else if (value <= UINT8_MAX)
+    {
+        put_u8(w, type | 24);
+        put_be(w, value, 1);
+    }
+    else if (value <= UINT16_MAX)
+    {
+        put_u8(w, type | 25);
+        put_be(w, value, 2);
+    }
+    else if (value <= UINT32_MAX)
+    {
+        put_u8(w, type | 26);
+        put_be(w, value, 4);
+    }
+    else
+    {
+        put_u8(w, type | 27);
+        put_be(w, value, 8);
+    }
+}
+
+static void cbor_int(writer_t *w, int64_t value)
+{
+    if (value >= 0)
+    {
+        cbor_head(w, CBOR_UINT, (uint64_t)value);
+    }
+    else
+    {
+        cbor_head(w, CBOR_NEGINT, (uint64_t)(-1 - value));
+    }
+}
+
+static void cbor_float(writer_t *w, float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    put_u8(w, CBOR_FLOAT32);
+    put_be(w, bits, 4);
+}
+
+static void cbor_telemetry(writer_t *w, const telemetry_data_t *data)
+{
+    cbor_head(w, CBOR_MAP, 4);
+    cbor_head(w, CBOR_UINT, PAYLOAD_CBOR_KEY_TEMPERATURA);
+    cbor_float(w, data->temperatura);
+    cbor_head(w, CBOR_UINT, PAYLOAD_CBOR_KEY_UMIDADE);
+    cbor_float(w, data->umidade);
+    cbor_head(w, CBOR_UINT, PAYLOAD_CBOR_KEY_CONTADOR);
+    cbor_head(w, CBOR_UINT, data->contador);
+    cbor_head(w, CBOR_UINT, PAYLOAD_CBOR_KEY_TIMESTAMP);
+    cbor_head(w, CBOR_UINT, data->timestamp);
+}
+
+/* Funções auxiliares - binário */
+
+static void binary_header(writer_t *w, uint8_t type, uint8_t count)
+{
+    put_u8(w, PAYLOAD_BINARY_VERSION);
+    put_u8(w, type);
+    put_u8(w, count);
+    put_u8(w, 0);
+}
+
+static void binary_telemetry(writer_t *w, const telemetry_data_t *data)
+{
+    put_le(w, (uint16_t)(int16_t)to_centi(data->temperatura), 2);
+    put_le(w, (uint16_t)to_centi(data->umidade), 2);
+    put_le(w, data->contador, 4);
+    put_le(w, data->timestamp, 8);
+}
+
+/* Implementação das funções públicas */
+
+size_t payload_encode_telemetry(payload_format_t format,
+                                const telemetry_data_t *samples, uint32_t count,
+                                bool as_array, uint8_t *buffer, size_t size,
+                                uint32_t *encoded)
+{
+    writer_t w = {.buf = buffer, .size = size};
+    *encoded = 0;
+
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    if (!as_array)
+    {
+        count = 1;
+    }
+
+    switch (format)
+    {
+    case PAYLOAD_FORMAT_CBOR:
+        // Tamanho indefinido permite truncar o lote sem reescrever o cabeçalho
+        if (as_array)
+        {
+            put_u8(&w, (CBOR_ARRAY << 5) | 31);
+        }
+        for (uint32_t i = 0; i < count; i++)
+        {
+            size_t mark = w.len;
+            cbor_telemetry(&w, &samples[i]);
+            if (w.overflow || (as_array && w.len >= size))
+            {
+                w.len = mark;
+                w.overflow = false;
+                break;
+            }
+            (*encoded)++;
+        }
+        if (as_array)
+        {
+            put_u8(&w, 0xFF);
+        }
+        break;
+
+    case PAYLOAD_FORMAT_BINARY:
+    {
+        uint32_t max = (size > BINARY_HEADER_SIZE) ? (size - BINARY_HEADER_SIZE) / BINARY_TELEMETRY_SIZE : 0;
+        if (count > max)
+        {
+            count = max;
+        }
+        if (count > UINT8_MAX)
+        {
+            count = UINT8_MAX;
+        }
+        binary_header(&w, PAYLOAD_BINARY_TYPE_TELEMETRY, (uint8_t)count);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            binary_telemetry(&w, &samples[i]);
+        }
+        *encoded = w.overflow ? 0 : count;
+        break;
+    }
+
+    case PAYLOAD_FORMAT_JSON:
+    default:
+        if (as_array)
+        {
+            put_u8(&w, '[');
+        }
+        for (uint32_t i = 0; i < count; i++)
+        {
+            size_t mark = w.len;
+            if (i > 0)
+            {
+                put_u8(&w, ',');
+            }
+            json_telemetry(&w, &samples[i]);
+            // Reserva espaço para ']' e '\0'
+            if (w.overflow || w.len + 2 > size)
+            {
+                w.len = mark;
+                w.overflow = false;
+                break;
+            }
+            (*encoded)++;
+        }
+        if (as_array)
+        {
+            put_u8(&w, ']');
+        }
+        if (!w.overflow && w.len < size)
+        {
+            buffer[w.len] = '\0';
+        }
+        break;
+    }
+
+    if (w.overflow || *encoded == 0)
+    {
+        *encoded = 0;
+        return 0;
+    }
+
+    return w.len;
+}
+
+size_t payload_encode_health(payload_format_t format, const health_report_t *report,
+                             uint8_t *buffer, size_t size)
+{
+    writer_t w = {.buf = buffer, .size = size};
+    const health_status_t *h = &report->health;
+    const mqtt_statistics_t *s = &report->stats;
+    const offline_queue_stats_t *q = &report->offline;
+    const actuator_stats_t *a = &report->atuacao;
+    const cpu_usage_t *cpu = &h->cpu;
+    const heap_usage_t *heap = &h->heap;
+
+    switch (format)
+    {
+    case PAYLOAD_FORMAT_CBOR:
+    {
+        uint32_t campos = CBOR_HEALTH_FIELDS + (cpu->valido ? CBOR_CPU_FIELDS : 0) +
+                          (heap->taxas_validas ? CBOR_HEAP_RATE_FIELDS : 0) +
+                          (heap->trace.valido ? CBOR_HEAP_TRACE_FIELDS : 0);
+        cbor_head(&w, CBOR_MAP, campos);
+        cbor_head(&w, CBOR_UINT, 1);
+        cbor_head(&w, CBOR_UINT, h->free_heap);
+        cbor_head(&w, CBOR_UINT, 2);
+        cbor_head(&w, CBOR_UINT, h->min_free_heap);
+        cbor_head(&w, CBOR_UINT, 3);
+        cbor_int(&w, h->wifi_rssi);
+        cbor_head(&w, CBOR_UINT, 4);
+        cbor_head(&w, CBOR_UINT, h->uptime_sec);
+        cbor_head(&w, CBOR_UINT, 5);
+        put_u8(&w, h->mqtt_connected ? CBOR_TRUE : CBOR_FALSE);
+        cbor_head(&w, CBOR_UINT, 6);
+        cbor_head(&w, CBOR_UINT, s->total_publicadas);
+        cbor_head(&w, CBOR_UINT, 7);
+        cbor_head(&w, CBOR_UINT, s->total_recebidas);
+        cbor_head(&w, CBOR_UINT, 8);
+        cbor_head(&w, CBOR_UINT, s->falhas_publicacao);
+        cbor_head(&w, CBOR_UINT, 9);
+        cbor_head(&w, CBOR_UINT, s->desconexoes);
+        cbor_head(&w, CBOR_UINT, 10);
+        cbor_head(&w, CBOR_UINT, q->profundidade);
+        cbor_head(&w, CBOR_UINT, 11);
+        cbor_head(&w, CBOR_UINT, q->bytes);
+        cbor_head(&w, CBOR_UINT, 12);
+        cbor_head(&w, CBOR_UINT, q->descartadas);
+        cbor_head(&w, CBOR_UINT, 13);
+        cbor_head(&w, CBOR_UINT, s->ack_amostras);
+        cbor_head(&w, CBOR_UINT, 14);
+        cbor_head(&w, CBOR_UINT, s->ack_p50_us);
+        cbor_head(&w, CBOR_UINT, 15);
+        cbor_head(&w, CBOR_UINT, s->ack_p95_us);
+        cbor_head(&w, CBOR_UINT, 16);
+        cbor_head(&w, CBOR_UINT, s->ack_p99_us);
+        cbor_head(&w, CBOR_UINT, 17);
+        cbor_head(&w, CBOR_UINT, s->ack_max_us);
+        cbor_head(&w, CBOR_UINT, 18);
+        cbor_head(&w, CBOR_UINT, a->latencia.amostras);
+        cbor_head(&w, CBOR_UINT, 19);
+        cbor_head(&w, CBOR_UINT, a->latencia.p50_us);
+        cbor_head(&w, CBOR_UINT, 20);
+        cbor_head(&w, CBOR_UINT, a->latencia.p95_us);
+        cbor_head(&w, CBOR_UINT, 21);
+        cbor_head(&w, CBOR_UINT, a->latencia.p99_us);
+        cbor_head(&w, CBOR_UINT, 22);
+        cbor_head(&w, CBOR_UINT, a->latencia.max_us);
+        cbor_head(&w, CBOR_UINT, 23);
+        cbor_head(&w, CBOR_UINT, a->descartados);
+        /* Stack livre: array na ordem de task_id_t */
+        cbor_head(&w, CBOR_UINT, 24);
+        cbor_head(&w, CBOR_ARRAY, TASK_ID_COUNT);
+        for (int id = 0; id < TASK_ID_COUNT; id++)
+        {
+            cbor_head(&w, CBOR_UINT, report->stack_livre[id]);
+        }
+        /* CPU em centésimos de %: ociosidade por núcleo e mapa nome -> uso */
+        if (cpu->valido)
+        {
+            cbor_head(&w, CBOR_UINT, 25);
+            cbor_head(&w, CBOR_UINT, cpu->janela_ms);
+            cbor_head(&w, CBOR_UINT, 26);
+            cbor_head(&w, CBOR_ARRAY, cpu->nucleos);
+            for (int c = 0; c < cpu->nucleos; c++)
+            {
+                cbor_head(&w, CBOR_UINT, cpu->ocioso_x100[c]);
+            }
+            cbor_head(&w, CBOR_UINT, 27);
+            cbor_head(&w, CBOR_MAP, cpu->n_tasks);
+            for (int i = 0; i < cpu->n_tasks; i++)
+            {
+                size_t len = strlen(cpu->tasks[i].nome);
+                cbor_head(&w, CBOR_TEXT, len);
+                put_bytes(&w, cpu->tasks[i].nome, len);
+                cbor_head(&w, CBOR_UINT, cpu->tasks[i].uso_x100);
+            }
+        }
+        /* Heap: regiões como mapa nome -> [livre, maior bloco, mínimo] */
+        cbor_head(&w, CBOR_UINT, 28);
+        cbor_head(&w, CBOR_UINT, heap->maior_bloco);
+        cbor_head(&w, CBOR_UINT, 29);
+        cbor_head(&w, CBOR_UINT, heap->frag_x100);
+        cbor_head(&w, CBOR_UINT, 30);
+        int presentes = 0;
+        for (int r = 0; r < HEAP_REGIAO_COUNT; r++)
+        {
+            presentes += heap->regioes[r].presente ? 1 : 0;
+        }
+        cbor_head(&w, CBOR_MAP, presentes);
+        for (int r = 0; r < HEAP_REGIAO_COUNT; r++)
+        {
+            const heap_region_info_t *regiao = &heap->regioes[r];
+            if (!regiao->presente)
+            {
+                continue;
+            }
+            const char *nome = heap_stats_region_name(r);
+            cbor_head(&w, CBOR_TEXT, strlen(nome));
+            put_bytes(&w, nome, strlen(nome));
+            cbor_head(&w, CBOR_ARRAY, 3);
+            cbor_head(&w, CBOR_UINT, regiao->livre);
+            cbor_head(&w, CBOR_UINT, regiao->maior_bloco);
+            cbor_head(&w, CBOR_UINT, regiao->minimo);
+        }
+        if (heap->taxas_validas)
+        {
+            cbor_head(&w, CBOR_UINT, 31);
+            cbor_head(&w, CBOR_UINT, heap->janela_ms);
+            cbor_head(&w, CBOR_UINT, 32);
+            cbor_head(&w, CBOR_UINT, heap->allocs);
+            cbor_head(&w, CBOR_UINT, 33);
+            cbor_head(&w, CBOR_UINT, heap->frees);
+            cbor_head(&w, CBOR_UINT, 34);
+            cbor_head(&w, CBOR_UINT, heap->bytes_alocados);
+        }
+        /* Captura: mapa nome -> [alocações, bytes] das tasks que alocaram */
+        if (heap->trace.valido)
+        {
+            cbor_head(&w, CBOR_UINT, 35);
+            cbor_head(&w, CBOR_UINT, heap->trace.janela_ms);
+            cbor_head(&w, CBOR_UINT, 36);
+            int com_alocacoes = 0;
+            for (int i = 0; i < HEAP_TRACE_SLOTS; i++)
+            {
+                com_alocacoes += heap->trace.allocs[i] > 0 ? 1 : 0;
+            }
+            cbor_head(&w, CBOR_MAP, com_alocacoes);
+            for (int i = 0; i < HEAP_TRACE_SLOTS; i++)
+            {
+                if (heap->trace.allocs[i] == 0)
+                {
+                    continue;
+                }
+                const char *nome = heap_stats_trace_name(i);
+                cbor_head(&w, CBOR_TEXT, strlen(nome));
+                put_bytes(&w, nome, strlen(nome));
+                cbor_head(&w, CBOR_ARRAY, 2);
+                cbor_head(&w, CBOR_UINT, heap->trace.allocs[i]);
+                cbor_head(&w, CBOR_UINT, heap->trace.bytes[i]);
+            }
+        }
+        break;
+    }
+
+    case PAYLOAD_FORMAT_BINARY:
+        if (size < BINARY_HEADER_SIZE + BINARY_HEALTH_SIZE)
+        {
+            return 0;
+        }
+        binary_header(&w, PAYLOAD_BINARY_TYPE_HEALTH, 1);
+        put_le(&w, h->free_heap, 4);
+        put_le(&w, h->min_free_heap, 4);
+        put_le(&w, (uint8_t)(int8_t)h->wifi_rssi, 1);
+        put_u8(&w, h->mqtt_connected ? 0x01 : 0x00);
+        put_le(&w, 0, 2);
+        put_le(&w, (uint32_t)h->uptime_sec, 4);
+        put_le(&w, s->total_publicadas, 4);
+        put_le(&w, s->total_recebidas, 4);
+        put_le(&w, s->falhas_publicacao, 4);
+        put_le(&w, s->desconexoes, 4);
+        put_le(&w, q->profundidade, 4);
+        put_le(&w, q->bytes, 4);
+        put_le(&w, q->descartadas, 4);
+        put_le(&w, s->ack_amostras, 4);
+        put_le(&w, s->ack_p50_us, 4);
+        put_le(&w, s->ack_p95_us, 4);
+        put_le(&w, s->ack_p99_us, 4);
+        put_le(&w, s->ack_max_us, 4);
+        put_le(&w, a->latencia.amostras, 4);
+        put_le(&w, a->latencia.p50_us, 4);
+        put_le(&w, a->latencia.p95_us, 4);
+        put_le(&w, a->latencia.p99_us, 4);
+        put_le(&w, a->latencia.max_us, 4);
+        put_le(&w, a->descartados, 4);
+        put_u8(&w, TASK_ID_COUNT);
+        for (int id = 0; id < TASK_ID_COUNT; id++)
+        {
+            put_le(&w, report->stack_livre[id], 2);
+        }
+        /* Só a ociosidade por núcleo; as tasks ficam para JSON e CBOR */
+        put_le(&w, cpu->valido ? cpu->janela_ms : 0, 4);
+        put_u8(&w, CPU_STATS_MAX_CORES);
+        for (int c = 0; c < CPU_STATS_MAX_CORES; c++)
+        {
+            bool medido = cpu->valido && c < cpu->nucleos;
+            put_le(&w, medido ? cpu->ocioso_x100[c] : BINARY_CPU_AUSENTE, 2);
+        }
+        /* Heap: sem regiões nem captura, que ficam para JSON e CBOR */
+        put_le(&w, heap->maior_bloco, 4);
+        put_le(&w, heap->frag_x100, 2);
+        put_le(&w, heap->taxas_validas ? heap->janela_ms : 0, 4);
+        put_le(&w, heap->allocs, 4);
+        put_le(&w, heap->frees, 4);
+        put_le(&w, heap->bytes_alocados, 4);
+        break;
+
+    case PAYLOAD_FORMAT_JSON:
+    default:
+        put_u8(&w, '{');
+        json_uint(&w, "free_heap", h->free_heap, false);
+        json_uint(&w, "min_free_heap", h->min_free_heap, true);
+        json_int(&w, "wifi_rssi", h->wifi_rssi, true);
+        json_uint(&w, "uptime_sec", h->uptime_sec, true);
+        json_uint(&w, "mqtt_connected", h->mqtt_connected ? 1 : 0, true);
+        json_uint(&w, "msgs_sent", s->total_publicadas, true);
+        json_uint(&w, "msgs_received", s->total_recebidas, true);
+        json_uint(&w, "mqtt_failures", s->falhas_publicacao, true);
+        json_uint(&w, "disconnects", s->desconexoes, true);
+        json_uint(&w, "offline_depth", q->profundidade, true);
+        json_uint(&w, "offline_bytes", q->bytes, true);
+        json_uint(&w, "offline_dropped", q->descartadas, true);
+        json_uint(&w, "ack_samples", s->ack_amostras, true);
+        json_uint(&w, "ack_p50_us", s->ack_p50_us, true);
+        json_uint(&w, "ack_p95_us", s->ack_p95_us, true);
+        json_uint(&w, "ack_p99_us", s->ack_p99_us, true);
+        json_uint(&w, "ack_max_us", s->ack_max_us, true);
+        json_uint(&w, "act_samples", a->latencia.amostras, true);
+        json_uint(&w, "act_p50_us", a->latencia.p50_us, true);
+        json_uint(&w, "act_p95_us", a->latencia.p95_us, true);
+        json_uint(&w, "act_p99_us", a->latencia.p99_us, true);
+        json_uint(&w, "act_max_us", a->latencia.max_us, true);
+        json_uint(&w, "act_dropped", a->descartados, true);
+        json_stack_free(&w, report->stack_livre);
+        json_cpu(&w, cpu);
+        json_heap(&w, heap);
+        put_u8(&w, '}');
+        if (!w.overflow && w.len < size)
+        {
+            buffer[w.len] = '\0';
+        }
+        else
+        {
+            w.overflow = true;
+        }
+        break;
+    }
+
+    return w.overflow ? 0 : w.len;
+}
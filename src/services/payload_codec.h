@@ -0,0 +1,107 @@
+/**
+ * @file payload_codec.h
+ * @brief Codificação dos payloads de telemetria e health.
+ *
+ * Suporta três formatos de fio, selecionáveis por tópico:
+ * - JSON: formato original, legível (tópico base).
+ * - CBOR: mapas com chaves inteiras (tópico base + "/cbor").
+ * - Binário compacto versionado, little-endian (tópico base + "/bin").
+ *
+ * Nenhum formato usa printf de ponto flutuante. O decodificador para o
+ * host está em tools/payload_codec.py.
+ *
+ * Layout binário v2 (PAYLOAD_BINARY_VERSION):
+ * - Cabeçalho (4 bytes): versão, tipo (1 = telemetria, 2 = health),
+ *   quantidade de registros, reservado.
+ * - Telemetria (16 bytes): int16 temperatura x100, uint16 umidade x100,
+ *   uint32 contador, uint64 timestamp.
+ * - Health: uint32 free_heap, uint32 min_free_heap, int8 rssi,
+ *   uint8 flags (bit0 = mqtt_connected), uint16 reservado,
+ *   uint32 uptime_sec, uint32 msgs_sent, msgs_received, mqtt_failures,
+ *   disconnects, offline_depth, offline_bytes, offline_dropped, as
+ *   latências de ACK e de atuação (uint32); uint8 número de tasks e o
+ *   menor stack livre de cada uma (uint16, na ordem de task_id_t,
+ *   PAYLOAD_STACK_AUSENTE para task inexistente); a janela de CPU (uint32
+ *   ms, 0 sem medição), uint8 número de núcleos e a ociosidade de cada um
+ *   (uint16 em centésimos de %, 0xFFFF sem medição); o maior bloco livre
+ *   (uint32), a fragmentação (uint16 em centésimos de %) e a janela do
+ *   heap (uint32 ms, 0 sem hooks) com alocações, liberações e bytes
+ *   alocados (uint32). O uso de CPU por task, as regiões do heap e a
+ *   captura por task só existem em JSON e CBOR.
+ *
+ * Toda mudança de layout incrementa a versão. A v1 não tinha as
+ * contagens: o array de stacks crescia com task_id_t e deslocava os
+ * campos seguintes.
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#ifndef PAYLOAD_CODEC_H
+#define PAYLOAD_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "mqtt_system.h"
+#include "actuator.h"
+#include "task_profile.h"
+
+/** Versão do layout binário compacto */
+#define PAYLOAD_BINARY_VERSION 2
+
+/** Tipos de registro do layout binário */
+#define PAYLOAD_BINARY_TYPE_TELEMETRY 1
+#define PAYLOAD_BINARY_TYPE_HEALTH 2
+
+/** Stack livre de uma task que não existe (CBOR e binário) */
+#define PAYLOAD_STACK_AUSENTE 0xFFFF
+
+/** Chaves CBOR do mapa de telemetria */
+#define PAYLOAD_CBOR_KEY_TEMPERATURA 1
+#define PAYLOAD_CBOR_KEY_UMIDADE 2
+#define PAYLOAD_CBOR_KEY_CONTADOR 3
+#define PAYLOAD_CBOR_KEY_TIMESTAMP 4
+
+/**
+ * @brief Dados agregados publicados no tópico de health.
+ */
+typedef struct
+{
+	health_status_t health;			 ///< Métricas de saúde.
+	mqtt_statistics_t stats;		 ///< Estatísticas MQTT.
+	offline_queue_stats_t offline; ///< Estatísticas da fila offline.
+	actuator_stats_t atuacao;		 ///< Latência mensagem→pino e descartes.
+	uint16_t stack_livre[TASK_ID_COUNT]; ///< Menor stack livre por task (bytes ou PAYLOAD_STACK_AUSENTE).
+} health_report_t;
+
+/**
+ * @brief Codifica amostras de telemetria.
+ *
+ * @param format Formato de saída.
+ * @param samples Amostras a codificar.
+ * @param count Número de amostras.
+ * @param as_array true para enquadrar como lote (array), false para
+ *        codificar apenas a primeira amostra como objeto único.
+ * @param buffer Buffer de destino.
+ * @param size Tamanho do buffer.
+ * @param encoded Número de amostras que couberam no buffer.
+ * @return Comprimento do payload em bytes (0 se nenhuma amostra coube).
+ */
+size_t payload_encode_telemetry(payload_format_t format,
+                                const telemetry_data_t *samples, uint32_t count,
+                                bool as_array, uint8_t *buffer, size_t size,
+                                uint32_t *encoded);
+
+/**
+ * @brief Codifica o relatório de health.
+ * @param format Formato de saída.
+ * @param report Dados a codificar.
+ * @param buffer Buffer de destino.
+ * @param size Tamanho do buffer.
+ * @return Comprimento do payload em bytes (0 se não coube).
+ */
+size_t payload_encode_health(payload_format_t format, const health_report_t *report,
+                             uint8_t *buffer, size_t size);
+
+#endif /* PAYLOAD_CODEC_H */
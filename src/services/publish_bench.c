@@ -0,0 +1,384 @@
+/**
+ * @file publish_bench.c
+ * @brief Implementação do microbenchmark do caminho de publicação.
+ *
+ * Cada caso executa PUBLISH_BENCH_WARMUP chamadas de aquecimento e
+ * PUBLISH_BENCH_ROUNDS rodadas de PUBLISH_BENCH_ITERATIONS chamadas
+ * medidas. A leitura do heap fica fora da janela de ciclos para não
+ * contaminar a medição.
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#ifdef CONFIG_PUBLISH_BENCH
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "mqtt_system.h"
+#include "publish_bench.h"
+#include "topic_trie.h"
+
+/* Definições privadas */
+
+#if defined(CONFIG_HOST_MODE)
+#define BENCH_PLATFORM "host"
+#elif defined(CONFIG_QEMU_MODE)
+#define BENCH_PLATFORM "qemu"
+#else
+#define BENCH_PLATFORM "esp32"
+#endif
+
+/** Tópico fora dos handlers registrados (custo do dispatch sem destino) */
+#define BENCH_TOPIC MQTT_TOPIC_BASE "/bench"
+
+/** Payload do caso de publicação QoS 1 */
+#define BENCH_PAYLOAD_SIZE 256
+
+/** Dispositivos do caso da trie; cada um registra 4 filtros com curingas */
+#define BENCH_TRIE_DEVICES (PUBLISH_BENCH_TRIE_FILTERS / 4)
+
+/** Função medida; recebe o índice da iteração */
+typedef void (*bench_fn_t)(uint32_t iteration);
+
+typedef struct
+{
+    const char *name;
+    bench_fn_t prepare; ///< Executada antes de cada chamada, fora da medição (opcional)
+    bench_fn_t run;
+} bench_case_t;
+
+/* Variáveis privadas (static) */
+
+static const char *TAG = "PUB_BENCH";
+
+/** Amostras do caso atual (estáticas: não cabem na stack da app_main) */
+static uint32_t s_cycles[PUBLISH_BENCH_ITERATIONS];
+
+/** Bytes entregues ao destino; impede que o payload seja descartado */
+static volatile uint32_t s_sink_bytes = 0;
+static int s_sink_msg_id = 0;
+
+static char s_payload[BENCH_PAYLOAD_SIZE];
+
+/** Tópico da próxima busca na trie (montado fora da medição) */
+static char s_trie_topic[64];
+static int s_trie_topic_len = 0;
+
+/* Destino das publicações */
+
+static int bench_sink(const char *topic, const char *data, int len, int qos, bool retain)
+{
+    s_sink_bytes += (uint32_t)len + (uint8_t)data[0];
+
+    /* Mesmo contrato do esp-mqtt: 0 para QoS 0, msg_id > 0 caso contrário */
+    if (qos == 0)
+    {
+        return 0;
+    }
+    s_sink_msg_id = (s_sink_msg_id % 0xFFFF) + 1;
+    return s_sink_msg_id;
+}
+
+/* Casos */
+
+static void make_sample(uint32_t iteration, telemetry_data_t *sample)
+{
+    sample->temperatura = 20.0f + (float)(iteration % 150) / 10.0f;
+    sample->umidade = 40.0f + (float)(iteration % 400) / 10.0f;
+    sample->contador = iteration;
+    sample->timestamp = esp_timer_get_time() / 1000ULL;
+}
+
+static void case_publish_qos0(uint32_t iteration)
+{
+    mqtt_publish_data(BENCH_TOPIC, "42", 0, 0, false);
+}
+
+static void case_publish_qos1(uint32_t iteration)
+{
+    mqtt_publish_data(BENCH_TOPIC, s_payload, sizeof(s_payload), 1, false);
+}
+
+static void case_telemetry(uint32_t iteration)
+{
+    telemetry_data_t sample;
+    make_sample(iteration, &sample);
+    mqtt_publish_telemetry(&sample);
+}
+
+/** Enche o lote até uma amostra antes do envio automático */
+static void prepare_flush(uint32_t iteration)
+{
+    telemetry_data_t sample;
+    for (uint32_t i = 0; i + 1 < MQTT_TELEMETRY_BATCH_SIZE; i++)
+    {
+        make_sample(iteration + i, &sample);
+        mqtt_publish_telemetry(&sample);
+    }
+}
+
+static void case_flush(uint32_t iteration)
+{
+    mqtt_flush_telemetry();
+}
+
+static void case_health(uint32_t iteration)
+{
+    mqtt_publish_health_check();
+}
+
+static void case_inbound_luminosity(uint32_t iteration)
+{
+    /* Alterna acima/abaixo do limiar para exercitar os dois ramos */
+    const char *value = (iteration & 1) ? "2" : "9";
+    mqtt_bench_inject_data(MQTT_TOPIC_LUMINOSITY, value, 1);
+}
+
+static void case_inbound_temperature(uint32_t iteration)
+{
+    const char *value = (iteration & 1) ? "31" : "18";
+    mqtt_bench_inject_data(MQTT_TOPIC_TEMPERATURE, value, 2);
+}
+
+static void case_inbound_unrouted(uint32_t iteration)
+{
+    mqtt_bench_inject_data(BENCH_TOPIC, "42", 2);
+}
+
+static void trie_handler(const mqtt_message_t *msg, void *ctx)
+{
+    s_sink_bytes += (uint32_t)msg->topic_len;
+}
+
+static void prepare_trie(uint32_t iteration)
+{
+    /* Casa "devN/+/estado" e "devN/#"; percorre também o ramo "+/devN/temp" */
+    s_trie_topic_len = snprintf(s_trie_topic, sizeof(s_trie_topic), "bench/trie/dev%03lu/sala/estado",
+                                (unsigned long)(iteration % BENCH_TRIE_DEVICES));
+}
+
+static void case_trie_match(uint32_t iteration)
+{
+    const mqtt_message_t msg = {
+        .topic = s_trie_topic,
+        .topic_len = s_trie_topic_len,
+        .data = "1",
+        .data_len = 1,
+    };
+    topic_trie_dispatch(&msg);
+}
+
+/* Funções auxiliares */
+
+/**
+ * @brief Registra (ou remove) os filtros do caso da trie.
+ * @return Número de filtros processados com sucesso.
+ */
+static uint32_t trie_filters(bool registrar)
+{
+    static const char *const s_formatos[] = {
+        "bench/trie/dev%03u/+/estado",
+        "bench/trie/dev%03u/#",
+        "bench/trie/+/dev%03u/temp",
+        "bench/trie/dev%03u/sensor/+",
+    };
+    char filtro[64];
+    uint32_t ok = 0;
+
+    for (unsigned dev = 0; dev < BENCH_TRIE_DEVICES; dev++)
+    {
+        for (size_t f = 0; f < sizeof(s_formatos) / sizeof(s_formatos[0]); f++)
+        {
+            snprintf(filtro, sizeof(filtro), s_formatos[f], dev);
+            esp_err_t ret = registrar ? mqtt_register_handler(filtro, trie_handler, NULL)
+                                      : mqtt_unregister_handler(filtro, trie_handler);
+            ok += (ret == ESP_OK);
+        }
+    }
+
+    return ok;
+}
+
+static int compare_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Percentil por posição mais próxima (nearest-rank) do vetor ordenado.
+ */
+static uint32_t percentile(const uint32_t *sorted, uint32_t count, uint32_t pct)
+{
+    uint32_t rank = (pct * count + 99) / 100;
+    return sorted[(rank > 0 ? rank : 1) - 1];
+}
+
+static void run_case(const bench_case_t *bench)
+{
+    uint32_t best[4] = {UINT32_MAX, UINT32_MAX, UINT32_MAX, UINT32_MAX}; // p50, p90, p99, máx
+    int64_t heap_total = 0;
+    int32_t heap_max = 0;
+
+    esp_log_level_set("*", ESP_LOG_WARN);
+
+    for (uint32_t i = 0; i < PUBLISH_BENCH_WARMUP; i++)
+    {
+        if (bench->prepare)
+        {
+            bench->prepare(i);
+        }
+        bench->run(i);
+    }
+
+    for (uint32_t round = 0; round < PUBLISH_BENCH_ROUNDS; round++)
+    {
+        for (uint32_t i = 0; i < PUBLISH_BENCH_ITERATIONS; i++)
+        {
+            if (bench->prepare)
+            {
+                bench->prepare(i);
+            }
+
+            uint32_t heap_before = esp_get_free_heap_size();
+            esp_cpu_cycle_count_t start = esp_cpu_get_cycle_count();
+
+            bench->run(i);
+
+            s_cycles[i] = (uint32_t)(esp_cpu_get_cycle_count() - start);
+            int32_t heap_delta = (int32_t)(heap_before - esp_get_free_heap_size());
+
+            heap_total += heap_delta;
+            if (heap_delta > heap_max)
+            {
+                heap_max = heap_delta;
+            }
+        }
+
+        qsort(s_cycles, PUBLISH_BENCH_ITERATIONS, sizeof(s_cycles[0]), compare_u32);
+
+        const uint32_t round_values[4] = {
+            percentile(s_cycles, PUBLISH_BENCH_ITERATIONS, 50),
+            percentile(s_cycles, PUBLISH_BENCH_ITERATIONS, 90),
+            percentile(s_cycles, PUBLISH_BENCH_ITERATIONS, 99),
+            s_cycles[PUBLISH_BENCH_ITERATIONS - 1],
+        };
+        for (int k = 0; k < 4; k++)
+        {
+            if (round_values[k] < best[k])
+            {
+                best[k] = round_values[k];
+            }
+        }
+
+        /* Libera a CPU para a idle task entre rodadas (task watchdog) */
+        vTaskDelay(1);
+    }
+
+    /* Não deixa amostras pendentes para o próximo caso */
+    mqtt_flush_telemetry();
+    esp_log_level_set("*", ESP_LOG_INFO);
+
+    ESP_LOGI(TAG, "BENCH name=%s n=%d p50=%lu p90=%lu p99=%lu max=%lu heap_avg=%ld heap_max=%ld",
+             bench->name, PUBLISH_BENCH_ITERATIONS * PUBLISH_BENCH_ROUNDS,
+             (unsigned long)best[0], (unsigned long)best[1],
+             (unsigned long)best[2], (unsigned long)best[3],
+             (long)(heap_total / (PUBLISH_BENCH_ITERATIONS * PUBLISH_BENCH_ROUNDS)),
+             (long)heap_max);
+}
+
+/**
+ * @brief Executa os casos de telemetria e health em um formato de payload.
+ */
+static void run_format_cases(payload_format_t format, const char *suffix)
+{
+    char names[3][32];
+    snprintf(names[0], sizeof(names[0]), "telemetry_%s", suffix);
+    snprintf(names[1], sizeof(names[1]), "telemetry_flush_%s", suffix);
+    snprintf(names[2], sizeof(names[2]), "health_%s", suffix);
+
+    const bench_case_t cases[] = {
+        {names[0], NULL, case_telemetry},
+        {names[1], prepare_flush, case_flush},
+        {names[2], NULL, case_health},
+    };
+
+    mqtt_set_payload_format(MQTT_PAYLOAD_TELEMETRY, format);
+    mqtt_set_payload_format(MQTT_PAYLOAD_HEALTH, format);
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        run_case(&cases[i]);
+    }
+}
+
+/* Implementação das funções públicas */
+
+esp_err_t publish_bench_run(void)
+{
+    static const bench_case_t s_cases[] = {
+        {"publish_data_qos0", NULL, case_publish_qos0},
+        {"publish_data_qos1_256b", NULL, case_publish_qos1},
+        {"inbound_luminosity", NULL, case_inbound_luminosity},
+        {"inbound_temperature", NULL, case_inbound_temperature},
+        {"inbound_unrouted", NULL, case_inbound_unrouted},
+    };
+
+    esp_err_t ret = mqtt_bench_attach(bench_sink);
+    if (ret != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Falha ao preparar benchmark: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    memset(s_payload, 'x', sizeof(s_payload));
+
+    ESP_LOGI(TAG, "BENCH_BEGIN platform=%s iterations=%d rounds=%d warmup=%d unit=cycles",
+             BENCH_PLATFORM, PUBLISH_BENCH_ITERATIONS, PUBLISH_BENCH_ROUNDS, PUBLISH_BENCH_WARMUP);
+    int64_t start_us = esp_timer_get_time();
+
+    for (size_t i = 0; i < sizeof(s_cases) / sizeof(s_cases[0]); i++)
+    {
+        run_case(&s_cases[i]);
+    }
+
+    run_format_cases(PAYLOAD_FORMAT_JSON, "json");
+    run_format_cases(PAYLOAD_FORMAT_CBOR, "cbor");
+    run_format_cases(PAYLOAD_FORMAT_BINARY, "binary");
+
+    /* Por último: com os filtros ativos, todo tópico sem handler exato percorre a trie */
+    uint32_t filtros = trie_filters(true);
+    if (filtros == BENCH_TRIE_DEVICES * 4)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "trie_match_%lu", (unsigned long)filtros);
+        const bench_case_t trie_case = {name, prepare_trie, case_trie_match};
+        run_case(&trie_case);
+    }
+    else
+    {
+        ESP_LOGE(TAG, "Trie aceitou %lu de %d filtros; aumente TOPIC_TRIE_MAX_*",
+                 (unsigned long)filtros, BENCH_TRIE_DEVICES * 4);
+    }
+    trie_filters(false);
+
+    mqtt_set_payload_format(MQTT_PAYLOAD_TELEMETRY, MQTT_TELEMETRY_FORMAT);
+    mqtt_set_payload_format(MQTT_PAYLOAD_HEALTH, MQTT_HEALTH_FORMAT);
+    mqtt_bench_attach(NULL);
+
+    ESP_LOGI(TAG, "BENCH_END duracao_ms=%lu",
+             (unsigned long)((esp_timer_get_time() - start_us) / 1000));
+    return ESP_OK;
+}
+
+#endif /* CONFIG_PUBLISH_BENCH */
@@ -0,0 +1,59 @@
+/**
+ * @file publish_bench.h
+ * @brief Microbenchmark do caminho de publicação e recepção MQTT.
+ *
+ * Mede ciclos de CPU (esp_cpu_get_cycle_count) e variação de heap por
+ * chamada de mqtt_publish_data, mqtt_publish_telemetry,
+ * mqtt_flush_telemetry e mqtt_publish_health_check em cada formato de
+ * payload, além do caminho MQTT_EVENT_DATA do handler de eventos e da
+ * busca na trie de filtros com PUBLISH_BENCH_TRIE_FILTERS filtros. As
+ * publicações são desviadas para um destino local (mqtt_bench_attach),
+ * então os números não incluem rede nem o cliente esp-mqtt.
+ *
+ * Cada caso roda PUBLISH_BENCH_ROUNDS rodadas e cada percentil reportado
+ * é o menor entre as rodadas, o que descarta interferências transitórias
+ * (interrupções, preempção, escalonamento do host).
+ *
+ * Os resultados são impressos em linhas "BENCH ..." com p50/p90/p99/máx,
+ * lidas por tools/publish_bench.py para comparação com a baseline
+ * armazenada em tools/publish_bench_baseline.json.
+ *
+ * Compilado apenas com CONFIG_PUBLISH_BENCH (ambientes host-bench e
+ * esp32-qemu-bench do platformio.ini).
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#ifndef PUBLISH_BENCH_H
+#define PUBLISH_BENCH_H
+
+#include "esp_err.h"
+
+#ifndef PUBLISH_BENCH_ITERATIONS
+#define PUBLISH_BENCH_ITERATIONS 1000 ///< Amostras medidas por rodada
+#endif
+
+#ifndef PUBLISH_BENCH_ROUNDS
+#define PUBLISH_BENCH_ROUNDS 7 ///< Rodadas por caso; reporta o melhor percentil entre elas
+#endif
+
+#ifndef PUBLISH_BENCH_TRIE_FILTERS
+#define PUBLISH_BENCH_TRIE_FILTERS 400 ///< Filtros com curingas registrados no caso da trie
+#endif
+
+#ifndef PUBLISH_BENCH_WARMUP
+#define PUBLISH_BENCH_WARMUP 20 ///< Chamadas descartadas antes da medição
+#endif
+
+/**
+ * @brief Executa todos os casos e imprime os resultados.
+ *
+ * Deve ser chamada no lugar de mqtt_system_init(): o sistema é preparado
+ * sem WiFi/MQTT e sem as tasks periódicas, que interfeririam na medição.
+ *
+ * @return ESP_OK, ou o erro de mqtt_bench_attach().
+ */
+esp_err_t publish_bench_run(void);
+
+#endif /* PUBLISH_BENCH_H */
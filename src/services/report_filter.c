@@ -0,0 +1,76 @@
+/**
+ * @file report_filter.c
+ * @brief Filtro de report-by-exception - Implementação
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#include "report_filter.h"
+
+#include <math.h>
+
+/* Implementação das funções públicas */
+
+void report_filter_init(report_filter_t *filter, const report_filter_config_t *config)
+{
+    filter->config = *config;
+    filter->reportadas = 0;
+    filter->suprimidas = 0;
+    report_filter_reset(filter);
+}
+
+void report_filter_reset(report_filter_t *filter)
+{
+    filter->has_value = false;
+    filter->last_value = 0.0f;
+    filter->last_report_ms = 0;
+}
+
+report_reason_t report_filter_check(const report_filter_t *filter, float value, uint64_t now_ms)
+{
+    const report_filter_config_t *cfg = &filter->config;
+
+    if (!filter->has_value)
+    {
+        return REPORT_FIRST;
+    }
+
+    uint64_t elapsed_ms = now_ms - filter->last_report_ms;
+    if (elapsed_ms < cfg->min_interval_ms)
+    {
+        return REPORT_NONE;
+    }
+
+    float delta = fabsf(value - filter->last_value);
+    if (delta >= cfg->deadband && delta > 0.0f)
+    {
+        return REPORT_DEADBAND;
+    }
+
+    if (cfg->max_interval_ms > 0 && delta > 0.0f && elapsed_ms >= cfg->max_interval_ms)
+    {
+        return REPORT_MAX_INTERVAL;
+    }
+
+    if (cfg->heartbeat_ms > 0 && elapsed_ms >= cfg->heartbeat_ms)
+    {
+        return REPORT_HEARTBEAT;
+    }
+
+    return REPORT_NONE;
+}
+
+void report_filter_commit(report_filter_t *filter, float value, uint64_t now_ms, bool reported)
+{
+    if (!reported)
+    {
+        filter->suprimidas++;
+        return;
+    }
+
+    filter->last_value = value;
+    filter->last_report_ms = now_ms;
+    filter->has_value = true;
+    filter->reportadas++;
+}
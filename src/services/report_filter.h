@@ -0,0 +1,98 @@
+/**
+ * @file report_filter.h
+ * @brief Filtro de report-by-exception por canal de medição.
+ *
+ * Decide, a cada amostra, se o valor de um canal precisa ser publicado:
+ * - variação maior ou igual à banda morta desde o último valor reportado;
+ * - qualquer variação, se o último report tem mais de `max_interval_ms`
+ *   (limita o atraso de derivas lentas abaixo da banda morta);
+ * - heartbeat: valor inalterado após `heartbeat_ms`.
+ * Nenhum report sai antes de `min_interval_ms` desde o anterior; a
+ * variação retida é reavaliada nas amostras seguintes.
+ *
+ * @note Não é thread-safe. Cada canal pertence a uma única task.
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#ifndef REPORT_FILTER_H
+#define REPORT_FILTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Parâmetros de um canal.
+ *
+ * Intervalos em 0 desativam o critério; banda morta 0 reporta qualquer
+ * variação.
+ */
+typedef struct
+{
+	float deadband;			  ///< Variação mínima (absoluta) para reportar.
+	uint32_t min_interval_ms; ///< Intervalo mínimo entre reports.
+	uint32_t max_interval_ms; ///< Reporta qualquer variação após este intervalo.
+	uint32_t heartbeat_ms;	  ///< Reporta mesmo sem variação após este intervalo.
+} report_filter_config_t;
+
+/**
+ * @brief Motivo de um report.
+ */
+typedef enum
+{
+	REPORT_NONE = 0,		///< Amostra suprimida.
+	REPORT_FIRST,		///< Primeiro valor (ou após report_filter_reset()).
+	REPORT_DEADBAND,	///< Variação acima da banda morta.
+	REPORT_MAX_INTERVAL, ///< Variação pequena, mas intervalo máximo atingido.
+	REPORT_HEARTBEAT	///< Sem variação, heartbeat vencido.
+} report_reason_t;
+
+/**
+ * @brief Estado de um canal.
+ */
+typedef struct
+{
+	report_filter_config_t config; ///< Parâmetros do canal.
+	float last_value;				 ///< Último valor reportado.
+	uint64_t last_report_ms;		 ///< Instante do último report.
+	bool has_value;				 ///< false até o primeiro report.
+	uint32_t reportadas;			 ///< Amostras reportadas.
+	uint32_t suprimidas;			 ///< Amostras suprimidas.
+} report_filter_t;
+
+/**
+ * @brief Inicializa um canal.
+ * @param filter Canal.
+ * @param config Parâmetros (copiados).
+ */
+void report_filter_init(report_filter_t *filter, const report_filter_config_t *config);
+
+/**
+ * @brief Força o próximo valor a ser reportado (ex.: após reconexão).
+ */
+void report_filter_reset(report_filter_t *filter);
+
+/**
+ * @brief Avalia uma amostra sem alterar o estado do canal.
+ * @param filter Canal.
+ * @param value Valor amostrado.
+ * @param now_ms Instante atual (ms).
+ * @return Motivo do report, ou REPORT_NONE se a amostra deve ser suprimida.
+ */
+report_reason_t report_filter_check(const report_filter_t *filter, float value, uint64_t now_ms);
+
+/**
+ * @brief Registra o resultado de uma amostra avaliada.
+ *
+ * Chamado após a tentativa de publicação: com `reported` false a
+ * amostra conta como suprimida e o valor de referência é mantido.
+ *
+ * @param filter Canal.
+ * @param value Valor amostrado.
+ * @param now_ms Instante atual (ms).
+ * @param reported true se o valor foi publicado.
+ */
+void report_filter_commit(report_filter_t *filter, float value, uint64_t now_ms, bool reported);
+
+#endif /* REPORT_FILTER_H */
@@ -0,0 +1,474 @@
+/**
+ * @file rule_engine.c
+ * @brief Motor de regras de automação - Implementação
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#include "rule_engine.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "actuator.h"
+
+/* Definições privadas */
+
+static const char *TAG = "RULE_ENGINE";
+
+/* Uma amostra que muda todas as regras cabe na fila vazia */
+_Static_assert(ACTUATOR_QUEUE_SIZE >= RULE_ENGINE_MAX_RULES,
+               "ACTUATOR_QUEUE_SIZE deve comportar RULE_ENGINE_MAX_RULES comandos");
+
+/**
+ * @brief Estado de execução de uma regra.
+ */
+typedef struct
+{
+    uint32_t last_true_ms; ///< Última amostra que satisfez a condição
+    bool active;
+} rule_state_t;
+
+/* Variáveis privadas (static) */
+
+/** Regras ordenadas por canal */
+static rule_t s_rules[RULE_ENGINE_MAX_RULES];
+static rule_state_t s_state[RULE_ENGINE_MAX_RULES];
+static uint32_t s_count = 0;
+
+/** Faixa do canal c: [s_channel_start[c], s_channel_start[c + 1]) */
+static uint32_t s_channel_start[RULE_CHANNEL_COUNT + 1];
+
+/** Liberações da recarga que não couberam na fila (bit N = GPIO N) */
+static uint64_t s_release_pending = 0;
+static uint64_t s_release_levels = 0;
+
+static uint64_t s_gpio_mask = 0;
+static const rule_t *s_defaults = NULL;
+static uint32_t s_default_count = 0;
+
+static const char *const s_channel_names[RULE_CHANNEL_COUNT] = {
+    [RULE_CHANNEL_LUMINOSIDADE] = "luminosidade",
+    [RULE_CHANNEL_TEMPERATURA] = "temperatura",
+};
+
+static const char *const s_cmp_names[RULE_CMP_COUNT] = {
+    [RULE_CMP_LT] = "<",
+    [RULE_CMP_LE] = "<=",
+    [RULE_CMP_GT] = ">",
+    [RULE_CMP_GE] = ">=",
+    [RULE_CMP_EQ] = "==",
+    [RULE_CMP_NE] = "!=",
+};
+
+/* Funções auxiliares */
+
+static bool compare(uint8_t cmp, int32_t value, int32_t threshold)
+{
+    switch (cmp)
+    {
+    case RULE_CMP_LT:
+        return value < threshold;
+    case RULE_CMP_LE:
+        return value <= threshold;
+    case RULE_CMP_GT:
+        return value > threshold;
+    case RULE_CMP_GE:
+        return value >= threshold;
+    case RULE_CMP_EQ:
+        return value == threshold;
+    default:
+        return value != threshold;
+    }
+}
+
+/**
+ * @brief Condição para manter a regra ativa: o limiar recuado pela
+ *        histerese (sem histerese, a própria condição de ativação).
+ */
+static bool keep_active(const rule_t *rule, int32_t value, bool cond)
+{
+    if (rule->hysteresis == 0)
+    {
+        return cond;
+    }
+
+    switch (rule->cmp)
+    {
+    case RULE_CMP_GT:
+    case RULE_CMP_GE:
+        return value >= rule->threshold - rule->hysteresis;
+    case RULE_CMP_LT:
+    case RULE_CMP_LE:
+        return value <= rule->threshold + rule->hysteresis;
+    default:
+        return cond;
+    }
+}
+
+static bool rule_is_valid(const rule_t *rule)
+{
+    return rule->channel < RULE_CHANNEL_COUNT &&
+           rule->cmp < RULE_CMP_COUNT &&
+           rule->gpio < 64 && (s_gpio_mask & (1ULL << rule->gpio)) != 0 &&
+           rule->level <= 1 &&
+           rule->hysteresis >= 0;
+}
+
+/** @return ESP_OK ou o erro de actuator_post() (a transição não aconteceu) */
+static esp_err_t post_action(uint32_t index, uint8_t level, int32_t value, int64_t timestamp_us)
+{
+    actuator_cmd_t cmd = {
+        .timestamp_us = (uint32_t)timestamp_us,
+        .value = value,
+        .rule = (uint16_t)index,
+        .gpio = s_rules[index].gpio,
+        .level = level,
+    };
+    return actuator_post(&cmd);
+}
+
+/**
+ * @brief Posta as liberações pendentes, uma por GPIO.
+ * @return true se nenhuma ficou pendente.
+ */
+static bool flush_releases(int64_t timestamp_us)
+{
+    for (uint32_t gpio = 0; gpio < 64 && s_release_pending != 0; gpio++)
+    {
+        uint64_t bit = 1ULL << gpio;
+        if ((s_release_pending & bit) == 0)
+        {
+            continue;
+        }
+
+        actuator_cmd_t cmd = {
+            .timestamp_us = (uint32_t)timestamp_us,
+            .value = 0,
+            .rule = ACTUATOR_NO_RULE,
+            .gpio = (uint8_t)gpio,
+            .level = (s_release_levels & bit) != 0,
+        };
+        if (actuator_post(&cmd) != ESP_OK)
+        {
+            return false;
+        }
+        s_release_pending &= ~bit;
+    }
+    return true;
+}
+
+/**
+ * @brief Leva as saídas das regras ativas ao nível inativo.
+ *
+ * Os comandos são agrupados por GPIO (vale a última regra da tabela,
+ * como na sequência de comandos por regra). O que não couber na fila é
+ * repostado antes da próxima avaliação.
+ */
+static void release_all(void)
+{
+    for (uint32_t i = 0; i < s_count; i++)
+    {
+        if (s_state[i].active)
+        {
+            uint64_t bit = 1ULL << s_rules[i].gpio;
+            s_release_pending |= bit;
+            if (s_rules[i].level)
+            {
+                s_release_levels &= ~bit;
+            }
+            else
+            {
+                s_release_levels |= bit;
+            }
+            s_state[i].active = false;
+        }
+    }
+
+    flush_releases(esp_timer_get_time());
+}
+
+/**
+ * @brief Prepara a troca da tabela a partir das contagens por canal.
+ *        Ao retornar, s_channel_start[c] é a próxima posição livre do canal.
+ */
+static void begin_table(const uint32_t counts[RULE_CHANNEL_COUNT], uint32_t total)
+{
+    release_all();
+
+    uint32_t offset = 0;
+    for (int c = 0; c < RULE_CHANNEL_COUNT; c++)
+    {
+        s_channel_start[c] = offset;
+        offset += counts[c];
+    }
+    s_channel_start[RULE_CHANNEL_COUNT] = offset;
+
+    s_count = total;
+    memset(s_state, 0, sizeof(s_state));
+}
+
+/** Restaura s_channel_start[] após o preenchimento (cada início avançou counts[c]) */
+static void end_table(const uint32_t counts[RULE_CHANNEL_COUNT])
+{
+    for (int c = 0; c < RULE_CHANNEL_COUNT; c++)
+    {
+        s_channel_start[c] -= counts[c];
+    }
+}
+
+static int find_name(const char *const *names, int count, const char *name)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (strcmp(names[i], name) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Interpreta uma linha da representação textual.
+ * @return 1 se gerou uma regra, 0 se a linha é vazia/comentário, -1 se inválida.
+ */
+static int parse_line(const char *text, size_t len, rule_t *rule)
+{
+    char line[RULE_ENGINE_MAX_LINE];
+
+    while (len > 0 && (*text == ' ' || *text == '\t' || *text == '\r'))
+    {
+        text++;
+        len--;
+    }
+    if (len == 0 || *text == '#')
+    {
+        return 0;
+    }
+    if (len >= sizeof(line))
+    {
+        return -1;
+    }
+
+    memcpy(line, text, len);
+    line[len] = '\0';
+
+    char channel[16];
+    char op[3];
+    long threshold;
+    long hysteresis;
+    unsigned long hold_ms;
+    unsigned gpio;
+    unsigned level;
+    char extra;
+
+    if (sscanf(line, "%15s %2s %ld %ld %lu %u %u %c", channel, op, &threshold,
+               &hysteresis, &hold_ms, &gpio, &level, &extra) != 7)
+    {
+        return -1;
+    }
+
+    int ch = find_name(s_channel_names, RULE_CHANNEL_COUNT, channel);
+    int cmp = find_name(s_cmp_names, RULE_CMP_COUNT, op);
+    if (ch < 0 || cmp < 0 || gpio > UINT8_MAX || level > UINT8_MAX)
+    {
+        return -1;
+    }
+
+    *rule = (rule_t){
+        .threshold = (int32_t)threshold,
+        .hysteresis = (int32_t)hysteresis,
+        .hold_ms = (uint32_t)hold_ms,
+        .channel = (uint8_t)ch,
+        .cmp = (uint8_t)cmp,
+        .gpio = (uint8_t)gpio,
+        .level = (uint8_t)level,
+    };
+    return rule_is_valid(rule) ? 1 : -1;
+}
+
+/**
+ * @brief Percorre as linhas do texto. Sem `fill`, apenas valida e conta;
+ *        com `fill`, grava cada regra na faixa do seu canal.
+ */
+static esp_err_t walk_text(const char *text, size_t len, uint32_t counts[RULE_CHANNEL_COUNT],
+                           uint32_t *total, bool fill, uint32_t *bad_line)
+{
+    uint32_t line_no = 0;
+    size_t pos = 0;
+
+    while (pos < len)
+    {
+        size_t end = pos;
+        while (end < len && text[end] != '\n' && text[end] != ';')
+        {
+            end++;
+        }
+        line_no++;
+
+        rule_t rule;
+        int parsed = parse_line(text + pos, end - pos, &rule);
+        if (parsed < 0)
+        {
+            if (bad_line)
+            {
+                *bad_line = line_no;
+            }
+            return ESP_ERR_INVALID_ARG;
+        }
+        if (parsed > 0)
+        {
+            if (fill)
+            {
+                s_rules[s_channel_start[rule.channel]++] = rule;
+            }
+            else
+            {
+                if (*total >= RULE_ENGINE_MAX_RULES)
+                {
+                    return ESP_ERR_NO_MEM;
+                }
+                counts[rule.channel]++;
+                (*total)++;
+            }
+        }
+        pos = end + 1;
+    }
+    return ESP_OK;
+}
+
+/* Implementação das funções públicas */
+
+esp_err_t rule_engine_init(uint64_t gpio_mask, const rule_t *defaults, uint32_t count)
+{
+    s_gpio_mask = gpio_mask;
+    s_defaults = defaults;
+    s_default_count = count;
+    s_count = 0;
+    memset(s_channel_start, 0, sizeof(s_channel_start));
+
+    return rule_engine_load(defaults, count);
+}
+
+esp_err_t rule_engine_load(const rule_t *rules, uint32_t count)
+{
+    uint32_t counts[RULE_CHANNEL_COUNT] = {0};
+
+    if (count > RULE_ENGINE_MAX_RULES)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (!rule_is_valid(&rules[i]))
+        {
+            return ESP_ERR_INVALID_ARG;
+        }
+        counts[rules[i].channel]++;
+    }
+
+    /* Ordenação por contagem: estável e O(n) */
+    begin_table(counts, count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        s_rules[s_channel_start[rules[i].channel]++] = rules[i];
+    }
+    end_table(counts);
+
+    ESP_LOGI(TAG, "%lu regras carregadas", (unsigned long)count);
+    return ESP_OK;
+}
+
+esp_err_t rule_engine_load_text(const char *text, size_t len, uint32_t *bad_line)
+{
+    static const char RESTORE[] = "padrao";
+
+    while (len > 0 && (text[len - 1] == '\n' || text[len - 1] == '\r' || text[len - 1] == ' '))
+    {
+        len--;
+    }
+    if (len == sizeof(RESTORE) - 1 && memcmp(text, RESTORE, len) == 0)
+    {
+        return rule_engine_load(s_defaults, s_default_count);
+    }
+
+    /* Primeira passada valida tudo; a tabela atual só muda se o texto for válido */
+    uint32_t counts[RULE_CHANNEL_COUNT] = {0};
+    uint32_t total = 0;
+    esp_err_t ret = walk_text(text, len, counts, &total, false, bad_line);
+    if (ret != ESP_OK)
+    {
+        return ret;
+    }
+
+    begin_table(counts, total);
+    walk_text(text, len, counts, &total, true, NULL);
+    end_table(counts);
+
+    ESP_LOGI(TAG, "%lu regras carregadas", (unsigned long)total);
+    return ESP_OK;
+}
+
+uint32_t rule_engine_eval(rule_channel_t channel, int32_t value, int64_t timestamp_us)
+{
+    if ((unsigned)channel >= RULE_CHANNEL_COUNT)
+    {
+        return 0;
+    }
+
+    // Liberações de uma recarga vão antes de qualquer transição nova
+    if (s_release_pending != 0 && !flush_releases(timestamp_us))
+    {
+        return 0;
+    }
+
+    uint32_t now_ms = (uint32_t)(timestamp_us / 1000);
+    uint32_t changed = 0;
+    uint32_t end = s_channel_start[channel + 1];
+
+    for (uint32_t i = s_channel_start[channel]; i < end; i++)
+    {
+        const rule_t *rule = &s_rules[i];
+        rule_state_t *state = &s_state[i];
+        bool cond = compare(rule->cmp, value, rule->threshold);
+
+        if (cond)
+        {
+            state->last_true_ms = now_ms;
+        }
+
+        if (!state->active)
+        {
+            if (!cond)
+            {
+                continue;
+            }
+            // Com a fila cheia a regra segue inativa e a próxima amostra tenta de novo
+            if (post_action(i, rule->level, value, timestamp_us) == ESP_OK)
+            {
+                state->active = true;
+                changed++;
+            }
+        }
+        else if (!keep_active(rule, value, cond) &&
+                 (uint32_t)(now_ms - state->last_true_ms) >= rule->hold_ms)
+        {
+            if (post_action(i, !rule->level, value, timestamp_us) == ESP_OK)
+            {
+                state->active = false;
+                changed++;
+            }
+        }
+    }
+
+    return changed;
+}
+
+uint32_t rule_engine_count(void)
+{
+    return s_count;
+}
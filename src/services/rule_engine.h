@@ -0,0 +1,135 @@
+/**
+ * @file rule_engine.h
+ * @brief Motor de regras de automação orientado a tabela.
+ *
+ * Cada regra liga um canal de medição a uma saída GPIO:
+ *
+ *     canal  comparador  limiar  histerese  retenção_ms  gpio  nível
+ *
+ * A regra ativa quando `valor comparador limiar` e então aciona o GPIO
+ * com `nível`. Ela só é liberada (GPIO com o nível oposto) quando o valor
+ * sai da faixa de histerese e a condição não é satisfeita há pelo menos
+ * `retenção_ms`. Ex.: "temperatura > 23 3 600000 19 1" liga o ar acima de
+ * 23 e desliga abaixo de 20, 10 minutos após a última leitura acima de 23.
+ *
+ * As regras são compiladas para faixas contíguas por canal: avaliar uma
+ * amostra percorre apenas as regras do seu canal, sem alocação, sem ponto
+ * flutuante e sem texto, com custo limitado pelo número de regras do canal.
+ * As transições viram comandos na fila da task de atuação (actuator.h);
+ * o motor não aciona GPIOs nem escreve no log.
+ *
+ * @note Não é thread-safe. Avaliação e recarga rodam nos handlers de
+ *       mensagens, chamados por local_bus_deliver() na task do cliente
+ *       MQTT (mensagens do broker) e na SensorSimulate (entregas locais);
+ *       o mutex de entrega do barramento local serializa essas chamadas.
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#ifndef RULE_ENGINE_H
+#define RULE_ENGINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+/* Configuração */
+
+#ifndef RULE_ENGINE_MAX_RULES
+#define RULE_ENGINE_MAX_RULES 256 ///< Capacidade da tabela de regras
+#endif
+
+/** Comprimento máximo de uma linha da representação textual */
+#define RULE_ENGINE_MAX_LINE 96
+
+/**
+ * @brief Canais de medição avaliados pelas regras.
+ */
+typedef enum
+{
+	RULE_CHANNEL_LUMINOSIDADE = 0, ///< MQTT_TOPIC_LUMINOSITY
+	RULE_CHANNEL_TEMPERATURA,		 ///< MQTT_TOPIC_TEMPERATURE
+	RULE_CHANNEL_COUNT
+} rule_channel_t;
+
+/**
+ * @brief Comparadores suportados.
+ */
+typedef enum
+{
+	RULE_CMP_LT = 0, ///< <
+	RULE_CMP_LE,	  ///< <=
+	RULE_CMP_GT,	  ///< >
+	RULE_CMP_GE,	  ///< >=
+	RULE_CMP_EQ,	  ///< ==
+	RULE_CMP_NE,	  ///< !=
+	RULE_CMP_COUNT
+} rule_cmp_t;
+
+/**
+ * @brief Definição de uma regra.
+ */
+typedef struct
+{
+	int32_t threshold;  ///< Limiar de ativação.
+	int32_t hysteresis; ///< Margem além do limiar para liberar (<, <=, >, >=).
+	uint32_t hold_ms;	  ///< Tempo mínimo desde a última ativação para liberar.
+	uint8_t channel;	  ///< rule_channel_t.
+	uint8_t cmp;		  ///< rule_cmp_t.
+	uint8_t gpio;		  ///< Saída acionada.
+	uint8_t level;	  ///< Nível aplicado na ativação (0 ou 1).
+} rule_t;
+
+/**
+ * @brief Inicializa o motor e carrega as regras padrão.
+ * @param gpio_mask Saídas que as regras podem acionar (bit N = GPIO N).
+ * @param defaults Regras padrão, também restauradas pelo texto "padrao".
+ * @param count Número de regras padrão.
+ * @return ESP_OK ou o erro de rule_engine_load().
+ */
+esp_err_t rule_engine_init(uint64_t gpio_mask, const rule_t *defaults, uint32_t count);
+
+/**
+ * @brief Substitui a tabela de regras.
+ *
+ * A tabela só é trocada se todas as regras forem válidas. As regras
+ * ativas da tabela anterior são liberadas (GPIO no nível inativo).
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG (regra inválida ou GPIO fora da
+ *         máscara) ou ESP_ERR_NO_MEM (mais que RULE_ENGINE_MAX_RULES).
+ */
+esp_err_t rule_engine_load(const rule_t *rules, uint32_t count);
+
+/**
+ * @brief Substitui a tabela a partir da representação textual.
+ *
+ * Uma regra por linha (ou separadas por ';'), campos separados por
+ * espaço: `canal op limiar histerese retencao_ms gpio nivel`, com canal
+ * "luminosidade" ou "temperatura" e op em < <= > >= == !=. Linhas vazias
+ * e iniciadas por '#' são ignoradas; o texto "padrao" restaura as regras
+ * padrão.
+ *
+ * @param text Texto (não precisa terminar em '\0').
+ * @param len Comprimento do texto.
+ * @param bad_line Linha (1..N) do primeiro erro, se houver (pode ser NULL).
+ * @return Os mesmos códigos de rule_engine_load().
+ */
+esp_err_t rule_engine_load_text(const char *text, size_t len, uint32_t *bad_line);
+
+/**
+ * @brief Avalia uma amostra contra as regras do canal.
+ * @param channel Canal da amostra.
+ * @param value Valor lido.
+ * @param timestamp_us Recebimento da amostra (esp_timer_get_time()); usado
+ *        nos tempos de retenção e na latência dos comandos de atuação.
+ * @return Número de regras que mudaram de estado.
+ */
+uint32_t rule_engine_eval(rule_channel_t channel, int32_t value, int64_t timestamp_us);
+
+/**
+ * @brief Número de regras carregadas.
+ */
+uint32_t rule_engine_count(void);
+
+#endif /* RULE_ENGINE_H */
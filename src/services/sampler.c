@@ -0,0 +1,185 @@
+/**
+ * @file sampler.c
+ * @brief Amostragem periódica de alta resolução - Implementação
+ *
+ * O callback do timer roda na task do esp_timer e só notifica a task do
+ * job. A contagem da notificação diz quantos disparos passaram desde a
+ * última espera: mais de um significa disparos perdidos. O instante
+ * nominal vem do número do disparo, não do relógio no despertar.
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#include "sampler.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "task_profile.h"
+
+/* Definições privadas */
+
+static const char *TAG = "SAMPLER";
+
+typedef struct
+{
+    esp_timer_handle_t timer;
+    TaskHandle_t task; ///< Lida pelo callback
+    bool ativo;
+    uint32_t periodo_us;
+    int64_t inicio_us;    ///< Instante do disparo 0
+    uint32_t disparo;     ///< Último disparo atendido (só a task)
+    int64_t despertar_us; ///< Último despertar (0 = nenhum)
+    latency_hist_t jitter;
+    uint32_t exec_max_us;
+    uint32_t atrasos;
+    uint32_t perdidas;
+} job_state_t;
+
+/** Task de cada job (nome do job e do timer) */
+static const task_id_t s_job_task[SAMPLER_JOB_COUNT] = {
+    [SAMPLER_JOB_TELEMETRY] = TASK_ID_TELEMETRY,
+    [SAMPLER_JOB_SENSORES] = TASK_ID_SENSOR_SIMULATE,
+};
+
+/* Variáveis privadas (static) */
+
+static job_state_t s_jobs[SAMPLER_JOB_COUNT];
+
+/* Funções auxiliares */
+
+static void timer_callback(void *arg)
+{
+    job_state_t *j = arg;
+    TaskHandle_t task = __atomic_load_n(&j->task, __ATOMIC_ACQUIRE);
+    if (task != NULL)
+    {
+        xTaskNotifyGive(task);
+    }
+}
+
+/* Implementação das funções públicas */
+
+esp_err_t sampler_start(sampler_job_t job, uint32_t periodo_us)
+{
+    if (job >= SAMPLER_JOB_COUNT || periodo_us < SAMPLER_PERIODO_MIN_US)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    job_state_t *j = &s_jobs[job];
+    esp_err_t ret;
+
+    if (j->timer == NULL)
+    {
+        const esp_timer_create_args_t args = {
+            .callback = timer_callback,
+            .arg = j,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name = sampler_job_name(job),
+            .skip_unhandled_events = false,
+        };
+        ret = esp_timer_create(&args, &j->timer);
+        if (ret != ESP_OK)
+        {
+            ESP_LOGE(TAG, "Falha ao criar timer de %s: %s", sampler_job_name(job),
+                     esp_err_to_name(ret));
+            return ret;
+        }
+    }
+    else
+    {
+        sampler_stop(job);
+    }
+
+    /* Descarta notificações antigas: a contagem passa a ser só de disparos */
+    ulTaskNotifyTake(pdTRUE, 0);
+    j->periodo_us = periodo_us;
+    j->disparo = 0;
+    j->despertar_us = 0;
+    __atomic_store_n(&j->task, xTaskGetCurrentTaskHandle(), __ATOMIC_RELEASE);
+
+    j->inicio_us = esp_timer_get_time();
+    ret = esp_timer_start_periodic(j->timer, periodo_us);
+    if (ret != ESP_OK)
+    {
+        __atomic_store_n(&j->task, NULL, __ATOMIC_RELEASE);
+        ESP_LOGE(TAG, "Falha ao iniciar timer de %s: %s", sampler_job_name(job),
+                 esp_err_to_name(ret));
+        return ret;
+    }
+
+    __atomic_store_n(&j->ativo, true, __ATOMIC_RELEASE);
+    ESP_LOGI(TAG, "%s: amostragem a cada %lu us", sampler_job_name(job), periodo_us);
+    return ESP_OK;
+}
+
+void sampler_stop(sampler_job_t job)
+{
+    job_state_t *j = &s_jobs[job];
+
+    __atomic_store_n(&j->task, NULL, __ATOMIC_RELEASE);
+    if (__atomic_exchange_n(&j->ativo, false, __ATOMIC_ACQ_REL))
+    {
+        esp_timer_stop(j->timer);
+    }
+}
+
+int64_t sampler_wait(sampler_job_t job)
+{
+    job_state_t *j = &s_jobs[job];
+
+    if (!__atomic_load_n(&j->ativo, __ATOMIC_ACQUIRE))
+    {
+        /* Sem timer (sampler_start falhou): espera em ticks */
+        TickType_t ticks = pdMS_TO_TICKS(j->periodo_us / 1000);
+        vTaskDelay(ticks > 0 ? ticks : 1);
+        return esp_timer_get_time();
+    }
+
+    if (j->despertar_us != 0)
+    {
+        uint32_t exec_us = (uint32_t)(esp_timer_get_time() - j->despertar_us);
+        if (exec_us > j->exec_max_us)
+        {
+            __atomic_store_n(&j->exec_max_us, exec_us, __ATOMIC_RELAXED);
+        }
+        if (exec_us > j->periodo_us)
+        {
+            __atomic_fetch_add(&j->atrasos, 1, __ATOMIC_RELAXED);
+        }
+    }
+
+    uint32_t disparos = ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    int64_t agora_us = esp_timer_get_time();
+
+    if (disparos > 1)
+    {
+        __atomic_fetch_add(&j->perdidas, disparos - 1, __ATOMIC_RELAXED);
+    }
+    j->disparo += disparos;
+
+    int64_t nominal_us = j->inicio_us + (int64_t)j->disparo * j->periodo_us;
+    latency_hist_record(&j->jitter, agora_us > nominal_us ? (uint32_t)(agora_us - nominal_us) : 0);
+    j->despertar_us = agora_us;
+    return nominal_us;
+}
+
+void sampler_get_stats(sampler_job_t job, sampler_stats_t *out)
+{
+    const job_state_t *j = &s_jobs[job];
+
+    out->ativo = __atomic_load_n(&j->ativo, __ATOMIC_ACQUIRE);
+    out->periodo_us = j->periodo_us;
+    latency_hist_summary(&j->jitter, &out->jitter);
+    out->exec_max_us = __atomic_load_n(&j->exec_max_us, __ATOMIC_RELAXED);
+    out->atrasos = __atomic_load_n(&j->atrasos, __ATOMIC_RELAXED);
+    out->perdidas = __atomic_load_n(&j->perdidas, __ATOMIC_RELAXED);
+}
+
+const char *sampler_job_name(sampler_job_t job)
+{
+    return task_profile_get(s_job_task[job])->nome;
+}
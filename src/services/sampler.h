@@ -0,0 +1,90 @@
+/**
+ * @file sampler.h
+ * @brief Amostragem periódica de alta resolução sobre o esp_timer.
+ *
+ * vTaskDelayUntil() só acorda em ticks (10 ms com CONFIG_FREERTOS_HZ=100).
+ * Aqui cada job tem um esp_timer periódico: o callback (task do esp_timer)
+ * só notifica a task do job, que acorda no disparo, independente do tick.
+ * O esp_timer agenda cada disparo a partir do anterior, então o período
+ * não acumula o tempo de execução do loop, e aceita períodos de
+ * SAMPLER_PERIODO_MIN_US (1 kHz) para cima.
+ *
+ * sampler_wait() devolve o instante nominal da amostra (início + k ×
+ * período), que serve de timestamp sem o jitter de despertar. Por job:
+ * - jitter: atraso do despertar em relação ao instante nominal;
+ * - atrasos: execuções mais longas que o período;
+ * - perdidas: disparos acumulados enquanto a task trabalhava. A task
+ *   segue no disparo mais recente e não executa os perdidos.
+ *
+ * Cada job tem uma única task: sampler_start() e sampler_wait() são
+ * chamadas por ela.
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "latency_hist.h"
+
+/** Menor período aceito (µs) */
+#define SAMPLER_PERIODO_MIN_US 1000
+
+/**
+ * @brief Jobs de amostragem.
+ */
+typedef enum
+{
+	SAMPLER_JOB_TELEMETRY = 0, ///< telemetry_task.
+	SAMPLER_JOB_SENSORES,	   ///< sensor_simulate_task.
+	SAMPLER_JOB_COUNT
+} sampler_job_t;
+
+/**
+ * @brief Estatísticas de um job.
+ */
+typedef struct
+{
+	bool ativo;				  ///< Timer rodando.
+	uint32_t periodo_us;	  ///< Período configurado.
+	latency_summary_t jitter; ///< Atraso do despertar (µs).
+	uint32_t exec_max_us;	  ///< Maior tempo entre despertar e a próxima espera.
+	uint32_t atrasos;		  ///< Execuções mais longas que o período.
+	uint32_t perdidas;		  ///< Disparos pulados.
+} sampler_stats_t;
+
+/**
+ * @brief Inicia (ou reinicia) o timer do job para a task que chama.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG (período abaixo do mínimo) ou o
+ *         erro do esp_timer.
+ */
+esp_err_t sampler_start(sampler_job_t job, uint32_t periodo_us);
+
+/**
+ * @brief Para o timer do job; chamar antes de apagar a task.
+ */
+void sampler_stop(sampler_job_t job);
+
+/**
+ * @brief Espera o próximo disparo.
+ *
+ * @return Instante nominal da amostra (µs, base esp_timer_get_time()).
+ */
+int64_t sampler_wait(sampler_job_t job);
+
+/**
+ * @brief Copia as estatísticas do job.
+ */
+void sampler_get_stats(sampler_job_t job, sampler_stats_t *out);
+
+/**
+ * @brief Nome do job (o da task).
+ */
+const char *sampler_job_name(sampler_job_t job);
+
+#endif /* SAMPLER_H */
@@ -0,0 +1,287 @@
+/**
+ * @file static_outbox.c
+ * @brief Outbox do esp-mqtt em pool estático - Implementação
+ *
+ * Mesma semântica do mqtt_outbox.c do esp-mqtt (lista FIFO, estados de
+ * pendência, expiração por tick), trocando os malloc por uma lista de
+ * slots livres. O esp-mqtt chama estas funções com o lock do cliente;
+ * só as estatísticas são lidas de fora, com atômicos.
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#include "freertos/FreeRTOS.h"
+
+#ifdef CONFIG_MQTT_CUSTOM_OUTBOX
+
+#include "static_outbox.h"
+
+#include <string.h>
+#include <sys/queue.h>
+#include "mqtt_outbox.h"
+#include "esp_log.h"
+
+/* Definições privadas */
+
+static const char *TAG = "STATIC_OUTBOX";
+
+typedef struct outbox_item
+{
+    uint8_t buffer[STATIC_OUTBOX_SLOT_SIZE];
+    int len;
+    int msg_id;
+    int msg_type;
+    int msg_qos;
+    outbox_tick_t tick;
+    pending_state_t pending;
+    STAILQ_ENTRY(outbox_item) next;
+} outbox_item_t;
+
+STAILQ_HEAD(outbox_list_t, outbox_item);
+
+struct outbox_t
+{
+    uint64_t size;
+    struct outbox_list_t list; ///< Mensagens em ordem de inserção
+    struct outbox_list_t livres;
+    bool em_uso;
+};
+
+/* Variáveis privadas (static) */
+
+static outbox_item_t s_slots[STATIC_OUTBOX_SLOTS];
+static struct outbox_t s_outbox;
+static static_outbox_stats_t s_stats;
+
+/* Funções auxiliares */
+
+static void release_item(outbox_handle_t outbox, outbox_item_handle_t item)
+{
+    STAILQ_REMOVE(&outbox->list, item, outbox_item, next);
+    outbox->size -= item->len;
+    STAILQ_INSERT_TAIL(&outbox->livres, item, next);
+    __atomic_sub_fetch(&s_stats.ocupados, 1, __ATOMIC_RELAXED);
+}
+
+/* Implementação das funções públicas (mqtt_outbox.h) */
+
+outbox_handle_t outbox_init(void)
+{
+    /* Um único cliente MQTT no firmware */
+    if (s_outbox.em_uso)
+    {
+        ESP_LOGE(TAG, "Outbox estatico ja em uso");
+        return NULL;
+    }
+
+    s_outbox.em_uso = true;
+    s_outbox.size = 0;
+    STAILQ_INIT(&s_outbox.list);
+    STAILQ_INIT(&s_outbox.livres);
+    for (int i = 0; i < STATIC_OUTBOX_SLOTS; i++)
+    {
+        STAILQ_INSERT_TAIL(&s_outbox.livres, &s_slots[i], next);
+    }
+    __atomic_store_n(&s_stats.ocupados, 0, __ATOMIC_RELAXED);
+    return &s_outbox;
+}
+
+outbox_item_handle_t outbox_enqueue(outbox_handle_t outbox, outbox_message_handle_t message,
+                                    outbox_tick_t tick)
+{
+    int len = message->len + message->remaining_len;
+    outbox_item_handle_t item = STAILQ_FIRST(&outbox->livres);
+    if (item == NULL || len > STATIC_OUTBOX_SLOT_SIZE)
+    {
+        __atomic_add_fetch(&s_stats.recusadas, 1, __ATOMIC_RELAXED);
+        ESP_LOGW(TAG, "Mensagem %d recusada (%d bytes, %s)", message->msg_id, len,
+                 item == NULL ? "sem slots" : "maior que o slot");
+        return NULL;
+    }
+    STAILQ_REMOVE_HEAD(&outbox->livres, next);
+
+    item->len = len;
+    item->msg_id = message->msg_id;
+    item->msg_type = message->msg_type;
+    item->msg_qos = message->msg_qos;
+    item->tick = tick;
+    item->pending = QUEUED;
+    memcpy(item->buffer, message->data, message->len);
+    if (message->remaining_data)
+    {
+        memcpy(item->buffer + message->len, message->remaining_data, message->remaining_len);
+    }
+
+    STAILQ_INSERT_TAIL(&outbox->list, item, next);
+    outbox->size += len;
+
+    uint32_t ocupados = __atomic_add_fetch(&s_stats.ocupados, 1, __ATOMIC_RELAXED);
+    if (ocupados > s_stats.pico)
+    {
+        __atomic_store_n(&s_stats.pico, ocupados, __ATOMIC_RELAXED);
+    }
+    return item;
+}
+
+outbox_item_handle_t outbox_get(outbox_handle_t outbox, int msg_id)
+{
+    outbox_item_handle_t item;
+    STAILQ_FOREACH(item, &outbox->list, next)
+    {
+        if (item->msg_id == msg_id)
+        {
+            return item;
+        }
+    }
+    return NULL;
+}
+
+outbox_item_handle_t outbox_dequeue(outbox_handle_t outbox, pending_state_t pending,
+                                    outbox_tick_t *tick)
+{
+    outbox_item_handle_t item;
+    STAILQ_FOREACH(item, &outbox->list, next)
+    {
+        if (item->pending == pending)
+        {
+            if (tick)
+            {
+                *tick = item->tick;
+            }
+            return item;
+        }
+    }
+    return NULL;
+}
+
+uint8_t *outbox_item_get_data(outbox_item_handle_t item, size_t *len, uint16_t *msg_id,
+                              int *msg_type, int *qos)
+{
+    if (item == NULL)
+    {
+        return NULL;
+    }
+    *len = item->len;
+    *msg_id = item->msg_id;
+    *msg_type = item->msg_type;
+    *qos = item->msg_qos;
+    return item->buffer;
+}
+
+esp_err_t outbox_delete_item(outbox_handle_t outbox, outbox_item_handle_t item_to_delete)
+{
+    outbox_item_handle_t item;
+    STAILQ_FOREACH(item, &outbox->list, next)
+    {
+        if (item == item_to_delete)
+        {
+            release_item(outbox, item);
+            return ESP_OK;
+        }
+    }
+    return ESP_FAIL;
+}
+
+esp_err_t outbox_delete(outbox_handle_t outbox, int msg_id, int msg_type)
+{
+    outbox_item_handle_t item;
+    STAILQ_FOREACH(item, &outbox->list, next)
+    {
+        if (item->msg_id == msg_id && (0xFF & item->msg_type) == (0xFF & msg_type))
+        {
+            release_item(outbox, item);
+            return ESP_OK;
+        }
+    }
+    return ESP_FAIL;
+}
+
+esp_err_t outbox_set_pending(outbox_handle_t outbox, int msg_id, pending_state_t pending)
+{
+    outbox_item_handle_t item = outbox_get(outbox, msg_id);
+    if (item == NULL)
+    {
+        return ESP_FAIL;
+    }
+    item->pending = pending;
+    return ESP_OK;
+}
+
+pending_state_t outbox_item_get_pending(outbox_item_handle_t item)
+{
+    return item ? item->pending : QUEUED;
+}
+
+esp_err_t outbox_set_tick(outbox_handle_t outbox, int msg_id, outbox_tick_t tick)
+{
+    outbox_item_handle_t item = outbox_get(outbox, msg_id);
+    if (item == NULL)
+    {
+        return ESP_FAIL;
+    }
+    item->tick = tick;
+    return ESP_OK;
+}
+
+int outbox_delete_single_expired(outbox_handle_t outbox, outbox_tick_t current_tick,
+                                 outbox_tick_t timeout)
+{
+    outbox_item_handle_t item;
+    STAILQ_FOREACH(item, &outbox->list, next)
+    {
+        if (current_tick - item->tick > timeout)
+        {
+            int msg_id = item->msg_id;
+            release_item(outbox, item);
+            return msg_id;
+        }
+    }
+    return -1;
+}
+
+int outbox_delete_expired(outbox_handle_t outbox, outbox_tick_t current_tick,
+                          outbox_tick_t timeout)
+{
+    int deleted = 0;
+    outbox_item_handle_t item = STAILQ_FIRST(&outbox->list);
+    while (item != NULL)
+    {
+        outbox_item_handle_t proximo = STAILQ_NEXT(item, next);
+        if (current_tick - item->tick > timeout)
+        {
+            release_item(outbox, item);
+            deleted++;
+        }
+        item = proximo;
+    }
+    return deleted;
+}
+
+uint64_t outbox_get_size(outbox_handle_t outbox)
+{
+    return outbox->size;
+}
+
+void outbox_delete_all_items(outbox_handle_t outbox)
+{
+    while (!STAILQ_EMPTY(&outbox->list))
+    {
+        release_item(outbox, STAILQ_FIRST(&outbox->list));
+    }
+}
+
+void outbox_destroy(outbox_handle_t outbox)
+{
+    outbox_delete_all_items(outbox);
+    outbox->em_uso = false;
+}
+
+void static_outbox_get_stats(static_outbox_stats_t *out)
+{
+    out->ocupados = __atomic_load_n(&s_stats.ocupados, __ATOMIC_RELAXED);
+    out->pico = __atomic_load_n(&s_stats.pico, __ATOMIC_RELAXED);
+    out->recusadas = __atomic_load_n(&s_stats.recusadas, __ATOMIC_RELAXED);
+}
+
+#endif /* CONFIG_MQTT_CUSTOM_OUTBOX */
@@ -0,0 +1,54 @@
+/**
+ * @file static_outbox.h
+ * @brief Outbox do esp-mqtt em um pool estático de slots.
+ *
+ * O outbox padrão do esp-mqtt faz dois malloc por publicação QoS > 0 (item
+ * e cópia da mensagem) e os libera no PUBACK. Com CONFIG_MQTT_CUSTOM_OUTBOX
+ * o esp-mqtt usa esta implementação: STATIC_OUTBOX_SLOTS slots de
+ * STATIC_OUTBOX_SLOT_SIZE bytes, reservados em tempo de compilação.
+ *
+ * Mensagem maior que um slot, ou com todos os slots ocupados, é recusada:
+ * o esp-mqtt retorna -1 na publicação e o firmware a conta em
+ * MQTT_STAT_FALHAS_PUBLICACAO.
+ *
+ * O arquivo .c é compilado dentro do componente mqtt (ver
+ * src/CMakeLists.txt), que fornece o mqtt_outbox.h privado.
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#ifndef STATIC_OUTBOX_H
+#define STATIC_OUTBOX_H
+
+#include <stdint.h>
+
+#ifndef STATIC_OUTBOX_SLOTS
+#define STATIC_OUTBOX_SLOTS 8 ///< Mensagens aguardando ACK
+#endif
+
+#ifndef STATIC_OUTBOX_SLOT_SIZE
+#define STATIC_OUTBOX_SLOT_SIZE 1280 ///< Maior mensagem (cabeçalho MQTT + tópico + payload)
+#endif
+
+/** Memória reservada pelo pool (bytes) */
+#define STATIC_OUTBOX_BYTES (STATIC_OUTBOX_SLOTS * STATIC_OUTBOX_SLOT_SIZE)
+
+/**
+ * @brief Ocupação do pool.
+ */
+typedef struct
+{
+	uint32_t ocupados;	 ///< Slots em uso agora.
+	uint32_t pico;		 ///< Maior ocupação desde o boot.
+	uint32_t recusadas;	 ///< Mensagens sem slot (pool cheio ou grande demais).
+} static_outbox_stats_t;
+
+/**
+ * @brief Copia a ocupação do pool.
+ *
+ * Só existe com CONFIG_MQTT_CUSTOM_OUTBOX.
+ */
+void static_outbox_get_stats(static_outbox_stats_t *out);
+
+#endif /* STATIC_OUTBOX_H */
@@ -0,0 +1,351 @@
+/**
+ * @file sub_registry.c
+ * @brief Registro de subscrições - Implementação
+ *
+ * Vetor estático de entradas protegido por spinlock. O lote aberto por
+ * sub_registry_begin_subscribe() tem msg_id -1 até o envio retornar; um
+ * SUBACK que chegue antes disso (a task do cliente pode processá-lo
+ * antes do retorno de esp_mqtt_client_subscribe_multiple) fica guardado
+ * e é aplicado por sub_registry_end_subscribe().
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#include "sub_registry.h"
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+
+/* Definições privadas */
+
+/** Código de falha no SUBACK */
+#define SUBACK_FAILURE 0x80
+
+typedef enum
+{
+    ENTRADA_LIVRE = 0,
+    ENTRADA_PENDENTE,   ///< Precisa de SUBSCRIBE
+    ENTRADA_ENVIADA,    ///< Aguardando SUBACK
+    ENTRADA_CONFIRMADA, ///< Ativa no broker
+    ENTRADA_REJEITADA,  ///< Broker recusou; nova tentativa só em nova sessão
+    ENTRADA_REMOVER,    ///< Fora do conjunto desejado, precisa de UNSUBSCRIBE
+} entry_state_t;
+
+typedef struct
+{
+    char filter[SUB_REGISTRY_MAX_FILTER];
+    uint8_t estado;    ///< entry_state_t
+    uint8_t qos;       ///< QoS desejado
+    uint8_t concedido; ///< QoS concedido no SUBACK
+    uint8_t lote_idx;  ///< Posição no SUBSCRIBE (índice do código no SUBACK)
+    int msg_id;        ///< msg_id do SUBSCRIBE (-1 enquanto o lote está aberto)
+} sub_entry_t;
+
+/* Variáveis privadas (static) */
+
+static sub_entry_t s_entries[SUB_REGISTRY_MAX_TOPICS];
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static bool s_lote_aberto = false;
+
+/** SUBACK recebido antes de sub_registry_end_subscribe() */
+static struct
+{
+    bool valido;
+    int msg_id;
+    int count;
+    uint8_t codes[SUB_REGISTRY_MAX_TOPICS];
+} s_early;
+
+static uint32_t s_subscribes_enviados = 0;
+static uint32_t s_topicos_enviados = 0;
+
+/* Funções auxiliares */
+
+static sub_entry_t *find_locked(const char *filter)
+{
+    for (int i = 0; i < SUB_REGISTRY_MAX_TOPICS; i++)
+    {
+        if (s_entries[i].estado != ENTRADA_LIVRE && strcmp(s_entries[i].filter, filter) == 0)
+        {
+            return &s_entries[i];
+        }
+    }
+    return NULL;
+}
+
+/** @return Número de entradas do lote encontradas (0 = msg_id desconhecido). */
+static int apply_suback_locked(int msg_id, const uint8_t *codes, int count, int *rejeitadas)
+{
+    int matched = 0;
+
+    for (int i = 0; i < SUB_REGISTRY_MAX_TOPICS; i++)
+    {
+        sub_entry_t *e = &s_entries[i];
+        if (e->estado != ENTRADA_ENVIADA || e->msg_id != msg_id)
+        {
+            continue;
+        }
+
+        matched++;
+        uint8_t code = (e->lote_idx < count) ? codes[e->lote_idx] : SUBACK_FAILURE;
+        if (code == SUBACK_FAILURE)
+        {
+            e->estado = ENTRADA_REJEITADA;
+            (*rejeitadas)++;
+        }
+        else
+        {
+            e->estado = ENTRADA_CONFIRMADA;
+            e->concedido = code;
+        }
+    }
+
+    return matched;
+}
+
+/* Implementação das funções públicas */
+
+esp_err_t sub_registry_add(const char *filter, int qos)
+{
+    if (filter == NULL || filter[0] == '\0' ||
+        strlen(filter) >= SUB_REGISTRY_MAX_FILTER || qos < 0 || qos > 2)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = ESP_OK;
+
+    portENTER_CRITICAL(&s_lock);
+    sub_entry_t *e = find_locked(filter);
+    if (e != NULL)
+    {
+        bool ativa = (e->estado == ENTRADA_CONFIRMADA || e->estado == ENTRADA_ENVIADA);
+        if (!ativa || e->qos != qos)
+        {
+            e->estado = ENTRADA_PENDENTE;
+            e->qos = (uint8_t)qos;
+        }
+    }
+    else
+    {
+        ret = ESP_ERR_NO_MEM;
+        for (int i = 0; i < SUB_REGISTRY_MAX_TOPICS; i++)
+        {
+            if (s_entries[i].estado == ENTRADA_LIVRE)
+            {
+                e = &s_entries[i];
+                strcpy(e->filter, filter);
+                e->qos = (uint8_t)qos;
+                e->estado = ENTRADA_PENDENTE;
+                ret = ESP_OK;
+                break;
+            }
+        }
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    return ret;
+}
+
+esp_err_t sub_registry_remove(const char *filter)
+{
+    if (filter == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+
+    portENTER_CRITICAL(&s_lock);
+    sub_entry_t *e = find_locked(filter);
+    if (e != NULL && e->estado != ENTRADA_REMOVER)
+    {
+        /* Nunca enviada ou recusada: o broker não tem a subscrição */
+        bool no_broker = (e->estado == ENTRADA_PENDENTE || e->estado == ENTRADA_REJEITADA);
+        e->estado = no_broker ? ENTRADA_LIVRE : ENTRADA_REMOVER;
+        ret = ESP_OK;
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    return ret;
+}
+
+void sub_registry_on_connect(bool session_present)
+{
+    portENTER_CRITICAL(&s_lock);
+    for (int i = 0; i < SUB_REGISTRY_MAX_TOPICS; i++)
+    {
+        sub_entry_t *e = &s_entries[i];
+        switch (e->estado)
+        {
+        case ENTRADA_ENVIADA:
+            /* O SUBACK se perdeu com a conexão; reenviar é idempotente */
+            e->estado = ENTRADA_PENDENTE;
+            break;
+
+        case ENTRADA_CONFIRMADA:
+        case ENTRADA_REJEITADA:
+            if (!session_present)
+            {
+                e->estado = ENTRADA_PENDENTE;
+            }
+            break;
+
+        case ENTRADA_REMOVER:
+            /* Sessão nova não tem a subscrição; o filtro pode estar no lote aberto */
+            if (!session_present && !s_lote_aberto)
+            {
+                e->estado = ENTRADA_LIVRE;
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&s_lock);
+}
+
+int sub_registry_begin_subscribe(esp_mqtt_topic_t *list, int max)
+{
+    int count = 0;
+
+    portENTER_CRITICAL(&s_lock);
+    for (int i = 0; i < SUB_REGISTRY_MAX_TOPICS && count < max; i++)
+    {
+        sub_entry_t *e = &s_entries[i];
+        if (e->estado != ENTRADA_PENDENTE)
+        {
+            continue;
+        }
+
+        e->estado = ENTRADA_ENVIADA;
+        e->msg_id = -1;
+        e->lote_idx = (uint8_t)count;
+        list[count].filter = e->filter;
+        list[count].qos = e->qos;
+        count++;
+    }
+    s_lote_aberto = count > 0;
+    s_early.valido = false;
+    portEXIT_CRITICAL(&s_lock);
+
+    return count;
+}
+
+void sub_registry_end_subscribe(int msg_id)
+{
+    int rejeitadas = 0;
+
+    portENTER_CRITICAL(&s_lock);
+    int count = 0;
+    for (int i = 0; i < SUB_REGISTRY_MAX_TOPICS; i++)
+    {
+        sub_entry_t *e = &s_entries[i];
+        if (e->estado == ENTRADA_ENVIADA && e->msg_id == -1)
+        {
+            if (msg_id < 0)
+            {
+                e->estado = ENTRADA_PENDENTE;
+            }
+            else
+            {
+                e->msg_id = msg_id;
+                count++;
+            }
+        }
+    }
+
+    if (msg_id >= 0 && count > 0)
+    {
+        s_subscribes_enviados++;
+        s_topicos_enviados += count;
+    }
+
+    if (s_early.valido && s_early.msg_id == msg_id)
+    {
+        apply_suback_locked(msg_id, s_early.codes, s_early.count, &rejeitadas);
+    }
+    s_early.valido = false;
+    s_lote_aberto = false;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+int sub_registry_on_suback(int msg_id, const uint8_t *codes, int count)
+{
+    int rejeitadas = 0;
+
+    portENTER_CRITICAL(&s_lock);
+    if (apply_suback_locked(msg_id, codes, count, &rejeitadas) == 0 && s_lote_aberto)
+    {
+        s_early.valido = true;
+        s_early.msg_id = msg_id;
+        s_early.count = (count < SUB_REGISTRY_MAX_TOPICS) ? count : SUB_REGISTRY_MAX_TOPICS;
+        memcpy(s_early.codes, codes, s_early.count);
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    return rejeitadas;
+}
+
+bool sub_registry_next_removal(char *filter, size_t len)
+{
+    bool found = false;
+
+    portENTER_CRITICAL(&s_lock);
+    for (int i = 0; i < SUB_REGISTRY_MAX_TOPICS; i++)
+    {
+        if (s_entries[i].estado == ENTRADA_REMOVER && strlen(s_entries[i].filter) < len)
+        {
+            strcpy(filter, s_entries[i].filter);
+            found = true;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    return found;
+}
+
+void sub_registry_removal_done(const char *filter)
+{
+    portENTER_CRITICAL(&s_lock);
+    sub_entry_t *e = find_locked(filter);
+    if (e != NULL && e->estado == ENTRADA_REMOVER)
+    {
+        e->estado = ENTRADA_LIVRE;
+    }
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void sub_registry_get_stats(sub_registry_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+
+    portENTER_CRITICAL(&s_lock);
+    for (int i = 0; i < SUB_REGISTRY_MAX_TOPICS; i++)
+    {
+        switch (s_entries[i].estado)
+        {
+        case ENTRADA_CONFIRMADA:
+            stats->confirmadas++;
+            stats->desejadas++;
+            break;
+        case ENTRADA_REJEITADA:
+            stats->rejeitadas++;
+            stats->desejadas++;
+            break;
+        case ENTRADA_PENDENTE:
+        case ENTRADA_ENVIADA:
+            stats->desejadas++;
+            break;
+        default:
+            break;
+        }
+    }
+    stats->subscribes_enviados = s_subscribes_enviados;
+    stats->topicos_enviados = s_topicos_enviados;
+    portEXIT_CRITICAL(&s_lock);
+}
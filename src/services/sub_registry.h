@@ -0,0 +1,109 @@
+/**
+ * @file sub_registry.h
+ * @brief Registro de subscrições com reconciliação do estado desejado.
+ *
+ * Guarda o conjunto desejado de filtros e QoS e o que o broker já
+ * confirmou. A cada conexão (ou mudança no conjunto) a task de conexão
+ * pede as entradas pendentes e as envia em um único SUBSCRIBE com vários
+ * tópicos; o SUBACK correspondente marca cada entrada como confirmada ou
+ * rejeitada. Com sessão persistente, uma reconexão com session_present
+ * mantém as confirmações e não gera tráfego de subscrição.
+ *
+ * Todas as funções são seguras entre tasks (spinlock interno).
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#ifndef SUB_REGISTRY_H
+#define SUB_REGISTRY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "mqtt_client.h"
+
+#ifndef SUB_REGISTRY_MAX_TOPICS
+#define SUB_REGISTRY_MAX_TOPICS 16 ///< Filtros no conjunto desejado
+#endif
+
+/** Comprimento máximo de um filtro (incluindo '\0') */
+#define SUB_REGISTRY_MAX_FILTER 64
+
+/**
+ * @brief Contadores do registro.
+ */
+typedef struct
+{
+	uint32_t desejadas;			  ///< Filtros no conjunto desejado.
+	uint32_t confirmadas;		  ///< Confirmadas pelo broker (SUBACK).
+	uint32_t rejeitadas;		  ///< SUBACK com falha (0x80).
+	uint32_t subscribes_enviados; ///< Pacotes SUBSCRIBE enviados.
+	uint32_t topicos_enviados;	  ///< Tópicos somados em todos os SUBSCRIBE.
+} sub_registry_stats_t;
+
+/**
+ * @brief Adiciona um filtro ao conjunto desejado ou altera seu QoS.
+ *
+ * Um filtro já confirmado com o mesmo QoS não gera novo SUBSCRIBE.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG ou ESP_ERR_NO_MEM se o registro estiver cheio.
+ */
+esp_err_t sub_registry_add(const char *filter, int qos);
+
+/**
+ * @brief Remove um filtro do conjunto desejado.
+ *
+ * Se o filtro já foi enviado ao broker, fica pendente de UNSUBSCRIBE.
+ * @return ESP_OK ou ESP_ERR_NOT_FOUND.
+ */
+esp_err_t sub_registry_remove(const char *filter);
+
+/**
+ * @brief Ajusta o registro a uma nova conexão (CONNACK).
+ * @param session_present false se o broker não guardou a sessão: tudo
+ *        volta a ser pendente.
+ */
+void sub_registry_on_connect(bool session_present);
+
+/**
+ * @brief Coleta as entradas pendentes para um SUBSCRIBE.
+ *
+ * As entradas passam a "enviadas"; os ponteiros de filtro em `list`
+ * permanecem válidos até sub_registry_end_subscribe(). Apenas um lote
+ * pode estar aberto por vez (uma única task envia).
+ * @return Número de entradas em `list` (0 se nada pendente).
+ */
+int sub_registry_begin_subscribe(esp_mqtt_topic_t *list, int max);
+
+/**
+ * @brief Associa o lote aberto ao msg_id retornado pelo cliente.
+ * @param msg_id msg_id do SUBSCRIBE ou negativo se o envio falhou (as
+ *        entradas voltam a ser pendentes).
+ */
+void sub_registry_end_subscribe(int msg_id);
+
+/**
+ * @brief Aplica um SUBACK.
+ * @param codes Um código por tópico, na ordem do lote (QoS concedido ou 0x80).
+ * @return Número de entradas rejeitadas.
+ */
+int sub_registry_on_suback(int msg_id, const uint8_t *codes, int count);
+
+/**
+ * @brief Copia o próximo filtro pendente de UNSUBSCRIBE.
+ * @return true se havia um filtro.
+ */
+bool sub_registry_next_removal(char *filter, size_t len);
+
+/**
+ * @brief Libera a entrada após o UNSUBSCRIBE ser enviado.
+ */
+void sub_registry_removal_done(const char *filter);
+
+/**
+ * @brief Obtém os contadores do registro.
+ */
+void sub_registry_get_stats(sub_registry_stats_t *stats);
+
+#endif /* SUB_REGISTRY_H */
@@ -0,0 +1,249 @@
+/**
+ * @file task_profile.c
+ * @brief Perfil de escalonamento das tasks - Implementação
+ *
+ * As prioridades são as mesmas nos dois perfis: trocar de perfil muda
+ * apenas a afinidade, e a diferença no jitter e na latência do atuador
+ * vem só do núcleo.
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#include "task_profile.h"
+
+#include "mem_budget.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+/* Definições privadas */
+
+static const char *TAG = "TASK_PROFILE";
+
+#if TASK_PROFILE == TASK_PROFILE_LEGADO
+#define PERFIL_NOME "legado"
+#define NUCLEO_APP tskNO_AFFINITY
+#define NUCLEO_CONEXAO tskNO_AFFINITY
+#elif TASK_PROFILE == TASK_PROFILE_APP_CPU
+#define PERFIL_NOME "app_cpu"
+#define NUCLEO_APP TASK_CORE_APP
+#define NUCLEO_CONEXAO TASK_CORE_PRO
+#else
+#error "TASK_PROFILE desconhecido"
+#endif
+
+/* Variáveis privadas (static) */
+
+static const task_profile_t s_tabela[TASK_ID_COUNT] = {
+    [TASK_ID_TELEMETRY] = {"Telemetry", TASK_STACK_TELEMETRY, 5, NUCLEO_APP},
+    [TASK_ID_HEALTH] = {"HealthMon", TASK_STACK_HEALTH, 3, NUCLEO_APP},
+    [TASK_ID_OFFLINE_DRAIN] = {"OfflineDrain", TASK_STACK_OFFLINE_DRAIN, 1, NUCLEO_APP},
+    [TASK_ID_CONNECTION] = {"Connection", TASK_STACK_CONNECTION, 4, NUCLEO_CONEXAO},
+    /* Acima da task do esp-mqtt (5); já era fixada antes da tabela */
+    [TASK_ID_ACTUATOR] = {"Actuator", TASK_STACK_ACTUATOR, 10, TASK_CORE_APP},
+    [TASK_ID_MONITOR] = {"SystemMonitor", TASK_STACK_MONITOR, 3, NUCLEO_APP},
+    [TASK_ID_CUSTOM_PUBLISH] = {"CustomPublish", TASK_STACK_CUSTOM_PUBLISH, 2, NUCLEO_APP},
+    [TASK_ID_SENSOR_SIMULATE] = {"SensorSimulate", TASK_STACK_SENSOR_SIMULATE, 2, NUCLEO_APP},
+    [TASK_ID_LOG_DRAIN] = {"LogDrain", TASK_STACK_LOG_DRAIN, 1, NUCLEO_APP},
+};
+
+#if MEM_STATIC_ALLOCATION
+/* Fatias consecutivas do pool, na ordem de task_id_t */
+static StackType_t s_stack_pool[TASK_STACK_TOTAL] __attribute__((aligned(16)));
+static StaticTask_t s_tcbs[TASK_ID_COUNT];
+#endif
+
+static latency_hist_t s_jitter[TASK_ID_COUNT];
+static uint32_t s_ultimo_despertar_us[TASK_ID_COUNT];
+
+/** Handles das tasks criadas (NULL = inexistente ou removida) */
+static TaskHandle_t s_handles[TASK_ID_COUNT];
+
+/* Funções auxiliares */
+
+static uint32_t round_up(uint32_t value, uint32_t step)
+{
+    return (value + step - 1) / step * step;
+}
+
+#if MEM_STATIC_ALLOCATION
+static StackType_t *stack_slot(task_id_t id)
+{
+    uint32_t offset = 0;
+    for (int i = 0; i < (int)id; i++)
+    {
+        offset += s_tabela[i].stack;
+    }
+    return &s_stack_pool[offset];
+}
+#endif
+
+/* Implementação das funções públicas */
+
+const task_profile_t *task_profile_get(task_id_t id)
+{
+    return (id < TASK_ID_COUNT) ? &s_tabela[id] : NULL;
+}
+
+const char *task_profile_name(void)
+{
+    return PERFIL_NOME;
+}
+
+esp_err_t task_profile_create(task_id_t id, TaskFunction_t fn, void *arg,
+                              TaskHandle_t *handle)
+{
+    if (id >= TASK_ID_COUNT)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const task_profile_t *p = &s_tabela[id];
+#if MEM_STATIC_ALLOCATION
+    if (__atomic_load_n(&s_handles[id], __ATOMIC_ACQUIRE) != NULL)
+    {
+        return ESP_ERR_INVALID_STATE; // A fatia do pool ainda está em uso
+    }
+
+    TaskHandle_t task = xTaskCreateStaticPinnedToCore(fn, p->nome, p->stack, arg,
+                                                      p->prioridade, stack_slot(id),
+                                                      &s_tcbs[id], p->nucleo);
+    if (task == NULL)
+    {
+        return ESP_FAIL;
+    }
+#else
+    TaskHandle_t task = NULL;
+    BaseType_t ret = xTaskCreatePinnedToCore(fn, p->nome, p->stack, arg,
+                                             p->prioridade, &task, p->nucleo);
+    if (ret != pdPASS)
+    {
+        return ESP_FAIL;
+    }
+#endif
+
+    __atomic_store_n(&s_handles[id], task, __ATOMIC_RELEASE);
+    if (handle != NULL)
+    {
+        *handle = task;
+    }
+    return ESP_OK;
+}
+
+void task_profile_delete(task_id_t id)
+{
+    if (id >= TASK_ID_COUNT)
+    {
+        return;
+    }
+
+    TaskHandle_t task = __atomic_exchange_n(&s_handles[id], NULL, __ATOMIC_ACQ_REL);
+    if (task != NULL)
+    {
+        vTaskDelete(task);
+#if MEM_STATIC_ALLOCATION
+        /* Se a task rodava no outro núcleo, o TCB só sai da lista de
+         * remoção pela idle task; espera um tick antes de liberar a fatia */
+        vTaskDelay(1);
+#endif
+    }
+}
+
+void task_profile_delay_until(task_id_t id, TickType_t *ultimo, TickType_t periodo)
+{
+    vTaskDelayUntil(ultimo, periodo);
+
+    uint32_t agora = (uint32_t)esp_timer_get_time();
+    uint32_t anterior = s_ultimo_despertar_us[id];
+    s_ultimo_despertar_us[id] = agora;
+
+    /* Despertares em ticks absolutos: fora do jitter, o intervalo é exato */
+    if (anterior != 0)
+    {
+        uint32_t real = agora - anterior;
+        uint32_t nominal = (uint32_t)pdTICKS_TO_MS(periodo) * 1000U;
+        latency_hist_record(&s_jitter[id], real > nominal ? real - nominal : nominal - real);
+    }
+}
+
+void task_profile_get_jitter(task_id_t id, latency_summary_t *out)
+{
+    latency_hist_summary(&s_jitter[id], out);
+}
+
+IRAM_ATTR task_id_t task_profile_current(void)
+{
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    for (int id = 0; id < TASK_ID_COUNT; id++)
+    {
+        if (__atomic_load_n(&s_handles[id], __ATOMIC_RELAXED) == self)
+        {
+            return (task_id_t)id;
+        }
+    }
+    return TASK_ID_COUNT;
+}
+
+void task_profile_get_stack(task_id_t id, task_stack_info_t *out)
+{
+    out->ativa = false;
+    out->configurada = s_tabela[id].stack;
+    out->livre_min = 0;
+    out->recomendada = 0;
+
+    TaskHandle_t task = __atomic_load_n(&s_handles[id], __ATOMIC_ACQUIRE);
+    if (task == NULL)
+    {
+        return;
+    }
+
+    /* No ESP-IDF a stack é contada em bytes */
+    uint32_t livre = (uint32_t)uxTaskGetStackHighWaterMark(task);
+    uint32_t usada = (livre < out->configurada) ? out->configurada - livre : 0;
+    uint32_t margem = usada * TASK_STACK_MARGIN_PCT / 100;
+    if (margem < TASK_STACK_MARGIN_MIN)
+    {
+        margem = TASK_STACK_MARGIN_MIN;
+    }
+
+    out->ativa = true;
+    out->livre_min = livre;
+    out->recomendada = round_up(usada + margem, TASK_STACK_ROUND);
+}
+
+void task_profile_log_stack_report(void)
+{
+    uint32_t total_configurado = 0;
+    uint32_t total_recomendado = 0;
+
+    ESP_LOGI(TAG, "Stacks (margem %d%%, min %d bytes):", TASK_STACK_MARGIN_PCT,
+             TASK_STACK_MARGIN_MIN);
+    ESP_LOGI(TAG, "   %-14s %6s %6s %6s %6s", "task", "atual", "usada", "livre", "recom.");
+
+    for (int id = 0; id < TASK_ID_COUNT; id++)
+    {
+        task_stack_info_t info;
+        task_profile_get_stack(id, &info);
+        if (!info.ativa)
+        {
+            continue;
+        }
+
+        ESP_LOGI(TAG, "   %-14s %6lu %6lu %6lu %6lu%s", s_tabela[id].nome,
+                 info.configurada, info.configurada - info.livre_min, info.livre_min,
+                 info.recomendada, info.recomendada > info.configurada ? " (aumentar)" : "");
+        total_configurado += info.configurada;
+        total_recomendado += info.recomendada;
+    }
+
+    if (total_recomendado < total_configurado)
+    {
+        ESP_LOGI(TAG, "   Total: %lu -> %lu bytes (%lu recuperaveis)", total_configurado,
+                 total_recomendado, total_configurado - total_recomendado);
+    }
+    else
+    {
+        ESP_LOGW(TAG, "   Total: %lu -> %lu bytes (stacks abaixo da margem)",
+                 total_configurado, total_recomendado);
+    }
+}
@@ -0,0 +1,199 @@
+/**
+ * @file task_profile.h
+ * @brief Perfil de escalonamento das tasks (núcleo, prioridade e stack).
+ *
+ * Uma única tabela define, para cada task do firmware, o núcleo, a
+ * prioridade e a stack usados em xTaskCreatePinnedToCore(). O perfil é
+ * escolhido em tempo de compilação por TASK_PROFILE:
+ *
+ * - TASK_PROFILE_LEGADO: tasks sem afinidade, como antes da tabela
+ *   (competem com WiFi/lwIP no núcleo 0).
+ * - TASK_PROFILE_APP_CPU: tasks da aplicação fixadas no núcleo de
+ *   aplicação (APP_CPU); a task de conexão, que só conversa com o driver
+ *   WiFi, fica no núcleo de protocolo (PRO_CPU).
+ *
+ * Com CONFIG_FREERTOS_UNICORE os dois núcleos se reduzem ao núcleo 0.
+ *
+ * As tasks periódicas dormem com task_profile_delay_until(), que mede o
+ * jitter de despertar (|intervalo real - período|) em um histograma por
+ * task: é o efeito do perfil sobre a latência de escalonamento.
+ *
+ * O menor espaço livre de stack de cada task (uxTaskGetStackHighWaterMark)
+ * segue no tópico de health, lido na cadência da task de health. Com
+ * TASK_STACK_REPORT o SystemMonitor imprime também o tamanho recomendado
+ * para cada stack: o maior uso observado mais uma margem, arredondado. O
+ * uso só cobre os caminhos já executados; gere reconexões, fila offline e
+ * comandos antes de confiar no relatório.
+ *
+ * Com MEM_STATIC_ALLOCATION (mem_budget.h) as tasks são criadas com
+ * xTaskCreateStaticPinnedToCore(): stacks e TCBs vêm de um pool estático
+ * dimensionado pelos TASK_STACK_* abaixo.
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#ifndef TASK_PROFILE_H
+#define TASK_PROFILE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_err.h"
+#include "latency_hist.h"
+
+/* Perfis disponíveis */
+
+#define TASK_PROFILE_LEGADO 0  ///< Sem afinidade (comportamento original)
+#define TASK_PROFILE_APP_CPU 1 ///< Aplicação no APP_CPU, conexão no PRO_CPU
+
+#ifndef TASK_PROFILE
+#define TASK_PROFILE TASK_PROFILE_APP_CPU ///< Perfil de escalonamento em uso
+#endif
+
+#ifndef TASK_STACK_REPORT
+#define TASK_STACK_REPORT 0 ///< 1 = relatório de dimensionamento das stacks no SystemMonitor
+#endif
+
+#ifndef TASK_STACK_MARGIN_PCT
+#define TASK_STACK_MARGIN_PCT 25 ///< Margem sobre o maior uso observado (%)
+#endif
+
+#ifndef TASK_STACK_MARGIN_MIN
+#define TASK_STACK_MARGIN_MIN 512 ///< Margem mínima (bytes)
+#endif
+
+/* Stacks (bytes): usados pela tabela e pelo pool estático */
+
+#define TASK_STACK_TELEMETRY 4096
+#define TASK_STACK_HEALTH 4096
+#define TASK_STACK_OFFLINE_DRAIN 3072
+#define TASK_STACK_CONNECTION 4096
+#define TASK_STACK_ACTUATOR 3072
+#define TASK_STACK_MONITOR 3072
+#define TASK_STACK_CUSTOM_PUBLISH 2560
+#define TASK_STACK_SENSOR_SIMULATE 3072
+#define TASK_STACK_LOG_DRAIN 2560
+
+/** Soma das stacks da tabela (tamanho do pool estático) */
+#define TASK_STACK_TOTAL (TASK_STACK_TELEMETRY + TASK_STACK_HEALTH +                 \
+                          TASK_STACK_OFFLINE_DRAIN + TASK_STACK_CONNECTION +         \
+                          TASK_STACK_ACTUATOR + TASK_STACK_MONITOR +                 \
+                          TASK_STACK_CUSTOM_PUBLISH + TASK_STACK_SENSOR_SIMULATE +   \
+                          TASK_STACK_LOG_DRAIN)
+
+/** Granularidade do tamanho recomendado (bytes) */
+#define TASK_STACK_ROUND 256
+
+/** Núcleo de protocolo (WiFi, lwIP, esp_timer) */
+#define TASK_CORE_PRO 0
+
+/** Núcleo de aplicação (0 em sistemas de um núcleo) */
+#define TASK_CORE_APP (portNUM_PROCESSORS - 1)
+
+/**
+ * @brief Tasks do firmware.
+ *
+ * Novas tasks entram no fim: a ordem é a dos arrays de stack do health
+ * (CBOR e binário) e dos nomes em tools/payload_codec.py.
+ */
+typedef enum
+{
+	TASK_ID_TELEMETRY = 0,	 ///< Amostragem de telemetria.
+	TASK_ID_HEALTH,			 ///< Publicação de health.
+	TASK_ID_OFFLINE_DRAIN,	 ///< Reenvio da fila offline.
+	TASK_ID_CONNECTION,		 ///< Máquina de estados WiFi/MQTT.
+	TASK_ID_ACTUATOR,		 ///< Aplicação de comandos nos GPIOs.
+	TASK_ID_MONITOR,		 ///< Monitoramento (log) do sistema.
+	TASK_ID_CUSTOM_PUBLISH,	 ///< Publicação customizada.
+	TASK_ID_SENSOR_SIMULATE, ///< Sensores simulados.
+	TASK_ID_LOG_DRAIN,		 ///< Escrita do log diferido.
+	TASK_ID_COUNT
+} task_id_t;
+
+/**
+ * @brief Parâmetros de criação de uma task.
+ */
+typedef struct
+{
+	const char *nome;		///< Nome da task (debug).
+	uint32_t stack;			///< Stack em bytes.
+	UBaseType_t prioridade; ///< Prioridade FreeRTOS.
+	BaseType_t nucleo;		///< Núcleo ou tskNO_AFFINITY.
+} task_profile_t;
+
+/**
+ * @brief Uso de stack de uma task.
+ */
+typedef struct
+{
+	bool ativa;			  ///< Task criada e não removida.
+	uint32_t configurada; ///< Stack da tabela (bytes).
+	uint32_t livre_min;	  ///< Menor espaço livre desde a criação (bytes).
+	uint32_t recomendada; ///< Uso máximo + margem, arredondado (bytes).
+} task_stack_info_t;
+
+/**
+ * @brief Parâmetros da task no perfil em uso.
+ */
+const task_profile_t *task_profile_get(task_id_t id);
+
+/**
+ * @brief Nome do perfil em uso ("legado" ou "app_cpu").
+ */
+const char *task_profile_name(void);
+
+/**
+ * @brief Cria a task com os parâmetros do perfil.
+ *
+ * No modo estático cada task tem uma única fatia do pool: criar de novo
+ * uma task ainda ativa retorna ESP_ERR_INVALID_STATE.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_STATE ou ESP_FAIL.
+ */
+esp_err_t task_profile_create(task_id_t id, TaskFunction_t fn, void *arg,
+							  TaskHandle_t *handle);
+
+/**
+ * @brief Remove a task criada por task_profile_create().
+ *
+ * Esquece o handle antes de apagar a task, para que as leituras de stack
+ * não usem uma task removida.
+ */
+void task_profile_delete(task_id_t id);
+
+/**
+ * @brief vTaskDelayUntil() que registra o jitter de despertar da task.
+ *
+ * Deve ser chamada apenas pela própria task `id` (um escritor por
+ * histograma). O primeiro despertar só inicia a medição.
+ */
+void task_profile_delay_until(task_id_t id, TickType_t *ultimo, TickType_t periodo);
+
+/**
+ * @brief Resumo do jitter de despertar da task (µs).
+ */
+void task_profile_get_jitter(task_id_t id, latency_summary_t *out);
+
+/**
+ * @brief Task do perfil que está executando (TASK_ID_COUNT se nenhuma).
+ *
+ * Em IRAM: é chamada pelos hooks de alocação do heap.
+ */
+task_id_t task_profile_current(void);
+
+/**
+ * @brief Uso de stack da task (ativa = false se ela não existe).
+ */
+void task_profile_get_stack(task_id_t id, task_stack_info_t *out);
+
+/**
+ * @brief Imprime o relatório de dimensionamento das stacks.
+ *
+ * Uma linha por task ativa (configurada, usada, livre e recomendada) e o
+ * total de RAM recuperável com os tamanhos recomendados.
+ */
+void task_profile_log_stack_report(void);
+
+#endif /* TASK_PROFILE_H */
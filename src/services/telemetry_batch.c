@@ -0,0 +1,86 @@
+/**
+ * @file telemetry_batch.c
+ * @brief Acumulador de amostras de telemetria - Implementação
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#include "telemetry_batch.h"
+
+
+/* Variáveis privadas (static) */
+
+/** Buffer circular de amostras */
+static telemetry_data_t s_samples[TELEMETRY_BATCH_CAPACITY];
+
+/** Índice da amostra mais antiga */
+static uint32_t s_head = 0;
+
+/** Número de amostras armazenadas */
+static uint32_t s_count = 0;
+
+/** Instante (ms) em que cada amostra foi adicionada (idade do lote) */
+static uint64_t s_added_ms[TELEMETRY_BATCH_CAPACITY];
+
+/* Implementação das funções públicas */
+
+void telemetry_batch_reset(void)
+{
+    s_head = 0;
+    s_count = 0;
+}
+
+bool telemetry_batch_add(const telemetry_data_t *data, uint64_t now_ms)
+{
+    uint32_t tail = (s_head + s_count) % TELEMETRY_BATCH_CAPACITY;
+    s_samples[tail] = *data;
+    s_added_ms[tail] = now_ms;
+
+    if (s_count < TELEMETRY_BATCH_CAPACITY)
+    {
+        s_count++;
+    }
+    else
+    {
+        // Buffer cheio: a amostra mais antiga foi sobrescrita
+        s_head = (s_head + 1) % TELEMETRY_BATCH_CAPACITY;
+    }
+
+    return s_count >= MQTT_TELEMETRY_BATCH_SIZE ||
+           (now_ms - s_added_ms[s_head]) >= MQTT_TELEMETRY_BATCH_MAX_AGE_MS;
+}
+
+bool telemetry_batch_expired(uint64_t now_ms)
+{
+    return s_count > 0 && (now_ms - s_added_ms[s_head]) >= MQTT_TELEMETRY_BATCH_MAX_AGE_MS;
+}
+
+uint32_t telemetry_batch_snapshot(telemetry_data_t *samples, uint32_t max)
+{
+    uint32_t count = (s_count < max) ? s_count : max;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        samples[i] = s_samples[(s_head + i) % TELEMETRY_BATCH_CAPACITY];
+    }
+
+    return count;
+}
+
+void telemetry_batch_consume(uint32_t count)
+{
+    if (count >= s_count)
+    {
+        telemetry_batch_reset();
+        return;
+    }
+
+    s_head = (s_head + count) % TELEMETRY_BATCH_CAPACITY;
+    s_count -= count;
+}
+
+uint32_t telemetry_batch_pending(void)
+{
+    return s_count;
+}
@@ -0,0 +1,80 @@
+/**
+ * @file telemetry_batch.h
+ * @brief Acumulador de amostras de telemetria para publicação em lote.
+ *
+ * Mantém um buffer circular de tamanho fixo com amostras de
+ * telemetria, publicadas juntas em um único payload (ver
+ * payload_codec.h), reduzindo o número de PUBLISH/ACKs enviados
+ * ao broker.
+ *
+ * @note Não é thread-safe. O chamador deve serializar o acesso.
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#ifndef TELEMETRY_BATCH_H
+#define TELEMETRY_BATCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "mqtt_system.h"
+
+/** Capacidade do buffer circular (amostras) */
+#define TELEMETRY_BATCH_CAPACITY MQTT_TELEMETRY_BATCH_SIZE
+
+/** Tamanho máximo do payload de um lote (bytes) */
+#define TELEMETRY_BATCH_BUFFER_SIZE 1536
+
+/**
+ * @brief Descarta todas as amostras acumuladas.
+ */
+void telemetry_batch_reset(void);
+
+/**
+ * @brief Adiciona uma amostra ao lote.
+ *
+ * Se o buffer estiver cheio, a amostra mais antiga é sobrescrita.
+ *
+ * @param data Amostra a ser adicionada.
+ * @param now_ms Instante atual (ms), usado para o controle de idade do lote.
+ * @return true se o lote atingiu o limite de quantidade ou de idade
+ *         e deve ser publicado.
+ */
+bool telemetry_batch_add(const telemetry_data_t *data, uint64_t now_ms);
+
+/**
+ * @brief Verifica se a amostra mais antiga atingiu a idade máxima.
+ *
+ * Permite publicar um lote parcial quando não chegam novas amostras
+ * (ex.: report-by-exception suprimindo leituras).
+ *
+ * @param now_ms Instante atual (ms), na mesma base de telemetry_batch_add().
+ * @return true se há amostras pendentes e o lote deve ser publicado.
+ */
+bool telemetry_batch_expired(uint64_t now_ms);
+
+/**
+ * @brief Copia as amostras acumuladas, da mais antiga para a mais nova.
+ *
+ * As amostras não são removidas; após uma publicação bem-sucedida
+ * o chamador deve chamar telemetry_batch_consume().
+ *
+ * @param samples Vetor de destino.
+ * @param max Capacidade do vetor de destino.
+ * @return Número de amostras copiadas.
+ */
+uint32_t telemetry_batch_snapshot(telemetry_data_t *samples, uint32_t max);
+
+/**
+ * @brief Remove as `count` amostras mais antigas do lote.
+ * @param count Número de amostras a remover.
+ */
+void telemetry_batch_consume(uint32_t count);
+
+/**
+ * @brief Retorna o número de amostras pendentes no lote.
+ */
+uint32_t telemetry_batch_pending(void);
+
+#endif /* TELEMETRY_BATCH_H */
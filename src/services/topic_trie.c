@@ -0,0 +1,466 @@
+/**
+ * @file topic_trie.c
+ * @brief Trie de filtros de tópico MQTT com curingas - Implementação
+ *
+ * Cada nó representa um nível do filtro. Filhos literais formam uma
+ * lista encadeada (comparados por hash FNV-1a + comprimento), enquanto
+ * os filhos '+' e '#' têm ponteiros dedicados, de modo que a busca
+ * visita no máximo três ramos por nível.
+ *
+ * Remover um handler apenas desativa a entrada; uma inserção posterior
+ * no mesmo nó a reativa, de modo que ciclos de registro e remoção do
+ * mesmo filtro não esgotam o pool de entradas. Enquanto a entrada é
+ * regravada, seu contador de sequência fica ímpar e a busca repete a
+ * leitura de callback/ctx se o contador mudou.
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#include "topic_trie.h"
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+
+/* Definições privadas */
+
+#define TRIE_NONE 0xFFFF
+#define TRIE_ROOT 0
+
+_Static_assert(TOPIC_TRIE_MAX_NODES < TRIE_NONE && TOPIC_TRIE_MAX_ENTRIES < TRIE_NONE &&
+                   TOPIC_TRIE_LABEL_POOL <= UINT16_MAX,
+               "indices e offsets da trie sao uint16_t");
+
+/**
+ * @brief Nó da trie (um nível de filtro).
+ */
+typedef struct
+{
+    uint32_t label_hash;   ///< Hash do rótulo do nível
+    uint16_t label_offset; ///< Posição do rótulo em s_labels
+    uint8_t label_len;     ///< Comprimento do rótulo
+    uint16_t first_child;  ///< Primeiro filho literal
+    uint16_t next_sibling; ///< Próximo irmão literal
+    uint16_t plus_child;   ///< Filho '+'
+    uint16_t hash_child;   ///< Filho '#'
+    uint16_t first_entry;  ///< Primeira entrada (handler) deste nó
+} trie_node_t;
+
+/**
+ * @brief Handler associado a um nó.
+ */
+typedef struct
+{
+    mqtt_message_handler_t callback;
+    void *ctx;
+    uint32_t seq;   ///< Sequência da gravação (ímpar durante a escrita)
+    uint16_t next;
+    uint8_t active;
+} trie_entry_t;
+
+/* Variáveis privadas (static) */
+
+static trie_node_t s_nodes[TOPIC_TRIE_MAX_NODES] = {
+    [TRIE_ROOT] = {
+        .first_child = TRIE_NONE,
+        .next_sibling = TRIE_NONE,
+        .plus_child = TRIE_NONE,
+        .hash_child = TRIE_NONE,
+        .first_entry = TRIE_NONE,
+    },
+};
+static uint16_t s_node_count = 1;
+
+static trie_entry_t s_entries[TOPIC_TRIE_MAX_ENTRIES];
+static uint16_t s_entry_count = 0;
+static uint32_t s_active_entries = 0;
+
+static char s_labels[TOPIC_TRIE_LABEL_POOL];
+static uint16_t s_labels_used = 0;
+
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/* Funções auxiliares */
+
+static inline uint32_t label_hash(const char *label, int len)
+{
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < len; i++)
+    {
+        hash ^= (uint8_t)label[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static inline uint16_t load_index(const uint16_t *index)
+{
+    return __atomic_load_n(index, __ATOMIC_ACQUIRE);
+}
+
+static inline void publish_index(uint16_t *index, uint16_t value)
+{
+    __atomic_store_n(index, value, __ATOMIC_RELEASE);
+}
+
+static inline int level_end(const char *topic, int pos, int len)
+{
+    const char *slash = memchr(topic + pos, '/', len - pos);
+    return slash ? (int)(slash - topic) : len;
+}
+
+static uint16_t find_literal_child(uint16_t parent, const char *label, int len, uint32_t hash)
+{
+    for (uint16_t child = load_index(&s_nodes[parent].first_child);
+         child != TRIE_NONE;
+         child = s_nodes[child].next_sibling)
+    {
+        const trie_node_t *node = &s_nodes[child];
+        if (node->label_hash == hash && node->label_len == len &&
+            memcmp(&s_labels[node->label_offset], label, len) == 0)
+        {
+            return child;
+        }
+    }
+    return TRIE_NONE;
+}
+
+/** Cria (se necessário) o filho de `parent` para o nível. Chamar com lock. */
+static uint16_t get_or_create_child(uint16_t parent, const char *label, int len)
+{
+    uint16_t *special = NULL;
+
+    if (len == 1 && label[0] == '+')
+    {
+        special = &s_nodes[parent].plus_child;
+    }
+    else if (len == 1 && label[0] == '#')
+    {
+        special = &s_nodes[parent].hash_child;
+    }
+
+    uint32_t hash = label_hash(label, len);
+
+    if (special != NULL && *special != TRIE_NONE)
+    {
+        return *special;
+    }
+
+    if (special == NULL)
+    {
+        uint16_t child = find_literal_child(parent, label, len, hash);
+        if (child != TRIE_NONE)
+        {
+            return child;
+        }
+    }
+
+    if (s_node_count >= TOPIC_TRIE_MAX_NODES || s_labels_used + len > TOPIC_TRIE_LABEL_POOL)
+    {
+        return TRIE_NONE;
+    }
+
+    uint16_t index = s_node_count++;
+    trie_node_t *node = &s_nodes[index];
+
+    memcpy(&s_labels[s_labels_used], label, len);
+    node->label_offset = s_labels_used;
+    node->label_len = (uint8_t)len;
+    node->label_hash = hash;
+    node->first_child = TRIE_NONE;
+    node->plus_child = TRIE_NONE;
+    node->hash_child = TRIE_NONE;
+    node->first_entry = TRIE_NONE;
+    s_labels_used += len;
+
+    if (special != NULL)
+    {
+        node->next_sibling = TRIE_NONE;
+        publish_index(special, index);
+    }
+    else
+    {
+        node->next_sibling = s_nodes[parent].first_child;
+        publish_index(&s_nodes[parent].first_child, index);
+    }
+
+    return index;
+}
+
+/** Localiza o nó de um filtro sem criar nós. Retorna TRIE_NONE se não existir. */
+static uint16_t find_filter_node(const char *filter)
+{
+    int len = strlen(filter);
+    uint16_t node = TRIE_ROOT;
+    int pos = 0;
+
+    while (node != TRIE_NONE && pos <= len)
+    {
+        int end = level_end(filter, pos, len);
+        int level_len = end - pos;
+        const char *label = filter + pos;
+
+        if (level_len == 1 && label[0] == '+')
+        {
+            node = s_nodes[node].plus_child;
+        }
+        else if (level_len == 1 && label[0] == '#')
+        {
+            node = s_nodes[node].hash_child;
+        }
+        else
+        {
+            node = find_literal_child(node, label, level_len, label_hash(label, level_len));
+        }
+
+        pos = end + 1;
+    }
+
+    return node;
+}
+
+/** Grava callback/ctx e ativa a entrada. Chamar com lock. */
+static void entry_write(trie_entry_t *entry, mqtt_message_handler_t callback, void *ctx)
+{
+    uint32_t seq = entry->seq;
+
+    __atomic_store_n(&entry->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    entry->callback = callback;
+    entry->ctx = ctx;
+    __atomic_store_n(&entry->active, 1, __ATOMIC_RELEASE);
+
+    __atomic_store_n(&entry->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+static int call_entries(uint16_t node, const mqtt_message_t *msg)
+{
+    int handled = 0;
+
+    for (uint16_t i = load_index(&s_nodes[node].first_entry); i != TRIE_NONE; i = s_entries[i].next)
+    {
+        const trie_entry_t *entry = &s_entries[i];
+        mqtt_message_handler_t callback;
+        void *ctx;
+        uint8_t active;
+        uint32_t seq;
+
+        // Cópia consistente: repete se a entrada foi reativada no meio
+        do
+        {
+            while ((seq = __atomic_load_n(&entry->seq, __ATOMIC_ACQUIRE)) & 1)
+            {
+            }
+            active = __atomic_load_n(&entry->active, __ATOMIC_ACQUIRE);
+            callback = entry->callback;
+            ctx = entry->ctx;
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        } while (__atomic_load_n(&entry->seq, __ATOMIC_RELAXED) != seq);
+
+        if (active)
+        {
+            callback(msg, ctx);
+            handled++;
+        }
+    }
+
+    return handled;
+}
+
+/**
+ * @brief Busca recursiva a partir de `node`, cujos níveis já casaram
+ *        até a posição `pos` do tópico.
+ */
+static int match_node(uint16_t node, const mqtt_message_t *msg, int pos, int depth)
+{
+    const char *topic = msg->topic;
+    int len = msg->topic_len;
+    bool wildcard_allowed = (depth > 0) || (topic[0] != '$');
+    int handled = 0;
+
+    // '#' casa o nível atual e todos os subníveis restantes
+    uint16_t hash_child = load_index(&s_nodes[node].hash_child);
+    if (hash_child != TRIE_NONE && wildcard_allowed)
+    {
+        handled += call_entries(hash_child, msg);
+    }
+
+    if (pos > len)
+    {
+        return handled + call_entries(node, msg);
+    }
+
+    if (depth >= TOPIC_TRIE_MAX_LEVELS)
+    {
+        return handled;
+    }
+
+    int end = level_end(topic, pos, len);
+    int level_len = end - pos;
+
+    uint16_t child = find_literal_child(node, topic + pos, level_len,
+                                        label_hash(topic + pos, level_len));
+    if (child != TRIE_NONE)
+    {
+        handled += match_node(child, msg, end + 1, depth + 1);
+    }
+
+    uint16_t plus_child = load_index(&s_nodes[node].plus_child);
+    if (plus_child != TRIE_NONE && wildcard_allowed)
+    {
+        handled += match_node(plus_child, msg, end + 1, depth + 1);
+    }
+
+    return handled;
+}
+
+/* Implementação das funções públicas */
+
+bool topic_trie_has_wildcard(const char *filter)
+{
+    return strpbrk(filter, "+#") != NULL;
+}
+
+bool topic_trie_filter_is_valid(const char *filter)
+{
+    int len = strlen(filter);
+    int levels = 0;
+
+    if (len == 0)
+    {
+        return false;
+    }
+
+    for (int pos = 0; pos <= len;)
+    {
+        int end = level_end(filter, pos, len);
+        int level_len = end - pos;
+
+        for (int i = pos; i < end; i++)
+        {
+            if ((filter[i] == '+' || filter[i] == '#') && level_len != 1)
+            {
+                return false; // Curinga deve ocupar o nível inteiro
+            }
+        }
+
+        if (level_len == 1 && filter[pos] == '#' && end != len)
+        {
+            return false; // '#' só pode ser o último nível
+        }
+
+        if (++levels > TOPIC_TRIE_MAX_LEVELS || level_len > UINT8_MAX)
+        {
+            return false;
+        }
+
+        pos = end + 1;
+    }
+
+    return true;
+}
+
+esp_err_t topic_trie_insert(const char *filter, mqtt_message_handler_t callback, void *ctx)
+{
+    if (filter == NULL || callback == NULL || !topic_trie_filter_is_valid(filter))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int len = strlen(filter);
+    esp_err_t ret = ESP_ERR_NO_MEM;
+
+    portENTER_CRITICAL(&s_lock);
+
+    uint16_t node = TRIE_ROOT;
+    for (int pos = 0; pos <= len && node != TRIE_NONE;)
+    {
+        int end = level_end(filter, pos, len);
+        node = get_or_create_child(node, filter + pos, end - pos);
+        pos = end + 1;
+    }
+
+    // Reativa uma entrada removida do mesmo nó antes de usar o pool
+    uint16_t index = TRIE_NONE;
+    if (node != TRIE_NONE)
+    {
+        for (uint16_t i = s_nodes[node].first_entry; i != TRIE_NONE; i = s_entries[i].next)
+        {
+            if (!s_entries[i].active)
+            {
+                index = i;
+                break;
+            }
+        }
+    }
+
+    if (index != TRIE_NONE)
+    {
+        entry_write(&s_entries[index], callback, ctx);
+        s_active_entries++;
+        ret = ESP_OK;
+    }
+    else if (node != TRIE_NONE && s_entry_count < TOPIC_TRIE_MAX_ENTRIES)
+    {
+        index = s_entry_count++;
+        trie_entry_t *entry = &s_entries[index];
+
+        entry_write(entry, callback, ctx);
+        entry->next = s_nodes[node].first_entry;
+        publish_index(&s_nodes[node].first_entry, index);
+        s_active_entries++;
+        ret = ESP_OK;
+    }
+
+    portEXIT_CRITICAL(&s_lock);
+
+    return ret;
+}
+
+esp_err_t topic_trie_remove(const char *filter, mqtt_message_handler_t callback)
+{
+    if (filter == NULL || !topic_trie_filter_is_valid(filter))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+
+    portENTER_CRITICAL(&s_lock);
+
+    uint16_t node = find_filter_node(filter);
+    if (node != TRIE_NONE)
+    {
+        for (uint16_t i = s_nodes[node].first_entry; i != TRIE_NONE; i = s_entries[i].next)
+        {
+            trie_entry_t *entry = &s_entries[i];
+            if (entry->active && entry->callback == callback)
+            {
+                __atomic_store_n(&entry->active, 0, __ATOMIC_RELEASE);
+                s_active_entries--;
+                ret = ESP_OK;
+                break;
+            }
+        }
+    }
+
+    portEXIT_CRITICAL(&s_lock);
+
+    return ret;
+}
+
+int topic_trie_dispatch(const mqtt_message_t *msg)
+{
+    if (msg->topic == NULL || msg->topic_len <= 0)
+    {
+        return 0;
+    }
+
+    return match_node(TRIE_ROOT, msg, 0, 0);
+}
+
+bool topic_trie_is_empty(void)
+{
+    return __atomic_load_n(&s_active_entries, __ATOMIC_RELAXED) == 0;
+}
@@ -0,0 +1,80 @@
+/**
+ * @file topic_trie.h
+ * @brief Trie de filtros de tópico MQTT com curingas.
+ *
+ * Implementa a semântica de curingas do MQTT 3.1.1 para o despacho
+ * local de mensagens:
+ * - '+' casa exatamente um nível;
+ * - '#' (último nível) casa o nível pai e qualquer número de subníveis;
+ * - tópicos iniciados por '$' não casam curingas no primeiro nível.
+ *
+ * Nós, entradas e rótulos ficam em pools estáticos. Inserções são
+ * serializadas por spinlock; a busca não usa locks e pode rodar em
+ * paralelo com inserções (nós são publicados com semântica release).
+ * Nós e rótulos não são liberados: o consumo acompanha o número de
+ * filtros distintos. Entradas removidas são reativadas por inserções
+ * no mesmo filtro.
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#ifndef TOPIC_TRIE_H
+#define TOPIC_TRIE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "mqtt_system.h"
+
+#ifndef TOPIC_TRIE_MAX_NODES
+#define TOPIC_TRIE_MAX_NODES 256 ///< Número máximo de nós (níveis distintos) da trie
+#endif
+
+#ifndef TOPIC_TRIE_MAX_ENTRIES
+#define TOPIC_TRIE_MAX_ENTRIES 128 ///< Número máximo de handlers registrados na trie
+#endif
+
+#ifndef TOPIC_TRIE_LABEL_POOL
+#define TOPIC_TRIE_LABEL_POOL 4096 ///< Bytes reservados para os rótulos dos níveis
+#endif
+
+/** Profundidade máxima de um filtro ou tópico (níveis) */
+#define TOPIC_TRIE_MAX_LEVELS 16
+
+/**
+ * @brief Verifica se um filtro contém curingas.
+ */
+bool topic_trie_has_wildcard(const char *filter);
+
+/**
+ * @brief Valida um filtro segundo as regras do MQTT 3.1.1.
+ * @return true se o filtro é válido.
+ */
+bool topic_trie_filter_is_valid(const char *filter);
+
+/**
+ * @brief Insere um handler para um filtro.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG (filtro inválido) ou ESP_ERR_NO_MEM.
+ */
+esp_err_t topic_trie_insert(const char *filter, mqtt_message_handler_t callback, void *ctx);
+
+/**
+ * @brief Desativa o handler de um filtro.
+ * @return ESP_OK ou ESP_ERR_NOT_FOUND.
+ */
+esp_err_t topic_trie_remove(const char *filter, mqtt_message_handler_t callback);
+
+/**
+ * @brief Chama todos os handlers cujos filtros casam com o tópico da mensagem.
+ * @param msg Mensagem recebida.
+ * @return Número de handlers chamados.
+ */
+int topic_trie_dispatch(const mqtt_message_t *msg);
+
+/**
+ * @brief Indica se há algum filtro inserido.
+ */
+bool topic_trie_is_empty(void);
+
+#endif /* TOPIC_TRIE_H */
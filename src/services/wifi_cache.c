@@ -0,0 +1,155 @@
+/**
+ * @file wifi_cache.c
+ * @brief Cache de conexão rápida WiFi - Implementação
+ *
+ * O cache é um único blob NVS com versão e hash do SSID na frente.
+ * Uma cópia do último conteúdo lido ou gravado fica em RAM para que
+ * wifi_cache_save() não reescreva a flash quando nada mudou.
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#include "wifi_cache.h"
+
+#include <string.h>
+#include "nvs.h"
+#include "esp_log.h"
+
+/* Definições privadas */
+
+static const char *TAG = "WIFI_CACHE";
+
+#define CACHE_KEY "sta"
+#define CACHE_VERSION 1
+
+/**
+ * @brief Registro gravado no NVS.
+ */
+typedef struct
+{
+    uint16_t versao;    ///< CACHE_VERSION
+    uint16_t tamanho;   ///< sizeof(wifi_cache_t) ao gravar
+    uint32_t ssid_hash; ///< Hash do SSID a que o cache pertence
+    wifi_cache_t dados; ///< Parâmetros da conexão
+} cache_record_t;
+
+/* Variáveis privadas (static) */
+
+/** Último registro lido ou gravado; evita regravar conteúdo igual */
+static cache_record_t s_last;
+static bool s_last_valid = false;
+
+/* Funções auxiliares */
+
+static uint32_t ssid_hash(const char *ssid)
+{
+    uint32_t hash = 2166136261u;
+    for (const char *p = ssid; *p != '\0'; p++)
+    {
+        hash ^= (uint8_t)*p;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/* Implementação das funções públicas */
+
+esp_err_t wifi_cache_load(const char *ssid, wifi_cache_t *out)
+{
+    nvs_handle_t handle;
+    esp_err_t ret = nvs_open(WIFI_CACHE_NVS_NAMESPACE, NVS_READONLY, &handle);
+    if (ret != ESP_OK)
+    {
+        return ESP_ERR_NOT_FOUND; // Namespace ainda não existe no primeiro boot
+    }
+
+    cache_record_t record;
+    size_t len = sizeof(record);
+    ret = nvs_get_blob(handle, CACHE_KEY, &record, &len);
+    nvs_close(handle);
+
+    if (ret != ESP_OK || len != sizeof(record) ||
+        record.versao != CACHE_VERSION || record.tamanho != sizeof(wifi_cache_t))
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    s_last = record;
+    s_last_valid = true;
+
+    if (record.ssid_hash != ssid_hash(ssid) || record.dados.channel == 0)
+    {
+        ESP_LOGI(TAG, "Cache pertence a outra rede, ignorando");
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    *out = record.dados;
+    return ESP_OK;
+}
+
+esp_err_t wifi_cache_save(const char *ssid, const wifi_cache_t *cache)
+{
+    cache_record_t record = {
+        .versao = CACHE_VERSION,
+        .tamanho = sizeof(wifi_cache_t),
+        .ssid_hash = ssid_hash(ssid),
+        .dados = *cache,
+    };
+    record.dados.reservado = 0;
+
+    if (s_last_valid && memcmp(&s_last, &record, sizeof(record)) == 0)
+    {
+        return ESP_OK;
+    }
+
+    nvs_handle_t handle;
+    esp_err_t ret = nvs_open(WIFI_CACHE_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Falha ao abrir NVS: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    ret = nvs_set_blob(handle, CACHE_KEY, &record, sizeof(record));
+    if (ret == ESP_OK)
+    {
+        ret = nvs_commit(handle);
+    }
+    nvs_close(handle);
+
+    if (ret != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Falha ao gravar cache: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    s_last = record;
+    s_last_valid = true;
+    ESP_LOGI(TAG, "Cache gravado (canal %u)", record.dados.channel);
+    return ESP_OK;
+}
+
+esp_err_t wifi_cache_erase(void)
+{
+    s_last_valid = false;
+
+    nvs_handle_t handle;
+    esp_err_t ret = nvs_open(WIFI_CACHE_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret != ESP_OK)
+    {
+        return ret;
+    }
+
+    ret = nvs_erase_key(handle, CACHE_KEY);
+    if (ret == ESP_OK)
+    {
+        ret = nvs_commit(handle);
+    }
+    else if (ret == ESP_ERR_NVS_NOT_FOUND)
+    {
+        ret = ESP_OK;
+    }
+    nvs_close(handle);
+    return ret;
+}
@@ -0,0 +1,82 @@
+/**
+ * @file wifi_cache.h
+ * @brief Cache de conexão rápida WiFi persistido em NVS.
+ *
+ * Guarda o canal e o BSSID do último AP em que a estação se associou e,
+ * opcionalmente, o endereço IP, máscara, gateway e DNS obtidos por DHCP.
+ * No boot seguinte a estação conecta direto no canal e BSSID conhecidos
+ * (sem varredura) e reaproveita o endereço sem esperar o DHCP. Se a
+ * tentativa falhar, o cache é apagado e a conexão volta ao fluxo normal.
+ * O endereço reaproveitado só vale depois do CONNACK: aí o DHCP volta a
+ * rodar para renovar o lease; sem CONNACK no prazo, o cache é descartado.
+ *
+ * O registro carrega o hash do SSID configurado: trocar de rede invalida
+ * o cache sem intervenção. A gravação só acontece quando o conteúdo muda,
+ * poupando a flash em boots repetidos na mesma rede.
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#ifndef WIFI_CACHE_H
+#define WIFI_CACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifndef WIFI_FAST_CONNECT
+#define WIFI_FAST_CONNECT 1 ///< Usa o cache de canal/BSSID no boot
+#endif
+
+#ifndef WIFI_FAST_CONNECT_REUSE_IP
+#define WIFI_FAST_CONNECT_REUSE_IP 1 ///< Reaproveita o último IP do DHCP como IP estático
+#endif
+
+#ifndef WIFI_FAST_CONNECT_MQTT_TIMEOUT_MS
+#define WIFI_FAST_CONNECT_MQTT_TIMEOUT_MS 15000 ///< Sem CONNACK nesse prazo, o IP do cache volta ao DHCP
+#endif
+
+/** Namespace NVS do cache */
+#define WIFI_CACHE_NVS_NAMESPACE "wifi_fast"
+
+/**
+ * @brief Parâmetros da última conexão bem-sucedida.
+ *
+ * Endereços em ordem de rede, como em esp_ip4_addr_t. ip == 0 indica que
+ * o endereço não foi guardado.
+ */
+typedef struct
+{
+	uint8_t bssid[6];	 ///< BSSID do AP
+	uint8_t channel;	 ///< Canal primário do AP
+	uint8_t reservado;	 ///< Alinhamento (sempre 0)
+	uint32_t ip;		 ///< Endereço IPv4
+	uint32_t netmask;	 ///< Máscara de rede
+	uint32_t gw;		 ///< Gateway
+	uint32_t dns;		 ///< Servidor DNS principal
+} wifi_cache_t;
+
+/**
+ * @brief Carrega o cache gravado para o SSID informado.
+ * @param ssid SSID configurado na estação.
+ * @param out Destino dos parâmetros.
+ * @return ESP_OK, ESP_ERR_NOT_FOUND se não houver cache válido para o SSID.
+ */
+esp_err_t wifi_cache_load(const char *ssid, wifi_cache_t *out);
+
+/**
+ * @brief Grava o cache se for diferente do último carregado ou gravado.
+ * @param ssid SSID configurado na estação.
+ * @param cache Parâmetros da conexão atual.
+ * @return ESP_OK (inclusive quando nada mudou) ou erro do NVS.
+ */
+esp_err_t wifi_cache_save(const char *ssid, const wifi_cache_t *cache);
+
+/**
+ * @brief Apaga o cache (usado quando a conexão rápida falha).
+ * @return ESP_OK ou erro do NVS.
+ */
+esp_err_t wifi_cache_erase(void);
+
+#endif /* WIFI_CACHE_H */
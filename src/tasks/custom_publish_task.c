@@ -8,6 +8,7 @@
 
 #include "tasks/custom_publish_task.h"
 #include "services/mqtt_system.h"
+#include "services/task_profile.h"
 #include "esp_log.h"
 #include <stdio.h>
 
@@ -19,10 +20,12 @@ void custom_publish_task(void *pvParameters)
 
     ESP_LOGI(TAG, "Task de publicacao customizada iniciada");
 
+    TickType_t ultimo_despertar = xTaskGetTickCount();
     while (1)
     {
         /* Aguardar intervalo de publicação */
-        vTaskDelay(pdMS_TO_TICKS(CUSTOM_PUBLISH_INTERVAL_MS));
+        task_profile_delay_until(TASK_ID_CUSTOM_PUBLISH, &ultimo_despertar,
+                                 pdMS_TO_TICKS(CUSTOM_PUBLISH_INTERVAL_MS));
 
         /* Verificar se MQTT está conectado antes de publicar */
         if (mqtt_system_is_connected())
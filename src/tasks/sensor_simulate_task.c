@@ -10,35 +10,93 @@
 
 #include "tasks/sensor_simulate_task.h"
 #include "services/mqtt_system.h"
+#include "services/report_filter.h"
+#include "services/sampler.h"
+#include "services/deferred_log.h"
 #include "esp_log.h"
 #include "esp_random.h"
+#include "esp_timer.h"
 #include <stdio.h>
 
 static const char *TAG = "SENSOR_SIMULATE";
 
+/**
+ * @brief Entrega a leitura de um canal.
+ *
+ * O barramento local (motor de regras) recebe toda leitura; o filtro de
+ * report-by-exception só decide a cópia para o broker.
+ *
+ * @return true se a leitura foi publicada no broker.
+ */
+static bool report_channel(report_filter_t *filter, const char *topic, int value, uint64_t now_ms)
+{
+    char buffer[16];
+    bool report = report_filter_check(filter, (float)value, now_ms) != REPORT_NONE;
+    mqtt_route_t route = (mqtt_route_t)(SENSOR_PUBLISH_ROUTE & (report ? MQTT_ROUTE_ALL : MQTT_ROUTE_LOCAL));
+    bool reported = false;
+
+    if (route != 0)
+    {
+        snprintf(buffer, sizeof(buffer), "%d", value);
+        int ret = mqtt_publish_routed(topic, buffer, 0, 1, false, route);
+        reported = report && ret >= 0;
+    }
+
+    report_filter_commit(filter, (float)value, now_ms, reported);
+    return reported;
+}
+
 void sensor_simulate_task(void *pvParameters)
 {
     ESP_LOGI(TAG, "Task de simulação de sensores iniciada");
 
-    char buffer[16];
+    const report_filter_config_t lum_cfg = {
+        .deadband = SENSOR_LUMINOSITY_DEADBAND,
+        .max_interval_ms = SENSOR_REPORT_MAX_INTERVAL_MS,
+        .heartbeat_ms = SENSOR_HEARTBEAT_MS,
+    };
+    const report_filter_config_t temp_cfg = {
+        .deadband = SENSOR_TEMPERATURE_DEADBAND,
+        .max_interval_ms = SENSOR_REPORT_MAX_INTERVAL_MS,
+        .heartbeat_ms = SENSOR_HEARTBEAT_MS,
+    };
+    report_filter_t lum_filter;
+    report_filter_t temp_filter;
+    report_filter_init(&lum_filter, &lum_cfg);
+    report_filter_init(&temp_filter, &temp_cfg);
 
+    bool was_connected = false;
+
+    sampler_start(SAMPLER_JOB_SENSORES, SENSOR_SIMULATE_PERIOD_US);
+    int64_t amostra_us = esp_timer_get_time();
     while (1)
     {
-        if (mqtt_system_is_connected())
+        bool connected = mqtt_system_is_connected();
+
+        /* Após reconexão o estado no broker pode estar defasado */
+        if (connected && !was_connected)
         {
-            // Simula e publica luminosidade (0 a 10)
-            int luminosity = esp_random() % 11;
-            snprintf(buffer, sizeof(buffer), "%d", luminosity);
-            mqtt_publish_data("/casa/externo/luminosidade", buffer, 0, 1, false);
+            report_filter_reset(&lum_filter);
+            report_filter_reset(&temp_filter);
+        }
+        was_connected = connected;
+
+        uint64_t now_ms = amostra_us / 1000ULL;
 
-            // Simula e publica temperatura (-3 a 45)
-            int temperature = (esp_random() % 49) - 3;
-            snprintf(buffer, sizeof(buffer), "%d", temperature);
-            mqtt_publish_data("/casa/sala/temperatura", buffer, 0, 1, false);
+        // Simula luminosidade (0 a 10)
+        int luminosity = esp_random() % 11;
+        bool lum_sent = report_channel(&lum_filter, MQTT_TOPIC_LUMINOSITY, luminosity, now_ms);
 
-            ESP_LOGI(TAG, "Sensores simulados: Luminosidade=%d, Temperatura=%d°C", luminosity, temperature);
+        // Simula temperatura (-3 a 45)
+        int temperature = (esp_random() % 49) - 3;
+        bool temp_sent = report_channel(&temp_filter, MQTT_TOPIC_TEMPERATURE, temperature, now_ms);
+
+        if (lum_sent || temp_sent)
+        {
+            DLOG(DLOG_SENSORES_SIMULADOS, luminosity, lum_sent ? "" : " (suprimida)",
+                 temperature, temp_sent ? "" : " (suprimida)");
         }
 
-        vTaskDelay(pdMS_TO_TICKS(SENSOR_SIMULATE_INTERVAL_MS));
+        amostra_us = sampler_wait(SAMPLER_JOB_SENSORES);
     }
-}
\ No newline at end of file
+}
@@ -8,74 +8,220 @@
 
 #include "tasks/system_monitor_task.h"
 #include "services/mqtt_system.h"
+#include "services/sub_registry.h"
+#include "services/task_profile.h"
+#include "services/cpu_stats.h"
+#include "services/heap_stats.h"
+#include "services/mem_budget.h"
+#include "services/static_outbox.h"
+#include "services/deferred_log.h"
+#include "services/sampler.h"
 #include "esp_log.h"
 
 static const char *TAG = "MONITOR_TASK";
 
+static const char *const s_conn_state_names[] = {
+    [MQTT_CONN_PARADO] = "parado",
+    [MQTT_CONN_WIFI_CONECTANDO] = "conectando WiFi",
+    [MQTT_CONN_WIFI_FALHA] = "WiFi indisponivel",
+    [MQTT_CONN_MQTT_CONECTANDO] = "conectando ao broker",
+    [MQTT_CONN_ONLINE] = "online",
+};
+
 void system_monitor_task(void *pvParameters)
 {
     uint32_t loop_count = 0;
+    uint32_t allocs_anteriores = 0;
 
     ESP_LOGI(TAG, "Task de monitoramento iniciada");
 
+    TickType_t ultimo_despertar = xTaskGetTickCount();
     while (1)
     {
         /* Aguardar intervalo de monitoramento */
-        vTaskDelay(pdMS_TO_TICKS(MONITOR_INTERVAL_MS));
+        task_profile_delay_until(TASK_ID_MONITOR, &ultimo_despertar,
+                                 pdMS_TO_TICKS(MONITOR_INTERVAL_MS));
         loop_count++;
 
-        ESP_LOGI(TAG, "");
-        ESP_LOGI(TAG, "════════════════════════════════════════");
-        ESP_LOGI(TAG, "  Status do Sistema (Loop #%lu)", loop_count);
-        ESP_LOGI(TAG, "════════════════════════════════════════");
+        DLOG(DLOG_MON_VAZIA);
+        DLOG(DLOG_MON_BORDA);
+        DLOG(DLOG_MON_TITULO, loop_count);
+        DLOG(DLOG_MON_BORDA);
 
         /* Verificar se MQTT está conectado */
         if (mqtt_system_is_connected())
         {
-            ESP_LOGI(TAG, "MQTT: Conectado e operacional");
+            DLOG(DLOG_MON_MQTT_OK);
 
             /* Obter e exibir estatísticas */
             mqtt_statistics_t stats;
             if (mqtt_get_statistics(&stats) == ESP_OK)
             {
-                ESP_LOGI(TAG, "Mensagens publicadas: %lu",
-                         stats.total_publicadas);
-                ESP_LOGI(TAG, "Mensagens recebidas: %lu",
-                         stats.total_recebidas);
-                ESP_LOGI(TAG, "Falhas de publicacao: %lu",
-                         stats.falhas_publicacao);
-                ESP_LOGI(TAG, "Desconexoes: %lu",
-                         stats.desconexoes);
+                DLOG(DLOG_MON_PUBLICADAS, stats.total_publicadas);
+                DLOG(DLOG_MON_RECEBIDAS, stats.total_recebidas);
+                DLOG(DLOG_MON_FALHAS, stats.falhas_publicacao);
+                DLOG(DLOG_MON_DESCONEXOES, stats.desconexoes);
+                DLOG(DLOG_MON_LOCAIS, stats.entregas_locais, stats.ecos_suprimidos);
             }
 
+            sub_registry_stats_t subs;
+            sub_registry_get_stats(&subs);
+            DLOG(DLOG_MON_SUBS, subs.confirmadas, subs.desejadas, subs.rejeitadas,
+                 subs.subscribes_enviados, subs.topicos_enviados);
+
             /* Obter status de saúde */
             health_status_t health;
             if (mqtt_get_health_status(&health) == ESP_OK)
             {
-                ESP_LOGI(TAG, "Heap livre: %lu bytes", health.free_heap);
-                ESP_LOGI(TAG, "WiFi RSSI: %d dBm", health.wifi_rssi);
-                ESP_LOGI(TAG, "Uptime: %llu segundos", health.uptime_sec);
+                DLOG(DLOG_MON_HEAP_LIVRE, health.free_heap);
+                DLOG(DLOG_MON_RSSI, health.wifi_rssi);
+                DLOG(DLOG_MON_UPTIME, health.uptime_sec);
 
                 /* Verificar alertas */
                 if (health.free_heap < 30000)
                 {
-                    ESP_LOGW(TAG, "Alerta: Memoria heap abaixo de 30KB!");
+                    DLOG(DLOG_MON_ALERTA_HEAP);
                 }
 
                 if (health.wifi_rssi < -80)
                 {
-                    ESP_LOGW(TAG, "Alerta: Sinal WiFi fraco!");
+                    DLOG(DLOG_MON_ALERTA_RSSI);
                 }
             }
         }
         else
         {
-            ESP_LOGW(TAG, "MQTT: Desconectado");
-            ESP_LOGI(TAG, "Sistema tentando reconectar automaticamente...");
+            DLOG(DLOG_MON_DESCONECTADO, s_conn_state_names[mqtt_system_get_conn_state()]);
+            DLOG(DLOG_MON_RECONECTANDO);
+        }
+
+        /* Jitter de despertar das tasks periódicas no perfil em uso */
+        DLOG(DLOG_MON_ESCALONAMENTO, task_profile_name());
+        for (int id = 0; id < TASK_ID_COUNT; id++)
+        {
+            latency_summary_t jitter;
+            task_profile_get_jitter(id, &jitter);
+            if (jitter.amostras == 0)
+            {
+                continue;
+            }
+
+            const task_profile_t *p = task_profile_get(id);
+            DLOG(DLOG_MON_JITTER, p->nome,
+                 p->nucleo == tskNO_AFFINITY ? "-" : (p->nucleo ? "1" : "0"),
+                 (unsigned)p->prioridade, jitter.p50_us, jitter.p99_us,
+                 jitter.max_us, jitter.amostras);
+        }
+
+        /* Jobs periódicos sobre o esp_timer */
+        DLOG(DLOG_MON_AMOSTRAGEM);
+        for (int job = 0; job < SAMPLER_JOB_COUNT; job++)
+        {
+            sampler_stats_t amostragem;
+            sampler_get_stats(job, &amostragem);
+            if (!amostragem.ativo)
+            {
+                continue;
+            }
+
+            DLOG(DLOG_MON_AMOSTRA_JITTER, sampler_job_name(job), amostragem.periodo_us,
+                 amostragem.jitter.p50_us, amostragem.jitter.p99_us, amostragem.jitter.max_us,
+                 amostragem.jitter.amostras);
+            DLOG(DLOG_MON_AMOSTRA_ATRASOS, sampler_job_name(job), amostragem.exec_max_us,
+                 amostragem.atrasos, amostragem.perdidas);
+        }
+
+        /* Uso de CPU na última janela da task de health */
+        cpu_usage_t cpu;
+        cpu_stats_get(&cpu);
+        if (cpu.valido)
+        {
+            for (int c = 0; c < cpu.nucleos; c++)
+            {
+                uint32_t ocupado = 10000U - cpu.ocioso_x100[c];
+                DLOG(DLOG_MON_CPU, c, ocupado / 100, ocupado % 100, cpu.janela_ms);
+            }
+            for (int i = 0; i < cpu.n_tasks; i++)
+            {
+                DLOG(DLOG_MON_CPU_TASK, cpu.tasks[i].nome, (unsigned)(cpu.tasks[i].uso_x100 / 100),
+                     (unsigned)(cpu.tasks[i].uso_x100 % 100));
+            }
         }
 
-        ESP_LOGI(TAG, "════════════════════════════════════════");
-        ESP_LOGI(TAG, "");
+        /* Fragmentação agora; taxas e captura da última janela da task de health */
+        heap_usage_t heap;
+        heap_stats_get(&heap);
+        DLOG(DLOG_MON_HEAP, heap.maior_bloco, (unsigned)(heap.frag_x100 / 100),
+             (unsigned)(heap.frag_x100 % 100));
+        for (int r = 0; r < HEAP_REGIAO_COUNT; r++)
+        {
+            if (heap.regioes[r].presente)
+            {
+                DLOG(DLOG_MON_HEAP_REGIAO, heap_stats_region_name(r), heap.regioes[r].livre,
+                     heap.regioes[r].maior_bloco, heap.regioes[r].minimo);
+            }
+        }
+        if (heap.maior_bloco < MQTT_BUFFER_SIZE)
+        {
+            DLOG(DLOG_MON_ALERTA_BLOCO, MQTT_BUFFER_SIZE);
+        }
+        if (heap.taxas_validas && heap.janela_ms > 0)
+        {
+            DLOG(DLOG_MON_HEAP_TAXAS,
+                 (uint32_t)((uint64_t)heap.allocs * 1000U / heap.janela_ms),
+                 (uint32_t)((uint64_t)heap.frees * 1000U / heap.janela_ms),
+                 (uint32_t)((uint64_t)heap.bytes_alocados * 1000U / heap.janela_ms),
+                 heap.janela_ms);
+        }
+        if (heap.trace.valido)
+        {
+            DLOG(DLOG_MON_CAPTURA, heap.trace.janela_ms);
+            for (int i = 0; i < HEAP_TRACE_SLOTS; i++)
+            {
+                if (heap.trace.allocs[i] > 0)
+                {
+                    DLOG(DLOG_MON_CAPTURA_TASK, heap_stats_trace_name(i), heap.trace.allocs[i],
+                         heap.trace.bytes[i]);
+                }
+            }
+        }
+
+        /* Alocações das tasks em regime; a primeira janela inclui o aquecimento */
+        mem_audit_t audit;
+        mem_budget_audit_get(&audit);
+        if (audit.suportado && audit.ativo)
+        {
+            uint32_t novas = audit.total - allocs_anteriores;
+            allocs_anteriores = audit.total;
+            if (MEM_STATIC_ALLOCATION && novas > 0 && loop_count > 1)
+            {
+                DLOG(DLOG_MON_REGIME_AVISO, novas);
+                for (int id = 0; id < TASK_ID_COUNT; id++)
+                {
+                    if (audit.por_task[id] > 0)
+                    {
+                        DLOG(DLOG_MON_REGIME_TASK, task_profile_get(id)->nome, audit.por_task[id]);
+                    }
+                }
+            }
+            else
+            {
+                DLOG(DLOG_MON_REGIME, novas, audit.total);
+            }
+        }
+
+#ifdef CONFIG_MQTT_CUSTOM_OUTBOX
+        static_outbox_stats_t outbox;
+        static_outbox_get_stats(&outbox);
+        DLOG(DLOG_MON_OUTBOX, outbox.ocupados, STATIC_OUTBOX_SLOTS, outbox.pico, outbox.recusadas);
+#endif
+
+#if TASK_STACK_REPORT
+        task_profile_log_stack_report();
+#endif
+
+        DLOG(DLOG_MON_BORDA);
+        DLOG(DLOG_MON_VAZIA);
     }
 
     /* Task nunca deve chegar aqui */
@@ -0,0 +1,81 @@
+/**
+ * @file test_main.c
+ * @brief Impressões de eco do barramento local (local_bus.h).
+ *
+ * Cada teste consome as impressões que registra, de modo que o vetor
+ * termina vazio para o próximo.
+ *
+ * Execução: pio test -e host-test -f test_local_bus
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#include <string.h>
+#include <unity.h>
+
+#include "services/local_bus.h"
+
+/* Funções auxiliares */
+
+static void mark(const char *topic, const char *data)
+{
+    local_bus_mark_forwarded(topic, strlen(topic), data, strlen(data));
+}
+
+static void unmark(const char *topic, const char *data)
+{
+    local_bus_unmark_forwarded(topic, strlen(topic), data, strlen(data));
+}
+
+static bool is_echo(const char *topic, const char *data)
+{
+    return local_bus_is_echo(topic, strlen(topic), data, strlen(data));
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+/* Casos */
+
+static void test_eco_descartado_uma_vez(void)
+{
+    mark("eco/sala", "21");
+
+    TEST_ASSERT_FALSE(is_echo("eco/sala", "22"));
+    TEST_ASSERT_FALSE(is_echo("eco/quarto", "21"));
+    TEST_ASSERT_TRUE(is_echo("eco/sala", "21"));
+    TEST_ASSERT_FALSE(is_echo("eco/sala", "21"));
+}
+
+static void test_envio_falho_nao_descarta_mensagem_externa(void)
+{
+    mark("falha/sala", "21");
+    unmark("falha/sala", "21");
+
+    TEST_ASSERT_FALSE(is_echo("falha/sala", "21"));
+}
+
+static void test_desfaz_apenas_uma_impressao(void)
+{
+    mark("duas/sala", "21");
+    mark("duas/sala", "21");
+    unmark("duas/sala", "21");
+
+    TEST_ASSERT_TRUE(is_echo("duas/sala", "21"));
+    TEST_ASSERT_FALSE(is_echo("duas/sala", "21"));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_eco_descartado_uma_vez);
+    RUN_TEST(test_envio_falho_nao_descarta_mensagem_externa);
+    RUN_TEST(test_desfaz_apenas_uma_impressao);
+    return UNITY_END();
+}
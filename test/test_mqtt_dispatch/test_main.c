@@ -0,0 +1,191 @@
+/**
+ * @file test_main.c
+ * @brief Testes da tabela de despacho de tópicos exatos (mqtt_dispatch.h).
+ *
+ * A tabela é global e não tem reset: cada teste usa tópicos próprios e
+ * remove os handlers no final.
+ *
+ * Execução: pio test -e host-test -f test_mqtt_dispatch
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unity.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "services/mqtt_dispatch.h"
+
+/** Ciclos de registro/remoção: várias voltas pela tabela */
+#define TESTE_CICLOS (4 * MQTT_DISPATCH_TABLE_SIZE)
+
+/** Ciclos da task concorrente durante o despacho */
+#define TESTE_CICLOS_CONCORRENTES 100000
+
+/* Variáveis privadas (static) */
+
+static volatile bool s_rotatividade_ativa;
+static volatile uint32_t s_rotatividade_ciclos;
+
+/* Funções auxiliares */
+
+static void count_handler(const mqtt_message_t *msg, void *ctx)
+{
+    (*(int *)ctx)++;
+}
+
+/** Entrega o tópico à tabela; retorna quantas vezes o handler do contexto rodou */
+static int deliver(const char *topic, int *counter)
+{
+    const mqtt_message_t msg = {
+        .topic = topic,
+        .topic_len = strlen(topic),
+        .data = "1",
+        .data_len = 1,
+    };
+
+    *counter = 0;
+    mqtt_dispatch_message(&msg);
+    return *counter;
+}
+
+/** Registra e remove tópicos continuamente enquanto o teste despacha */
+static void rotatividade_task(void *arg)
+{
+    int n = 0;
+    char topic[32];
+
+    for (int i = 0; s_rotatividade_ativa; i++)
+    {
+        snprintf(topic, sizeof(topic), "concorrente/%d", i % 97);
+        mqtt_dispatch_register(topic, count_handler, &n);
+        mqtt_dispatch_unregister(topic, count_handler);
+        s_rotatividade_ciclos++;
+    }
+
+    *(volatile bool *)arg = true;
+    vTaskDelete(NULL);
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+/* Casos */
+
+static void test_registro_e_remocao(void)
+{
+    int n = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, mqtt_dispatch_register("exato/sala", count_handler, &n));
+
+    TEST_ASSERT_EQUAL(1, deliver("exato/sala", &n));
+    TEST_ASSERT_EQUAL(0, deliver("exato/sal", &n));
+    TEST_ASSERT_EQUAL(0, deliver("exato/sala/x", &n));
+
+    TEST_ASSERT_EQUAL(ESP_OK, mqtt_dispatch_unregister("exato/sala", count_handler));
+    TEST_ASSERT_EQUAL(0, deliver("exato/sala", &n));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, mqtt_dispatch_unregister("exato/sala", count_handler));
+}
+
+static void test_limite_de_handlers(void)
+{
+    int n = 0;
+    char topic[32];
+
+    for (int i = 0; i < MQTT_DISPATCH_MAX_HANDLERS; i++)
+    {
+        snprintf(topic, sizeof(topic), "limite/%d", i);
+        TEST_ASSERT_EQUAL(ESP_OK, mqtt_dispatch_register(topic, count_handler, &n));
+    }
+    TEST_ASSERT_EQUAL(ESP_ERR_NO_MEM, mqtt_dispatch_register("limite/extra", count_handler, &n));
+
+    for (int i = 0; i < MQTT_DISPATCH_MAX_HANDLERS; i++)
+    {
+        snprintf(topic, sizeof(topic), "limite/%d", i);
+        TEST_ASSERT_EQUAL(ESP_OK, mqtt_dispatch_unregister(topic, count_handler));
+    }
+}
+
+static void test_ciclos_reaproveitam_slots(void)
+{
+    int fixo = 0;
+    int n = 0;
+    char topic[32];
+
+    // Handlers permanentes ocupam metade do limite durante a rotatividade
+    for (int i = 0; i < MQTT_DISPATCH_MAX_HANDLERS / 2; i++)
+    {
+        snprintf(topic, sizeof(topic), "fixo/%d", i);
+        TEST_ASSERT_EQUAL(ESP_OK, mqtt_dispatch_register(topic, count_handler, &fixo));
+    }
+
+    for (int i = 0; i < TESTE_CICLOS; i++)
+    {
+        snprintf(topic, sizeof(topic), "ciclo/%d", i);
+        TEST_ASSERT_EQUAL_MESSAGE(ESP_OK, mqtt_dispatch_register(topic, count_handler, &n), topic);
+        TEST_ASSERT_EQUAL(1, deliver(topic, &n));
+        TEST_ASSERT_EQUAL(ESP_OK, mqtt_dispatch_unregister(topic, count_handler));
+        TEST_ASSERT_EQUAL(0, deliver(topic, &n));
+    }
+
+    for (int i = 0; i < MQTT_DISPATCH_MAX_HANDLERS / 2; i++)
+    {
+        snprintf(topic, sizeof(topic), "fixo/%d", i);
+        TEST_ASSERT_EQUAL(1, deliver(topic, &fixo));
+        TEST_ASSERT_EQUAL(ESP_OK, mqtt_dispatch_unregister(topic, count_handler));
+    }
+
+    // Depois da rotatividade a tabela ainda aceita o limite completo
+    for (int i = 0; i < MQTT_DISPATCH_MAX_HANDLERS; i++)
+    {
+        snprintf(topic, sizeof(topic), "cheia/%d", i);
+        TEST_ASSERT_EQUAL(ESP_OK, mqtt_dispatch_register(topic, count_handler, &n));
+    }
+    for (int i = 0; i < MQTT_DISPATCH_MAX_HANDLERS; i++)
+    {
+        snprintf(topic, sizeof(topic), "cheia/%d", i);
+        TEST_ASSERT_EQUAL(1, deliver(topic, &n));
+        TEST_ASSERT_EQUAL(ESP_OK, mqtt_dispatch_unregister(topic, count_handler));
+    }
+}
+
+static void test_despacho_durante_rotatividade(void)
+{
+    int fixo = 0;
+    volatile bool terminou = false;
+    TEST_ASSERT_EQUAL(ESP_OK, mqtt_dispatch_register("concorrente/fixo", count_handler, &fixo));
+
+    s_rotatividade_ativa = true;
+    s_rotatividade_ciclos = 0;
+    TEST_ASSERT_EQUAL(pdPASS, xTaskCreate(rotatividade_task, "churn", 4096, (void *)&terminou, 5, NULL));
+
+    // Slots vizinhos são regravados o tempo todo: o handler fixo roda uma vez por mensagem
+    while (s_rotatividade_ciclos < TESTE_CICLOS_CONCORRENTES)
+    {
+        TEST_ASSERT_EQUAL(1, deliver("concorrente/fixo", &fixo));
+    }
+
+    s_rotatividade_ativa = false;
+    while (!terminou)
+    {
+        vTaskDelay(pdMS_TO_TICKS(1));
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, mqtt_dispatch_unregister("concorrente/fixo", count_handler));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_registro_e_remocao);
+    RUN_TEST(test_limite_de_handlers);
+    RUN_TEST(test_ciclos_reaproveitam_slots);
+    RUN_TEST(test_despacho_durante_rotatividade);
+    return UNITY_END();
+}
@@ -0,0 +1,131 @@
+/**
+ * @file test_main.c
+ * @brief Transições do motor de regras e a fila de atuação (rule_engine.h).
+ *
+ * Uma transição só muda o estado da regra se o comando entrar na fila da
+ * task de atuação. A recarga libera as saídas com um comando por GPIO, e
+ * a liberação que não coube na fila é repostada pela próxima amostra.
+ *
+ * Execução: pio test -e host-test -f test_rule_engine
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#include <unity.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/gpio.h"
+#include "esp_timer.h"
+#include "services/actuator.h"
+#include "services/rule_engine.h"
+
+/** Saída usada pelas regras do teste */
+#define TESTE_GPIO 2
+
+/** Limite para a task de atuação aplicar os comandos */
+#define TESTE_TIMEOUT_MS 2000
+
+/* Variáveis privadas (static) */
+
+static rule_t s_tabela[RULE_ENGINE_MAX_RULES];
+
+/* Funções auxiliares */
+
+static uint32_t avaliar(int32_t temperatura)
+{
+    return rule_engine_eval(RULE_CHANNEL_TEMPERATURA, temperatura, esp_timer_get_time());
+}
+
+/** Aguarda a task de atuação aplicar `total` comandos desde o início */
+static void aguardar_executados(uint32_t total)
+{
+    actuator_stats_t stats;
+    TickType_t inicio = xTaskGetTickCount();
+
+    do
+    {
+        TEST_ASSERT_LESS_THAN(pdMS_TO_TICKS(TESTE_TIMEOUT_MS), xTaskGetTickCount() - inicio);
+        vTaskDelay(pdMS_TO_TICKS(1));
+        actuator_get_stats(&stats);
+    } while (stats.executados < total);
+
+    TEST_ASSERT_EQUAL_UINT32(total, stats.executados);
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+/* Casos */
+
+static void test_transicao_descartada_e_repetida(void)
+{
+    const rule_t regra = {
+        .threshold = 10,
+        .channel = RULE_CHANNEL_TEMPERATURA,
+        .cmp = RULE_CMP_GT,
+        .gpio = TESTE_GPIO,
+        .level = 1,
+    };
+    TEST_ASSERT_EQUAL(ESP_OK, rule_engine_init(1ULL << TESTE_GPIO, &regra, 1));
+
+    // Sem a task de atuação o comando é descartado e a regra segue inativa
+    TEST_ASSERT_EQUAL_UINT32(0, avaliar(20));
+
+    actuator_stats_t stats;
+    actuator_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.descartados);
+
+    TEST_ASSERT_EQUAL(ESP_OK, actuator_init());
+    TEST_ASSERT_EQUAL_UINT32(1, avaliar(20));
+    TEST_ASSERT_EQUAL_UINT32(0, avaliar(20));
+    aguardar_executados(1);
+    TEST_ASSERT_EQUAL(1, gpio_get_level(TESTE_GPIO));
+}
+
+static void test_recarga_libera_tabela_cheia(void)
+{
+    for (int i = 0; i < RULE_ENGINE_MAX_RULES; i++)
+    {
+        s_tabela[i] = (rule_t){
+            .threshold = 10 + i % 4,
+            .channel = RULE_CHANNEL_TEMPERATURA,
+            .cmp = RULE_CMP_GT,
+            .gpio = TESTE_GPIO,
+            .level = 1,
+        };
+    }
+
+    // Libera a regra do caso anterior; com a fila vazia, a tabela inteira cabe
+    TEST_ASSERT_EQUAL(ESP_OK, rule_engine_load(s_tabela, RULE_ENGINE_MAX_RULES));
+    aguardar_executados(2);
+    TEST_ASSERT_EQUAL_UINT32(RULE_ENGINE_MAX_RULES, avaliar(20));
+
+    // A recarga libera as RULE_ENGINE_MAX_RULES regras com um comando só
+    // (mesmo GPIO). Se a fila ainda estiver cheia, a próxima amostra o reposta.
+    TEST_ASSERT_EQUAL(ESP_OK, rule_engine_load(s_tabela, 1));
+    TickType_t inicio = xTaskGetTickCount();
+    while (gpio_get_level(TESTE_GPIO) != 0)
+    {
+        TEST_ASSERT_LESS_THAN(pdMS_TO_TICKS(TESTE_TIMEOUT_MS), xTaskGetTickCount() - inicio);
+        vTaskDelay(pdMS_TO_TICKS(1));
+        TEST_ASSERT_EQUAL_UINT32(0, avaliar(0));
+    }
+
+    // Caso anterior (ativação e liberação), a tabela inteira e uma liberação
+    aguardar_executados(2 + RULE_ENGINE_MAX_RULES + 1);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_transicao_descartada_e_repetida);
+    RUN_TEST(test_recarga_libera_tabela_cheia);
+    return UNITY_END();
+}
@@ -0,0 +1,101 @@
+/**
+ * @file test_main.c
+ * @brief Alocações em regime no modo de memória estática (mem_budget.h).
+ *
+ * Sobe o sistema com mqtt_system_init() e cria a task de sensores como o
+ * app_main(). Depois do aquecimento, a auditoria do mem_budget conta os
+ * malloc das tasks do perfil (hooks do host, CONFIG_HEAP_USE_HOOKS)
+ * durante TESTE_ITERACOES iterações da telemetria e dos sensores: no modo
+ * estático a contagem deve ser zero. Sem broker, a telemetria segue pela
+ * fila offline.
+ *
+ * Execução: pio test -e host-test-static
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#include <unity.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "services/mqtt_system.h"
+#include "services/mem_budget.h"
+#include "services/sampler.h"
+#include "services/task_profile.h"
+#include "tasks/sensor_simulate_task.h"
+
+/** Iterações de cada loop auditadas */
+#define TESTE_ITERACOES 200
+
+/** Tempo de subida das tasks e da conexão antes da auditoria */
+#define TESTE_AQUECIMENTO_MS 2000
+
+/** Limite para as iterações (os períodos do ambiente são de 5 ms) */
+#define TESTE_TIMEOUT_MS 20000
+
+/* Funções auxiliares */
+
+/** Despertares do job desde o início (amostras do histograma de jitter) */
+static uint32_t iteracoes(sampler_job_t job)
+{
+    sampler_stats_t stats;
+    sampler_get_stats(job, &stats);
+    return stats.jitter.amostras;
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+/* Casos */
+
+static void test_init_em_modo_estatico(void)
+{
+    TEST_ASSERT_EQUAL(1, MEM_STATIC_ALLOCATION);
+    TEST_ASSERT_EQUAL(ESP_OK, mqtt_system_init());
+    TEST_ASSERT_EQUAL(ESP_OK, task_profile_create(TASK_ID_SENSOR_SIMULATE,
+                                                  sensor_simulate_task, NULL, NULL));
+    vTaskDelay(pdMS_TO_TICKS(TESTE_AQUECIMENTO_MS));
+
+    TEST_ASSERT_GREATER_THAN(0, iteracoes(SAMPLER_JOB_TELEMETRY));
+    TEST_ASSERT_GREATER_THAN(0, iteracoes(SAMPLER_JOB_SENSORES));
+}
+
+static void test_regime_sem_alocacoes(void)
+{
+    mem_audit_t audit;
+    mem_budget_audit_get(&audit);
+    TEST_ASSERT_TRUE_MESSAGE(audit.suportado, "Compile com CONFIG_HEAP_USE_HOOKS");
+
+    uint32_t telemetria = iteracoes(SAMPLER_JOB_TELEMETRY);
+    uint32_t sensores = iteracoes(SAMPLER_JOB_SENSORES);
+    mem_budget_audit_start();
+
+    TickType_t inicio = xTaskGetTickCount();
+    while (iteracoes(SAMPLER_JOB_TELEMETRY) - telemetria < TESTE_ITERACOES ||
+           iteracoes(SAMPLER_JOB_SENSORES) - sensores < TESTE_ITERACOES)
+    {
+        TEST_ASSERT_LESS_THAN(pdMS_TO_TICKS(TESTE_TIMEOUT_MS), xTaskGetTickCount() - inicio);
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+
+    mem_budget_audit_get(&audit);
+    for (int id = 0; id < TASK_ID_COUNT; id++)
+    {
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, audit.por_task[id], task_profile_get(id)->nome);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, audit.total);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_init_em_modo_estatico);
+    RUN_TEST(test_regime_sem_alocacoes);
+    return UNITY_END();
+}
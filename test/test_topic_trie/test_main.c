@@ -0,0 +1,211 @@
+/**
+ * @file test_main.c
+ * @brief Testes da trie de filtros com curingas (topic_trie.h).
+ *
+ * A trie é global e não tem reset: cada teste usa um prefixo próprio,
+ * conta as chamadas no seu contexto e remove os filtros no final, de modo
+ * que filtros de outros testes não alteram as contagens.
+ *
+ * Execução: pio test -e host-test -f test_topic_trie
+ *
+ * @author Moacyr Francischetti Correa
+ * @date 2025
+ */
+
+#include <string.h>
+#include <unity.h>
+
+#include "services/topic_trie.h"
+
+/* Funções auxiliares */
+
+static void count_handler(const mqtt_message_t *msg, void *ctx)
+{
+    (*(int *)ctx)++;
+}
+
+/** Entrega o tópico à trie; retorna quantas vezes o handler do contexto rodou */
+static int deliver(const char *topic, int *counter)
+{
+    const mqtt_message_t msg = {
+        .topic = topic,
+        .topic_len = strlen(topic),
+        .data = "1",
+        .data_len = 1,
+    };
+
+    *counter = 0;
+    topic_trie_dispatch(&msg);
+    return *counter;
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+/* Casos */
+
+static void test_hash_casa_nivel_pai_e_subniveis(void)
+{
+    int n = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, topic_trie_insert("pai/casa/#", count_handler, &n));
+
+    TEST_ASSERT_EQUAL(1, deliver("pai/casa", &n));
+    TEST_ASSERT_EQUAL(1, deliver("pai/casa/sala", &n));
+    TEST_ASSERT_EQUAL(1, deliver("pai/casa/sala/luz", &n));
+    TEST_ASSERT_EQUAL(1, deliver("pai/casa/", &n));
+    TEST_ASSERT_EQUAL(0, deliver("pai", &n));
+    TEST_ASSERT_EQUAL(0, deliver("pai/casas", &n));
+    TEST_ASSERT_EQUAL(0, deliver("pai/outra/sala", &n));
+
+    TEST_ASSERT_EQUAL(ESP_OK, topic_trie_remove("pai/casa/#", count_handler));
+    TEST_ASSERT_EQUAL(0, deliver("pai/casa/sala", &n));
+}
+
+static void test_mais_casa_exatamente_um_nivel(void)
+{
+    int n = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, topic_trie_insert("mais/+/temp", count_handler, &n));
+
+    TEST_ASSERT_EQUAL(1, deliver("mais/sala/temp", &n));
+    TEST_ASSERT_EQUAL(1, deliver("mais/quarto/temp", &n));
+    TEST_ASSERT_EQUAL(0, deliver("mais/temp", &n));
+    TEST_ASSERT_EQUAL(0, deliver("mais/sala/quarto/temp", &n));
+    TEST_ASSERT_EQUAL(0, deliver("mais/sala/temp/x", &n));
+
+    TEST_ASSERT_EQUAL(ESP_OK, topic_trie_remove("mais/+/temp", count_handler));
+}
+
+static void test_filtros_sobrepostos_chamam_todos(void)
+{
+    int n = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, topic_trie_insert("sobre/+/luz", count_handler, &n));
+    TEST_ASSERT_EQUAL(ESP_OK, topic_trie_insert("sobre/sala/+", count_handler, &n));
+    TEST_ASSERT_EQUAL(ESP_OK, topic_trie_insert("sobre/#", count_handler, &n));
+    TEST_ASSERT_EQUAL(ESP_OK, topic_trie_insert("sobre/+/#", count_handler, &n));
+
+    TEST_ASSERT_EQUAL(4, deliver("sobre/sala/luz", &n));
+    TEST_ASSERT_EQUAL(3, deliver("sobre/sala/tv", &n));
+    TEST_ASSERT_EQUAL(2, deliver("sobre/sala", &n)); // '#' e "+/#" (nível pai)
+    TEST_ASSERT_EQUAL(1, deliver("sobre", &n));
+
+    TEST_ASSERT_EQUAL(ESP_OK, topic_trie_remove("sobre/+/luz", count_handler));
+    TEST_ASSERT_EQUAL(ESP_OK, topic_trie_remove("sobre/sala/+", count_handler));
+    TEST_ASSERT_EQUAL(ESP_OK, topic_trie_remove("sobre/#", count_handler));
+    TEST_ASSERT_EQUAL(ESP_OK, topic_trie_remove("sobre/+/#", count_handler));
+    TEST_ASSERT_EQUAL(0, deliver("sobre/sala/luz", &n));
+}
+
+static void test_topicos_dolar_e_curingas_no_primeiro_nivel(void)
+{
+    int raiz = 0;
+    int sys = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, topic_trie_insert("#", count_handler, &raiz));
+    TEST_ASSERT_EQUAL(ESP_OK, topic_trie_insert("+/monitor/#", count_handler, &raiz));
+    TEST_ASSERT_EQUAL(ESP_OK, topic_trie_insert("$SYS/#", count_handler, &sys));
+    TEST_ASSERT_EQUAL(ESP_OK, topic_trie_insert("$SYS/+/clientes", count_handler, &sys));
+
+    /* Curinga no primeiro nível não casa tópico iniciado por '$' */
+    TEST_ASSERT_EQUAL(0, deliver("$SYS/monitor/uptime", &raiz));
+    TEST_ASSERT_EQUAL(1, deliver("$SYS/monitor/uptime", &sys));
+    TEST_ASSERT_EQUAL(2, deliver("$SYS/broker/clientes", &sys));
+
+    /* '$' fora do primeiro nível é um caractere comum */
+    TEST_ASSERT_EQUAL(2, deliver("app/monitor/$x", &raiz));
+    TEST_ASSERT_EQUAL(0, deliver("app/monitor/$x", &sys));
+
+    TEST_ASSERT_EQUAL(ESP_OK, topic_trie_remove("#", count_handler));
+    TEST_ASSERT_EQUAL(ESP_OK, topic_trie_remove("+/monitor/#", count_handler));
+    TEST_ASSERT_EQUAL(ESP_OK, topic_trie_remove("$SYS/#", count_handler));
+    TEST_ASSERT_EQUAL(ESP_OK, topic_trie_remove("$SYS/+/clientes", count_handler));
+}
+
+static void test_niveis_vazios(void)
+{
+    int exato = 0;
+    int mais = 0;
+    int raiz = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, topic_trie_insert("vazio//b", count_handler, &exato));
+    TEST_ASSERT_EQUAL(ESP_OK, topic_trie_insert("vazio/+/b", count_handler, &mais));
+    TEST_ASSERT_EQUAL(ESP_OK, topic_trie_insert("/+", count_handler, &raiz));
+
+    /* Nível vazio é um nível: casa o literal vazio e '+' */
+    TEST_ASSERT_EQUAL(1, deliver("vazio//b", &exato));
+    TEST_ASSERT_EQUAL(1, deliver("vazio//b", &mais));
+    TEST_ASSERT_EQUAL(0, deliver("vazio/b", &exato));
+    TEST_ASSERT_EQUAL(0, deliver("vazio/b", &mais));
+
+    /* Barra inicial cria um primeiro nível vazio */
+    TEST_ASSERT_EQUAL(1, deliver("/vazio", &raiz));
+    TEST_ASSERT_EQUAL(1, deliver("/", &raiz));
+    TEST_ASSERT_EQUAL(0, deliver("vazio", &raiz));
+    TEST_ASSERT_EQUAL(0, deliver("/vazio/b", &raiz));
+
+    TEST_ASSERT_EQUAL(ESP_OK, topic_trie_remove("vazio//b", count_handler));
+    TEST_ASSERT_EQUAL(ESP_OK, topic_trie_remove("vazio/+/b", count_handler));
+    TEST_ASSERT_EQUAL(ESP_OK, topic_trie_remove("/+", count_handler));
+}
+
+static void test_ciclos_reativam_entradas(void)
+{
+    int n = 0;
+    int outro = 0;
+
+    // Mais ciclos que o pool de entradas: cada inserção reativa a entrada removida
+    for (int i = 0; i < 2 * TOPIC_TRIE_MAX_ENTRIES; i++)
+    {
+        int *ctx = (i % 2) ? &outro : &n;
+        TEST_ASSERT_EQUAL(ESP_OK, topic_trie_insert("ciclo/+/estado", count_handler, ctx));
+        TEST_ASSERT_EQUAL(1, deliver("ciclo/sala/estado", ctx));
+        TEST_ASSERT_EQUAL(ESP_OK, topic_trie_remove("ciclo/+/estado", count_handler));
+        TEST_ASSERT_EQUAL(0, deliver("ciclo/sala/estado", ctx));
+    }
+
+    // Dois handlers no mesmo filtro: a remoção de um não afeta o outro
+    TEST_ASSERT_EQUAL(ESP_OK, topic_trie_insert("ciclo/#", count_handler, &n));
+    TEST_ASSERT_EQUAL(ESP_OK, topic_trie_insert("ciclo/#", count_handler, &n));
+    for (int i = 0; i < 2 * TOPIC_TRIE_MAX_ENTRIES; i++)
+    {
+        TEST_ASSERT_EQUAL(ESP_OK, topic_trie_remove("ciclo/#", count_handler));
+        TEST_ASSERT_EQUAL(1, deliver("ciclo/x", &n));
+        TEST_ASSERT_EQUAL(ESP_OK, topic_trie_insert("ciclo/#", count_handler, &n));
+        TEST_ASSERT_EQUAL(2, deliver("ciclo/x", &n));
+    }
+
+    TEST_ASSERT_EQUAL(ESP_OK, topic_trie_remove("ciclo/#", count_handler));
+    TEST_ASSERT_EQUAL(ESP_OK, topic_trie_remove("ciclo/#", count_handler));
+    TEST_ASSERT_EQUAL(0, deliver("ciclo/x", &n));
+}
+
+static void test_validacao_de_filtros(void)
+{
+    TEST_ASSERT_TRUE(topic_trie_filter_is_valid("#"));
+    TEST_ASSERT_TRUE(topic_trie_filter_is_valid("+"));
+    TEST_ASSERT_TRUE(topic_trie_filter_is_valid("+/+/"));
+    TEST_ASSERT_TRUE(topic_trie_filter_is_valid("a//#"));
+    TEST_ASSERT_FALSE(topic_trie_filter_is_valid(""));
+    TEST_ASSERT_FALSE(topic_trie_filter_is_valid("a/#/b"));
+    TEST_ASSERT_FALSE(topic_trie_filter_is_valid("a/b#"));
+    TEST_ASSERT_FALSE(topic_trie_filter_is_valid("a/+b"));
+
+    int n = 0;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, topic_trie_insert("a/#/b", count_handler, &n));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, topic_trie_remove("nunca/+", count_handler));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_hash_casa_nivel_pai_e_subniveis);
+    RUN_TEST(test_mais_casa_exatamente_um_nivel);
+    RUN_TEST(test_filtros_sobrepostos_chamam_todos);
+    RUN_TEST(test_topicos_dolar_e_curingas_no_primeiro_nivel);
+    RUN_TEST(test_niveis_vazios);
+    RUN_TEST(test_ciclos_reativam_entradas);
+    RUN_TEST(test_validacao_de_filtros);
+    return UNITY_END();
+}
@@ -0,0 +1,132 @@
+"""Formatador no host do log diferido em modo bruto (DEFERRED_LOG_RAW=1).
+
+Espelha src/services/deferred_log.c. Com DEFERRED_LOG_RAW=1 a task
+LogDrain escreve cada registro como "DL <hex>"; este script lê a tabela
+de formatos de src/services/deferred_log_fmt.h (o ID é a posição na
+tabela) e troca essas linhas pelo texto que o ESP_LOGx teria escrito,
+com o instante da gravação. As demais linhas passam sem alteração.
+
+Uso (log lido do arquivo ou da stdin):
+    pio device monitor | python tools/deferred_log.py
+    python tools/deferred_log.py serial.log --fmt src/services/deferred_log_fmt.h
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+DEFAULT_FMT = os.path.join(os.path.dirname(__file__), "..", "src", "services", "deferred_log_fmt.h")
+
+# timestamp_ms, id, n_args, n_str (deferred_log_record_t)
+RECORD_HEADER = struct.Struct("<IHBB")
+
+LEVEL_LETTERS = {
+    "ESP_LOG_ERROR": "E",
+    "ESP_LOG_WARN": "W",
+    "ESP_LOG_INFO": "I",
+    "ESP_LOG_DEBUG": "D",
+    "ESP_LOG_VERBOSE": "V",
+}
+
+ENTRY_RE = re.compile(
+    r'X\(\s*(\w+)\s*,\s*(ESP_LOG_\w+)\s*,\s*"((?:[^"\\]|\\.)*)"\s*,\s*((?:"(?:[^"\\]|\\.)*"\s*)+)\)'
+)
+LITERAL_RE = re.compile(r'"((?:[^"\\]|\\.)*)"')
+CONV_RE = re.compile(
+    r"%(?P<flags>[-+ #0]*)(?P<width>\d*)(?P<prec>\.\*|\.\d*)?(?P<len>hh|h|ll|l|z)?(?P<conv>[diuxXocfeEgGs%])"
+)
+LINE_RE = re.compile(r"DL ([0-9a-fA-F]+)")
+
+
+def _unescape(literal):
+    return re.sub(r"\\(.)", lambda m: {"n": "\n", "t": "\t"}.get(m.group(1), m.group(1)), literal)
+
+
+def load_formats(path=DEFAULT_FMT):
+    """Lê a tabela DEFERRED_LOG_FORMATS: lista de (id, nível, tag, formato)."""
+    with open(path, encoding="utf-8") as f:
+        text = f.read().replace("\\\n", "\n")
+    text = re.sub(r"/\*.*?\*/", "", text, flags=re.S)
+    start = text.index("#define DEFERRED_LOG_FORMATS(X)")
+    formats = []
+    for m in ENTRY_RE.finditer(text, start):
+        fmt = "".join(_unescape(s) for s in LITERAL_RE.findall(m.group(4)))
+        formats.append((m.group(1), m.group(2), _unescape(m.group(3)), fmt))
+    return formats
+
+
+def format_record(fmt, args, strings):
+    """Aplica o formato C aos argumentos do registro, como deferred_log_format()."""
+    args = list(args)
+    strings = list(strings)
+
+    def next_word():
+        return args.pop(0) if args else 0
+
+    def conversion(m):
+        conv = m.group("conv")
+        if conv == "%":
+            return "%"
+        spec = "%" + m.group("flags") + m.group("width")
+        if m.group("prec") and m.group("prec") != ".*":
+            spec += m.group("prec")
+
+        if conv == "s":
+            return (spec + "s") % (strings.pop(0) if strings else "")
+        if conv in "feEgG":
+            return (spec + conv) % struct.unpack("<f", struct.pack("<I", next_word()))[0]
+
+        bits = 32
+        value = next_word()
+        if m.group("len") == "ll":
+            value |= next_word() << 32
+            bits = 64
+        if conv == "c":
+            return (spec + "c") % chr(value & 0xFF)
+        if conv in "di" and value >= 1 << (bits - 1):
+            value -= 1 << bits
+        return (spec + ("d" if conv in "diu" else conv)) % value
+
+    return CONV_RE.sub(conversion, fmt)
+
+
+def decode_line(hex_text, formats):
+    """Converte o hex de uma linha "DL" na linha do esp_log."""
+    data = bytes.fromhex(hex_text)
+    timestamp_ms, fmt_id, n_args, n_str = RECORD_HEADER.unpack_from(data)
+    args = struct.unpack_from(f"<{n_args}I", data, RECORD_HEADER.size)
+    raw = data[RECORD_HEADER.size + 4 * n_args:][:n_str]
+    strings = [s.decode("utf-8", "replace") for s in raw.split(b"\0")[:-1]] if raw else []
+
+    if fmt_id >= len(formats):
+        return f"? ({timestamp_ms}) DEFERRED_LOG: formato desconhecido {fmt_id} (tabela desatualizada?)"
+
+    _, level, tag, fmt = formats[fmt_id]
+    return f"{LEVEL_LETTERS.get(level, '?')} ({timestamp_ms}) {tag}: {format_record(fmt, args, strings)}"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("log", nargs="?", help="arquivo de log (padrão: stdin)")
+    parser.add_argument("--fmt", default=DEFAULT_FMT, help="caminho de deferred_log_fmt.h")
+    opts = parser.parse_args()
+
+    formats = load_formats(opts.fmt)
+    source = open(opts.log, encoding="utf-8", errors="replace") if opts.log else sys.stdin
+    with source:
+        for line in source:
+            m = LINE_RE.search(line)
+            if m is None:
+                sys.stdout.write(line)
+                continue
+            try:
+                print(decode_line(m.group(1), formats))
+            except (ValueError, struct.error):
+                sys.stdout.write(line)
+            sys.stdout.flush()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,339 @@
+"""Decodificador dos payloads de telemetria e health para o host.
+
+Espelha src/services/payload_codec.c. Converte payloads JSON, CBOR
+(tópico + "/cbor") ou binários v1/v2 (tópico + "/bin") para dicionários
+com os mesmos nomes de campo do formato JSON.
+
+Uso como biblioteca:
+    from payload_codec import decode
+    amostras = decode(payload, "cbor")
+
+Uso pela linha de comando (payload lido do arquivo ou da stdin):
+    mosquitto_sub -t demo/central/telemetria/bin -C 1 | python tools/payload_codec.py bin
+"""
+
+import json
+import struct
+import sys
+
+BINARY_VERSION = 2
+BINARY_TYPE_TELEMETRY = 1
+BINARY_TYPE_HEALTH = 2
+
+TELEMETRY_KEYS = {1: "temperatura", 2: "umidade", 3: "contador", 4: "timestamp"}
+
+HEALTH_KEYS = {
+    1: "free_heap",
+    2: "min_free_heap",
+    3: "wifi_rssi",
+    4: "uptime_sec",
+    5: "mqtt_connected",
+    6: "msgs_sent",
+    7: "msgs_received",
+    8: "mqtt_failures",
+    9: "disconnects",
+    10: "offline_depth",
+    11: "offline_bytes",
+    12: "offline_dropped",
+    13: "ack_samples",
+    14: "ack_p50_us",
+    15: "ack_p95_us",
+    16: "ack_p99_us",
+    17: "ack_max_us",
+    18: "act_samples",
+    19: "act_p50_us",
+    20: "act_p95_us",
+    21: "act_p99_us",
+    22: "act_max_us",
+    23: "act_dropped",
+    24: "stack_free",
+    25: "cpu_window_ms",
+    26: "cpu_idle",
+    27: "cpu_tasks",
+    28: "heap_largest",
+    29: "heap_frag",
+    30: "heap_caps",
+    31: "heap_window_ms",
+    32: "heap_allocs",
+    33: "heap_frees",
+    34: "heap_alloc_bytes",
+    35: "heap_trace_ms",
+    36: "heap_trace",
+}
+
+HEALTH_FIELDS = [
+    "msgs_sent",
+    "msgs_received",
+    "mqtt_failures",
+    "disconnects",
+    "offline_depth",
+    "offline_bytes",
+    "offline_dropped",
+]
+
+# Acrescentados ao fim do registro de health (ausentes em firmwares antigos)
+HEALTH_ACK_FIELDS = ["ack_samples", "ack_p50_us", "ack_p95_us", "ack_p99_us", "ack_max_us"]
+HEALTH_ACT_FIELDS = [
+    "act_samples",
+    "act_p50_us",
+    "act_p95_us",
+    "act_p99_us",
+    "act_max_us",
+    "act_dropped",
+]
+
+# Stack livre de task inexistente (PAYLOAD_STACK_AUSENTE)
+STACK_ABSENT = 0xFFFF
+
+# Nomes das tasks na ordem de task_id_t (src/services/task_profile.h); o
+# tamanho do array vem do payload, e ids além desta lista viram "task<id>"
+STACK_TASKS = [
+    "Telemetry",
+    "HealthMon",
+    "OfflineDrain",
+    "Connection",
+    "Actuator",
+    "SystemMonitor",
+    "CustomPublish",
+    "SensorSimulate",
+    "LogDrain",
+]
+
+# Núcleos com ociosidade no registro binário v1 e marcador de núcleo sem medição
+CPU_CORES = 2
+CPU_ABSENT = 0xFFFF
+
+# A v1 não tinha contagens: firmwares publicaram 8 tasks (até a LogDrain) ou
+# 9, seguidas de nada, da CPU ou da CPU e do heap. O tamanho do registro
+# identifica a combinação
+V1_STACK_TASK_COUNTS = (8, 9)
+V1_STACK_TAILS = (0, 4 + 2 * CPU_CORES, 4 + 2 * CPU_CORES + 22)
+
+# Campos do heap ao fim do registro binário
+HEAP_RATE_FIELDS = ["heap_allocs", "heap_frees", "heap_alloc_bytes"]
+
+
+# =============================================================================
+# CBOR (subconjunto usado pelo firmware)
+# =============================================================================
+
+
+def _cbor_item(data, pos):
+    initial = data[pos]
+    pos += 1
+    major, info = initial >> 5, initial & 0x1F
+
+    if initial == 0xF4:
+        return False, pos
+    if initial == 0xF5:
+        return True, pos
+    if initial == 0xFA:
+        return struct.unpack(">f", data[pos : pos + 4])[0], pos + 4
+
+    if info == 31:
+        if major != 4:
+            raise ValueError("Item CBOR indefinido nao suportado")
+        items = []
+        while data[pos] != 0xFF:
+            item, pos = _cbor_item(data, pos)
+            items.append(item)
+        return items, pos + 1
+
+    if info < 24:
+        value = info
+    else:
+        size = {24: 1, 25: 2, 26: 4, 27: 8}[info]
+        value = int.from_bytes(data[pos : pos + size], "big")
+        pos += size
+
+    if major == 0:
+        return value, pos
+    if major == 1:
+        return -1 - value, pos
+    if major == 3:
+        return data[pos : pos + value].decode("utf-8"), pos + value
+    if major == 4:
+        items = []
+        for _ in range(value):
+            item, pos = _cbor_item(data, pos)
+            items.append(item)
+        return items, pos
+    if major == 5:
+        result = {}
+        for _ in range(value):
+            key, pos = _cbor_item(data, pos)
+            result[key], pos = _cbor_item(data, pos)
+        return result, pos
+
+    raise ValueError(f"Tipo CBOR nao suportado: {major}")
+
+
+def _rename(item, names):
+    return {names.get(key, key): value for key, value in item.items()}
+
+
+def _task_name(task_id):
+    return STACK_TASKS[task_id] if task_id < len(STACK_TASKS) else f"task{task_id}"
+
+
+def _stack_free(values):
+    """Array na ordem de task_id_t -> objeto do JSON."""
+    return {_task_name(i): value for i, value in enumerate(values) if value != STACK_ABSENT}
+
+
+def _centi(value):
+    """Centésimos de % -> % com duas casas, como no JSON."""
+    return value / 100.0
+
+
+def decode_cbor(data):
+    item, _ = _cbor_item(bytes(data), 0)
+
+    if isinstance(item, list):
+        return [_rename(sample, TELEMETRY_KEYS) for sample in item]
+    if len(item) == len(TELEMETRY_KEYS):
+        return _rename(item, TELEMETRY_KEYS)
+
+    health = _rename(item, HEALTH_KEYS)
+    health["mqtt_connected"] = int(health["mqtt_connected"])
+    if "stack_free" in health:
+        health["stack_free"] = _stack_free(health["stack_free"])
+    if "cpu_idle" in health:
+        health["cpu_idle"] = [_centi(v) for v in health["cpu_idle"]]
+        health["cpu_tasks"] = {k: _centi(v) for k, v in health["cpu_tasks"].items()}
+    if "heap_frag" in health:
+        health["heap_frag"] = _centi(health["heap_frag"])
+        health["heap_caps"] = {
+            name: dict(zip(("free", "largest", "min"), values))
+            for name, values in health["heap_caps"].items()
+        }
+    return health
+
+
+# =============================================================================
+# Binário compacto (v1 e v2)
+# =============================================================================
+
+
+def _v1_stack_tasks(data):
+    """Tasks no array de stacks de um registro v1, pelo tamanho do registro."""
+    rest = len(data) - (4 + 88)
+    if rest <= 0:
+        return 0
+    for tail in V1_STACK_TAILS:
+        if (rest - tail) % 2 == 0 and (rest - tail) // 2 in V1_STACK_TASK_COUNTS:
+            return (rest - tail) // 2
+    raise ValueError(f"Registro de health v1 com tamanho inesperado: {len(data)}")
+
+
+def _decode_health_v1_tail(data, health):
+    """Campos após as latências na v1, sem contagens antes dos arrays."""
+    tasks = _v1_stack_tasks(data)
+    if tasks:
+        values = struct.unpack_from(f"<{tasks}H", data, 4 + 88)
+        health["stack_free"] = _stack_free(values)
+    offset = 4 + 88 + 2 * tasks
+    if len(data) >= offset + 4 + 2 * CPU_CORES:
+        window, *idle = struct.unpack_from(f"<I{CPU_CORES}H", data, offset)
+        if window != 0:
+            health["cpu_window_ms"] = window
+            health["cpu_idle"] = [_centi(v) for v in idle if v != CPU_ABSENT]
+    offset += 4 + 2 * CPU_CORES
+    return offset
+
+
+def _decode_health_v2_tail(data, health):
+    """Campos após as latências na v2: cada array traz a própria contagem."""
+    offset = 4 + 88
+    (tasks,) = struct.unpack_from("<B", data, offset)
+    values = struct.unpack_from(f"<{tasks}H", data, offset + 1)
+    health["stack_free"] = _stack_free(values)
+    offset += 1 + 2 * tasks
+
+    window, cores = struct.unpack_from("<IB", data, offset)
+    idle = struct.unpack_from(f"<{cores}H", data, offset + 5)
+    # Só a ociosidade por núcleo: o uso por task não vai no binário
+    if window != 0:
+        health["cpu_window_ms"] = window
+        health["cpu_idle"] = [_centi(v) for v in idle if v != CPU_ABSENT]
+    return offset + 5 + 2 * cores
+
+
+def decode_binary(data):
+    data = bytes(data)
+    version, kind, count, _ = struct.unpack_from("<BBBB", data, 0)
+
+    if version not in (1, BINARY_VERSION):
+        raise ValueError(f"Versao binaria desconhecida: {version}")
+
+    if kind == BINARY_TYPE_TELEMETRY:
+        samples = []
+        for i in range(count):
+            temp, umid, contador, timestamp = struct.unpack_from("<hHIQ", data, 4 + 16 * i)
+            samples.append(
+                {
+                    "temperatura": temp / 100.0,
+                    "umidade": umid / 100.0,
+                    "contador": contador,
+                    "timestamp": timestamp,
+                }
+            )
+        return samples
+
+    if kind == BINARY_TYPE_HEALTH:
+        free, min_free, rssi, flags, _, uptime = struct.unpack_from("<IIbBHI", data, 4)
+        health = {
+            "free_heap": free,
+            "min_free_heap": min_free,
+            "wifi_rssi": rssi,
+            "uptime_sec": uptime,
+            "mqtt_connected": flags & 0x01,
+        }
+        values = struct.unpack_from("<7I", data, 4 + 16)
+        health.update(zip(HEALTH_FIELDS, values))
+        if len(data) >= 4 + 64:
+            values = struct.unpack_from("<5I", data, 4 + 44)
+            health.update(zip(HEALTH_ACK_FIELDS, values))
+        if len(data) >= 4 + 88:
+            values = struct.unpack_from("<6I", data, 4 + 64)
+            health.update(zip(HEALTH_ACT_FIELDS, values))
+        if version == 1:
+            offset = _decode_health_v1_tail(data, health)
+        else:
+            offset = _decode_health_v2_tail(data, health)
+        if len(data) >= offset + 22:
+            largest, frag, window, *rates = struct.unpack_from("<IHI3I", data, offset)
+            # Sem regiões nem captura por task: só em JSON e CBOR
+            health["heap_largest"] = largest
+            health["heap_frag"] = _centi(frag)
+            if window != 0:
+                health["heap_window_ms"] = window
+                health.update(zip(HEAP_RATE_FIELDS, rates))
+        return health
+
+    raise ValueError(f"Tipo de registro desconhecido: {kind}")
+
+
+def decode(data, fmt="json"):
+    """Decodifica um payload no formato 'json', 'cbor' ou 'bin'."""
+    if fmt == "json":
+        return json.loads(bytes(data).decode("utf-8"))
+    if fmt == "cbor":
+        return decode_cbor(data)
+    if fmt == "bin":
+        return decode_binary(data)
+    raise ValueError(f"Formato desconhecido: {fmt}")
+
+
+if __name__ == "__main__":
+    if len(sys.argv) < 2:
+        print(f"Uso: {sys.argv[0]} json|cbor|bin [arquivo]")
+        sys.exit(1)
+
+    if len(sys.argv) > 2:
+        with open(sys.argv[2], "rb") as f:
+            payload = f.read()
+    else:
+        payload = sys.stdin.buffer.read()
+
+    print(json.dumps(decode(payload, sys.argv[1]), indent=2, ensure_ascii=False))
@@ -0,0 +1,157 @@
+"""Compara os resultados do microbenchmark de publicação com a baseline.
+
+Lê o log do firmware compilado com CONFIG_PUBLISH_BENCH (linhas
+"BENCH name=... p50=... p99=... heap_max=...") e compara cada caso com
+tools/publish_bench_baseline.json, separada por plataforma (host, qemu,
+esp32). Ciclos de plataformas diferentes não são comparáveis.
+
+Regressão (código de saída 1):
+    - p50 acima da baseline em mais que --tolerance (padrão 15%);
+    - p99 acima da baseline em mais que --tail-tolerance (padrão 50%);
+    - heap_max maior que o da baseline (nova alocação retida por chamada).
+Diferenças menores que --min-delta ciclos (padrão 100) são ignoradas, pois
+em casos curtos ficam dentro do ruído da própria leitura do contador.
+
+Uso:
+    .pio/build/host-bench/program | python tools/publish_bench.py compare -
+    python tools/publish_bench.py compare qemu.log
+    python tools/publish_bench.py update a.log b.log c.log  # nova baseline (mediana)
+"""
+
+import argparse
+import json
+import os
+import re
+import statistics
+import sys
+
+DEFAULT_BASELINE = os.path.join(os.path.dirname(__file__), "publish_bench_baseline.json")
+
+BEGIN_RE = re.compile(r"BENCH_BEGIN platform=(\w+)")
+CASE_RE = re.compile(r"BENCH name=(\S+) ((?:\w+=-?\d+\s*)+)")
+METRICS = ("p50", "p90", "p99", "max", "heap_avg", "heap_max")
+
+
+def parse_log(lines):
+    """Retorna (plataforma, {caso: {métrica: valor}}) do último BENCH_BEGIN."""
+    platform = None
+    cases = {}
+    for line in lines:
+        begin = BEGIN_RE.search(line)
+        if begin:
+            platform = begin.group(1)
+            cases = {}
+            continue
+        match = CASE_RE.search(line)
+        if match and platform:
+            fields = dict(kv.split("=") for kv in match.group(2).split())
+            cases[match.group(1)] = {k: int(v) for k, v in fields.items() if k in METRICS}
+    return platform, cases
+
+
+def read_lines(path):
+    if path == "-":
+        return sys.stdin.read().splitlines()
+    with open(path, encoding="utf-8", errors="replace") as f:
+        return f.read().splitlines()
+
+
+def median_cases(runs):
+    """Mediana, por caso e métrica, de várias execuções (baseline estável)."""
+    merged = {}
+    for name in runs[0]:
+        samples = [run[name] for run in runs if name in run]
+        merged[name] = {
+            k: int(statistics.median(sample[k] for sample in samples))
+            for k in ("p50", "p90", "p99", "heap_max")
+        }
+    return merged
+
+
+def load_baseline(path):
+    if not os.path.exists(path):
+        return {}
+    with open(path, encoding="utf-8") as f:
+        return json.load(f)
+
+
+def compare(platform, cases, baseline, tolerance, tail_tolerance, min_delta):
+    """Imprime a tabela de comparação e retorna o número de regressões."""
+    reference = baseline.get(platform)
+    if not reference:
+        print(f"Sem baseline para '{platform}'; gere com: publish_bench.py update <log>")
+        return 0
+
+    regressions = 0
+    print(f"{'caso':<26}{'p50':>9}{'base':>9}{'Δ%':>8}{'p99':>9}{'base':>9}{'Δ%':>8}  heap")
+    for name, result in cases.items():
+        base = reference.get(name)
+        if base is None:
+            print(f"{name:<26}{result['p50']:>9}{'-':>9}{'':>8}{result['p99']:>9}{'-':>9}{'':>8}  NOVO")
+            continue
+
+        d50 = (result["p50"] - base["p50"]) / max(base["p50"], 1)
+        d99 = (result["p99"] - base["p99"]) / max(base["p99"], 1)
+        problems = []
+        if d50 > tolerance and result["p50"] - base["p50"] > min_delta:
+            problems.append("p50")
+        if d99 > tail_tolerance and result["p99"] - base["p99"] > min_delta:
+            problems.append("p99")
+        if result["heap_max"] > base["heap_max"]:
+            problems.append("heap")
+
+        status = "REGRESSAO(" + ",".join(problems) + ")" if problems else "ok"
+        regressions += 1 if problems else 0
+        print(f"{name:<26}{result['p50']:>9}{base['p50']:>9}{d50 * 100:>7.1f}%"
+              f"{result['p99']:>9}{base['p99']:>9}{d99 * 100:>7.1f}%  "
+              f"{result['heap_max']:>4} {status}")
+
+    for name in reference:
+        if name not in cases:
+            print(f"{name:<26} ausente no log")
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("command", choices=("compare", "update"))
+    parser.add_argument("logs", nargs="+", help="log(s) do firmware ('-' para stdin)")
+    parser.add_argument("--baseline", default=DEFAULT_BASELINE)
+    parser.add_argument("--tolerance", type=float, default=0.15)
+    parser.add_argument("--tail-tolerance", type=float, default=0.50)
+    parser.add_argument("--min-delta", type=int, default=100)
+    args = parser.parse_args()
+
+    parsed = [parse_log(read_lines(path)) for path in args.logs]
+    parsed = [(platform, cases) for platform, cases in parsed if cases]
+    if not parsed:
+        print("Nenhum resultado BENCH encontrado no log")
+        return 2
+    if len({platform for platform, _ in parsed}) > 1:
+        print("Logs de plataformas diferentes não podem ser combinados")
+        return 2
+    platform, cases = parsed[0]
+
+    baseline = load_baseline(args.baseline)
+
+    if args.command == "update":
+        baseline[platform] = median_cases([c for _, c in parsed])
+        with open(args.baseline, "w", encoding="utf-8") as f:
+            json.dump(baseline, f, indent=2, sort_keys=True)
+            f.write("\n")
+        print(f"Baseline '{platform}' atualizada com {len(cases)} casos "
+              f"({len(parsed)} execuções) em {args.baseline}")
+        return 0
+
+    if len(parsed) > 1:
+        print("compare aceita um único log")
+        return 2
+
+    regressions = compare(platform, cases, baseline, args.tolerance, args.tail_tolerance,
+                          args.min_delta)
+    print(f"{len(cases)} casos, {regressions} regressões ({platform})")
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())